@@ -0,0 +1,115 @@
+#include <blockchain/BlockTimestampIndex.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/interprocess/file_mapping.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+namespace thinkyoung {
+    namespace blockchain {
+
+        namespace {
+            //the file grows by this many blocks at a time, about three days of blocks
+            const uint32_t timestamp_file_growth = 1 << 15;
+        }
+
+        BlockTimestampIndex::BlockTimestampIndex()
+            : _timestamps(nullptr), _capacity(0), _size(0)
+        {
+        }
+
+        BlockTimestampIndex::~BlockTimestampIndex()
+        {
+            close();
+        }
+
+        void BlockTimestampIndex::open(const fc::path& file)
+        {
+            try {
+                close();
+                _file = file;
+                fc::create_directories(_file.parent_path());
+
+                if (!fc::exists(_file))
+                    std::ofstream(_file.generic_string().c_str(), std::ios::binary);
+
+                map(std::max<uint32_t>(uint32_t(fc::file_size(_file) / sizeof(uint32_t)), timestamp_file_growth));
+                _size = 0;
+            } FC_CAPTURE_AND_RETHROW((file))
+        }
+
+        void BlockTimestampIndex::close()
+        {
+            if (_region)
+                _region->flush();
+            _region.reset();
+            _mapping.reset();
+            _timestamps = nullptr;
+            _capacity = 0;
+            _size = 0;
+        }
+
+        void BlockTimestampIndex::resize(const uint32_t block_count)
+        {
+            _size = std::min(block_count, _capacity);
+        }
+
+        void BlockTimestampIndex::store(const uint32_t block_num, const fc::time_point_sec& timestamp)
+        {
+            try {
+                FC_ASSERT(is_open(), "block timestamp index is not open");
+                FC_ASSERT(block_num > 0);
+
+                if (block_num > _capacity)
+                    map(block_num + timestamp_file_growth - block_num % timestamp_file_growth);
+
+                _timestamps[block_num - 1] = timestamp.sec_since_epoch();
+                _size = block_num;
+            } FC_CAPTURE_AND_RETHROW((block_num)(timestamp))
+        }
+
+        fc::time_point_sec BlockTimestampIndex::at(const uint32_t block_num)const
+        {
+            if (block_num == 0 || block_num > _capacity)
+                return fc::time_point_sec();
+
+            return fc::time_point_sec(_timestamps[block_num - 1]);
+        }
+
+        uint32_t BlockTimestampIndex::find_block_num(const fc::time_point_sec& time)const
+        {
+            if (_size == 0)
+                return 0;
+
+            const uint32_t* last = std::upper_bound(_timestamps, _timestamps + _size, time.sec_since_epoch());
+            return std::max<uint32_t>(uint32_t(last - _timestamps), 1);
+        }
+
+        uint32_t BlockTimestampIndex::find_first_block_num(const fc::time_point_sec& time)const
+        {
+            const uint32_t* first = std::lower_bound(_timestamps, _timestamps + _size, time.sec_since_epoch());
+            return uint32_t(first - _timestamps) + 1;
+        }
+
+        void BlockTimestampIndex::map(const uint32_t capacity)
+        {
+            try {
+                if (_region)
+                    _region->flush();
+                _region.reset();
+                _mapping.reset();
+                _timestamps = nullptr;
+
+                if (fc::file_size(_file) < uint64_t(capacity) * sizeof(uint32_t))
+                    fc::resize_file(_file, size_t(capacity) * sizeof(uint32_t));
+
+                _mapping.reset(new fc::file_mapping(_file.generic_string().c_str(), fc::read_write));
+                _region.reset(new fc::mapped_region(*_mapping, fc::read_write));
+                _timestamps = static_cast<uint32_t*>(_region->get_address());
+                _capacity = uint32_t(_region->get_size() / sizeof(uint32_t));
+            } FC_CAPTURE_AND_RETHROW((capacity))
+        }
+
+    }
+} // thinkyoung::blockchain
@@ -23,41 +23,133 @@
 #include <blockchain/api_extern.hpp>
 #include <thread>
 #include <blockchain/ContractOperations.hpp>
+#include <glua/glua_state_pool.h>
 namespace thinkyoung {
     namespace blockchain {
     
         const static short MAX_RECENT_OPERATIONS = 20;
         
         namespace detail {
+            // every transaction adds its fee to the base asset, the other fields must be left alone
+            static bool same_except_collected_fees(AssetEntry a, const AssetEntry& b) {
+                a.collected_fees = b.collected_fees;
+                return fc::raw::pack(a) == fc::raw::pack(b);
+            }
+            
             void ChainDatabaseImpl::revalidate_pending() {
                 _pending_fee_index.clear();
                 int count = 0;
                 vector<TransactionIdType> trx_to_discard;
                 _pending_trx_state = std::make_shared<PendingChainState>(self->shared_from_this());
                 unsigned num_pending_transaction_considered = 0;
-                auto itr = _pending_transaction_db.begin();
+                unsigned num_pending_transaction_reused = 0;
+                
+                // Replay in the order the transactions were accepted so each one only depends on those before it;
+                // transactions never evaluated with dependency tracking come first
+                vector<std::pair<uint64_t, SignedTransaction>> pending_trxs;
+                
+                for (auto itr = _pending_transaction_db.begin(); itr.valid(); ++itr) {
+                    const auto dep_iter = _pending_trx_dependencies.find(itr.key());
+                    pending_trxs.emplace_back(dep_iter != _pending_trx_dependencies.end() ? dep_iter->second.sequence : 0, itr.value());
+                }
                 
-                while (itr.valid()) {
-                    SignedTransaction trx = itr.value();
-                    const TransactionIdType trx_id = itr.key();
-                    assert(trx_id == trx.id());
+                std::stable_sort(pending_trxs.begin(), pending_trxs.end(),
+                [](const std::pair<uint64_t, SignedTransaction>& a, const std::pair<uint64_t, SignedTransaction>& b) {
+                    return a.first < b.first;
+                });
+                // Keys changed since the transactions were evaluated, grows with the changes of every
+                // transaction that is evaluated again or dropped
+                ChainStateKeys dirty_keys = std::move(_pending_dirty_keys);
+                _pending_dirty_keys.clear();
+                // every block and every transaction writes the base asset, each transaction compares it below instead
+                const AssetIdType base_asset_id(0);
+                const auto ignore_base_asset = [base_asset_id](ChainStateKeys& keys) {
+                    keys.asset_ids.erase(base_asset_id);
+                    keys.asset_symbols.erase(ALP_BLOCKCHAIN_SYMBOL);
+                };
+                const auto base_asset_holds = [base_asset_id](const PendingTrxDependencies& dependencies, const oAssetEntry& current_base) -> bool {
+                    if (!dependencies.base_asset.valid() || !current_base.valid())
+                        return false;
+                        
+                    // blocks pay their delegate from the collected fees and new shares, transactions read neither
+                    AssetEntry read_base = *dependencies.base_asset;
+                    read_base.current_share_supply = current_base->current_share_supply;
+                    
+                    if (!same_except_collected_fees(read_base, *current_base))
+                        return false;
+                        
+                    const auto written_base = dependencies.changes->_asset_id_to_entry.find(base_asset_id);
+                    return written_base == dependencies.changes->_asset_id_to_entry.end()
+                           || same_except_collected_fees(written_base->second, *dependencies.base_asset);
+                };
+                ignore_base_asset(dirty_keys);
+                // a later head block only loosens the other checks that read now()
+                const fc::time_point_sec now = self->now();
+                map<TransactionIdType, PendingTrxDependencies> kept_dependencies;
+                
+                for (const auto& item : pending_trxs) {
+                    const SignedTransaction& trx = item.second;
+                    const TransactionIdType trx_id = trx.id();
+                    auto dep_iter = _pending_trx_dependencies.find(trx_id);
+                    const bool tracked = dep_iter != _pending_trx_dependencies.end() && dep_iter->second.changes;
                     
                     try {
-                        TransactionEvaluationStatePtr eval_state = self->evaluate_transaction(trx, _relay_fee, false, true);
+                        const oAssetEntry current_base = _pending_trx_state->get_asset_entry(base_asset_id);
                         
-                        if (eval_state->p_result_trx.operations.size() > 0) {
-                            eval_state->p_result_trx.operations.resize(0);
+                        if (tracked && dep_iter->second.fees >= _relay_fee && now < trx.expiration
+                                && !dep_iter->second.read_keys->intersects(dirty_keys)
+                                && base_asset_holds(dep_iter->second, current_base)) {
+                            // the changes keep the time they were stamped with, generate_block evaluates them again
+                            PendingTrxDependencies& dependencies = dep_iter->second;
+                            dependencies.changes->set_prev_state(_pending_trx_state);
+                            dependencies.changes->apply_changes();
+                            const auto written_base = dependencies.changes->_asset_id_to_entry.find(base_asset_id);
+                            
+                            if (written_base != dependencies.changes->_asset_id_to_entry.end()) {
+                                // the changes hold the base asset as it was read, add only their own fee to it
+                                AssetEntry base = *current_base;
+                                base.collected_fees = (fc::safe<ShareType>(current_base->collected_fees)
+                                                       + fc::safe<ShareType>(written_base->second.collected_fees)
+                                                       - fc::safe<ShareType>(dependencies.base_asset->collected_fees)).value;
+                                _pending_trx_state->store_asset_entry(base);
+                            }
+                            
+                            _pending_fee_index[fee_index(dependencies.eval_state->get_fees(), trx_id)] = dependencies.eval_state;
+                            dependencies.sequence = ++_pending_trx_sequence;
+                            kept_dependencies[trx_id] = std::move(dependencies);
+                            ++num_pending_transaction_reused;
+                            
+                        } else {
+                            if (tracked) {
+                                dep_iter->second.changes->get_written_keys(dirty_keys);
+                                ignore_base_asset(dirty_keys);
+                            }
+                            
+                            PendingTrxDependencies dependencies;
+                            TransactionEvaluationStatePtr eval_state = self->evaluate_transaction(trx, _relay_fee, false, true, false, &dependencies);
+                            
+                            if (eval_state->p_result_trx.operations.size() > 0) {
+                                eval_state->p_result_trx.operations.resize(0);
+                            }
+                            
+                            ShareType fees = eval_state->get_fees();
+                            _pending_fee_index[fee_index(fees, trx_id)] = eval_state;
+                            
+                            if (dependencies.changes) {
+                                dependencies.changes->get_written_keys(dirty_keys);
+                                ignore_base_asset(dirty_keys);
+                                dependencies.sequence = ++_pending_trx_sequence;
+                                kept_dependencies[trx_id] = std::move(dependencies);
+                            }
+                            
+                            ilog("revalidated pending transaction id ${id}", ("id", trx_id));
                         }
                         
-                        ShareType fees = eval_state->get_fees();
-                        _pending_fee_index[fee_index(fees, trx_id)] = eval_state;
                         count++;
                         
                         if (count > ALP_BLOCKCHAIN_REVALIDATE_MAX_TRX_COUNT)
                             break;
                             
-                        ilog("revalidated pending transaction id ${id}", ("id", trx_id));
-                        
                     } catch (const fc::canceled_exception&) {
                         throw;
                         
@@ -68,15 +160,17 @@ namespace thinkyoung {
                     }
                     
                     ++num_pending_transaction_considered;
-                    ++itr;
                 }
                 
+                _pending_trx_dependencies = std::move(kept_dependencies);
+                
                 for (const auto& item : trx_to_discard)
                     _pending_transaction_db.remove(item);
                     
-                ilog("revalidate_pending complete, there are now ${pending_count} evaluated transactions, ${num_pending_transaction_considered} raw transactions",
+                ilog("revalidate_pending complete, there are now ${pending_count} evaluated transactions, ${num_pending_transaction_considered} raw transactions, ${num_pending_transaction_reused} unaffected by the new block",
                      ("pending_count", _pending_fee_index.size())
-                     ("num_pending_transaction_considered", num_pending_transaction_considered));
+                     ("num_pending_transaction_considered", num_pending_transaction_considered)
+                     ("num_pending_transaction_reused", num_pending_transaction_reused));
             }
             
             void ChainDatabaseImpl::load_checkpoints(const fc::path& data_dir)const {
@@ -126,10 +220,177 @@ namespace thinkyoung {
             
             bool ChainDatabaseImpl::replay_required(const fc::path& data_dir) {
                 try {
-                    _property_id_to_entry.open(data_dir / "index/property_id_to_entry");
+                    // older versions kept every table of the chain state in a database of its own
+                    if (!fc::is_directory(data_dir / "index/chain_state"))
+                        return true;
+                        
+                    // the version is a table of the chain state, which only opens with all of its tables
+                    open_database(data_dir);
                     const oPropertyEntry entry = self->get_property_entry(PropertyIdType::database_version);
-                    _property_id_to_entry.close();
-                    return !entry.valid() || entry->value.as_uint64() != ALP_BLOCKCHAIN_DATABASE_VERSION;
+                    
+                    if (entry.valid() && entry->value.as_uint64() == ALP_BLOCKCHAIN_DATABASE_VERSION)
+                        return false;
+                        
+                    self->close();
+                    return true;
+                }
+                
+                FC_CAPTURE_AND_RETHROW((data_dir))
+            }
+            
+            void ChainDatabaseImpl::upgrade_contract_storage_db(const fc::path& data_dir) {
+                try {
+                    const fc::path legacy_dir = data_dir / "index/contract_id_to_storage";
+                    
+                    if (!fc::is_directory(legacy_dir))
+                        return;
+                        
+                    wlog("Converting contract storage database to per-key layout");
+                    thinkyoung::db::LevelMap<ContractIdType, ContractStorageEntry> legacy_storage_db;
+                    legacy_storage_db.open(legacy_dir);
+                    
+                    for (auto iter = legacy_storage_db.begin(); iter.valid(); ++iter) {
+                        const ContractStorageEntry& entry = iter.value();
+                        auto batch = _contract_storage_key_to_item.create_batch();
+                        
+                        for (const auto& item : entry.contract_storages)
+                            batch.store(ContractStorageKey(iter.key(), item.first), ContractStorageItem(item.second));
+                            
+                        batch.commit();
+                    }
+                    
+                    legacy_storage_db.close();
+                    fc::remove_all(legacy_dir);
+                }
+                
+                FC_CAPTURE_AND_RETHROW((data_dir))
+            }
+            
+            void ChainDatabaseImpl::upgrade_block_header_db() {
+                try {
+                    // a replay stores every header again while it pushes the blocks
+                    if (_replaying || _block_id_to_header.begin().valid() || !_block_id_to_full_block.begin().valid())
+                        return;
+                        
+                    wlog("Building block header database from stored blocks");
+                    
+                    for (auto iter = _block_id_to_full_block.begin(); iter.valid(); ++iter)
+                        _block_id_to_header.store(iter.key(), SignedBlockHeader(iter.value()));
+                }
+                
+                FC_CAPTURE_AND_RETHROW()
+            }
+            
+            void ChainDatabaseImpl::sync_block_timestamps() {
+                try {
+                    const uint32_t head_block_num = _head_block_header.block_num;
+                    // blocks within the undo history may have been replaced by a fork before the index was written
+                    const uint32_t recent_block_num = head_block_num > ALP_BLOCKCHAIN_MAX_UNDO_HISTORY ? head_block_num - ALP_BLOCKCHAIN_MAX_UNDO_HISTORY : 0;
+                    
+                    if (head_block_num > 0 && _block_timestamps.at(1) == fc::time_point_sec())
+                        wlog("Building block timestamp index from stored block headers");
+                        
+                    for (uint32_t block_num = 1; block_num <= head_block_num; ++block_num) {
+                        if (block_num <= recent_block_num && _block_timestamps.at(block_num) != fc::time_point_sec())
+                            continue;
+                            
+                        _block_timestamps.store(block_num, self->get_block_header(block_num).timestamp);
+                    }
+                    
+                    _block_timestamps.resize(head_block_num);
+                }
+                
+                FC_CAPTURE_AND_RETHROW()
+            }
+            
+            void ChainDatabaseImpl::upgrade_balance_owner_db() {
+                try {
+                    if (_balance_owner_index.begin().valid() || _balance_id_to_entry.empty())
+                        return;
+                        
+                    wlog("Building balance owner index from balance database");
+                    _balance_id_to_entry.scan([this](const BalanceIdType& id, const BalanceEntry& entry) {
+                        index_balance_owners(id, entry, true);
+                    });
+                }
+                
+                FC_CAPTURE_AND_RETHROW()
+            }
+            
+            void ChainDatabaseImpl::index_balance_owners(const BalanceIdType& id, const BalanceEntry& entry, const bool add) {
+                try {
+                    for (const Address& owner : entry.owners()) {
+                        if (add)
+                            _balance_owner_index.store(BalanceOwnerKey(owner, id), 0);
+                            
+                        else
+                            _balance_owner_index.remove(BalanceOwnerKey(owner, id));
+                    }
+                }
+                
+                FC_CAPTURE_AND_RETHROW((id)(entry)(add))
+            }
+            
+            void ChainDatabaseImpl::index_contract_events(const FullBlock& block_data, const bool add) {
+                try {
+                    uint32_t trx_num = 0;
+                    
+                    for (const SignedTransaction& trx : block_data.user_transactions) {
+                        TransactionIdType trx_id;
+                        uint32_t op_num = 0;
+                        
+                        for (const Operation& op : trx.operations) {
+                            if (op.type.value == event_op_type) {
+                                const EventOperation event_op = op.as<EventOperation>();
+                                const ContractEventKey key(event_op.id, event_op.event_type, block_data.block_num, trx_num, op_num);
+                                
+                                if (!add) {
+                                    _contract_event_index.remove(key);
+                                    
+                                } else {
+                                    if (trx_id == TransactionIdType())
+                                        trx_id = trx.id();
+                                        
+                                    _contract_event_index.store(key, ContractEventEntry(event_op, trx_id, block_data.block_num, trx_num));
+                                }
+                            }
+                            
+                            ++op_num;
+                        }
+                        
+                        ++trx_num;
+                    }
+                }
+                
+                FC_CAPTURE_AND_RETHROW((block_data.block_num)(add))
+            }
+            
+            void ChainDatabaseImpl::upgrade_address_transaction_db(const fc::path& data_dir) {
+                try {
+                    const fc::path legacy_dir = data_dir / "index/address_to_transaction_ids";
+                    
+                    if (!fc::is_directory(legacy_dir))
+                        return;
+                        
+                    wlog("Converting address transaction database to per-transaction keys");
+                    thinkyoung::db::LevelMap<Address, unordered_set<TransactionIdType>> legacy_transaction_db;
+                    legacy_transaction_db.open(legacy_dir);
+                    
+                    for (auto iter = legacy_transaction_db.begin(); iter.valid(); ++iter) {
+                        auto batch = _address_transaction_index.create_batch();
+                        
+                        for (const TransactionIdType& id : iter.value()) {
+                            const oTransactionEntry entry = _transaction_id_to_entry.fetch_optional(id);
+                            
+                            if (entry.valid())
+                                batch.store(AddressTransactionKey(iter.key(), entry->chain_location.block_num, entry->chain_location.trx_num), id);
+                        }
+                        
+                        batch.commit();
+                    }
+                    
+                    legacy_transaction_db.close();
+                    fc::remove_all(legacy_dir);
                 }
                 
                 FC_CAPTURE_AND_RETHROW((data_dir))
@@ -137,37 +398,79 @@ namespace thinkyoung {
             
             void ChainDatabaseImpl::open_database(const fc::path& data_dir) {
                 try {
+                    const auto cache_limit = [this](const string& name) -> size_t {
+                        const auto iter = _db_cache_sizes.find(name);
+                        return iter != _db_cache_sizes.end() ? iter->second : 0;
+                    };
+                    // leveldb orders the keys of every table while it opens, so all of them are added first
+                    decltype(_property_id_to_entry)::add_table(_chain_state_db, property_id_to_entry_table);
+                    decltype(_account_id_to_entry)::add_table(_chain_state_db, account_id_to_entry_table);
+                    decltype(_account_name_to_id)::add_table(_chain_state_db, account_name_to_id_table);
+                    decltype(_account_address_to_id)::add_table(_chain_state_db, account_address_to_id_table);
+                    decltype(_asset_id_to_entry)::add_table(_chain_state_db, asset_id_to_entry_table);
+                    decltype(_asset_symbol_to_id)::add_table(_chain_state_db, asset_symbol_to_id_table);
+                    decltype(_slate_id_to_entry)::add_table(_chain_state_db, slate_id_to_entry_table);
+                    decltype(_balance_id_to_entry)::add_table(_chain_state_db, balance_id_to_entry_table);
+                    decltype(_balance_owner_index)::add_table(_chain_state_db, balance_owner_index_table);
+                    decltype(_alp_input_balance_entry)::add_table(_chain_state_db, alp_input_balance_entry_table);
+                    decltype(_alp_full_entry)::add_table(_chain_state_db, alp_full_entry_table);
+                    decltype(_contract_id_to_entry)::add_table(_chain_state_db, contract_id_to_entry_table);
+                    decltype(_contract_name_to_id)::add_table(_chain_state_db, contract_name_to_id_table);
+                    decltype(_request_to_result_iddb)::add_table(_chain_state_db, request_to_result_iddb_table);
+                    decltype(_result_to_request_iddb)::add_table(_chain_state_db, result_to_request_iddb_table);
+                    decltype(_trx_to_contract_iddb)::add_table(_chain_state_db, trx_to_contract_iddb_table);
+                    decltype(_contract_to_trx_iddb)::add_table(_chain_state_db, contract_to_trx_iddb_table);
+                    decltype(_pending_transaction_db)::add_table(_chain_state_db, pending_transaction_db_table);
+                    decltype(_fork_number_db)::add_table(_chain_state_db, fork_number_db_table);
+                    decltype(_fork_db)::add_table(_chain_state_db, fork_db_table);
+                    decltype(_revalidatable_future_blocks_db)::add_table(_chain_state_db, revalidatable_future_blocks_db_table);
+                    decltype(_block_id_to_block_entry_db)::add_table(_chain_state_db, block_id_to_block_entry_db_table);
+                    decltype(_transaction_id_to_entry)::add_table(_chain_state_db, transaction_id_to_entry_table);
+                    decltype(_address_transaction_index)::add_table(_chain_state_db, address_transaction_index_table);
+                    decltype(_slot_index_to_entry)::add_table(_chain_state_db, slot_index_to_entry_table);
+                    decltype(_slot_timestamp_to_delegate)::add_table(_chain_state_db, slot_timestamp_to_delegate_table);
+                    decltype(_contract_storage_key_to_item)::add_table(_chain_state_db, contract_storage_key_to_item_table);
+                    decltype(_contract_event_index)::add_table(_chain_state_db, contract_event_index_table);
+                    decltype(_block_num_to_undo_journal)::add_table(_chain_state_db, block_num_to_undo_journal_table);
+                    _chain_state_db.open(data_dir / "index/chain_state");
+                    _contract_storage_key_to_item.open(_chain_state_db, contract_storage_key_to_item_table);
+                    _contract_event_index.open(_chain_state_db, contract_event_index_table);
+                    upgrade_contract_storage_db(data_dir);
                     _block_id_to_full_block.open(data_dir / "raw_chain/block_id_to_block_data_db");
-                    _block_id_to_undo_state.open(data_dir / "index/block_id_to_undo_state");
-                    _fork_number_db.open(data_dir / "index/fork_number_db");
-                    _fork_db.open(data_dir / "index/fork_db");
-                    _revalidatable_future_blocks_db.open(data_dir / "index/future_blocks_db");
+                    _block_id_to_header.open(data_dir / "index/block_id_to_header_db");
+                    upgrade_block_header_db();
+                    _block_timestamps.open(data_dir / "index/block_timestamps");
+                    _block_num_to_undo_journal.open(_chain_state_db, block_num_to_undo_journal_table);
+                    _fork_number_db.open(_chain_state_db, fork_number_db_table);
+                    _fork_db.open(_chain_state_db, fork_db_table);
+                    _revalidatable_future_blocks_db.open(_chain_state_db, revalidatable_future_blocks_db_table);
                     _block_num_to_id_db.open(data_dir / "raw_chain/block_num_to_id_db");
-                    _block_id_to_block_entry_db.open(data_dir / "index/block_id_to_block_entry_db");
-                    _property_id_to_entry.open(data_dir / "index/property_id_to_entry");
-                    _account_id_to_entry.open(data_dir / "index/account_id_to_entry");
-                    _account_name_to_id.open(data_dir / "index/account_name_to_id");
-                    _account_address_to_id.open(data_dir / "index/account_address_to_id");
+                    _block_id_to_block_entry_db.open(_chain_state_db, block_id_to_block_entry_db_table);
+                    _property_id_to_entry.open(_chain_state_db, property_id_to_entry_table, cache_limit("property_id_to_entry"));
+                    _account_id_to_entry.open(_chain_state_db, account_id_to_entry_table, cache_limit("account_id_to_entry"));
+                    _account_name_to_id.open(_chain_state_db, account_name_to_id_table, cache_limit("account_name_to_id"));
+                    _account_address_to_id.open(_chain_state_db, account_address_to_id_table, cache_limit("account_address_to_id"));
                     //contract db
-                    _contract_id_to_entry.open(data_dir / "index/contract_id_to_entry");
-                    _contract_id_to_storage.open(data_dir / "index/contract_id_to_storage");
-                    _contract_name_to_id.open(data_dir / "index/contract_name_to_id");
-                    _result_to_request_iddb.open(data_dir / "index/_result_to_request_id");
-                    _asset_id_to_entry.open(data_dir / "index/asset_id_to_entry");
-                    _asset_symbol_to_id.open(data_dir / "index/asset_symbol_to_id");
-                    _slate_id_to_entry.open(data_dir / "index/slate_id_to_entry");
-                    _balance_id_to_entry.open(data_dir / "index/balance_id_to_entry");
-                    _transaction_id_to_entry.open(data_dir / "index/transaction_id_to_entry");
-                    _address_to_transaction_ids.open(data_dir / "index/address_to_transaction_ids");
-                    _alp_input_balance_entry.open(data_dir / "index/_alp_input_balance_entry");
-                    _alp_full_entry.open(data_dir / "index/_alp_full_entry");
-                    _block_extend_status.open(data_dir / "index/_block_extend_status");
-                    _pending_transaction_db.open(data_dir / "index/pending_transaction_db");
-                    _slot_index_to_entry.open(data_dir / "index/slot_index_to_entry");
-                    _slot_timestamp_to_delegate.open(data_dir / "index/slot_timestamp_to_delegate");
-                    _request_to_result_iddb.open(data_dir / "index/_request_to_result_iddb");
-                    _contract_to_trx_iddb.open(data_dir / "index/_contract_to_trx_iddb");
-                    _trx_to_contract_iddb.open(data_dir / "index/_trx_to_contract_iddb");
+                    _contract_id_to_entry.open(_chain_state_db, contract_id_to_entry_table, cache_limit("contract_id_to_entry"));
+                    _contract_name_to_id.open(_chain_state_db, contract_name_to_id_table, cache_limit("contract_name_to_id"));
+                    _result_to_request_iddb.open(_chain_state_db, result_to_request_iddb_table, cache_limit("_result_to_request_id"));
+                    _asset_id_to_entry.open(_chain_state_db, asset_id_to_entry_table, cache_limit("asset_id_to_entry"));
+                    _asset_symbol_to_id.open(_chain_state_db, asset_symbol_to_id_table, cache_limit("asset_symbol_to_id"));
+                    _slate_id_to_entry.open(_chain_state_db, slate_id_to_entry_table, cache_limit("slate_id_to_entry"));
+                    _balance_id_to_entry.open(_chain_state_db, balance_id_to_entry_table, cache_limit("balance_id_to_entry"));
+                    _balance_owner_index.open(_chain_state_db, balance_owner_index_table);
+                    upgrade_balance_owner_db();
+                    _transaction_id_to_entry.open(_chain_state_db, transaction_id_to_entry_table);
+                    _address_transaction_index.open(_chain_state_db, address_transaction_index_table);
+                    upgrade_address_transaction_db(data_dir);
+                    _alp_input_balance_entry.open(_chain_state_db, alp_input_balance_entry_table, cache_limit("_alp_input_balance_entry"));
+                    _alp_full_entry.open(_chain_state_db, alp_full_entry_table, cache_limit("_alp_full_entry"));
+                    _pending_transaction_db.open(_chain_state_db, pending_transaction_db_table);
+                    _slot_index_to_entry.open(_chain_state_db, slot_index_to_entry_table);
+                    _slot_timestamp_to_delegate.open(_chain_state_db, slot_timestamp_to_delegate_table);
+                    _request_to_result_iddb.open(_chain_state_db, request_to_result_iddb_table, cache_limit("_request_to_result_iddb"));
+                    _contract_to_trx_iddb.open(_chain_state_db, contract_to_trx_iddb_table, cache_limit("_contract_to_trx_iddb"));
+                    _trx_to_contract_iddb.open(_chain_state_db, trx_to_contract_iddb_table, cache_limit("_trx_to_contract_iddb"));
                     _pending_trx_state = std::make_shared<PendingChainState>(self->shared_from_this());
                     clear_invalidation_of_future_blocks();
                 }
@@ -177,13 +480,10 @@ namespace thinkyoung {
             
             void ChainDatabaseImpl::populate_indexes() {
                 try {
-                    for (auto iter = _account_id_to_entry.unordered_begin();
-                            iter != _account_id_to_entry.unordered_end(); ++iter) {
-                        const AccountEntry& entry = iter->second;
-                        
+                    _account_id_to_entry.scan([this](const AccountIdType, const AccountEntry& entry) {
                         if (!entry.is_retracted() && entry.is_delegate())
                             _delegate_votes.emplace(entry.net_votes(), entry.id);
-                    }
+                    });
                     
                     for (auto iter = _transaction_id_to_entry.begin(); iter.valid(); ++iter) {
 #ifdef __linux__
@@ -500,6 +800,7 @@ namespace thinkyoung {
 #endif
                     // first of all store this block at the given block number
                     _block_id_to_full_block.store(block_id, block_data);
+                    _block_id_to_header.store(block_id, block_data);
                     
                     if (self->get_statistics_enabled()) {
                         BlockEntry entry;
@@ -508,6 +809,10 @@ namespace thinkyoung {
                         entry.id = block_id;
                         entry.block_size = block_data.block_size();
                         entry.latency = blockchain::now() - block_data.timestamp;
+                        
+                        if (block_data.block_num == _generated_block_num && block_data.timestamp == _generated_block_timestamp)
+                            entry.assembly_time = _generated_block_assembly_time;
+                            
                         _block_id_to_block_entry_db.store(block_id, entry);
                     }
                     
@@ -671,7 +976,9 @@ namespace thinkyoung {
             }
             
             void ChainDatabaseImpl::apply_transactions(const FullBlock& block_data,
-                    const PendingChainStatePtr& pending_state) {
+                    const PendingChainStatePtr& pending_state,
+                    const vector<vector<RecoveredSignature>>* trx_signees,
+                    const bool allow_speculation) {
                 try {
                     uint32_t index = 0;
                     vector<std::future<bool>> signature_check_progress;
@@ -679,6 +986,22 @@ namespace thinkyoung {
                     uint32_t trx_num = 0;
                     bool all_trx_check = true;
                     
+                    if (trx_signees != nullptr && trx_signees->size() != block_data.user_transactions.size())
+                        trx_signees = nullptr;
+                        
+                    const bool speculate = allow_speculation && can_speculate_transactions(block_data.user_transactions);
+                    vector<SpeculativeTransaction> speculative;
+                    SpeculativeMerge merge;
+                    
+                    if (speculate) {
+                        merge.base_asset = pending_state->get_asset_entry(AssetIdType(0));
+                        FC_ASSERT(merge.base_asset.valid(), "Invalid asset");
+                        const auto new_eval_state = [this](const SignedTransaction& trx, const PendingChainStatePtr& state) {
+                            return new_block_eval_state(trx, state);
+                        };
+                        speculate_transactions(block_data.user_transactions, pending_state, new_eval_state, speculative);
+                    }
+                    
                     //̲߳Դ
                     for (const auto& trx : block_data.user_transactions) {
                         TransactionEvaluationStatePtr trx_eval_state = std::make_shared<TransactionEvaluationState>(pending_state.get());
@@ -688,10 +1011,25 @@ namespace thinkyoung {
                             std::vector<BalanceEntry> all_balances;
                             std::vector<AccountEntry> all_accounts;
                             trx_eval_state->transaction_entry_analy(trx, all_balances, all_accounts);
-                            auto check_thread = [=]()->bool {
-                                return trx_eval_state->transaction_signature_check(trx, all_balances, all_accounts);
-                            };
-                            signature_check_progress[trx_num] = _thread_pool.submit(check_thread);
+                            
+                            if (trx_signees != nullptr) {
+                                // Keys are already recovered, the remaining check is cheap enough to run here
+                                trx_eval_state->_recovered_signees = (*trx_signees)[trx_num];
+                                
+                                try {
+                                    if (!trx_eval_state->transaction_signature_check(trx, all_balances, all_accounts))
+                                        all_trx_check = false;
+                                        
+                                } catch (const fc::exception&) {
+                                }
+                                
+                            } else {
+                                auto check_thread = [=]()->bool {
+                                    return trx_eval_state->transaction_signature_check(trx, all_balances, all_accounts);
+                                };
+                                signature_check_progress[trx_num] = _thread_pool.submit(check_thread);
+                            }
+                            
                             trx_eval_state->_skip_signature_check = true;
                         }
                         
@@ -705,8 +1043,11 @@ namespace thinkyoung {
                         if (trx.result_trx_type == ResultTransactionType::incomplete_result_transaction)
                             trx_eval_state->skipexec = false;
                             
-                        trx_eval_state->evaluate(trx);
-                        
+                        if (speculate)
+                            trx_eval_state = merge_speculative_transaction(trx, speculative[trx_num], pending_state, merge);
+                        else
+                            trx_eval_state->evaluate(trx);
+                            
                         if (trx.result_trx_type == ResultTransactionType::origin_transaction) {
                             const TransactionIdType& trx_id = trx.id();
                             oTransactionEntry entry = pending_state->lookup<TransactionEntry>(trx_id);
@@ -747,6 +1088,17 @@ namespace thinkyoung {
                             ;
                         }
                         
+                        if (speculate) {
+                            // chain locations are stored on pending_state directly, later layers must not have read them
+                            merge.written_keys.transaction_ids.insert(trx.id());
+                            
+                            if (trx.result_trx_type != ResultTransactionType::origin_transaction)
+                                merge.written_keys.transaction_ids.insert(trx.operations[0].as<TransactionOperation>().trx.id());
+                                
+                            if (trx.result_trx_type == ResultTransactionType::incomplete_result_transaction)
+                                merge.written_keys.transaction_ids.insert(trx.result_trx_id);
+                        }
+                        
                         pending_state->event_vector.insert(pending_state->event_vector.end(), trx_eval_state->event_vector.begin(), trx_eval_state->event_vector.end());
                         // TODO:  capture the evaluation state with a callback for wallets...
                         // summary.transaction_states.emplace_back( std::move(trx_eval_state) );
@@ -766,6 +1118,10 @@ namespace thinkyoung {
                     
                     signature_check_progress.clear();
                     
+                    if (speculate && merge.reexecuted > 0)
+                        dlog("block ${n}: ${r} of ${t} transactions evaluated again after a conflict",
+                             ("n", block_data.block_num)("r", merge.reexecuted)("t", block_data.user_transactions.size()));
+                             
                     // test start
                     if (!all_trx_check) {
                         FC_CAPTURE_AND_THROW(missing_signature);
@@ -777,6 +1133,276 @@ namespace thinkyoung {
                 FC_CAPTURE_AND_RETHROW((block_data))
             }
             
+            // contract operations run in the glua vm, which keeps global state and can not run concurrently
+            static bool is_speculation_candidate(const SignedTransaction& trx) {
+                if (trx.result_trx_type != ResultTransactionType::origin_transaction)
+                    return false;
+                    
+                for (const auto& op : trx.operations) {
+                    switch (op.type.value) {
+                        case withdraw_op_type:
+                        case deposit_op_type:
+                        case register_account_op_type:
+                        case update_account_op_type:
+                        case withdraw_pay_op_type:
+                        case create_asset_op_type:
+                        case update_asset_op_type:
+                        case issue_asset_op_type:
+                        case define_slate_op_type:
+                        case update_signing_key_op_type:
+                        case update_balance_vote_op_type:
+                        case update_asset_ext_op_type:
+                        case imessage_memo_op_type:
+                            break;
+                            
+                        default:
+                            return false;
+                    }
+                }
+                
+                return true;
+            }
+            
+            template<typename EntryType, typename KeyType>
+            static void pack_written_entries(fc::sha256::encoder& enc, const PendingChainStatePtr& state, const set<KeyType>& keys) {
+                for (const auto& key : keys) {
+                    fc::raw::pack(enc, key);
+                    fc::raw::pack(enc, state->lookup<EntryType>(key));
+                }
+            }
+            
+            // digest of every entry a state wrote as read back through it, in key order
+            static fc::sha256 written_state_digest(const PendingChainStatePtr& state) {
+                ChainStateKeys keys;
+                state->get_written_keys(keys);
+                fc::sha256::encoder enc;
+                pack_written_entries<AccountEntry>(enc, state, keys.account_ids);
+                pack_written_entries<AccountEntry>(enc, state, keys.account_names);
+                pack_written_entries<AccountEntry>(enc, state, keys.account_addresses);
+                pack_written_entries<AssetEntry>(enc, state, keys.asset_ids);
+                pack_written_entries<AssetEntry>(enc, state, keys.asset_symbols);
+                pack_written_entries<SlateEntry>(enc, state, keys.slate_ids);
+                pack_written_entries<BalanceEntry>(enc, state, keys.balance_ids);
+                pack_written_entries<ContractEntry>(enc, state, keys.contract_ids);
+                pack_written_entries<ContractEntry>(enc, state, keys.contract_names);
+                pack_written_entries<ContractStorageItem>(enc, state, keys.contract_storage_keys);
+                pack_written_entries<PropertyEntry>(enc, state, keys.property_ids);
+                pack_written_entries<TransactionEntry>(enc, state, keys.transaction_ids);
+                pack_written_entries<SlotEntry>(enc, state, keys.slot_indexes);
+                pack_written_entries<SlotEntry>(enc, state, keys.slot_timestamps);
+                fc::raw::pack(enc, state->event_vector);
+                return enc.result();
+            }
+            
+            fc::sha256 ChainDatabaseImpl::applied_transactions_digest(const FullBlock& block_data,
+                    const PendingChainStatePtr& pending_state,
+                    const vector<vector<RecoveredSignature>>* trx_signees,
+                    const bool allow_speculation) {
+                try {
+                    const PendingChainStatePtr layer = std::make_shared<PendingChainState>(pending_state);
+                    apply_transactions(block_data, layer, trx_signees, allow_speculation);
+                    return written_state_digest(layer);
+                }
+                
+                FC_CAPTURE_AND_RETHROW((block_data.block_num)(allow_speculation))
+            }
+            
+            void ChainDatabaseImpl::check_speculative_transactions(const FullBlock& block_data,
+                    const PendingChainStatePtr& pending_state,
+                    const vector<vector<RecoveredSignature>>* trx_signees) {
+                try {
+                    const fc::sha256 sequential_digest = applied_transactions_digest(block_data, pending_state, trx_signees, false);
+                    const fc::sha256 speculated_digest = applied_transactions_digest(block_data, pending_state, trx_signees, true);
+                    FC_ASSERT(sequential_digest == speculated_digest, "speculative evaluation changed the block state",
+                              ("block_num", block_data.block_num)("sequential", sequential_digest)("speculated", speculated_digest));
+                }
+                
+                FC_CAPTURE_AND_RETHROW((block_data.block_num))
+            }
+            
+            TransactionEvaluationStatePtr ChainDatabaseImpl::new_block_eval_state(const SignedTransaction& trx,
+                    const PendingChainStatePtr& state)const {
+                TransactionEvaluationStatePtr eval_state = std::make_shared<TransactionEvaluationState>(state.get());
+                eval_state->_skip_signature_check = true;
+                eval_state->skipexec = !(self->generating_block);
+                
+                if (eval_state->skipexec)
+                    eval_state->skipexec = !self->get_node_vm_enabled();
+                    
+                if (trx.result_trx_type == ResultTransactionType::incomplete_result_transaction)
+                    eval_state->skipexec = false;
+                    
+                return eval_state;
+            }
+            
+            bool ChainDatabaseImpl::has_lazy_index()const {
+                for (const auto& item : _db_cache_sizes)
+                    if (item.second > 0)
+                        return true;
+                        
+                return false;
+            }
+            
+            bool ChainDatabaseImpl::can_speculate_transactions(const vector<SignedTransaction>& trxs)const {
+                if (has_lazy_index())
+                    return false;
+                    
+                uint32_t candidates = 0;
+                
+                for (const auto& trx : trxs)
+                    if (is_speculation_candidate(trx))
+                        ++candidates;
+                        
+                return candidates >= ALP_BLOCKCHAIN_MIN_SPECULATIVE_TRXS;
+            }
+            
+            void ChainDatabaseImpl::speculate_transactions(const vector<SignedTransaction>& trxs,
+                    const PendingChainStatePtr& pending_state,
+                    const std::function<TransactionEvaluationStatePtr(const SignedTransaction&, const PendingChainStatePtr&)>& new_eval_state,
+                    vector<SpeculativeTransaction>& speculative,
+                    const fc::time_point deadline) {
+                try {
+                    speculative.clear();
+                    speculative.resize(trxs.size());
+                    vector<std::future<bool>> progress(trxs.size());
+                    
+                    for (size_t i = 0; i < trxs.size(); ++i) {
+                        const SignedTransaction& trx = trxs[i];
+                        
+                        if (time_point::now() >= deadline)
+                            break;
+                            
+                        if (!is_speculation_candidate(trx))
+                            continue;
+                            
+                        SpeculativeTransaction& spec = speculative[i];
+                        spec.layer = std::make_shared<PendingChainState>(pending_state);
+                        spec.read_keys = std::make_shared<ChainStateKeys>();
+                        spec.layer->track_reads(spec.read_keys);
+                        spec.eval_state = new_eval_state(trx, spec.layer);
+                        const TransactionEvaluationStatePtr eval_state = spec.eval_state;
+                        auto evaluate_thread = [eval_state, &trx, deadline]()->bool {
+                            // started past the deadline, the block is packed without this transaction
+                            if (time_point::now() >= deadline)
+                                return false;
+                                
+                            try {
+                                eval_state->evaluate(trx);
+                                return true;
+                                
+                            } catch (const fc::exception&) {
+                            } catch (const std::exception&) {
+                            }
+                            
+                            return false;
+                        };
+                        progress[i] = _thread_pool.submit(evaluate_thread);
+                    }
+                    
+                    // pending_state must not change while any layer still reads through it
+                    for (size_t i = 0; i < progress.size(); ++i) {
+                        if (progress[i].valid() && !progress[i].get())
+                            speculative[i] = SpeculativeTransaction();
+                    }
+                }
+                
+                FC_CAPTURE_AND_RETHROW((trxs.size()))
+            }
+            
+            bool ChainDatabaseImpl::is_speculation_valid(const SignedTransaction& trx,
+                    const SpeculativeTransaction& speculative,
+                    const PendingChainStatePtr& pending_state,
+                    const SpeculativeMerge& merge)const {
+                try {
+                    // the merged writes leave out the base asset every layer adds its fee to, and the reads of
+                    // a layer do not include the transaction digests, check those here
+                    if (speculative.layer == nullptr || merge.base_asset_changed)
+                        return false;
+                        
+                    if (pending_state->is_known_transaction(trx))
+                        return false;
+                        
+                    if (speculative.read_keys->intersects(merge.written_keys))
+                        return false;
+                        
+                    ChainStateKeys written_keys;
+                    speculative.layer->get_written_keys(written_keys);
+                    
+                    if (written_keys.asset_ids.erase(AssetIdType(0)) > 0) {
+                        written_keys.asset_symbols.erase(merge.base_asset->symbol);
+                        const oAssetEntry layer_base = speculative.layer->get_asset_entry(AssetIdType(0));
+                        
+                        if (!layer_base.valid() || !same_except_collected_fees(*layer_base, *merge.base_asset))
+                            return false;
+                    }
+                    
+                    return !written_keys.intersects(merge.written_keys);
+                }
+                
+                FC_CAPTURE_AND_RETHROW((trx))
+            }
+            
+            void ChainDatabaseImpl::merge_layer(const PendingChainStatePtr& layer,
+                                                const bool speculated,
+                                                const PendingChainStatePtr& pending_state,
+                                                SpeculativeMerge& merge) {
+                try {
+                    const AssetIdType base_asset_id(0);
+                    const oAssetEntry current_base = pending_state->get_asset_entry(base_asset_id);
+                    FC_ASSERT(current_base.valid(), "Invalid asset");
+                    const auto layer_base = layer->_asset_id_to_entry.find(base_asset_id);
+                    oAssetEntry base;
+                    
+                    if (layer_base != layer->_asset_id_to_entry.end()) {
+                        if (speculated) {
+                            // the layer saw the base asset before any other fee of the block, keep only its own fee
+                            base = *current_base;
+                            base->collected_fees = (fc::safe<ShareType>(current_base->collected_fees)
+                                                    + fc::safe<ShareType>(layer_base->second.collected_fees)
+                                                    - fc::safe<ShareType>(merge.base_asset->collected_fees)).value;
+                                                    
+                        } else if (!same_except_collected_fees(layer_base->second, *current_base)) {
+                            // later layers read the base asset without recording it, they all run again
+                            merge.base_asset_changed = true;
+                        }
+                    }
+                    
+                    layer->apply_changes();
+                    
+                    if (base.valid())
+                        pending_state->store_asset_entry(*base);
+                        
+                    layer->get_written_keys(merge.written_keys);
+                    merge.written_keys.asset_ids.erase(base_asset_id);
+                    merge.written_keys.asset_symbols.erase(merge.base_asset->symbol);
+                }
+                
+                FC_CAPTURE_AND_RETHROW((speculated))
+            }
+            
+            TransactionEvaluationStatePtr ChainDatabaseImpl::merge_speculative_transaction(const SignedTransaction& trx,
+                    SpeculativeTransaction& speculative,
+                    const PendingChainStatePtr& pending_state,
+                    SpeculativeMerge& merge) {
+                try {
+                    if (is_speculation_valid(trx, speculative, pending_state, merge)) {
+                        merge_layer(speculative.layer, true, pending_state, merge);
+                        return speculative.eval_state;
+                    }
+                    
+                    if (speculative.layer != nullptr)
+                        ++merge.reexecuted;
+                        
+                    speculative.layer = std::make_shared<PendingChainState>(pending_state);
+                    speculative.eval_state = new_block_eval_state(trx, speculative.layer);
+                    speculative.eval_state->evaluate(trx);
+                    merge_layer(speculative.layer, false, pending_state, merge);
+                    return speculative.eval_state;
+                }
+                
+                FC_CAPTURE_AND_RETHROW((trx))
+            }
+            
             void ChainDatabaseImpl::pay_delegate(const BlockIdType& block_id,
                                                  const PublicKeyType& block_signee,
                                                  const PendingChainStatePtr& pending_state,
@@ -823,21 +1449,58 @@ namespace thinkyoung {
             
             void ChainDatabaseImpl::save_undo_state(const uint32_t block_num,
                                                     const BlockIdType& block_id,
-                                                    const PendingChainStatePtr& pending_state) {
+                                                    const PendingChainStatePtr& pending_state,
+                                                    oBlockEntry& block_entry) {
                 try {
                     if (block_num < _min_undo_block)
                         return;
                         
-                    PendingChainStatePtr undo_state = std::make_shared<PendingChainState>(pending_state);
-                    pending_state->get_undo_state(undo_state);
+                    UndoJournal journal;
+                    journal.block_id = block_id;
+                    pending_state->get_undo_journal(journal);
                     
-                    if (block_num > ALP_BLOCKCHAIN_MAX_UNDO_HISTORY) {
-                        const uint32_t old_block_num = block_num - ALP_BLOCKCHAIN_MAX_UNDO_HISTORY;
-                        const BlockIdType& old_block_id = self->get_block_id(old_block_num);
-                        _block_id_to_undo_state.remove(old_block_id);
-                    }
+                    if (block_num > ALP_BLOCKCHAIN_MAX_UNDO_HISTORY)
+                        _block_num_to_undo_journal.remove(block_num - ALP_BLOCKCHAIN_MAX_UNDO_HISTORY);
+                        
+                    _block_num_to_undo_journal.store(block_num, journal);
+                    
+                    if (block_entry.valid())
+                        block_entry->undo_bytes = fc::raw::pack_size(journal);
+                        
+                    _undo_journal_tail[block_num] = std::move(journal);
                     
-                    _block_id_to_undo_state.store(block_id, *undo_state);
+                    while (_undo_journal_tail.size() > ALP_BLOCKCHAIN_UNDO_JOURNAL_TAIL_SIZE)
+                        _undo_journal_tail.erase(_undo_journal_tail.begin());
+                }
+                
+                FC_CAPTURE_AND_RETHROW((block_num)(block_id))
+            }
+            
+            PendingChainStatePtr ChainDatabaseImpl::revert_undo_state(const uint32_t block_num,
+                    const BlockIdType& block_id) {
+                try {
+                    optional<UndoJournal> journal;
+                    const auto tail_iter = _undo_journal_tail.find(block_num);
+                    
+                    if (tail_iter != _undo_journal_tail.end())
+                        journal = tail_iter->second;
+                        
+                    else
+                        journal = _block_num_to_undo_journal.fetch_optional(block_num);
+                        
+                    FC_ASSERT(journal.valid() && journal->block_id == block_id, "undo journal of the block is missing");
+                    PendingChainStatePtr undo_state = std::make_shared<PendingChainState>(self->shared_from_this());
+                    journal->revert(*undo_state);
+                    undo_state->apply_changes();
+                    
+                    if (!_pending_trx_dependencies.empty()) {
+                        undo_state->get_written_keys(_pending_dirty_keys);
+                        _pending_dirty_keys.head_block = true;
+                    }
+                        
+                    _undo_journal_tail.erase(block_num);
+                    _block_num_to_undo_journal.remove(block_num);
+                    return undo_state;
                 }
                 
                 FC_CAPTURE_AND_RETHROW((block_num)(block_id))
@@ -881,6 +1544,15 @@ namespace thinkyoung {
                 try {
                     _head_block_header = block_header;
                     _head_block_id = block_id;
+                    
+                    if (block_header.block_num > 0)
+                        _block_timestamps.store(block_header.block_num, block_header.timestamp);
+                    
+                    std::lock_guard<std::mutex> lock(_block_header_tail_mutex);
+                    _block_header_tail[block_header.block_num] = block_header;
+                    
+                    while (_block_header_tail.size() > ALP_BLOCKCHAIN_MAX_UNDO_HISTORY)
+                        _block_header_tail.erase(_block_header_tail.begin());
                 }
                 
                 FC_CAPTURE_AND_RETHROW((block_header)(block_id))
@@ -1036,14 +1708,18 @@ namespace thinkyoung {
                     FullBlock block_data = self->get_block(block_index);
                     
                     for (const auto& item : block_data.user_transactions) {
-                        TransactionIdType trx_id = item.id();
+                        bool checked = false;
                         
                         for (const auto& op : item.operations) {
-                            if (thinkyoung::blockchain::event_op_type == op.type.value
-                                    && trx_id == trx_id_type) {
-                                EventOperation eop = op.as<EventOperation>();
-                                ops.push_back(eop);
-                            }
+                            if (thinkyoung::blockchain::event_op_type != op.type.value)
+                                continue;
+                                
+                            // only transactions that carry events are hashed
+                            if (!checked && item.id() != trx_id_type)
+                                break;
+                                
+                            checked = true;
+                            ops.push_back(op.as<EventOperation>());
                         }
                     }
                     
@@ -1054,6 +1730,18 @@ namespace thinkyoung {
                 return ops;
             }
             
+            void ChainDatabaseImpl::defer_chain_writes() {
+                try {
+                    _chain_state_db.defer_writes();
+                } FC_CAPTURE_AND_RETHROW()
+            }
+            
+            void ChainDatabaseImpl::commit_chain_writes() {
+                try {
+                    _chain_state_db.commit_deferred_writes();
+                } FC_CAPTURE_AND_RETHROW()
+            }
+            
             /**
              *  Performs all of the block validation steps and throws if error.
              */
@@ -1065,9 +1753,16 @@ namespace thinkyoung {
                     
                     try {
                         PublicKeyType block_signee;
+                        RecoveredSignees recovered;
+                        const auto recovered_iter = _recovered_signees.find(block_id);
+                        
+                        if (recovered_iter != _recovered_signees.end()) {
+                            recovered = std::move(recovered_iter->second);
+                            _recovered_signees.erase(recovered_iter);
+                        }
                         
                         if (block_data.block_num > LAST_CHECKPOINT_BLOCK_NUM) {
-                            block_signee = block_data.signee();
+                            block_signee = recovered.block_signee.valid() ? *recovered.block_signee : block_data.signee();
                             
                         } else {
                             const auto iter = CHECKPOINT_BLOCKS.find(block_data.block_num);
@@ -1093,26 +1788,43 @@ namespace thinkyoung {
                         
                         if (self->get_statistics_enabled()) block_entry = self->get_block_entry(block_id);
                         
-                        apply_transactions(block_data, pending_state);
+#ifndef NDEBUG
+                        // replay is where a divergence of the speculative path would go unnoticed
+                        if (_replaying && can_speculate_transactions(block_data.user_transactions))
+                            check_speculative_transactions(block_data, pending_state,
+                                                           recovered.trx_signees.empty() ? nullptr : &recovered.trx_signees);
+#endif
+                        apply_transactions(block_data, pending_state,
+                                           recovered.trx_signees.empty() ? nullptr : &recovered.trx_signees);
                         summary.applied_changes->event_vector = pending_state->event_vector;
                         pay_delegate(block_id, block_signee, pending_state, block_entry);
                         update_active_delegate_list(block_data.block_num, pending_state);
                         update_random_seed(block_data.previous_secret, pending_state, block_entry);
-                        save_undo_state(block_data.block_num, block_id, pending_state);
-                        self->store_extend_status(block_id, 1);
+                        // Everything the block changes, its undo journal included, reaches leveldb as one batch
+                        defer_chain_writes();
+                        save_undo_state(block_data.block_num, block_id, pending_state, block_entry);
                         // TODO: Verify idempotency
                         pending_state->apply_changes();
+                        index_contract_events(block_data, true);
+                        
+                        if (!_pending_trx_dependencies.empty()) {
+                            pending_state->get_written_keys(_pending_dirty_keys);
+                            _pending_dirty_keys.head_block = true;
+                        }
+                        
                         mark_included(block_id, true);
                         update_head_block(block_data, block_id);
                         clear_pending(block_data);
-                        _block_num_to_id_db.store(block_data.block_num, block_id);
+                        self->store_property_entry(PropertyIdType::head_block_id, variant(block_id));
                         
                         if (block_entry.valid()) {
                             block_entry->processing_time = time_point::now() - start_time;
                             _block_id_to_block_entry_db.store(block_id, *block_entry);
                         }
                         
-                        self->store_extend_status(block_id, 2);
+                        commit_chain_writes();
+                        // written after the chain state, sync_block_num_to_id repairs a crash in between
+                        _block_num_to_id_db.store(block_data.block_num, block_id);
                         
                         if (thinkyoung::client::g_client->get_wallet() != nullptr&&thinkyoung::client::g_client->get_wallet()->is_open()) {
                             if (!thinkyoung::client::g_client->get_wallet()->get_my_delegates(thinkyoung::wallet::enabled_delegate_status).empty()) {
@@ -1128,8 +1840,8 @@ namespace thinkyoung {
                         
                     } catch (const fc::exception& e) {
                         wlog("error applying block: ${e}", ("e", e.to_detail_string()));
+                        commit_chain_writes();
                         mark_invalid(block_id, e);
-                        self->store_extend_status(block_id, 2);
                         throw;
                     }
                     
@@ -1139,6 +1851,13 @@ namespace thinkyoung {
                     while (iter != _unique_transactions.end() && iter->expiration <= self->now())
                         iter = _unique_transactions.erase(iter);
                         
+                    // Top up the lua states of this thread once it is idle, used states come back reset and only
+                    // those that could not be reset are created again here; contracts run on this thread
+                    if (!_replaying && (!_prefill_lua_states.valid() || _prefill_lua_states.ready()))
+                        _prefill_lua_states = fc::async([]() {
+                        thinkyoung::lua::lib::GluaStatePool::instance().prefill();
+                    }, "prefill_lua_states");
+                    
                     //Schedule the observer notifications for later; the chain is in a
                     //non-premptable state right now, and observers may yield.
                     if ((now() - block_data.timestamp).to_seconds() < ALP_BLOCKCHAIN_BLOCK_INTERVAL_SEC)
@@ -1199,25 +1918,41 @@ namespace thinkyoung {
                         return;
                     }
                     
-                    // update the is_included flag on the fork data
-                    mark_included(_head_block_id, false);
-                    // update the block_num_to_block_id index
-                    _block_num_to_id_db.remove(_head_block_header.block_num);
-                    auto previous_block_id = _head_block_header.previous;
-                    const auto undo_iter = _block_id_to_undo_state.unordered_find(_head_block_id);
-                    FC_ASSERT(undo_iter != _block_id_to_undo_state.unordered_end(), "_block_id_to_undo_state is empty");
-                    const auto& undo_state = undo_iter->second;
-                    thinkyoung::blockchain::PendingChainStatePtr undo_state_ptr = std::make_shared<thinkyoung::blockchain::PendingChainState>(undo_state);
-                    undo_state_ptr->set_prev_state(self->shared_from_this());
-                    undo_state_ptr->apply_changes();
-                    _head_block_id = previous_block_id;
-                    
-                    if (_head_block_id == BlockIdType())
-                        _head_block_header = SignedBlockHeader();
+                    const uint32_t block_num = _head_block_header.block_num;
+                    PendingChainStatePtr undo_state_ptr;
+                    // the block is taken back with one batch as well, see extend_chain
+                    defer_chain_writes();
+                    
+                    try {
+                        // update the is_included flag on the fork data
+                        mark_included(_head_block_id, false);
+                        index_contract_events(self->get_block(_head_block_id), false);
+                        {
+                            std::lock_guard<std::mutex> lock(_block_header_tail_mutex);
+                            _block_header_tail.erase(block_num);
+                        }
+                        _block_timestamps.resize(block_num - 1);
+                        auto previous_block_id = _head_block_header.previous;
+                        undo_state_ptr = revert_undo_state(block_num, _head_block_id);
+                        _head_block_id = previous_block_id;
                         
-                    else
-                        _head_block_header = self->get_block_header(_head_block_id);
+                        if (_head_block_id == BlockIdType())
+                            _head_block_header = SignedBlockHeader();
+                            
+                        else
+                            _head_block_header = self->get_block_header(_head_block_id);
+                            
+                        self->store_property_entry(PropertyIdType::head_block_id, variant(_head_block_id));
+                        commit_chain_writes();
                         
+                    } catch (const fc::exception&) {
+                        commit_chain_writes();
+                        throw;
+                    }
+                    
+                    // update the block_num_to_block_id index
+                    _block_num_to_id_db.remove(block_num);
+                    
                     //Schedule the observer notifications for later; the chain is in a
                     //non-premptable state right now, and observers may yield.
                     for (ChainObserver* o : _observers)
@@ -1227,28 +1962,30 @@ namespace thinkyoung {
                 FC_CAPTURE_AND_RETHROW()
             }
             
-            void ChainDatabaseImpl::repair_block(BlockIdType block_id) {
+            void ChainDatabaseImpl::sync_block_num_to_id() {
                 try {
-                    auto full_block = self->get_block(block_id);
-                    mark_included(block_id, false);
-                    _block_num_to_id_db.remove(full_block.block_num);
-                    auto previous_block_id = full_block.previous;
-                    const auto undo_iter = _block_id_to_undo_state.unordered_find(block_id);
-                    FC_ASSERT(undo_iter != _block_id_to_undo_state.unordered_end(), "_block_id_to_undo_state is empty");
-                    const auto& undo_state = undo_iter->second;
-                    thinkyoung::blockchain::PendingChainStatePtr undo_state_ptr = std::make_shared<thinkyoung::blockchain::PendingChainState>(undo_state);
-                    undo_state_ptr->set_prev_state(self->shared_from_this());
-                    undo_state_ptr->apply_changes();
-                    _head_block_id = previous_block_id;
-                    
-                    if (_head_block_id == BlockIdType())
-                        _head_block_header = SignedBlockHeader();
-                        
-                    else
-                        _head_block_header = self->get_block_header(_head_block_id);
+                    BlockIdType head_block_id;
+                    const oPropertyEntry entry = self->get_property_entry(PropertyIdType::head_block_id);
+                    
+                    if (entry.valid())
+                        head_block_id = entry->value.as<BlockIdType>();
                         
-                    for (ChainObserver* o : _observers)
-                        fc::async([o, undo_state_ptr] { o->state_changed(undo_state_ptr); }, "call_state_changed_observer");
+                    const uint32_t head_block_num = head_block_id != BlockIdType() ? self->get_block_header(head_block_id).block_num : 0;
+                    uint32_t last_block_num = 0;
+                    BlockIdType last_block_id;
+                    
+                    // a block was popped from the chain state, but not from the index
+                    while (_block_num_to_id_db.last(last_block_num, last_block_id) && last_block_num > head_block_num) {
+                        wlog("Removing block ${n} the chain state does not include from the block number index", ("n", last_block_num));
+                        _block_num_to_id_db.remove(last_block_num);
+                        last_block_num = 0;
+                    }
+                    
+                    // a block was pushed to the chain state, but not to the index
+                    if (head_block_num > 0 && (last_block_num != head_block_num || last_block_id != head_block_id)) {
+                        wlog("Adding head block ${n} to the block number index", ("n", head_block_num));
+                        _block_num_to_id_db.store(head_block_num, head_block_id);
+                    }
                 }
                 
                 FC_CAPTURE_AND_RETHROW()
@@ -1319,6 +2056,10 @@ namespace thinkyoung {
         }
         
         
+        void ChainDatabase::set_db_cache_sizes(const std::map<std::string, uint32_t>& cache_sizes) {
+            my->_db_cache_sizes = cache_sizes;
+        }
+        
         void ChainDatabase::open(const fc::path& data_dir, const fc::optional<fc::path>& genesis_file, const bool statistics_enabled,
                                  const std::function<void(float)> replay_status_callback) {
             try {
@@ -1329,8 +2070,9 @@ namespace thinkyoung {
                     now();
                     my->load_checkpoints(data_dir.parent_path());
                     
+                    // replay_required leaves the database open when it can be used as it is
                     if (!my->replay_required(data_dir)) {
-                        my->open_database(data_dir);
+                        my->sync_block_num_to_id();
                         uint32_t head_block_num = 0;
                         BlockIdType head_block_id;
                         my->_block_num_to_id_db.last(head_block_num, head_block_id);
@@ -1340,10 +2082,12 @@ namespace thinkyoung {
                             my->_head_block_header = get_block_header(head_block_id);
                         }
                         
+                        my->sync_block_timestamps();
                         my->populate_indexes();
                         
                     } else {
                         wlog("Database inconsistency detected; erasing state and attempting to replay blockchain");
+                        my->_replaying = true;
                         fc::remove_all(data_dir / "index");
                         
                         if (fc::is_directory(data_dir / "raw_chain/block_id_to_block_data_db")) {
@@ -1358,14 +2102,12 @@ namespace thinkyoung {
                         my->open_database(data_dir);
                         store_property_entry(PropertyIdType::database_version, variant(ALP_BLOCKCHAIN_DATABASE_VERSION));
                         const auto toggle_leveldb = [this](const bool enabled) {
-                            my->_block_id_to_undo_state.toggle_leveldb(enabled);
                             my->_property_id_to_entry.toggle_leveldb(enabled);
                             my->_account_id_to_entry.toggle_leveldb(enabled);
                             my->_account_name_to_id.toggle_leveldb(enabled);
                             my->_account_address_to_id.toggle_leveldb(enabled);
                             //contract db related
                             my->_contract_id_to_entry.toggle_leveldb(enabled);
-                            my->_contract_id_to_storage.toggle_leveldb(enabled);
                             my->_contract_name_to_id.toggle_leveldb(enabled);
                             my->_result_to_request_iddb.toggle_leveldb(enabled);
                             my->_asset_id_to_entry.toggle_leveldb(enabled);
@@ -1402,7 +2144,7 @@ namespace thinkyoung {
                         const auto total_blocks = num_to_id.size();
                         const auto genesis_time = get_genesis_timestamp();
                         const auto start_time = blockchain::now();
-                        const auto insert_block = [&](const FullBlock& block) {
+                        const auto insert_block = [&](const RecoveredBlock& recovered, const ReplayPipeline& pipeline) {
                             if (blocks_indexed % 200 == 0) {
                                 float progress;
                                 
@@ -1415,17 +2157,30 @@ namespace thinkyoung {
                                 }
                                 
                                 progress *= 100;
+                                const auto elapsed_sec = (blockchain::now() - start_time).to_seconds();
+                                const double blocks_per_sec = elapsed_sec > 0 ? double(blocks_indexed) / elapsed_sec : blocks_indexed;
+                                const auto fetched_depth = pipeline.fetched_depth();
+                                const auto recovered_depth = pipeline.recovered_depth();
                                 
                                 if (!replay_status_callback) {
                                     std::cout << "\rReplaying blockchain... "
-                                              "Approximately " << std::setprecision(2) << progress << "% complete." << std::flush;
+                                              "Approximately " << std::setprecision(2) << progress << "% complete, "
+                                              << blocks_per_sec << " blocks/sec, queued " << fetched_depth << " recovering "
+                                              << recovered_depth << " ready." << std::flush;
                                               
                                 } else {
                                     replay_status_callback(progress);
                                 }
+                                
+                                if (blocks_indexed % 10000 == 0)
+                                    ilog("replayed ${n} blocks at ${rate} blocks/sec, ${fetched} blocks recovering signatures, ${recovered} ready to apply",
+                                         ("n", blocks_indexed)("rate", blocks_per_sec)("fetched", fetched_depth)("recovered", recovered_depth));
                             }
                             
-                            push_block(block);
+                            my->_recovered_signees[recovered.block_id] = recovered.signees;
+                            push_block(recovered.block);
+                            // not consumed when the block was stored without extending the chain
+                            my->_recovered_signees.erase(recovered.block_id);
                             ++blocks_indexed;
                             //if( blocks_indexed % 1000 == 0 )
                             //{
@@ -1435,23 +2190,48 @@ namespace thinkyoung {
                         };
                         
                         try {
+                            // Blocks are read and their signatures recovered on worker threads while
+                            // this thread applies them in order
+                            ReplayPipeline::BlockSource block_source;
+                            
                             if (num_to_id.empty()) {
-                                for (auto block_itr = block_id_to_data_original.begin(); block_itr.valid(); ++block_itr)
-                                    insert_block(block_itr.value());
+                                auto block_itr = block_id_to_data_original.begin();
+                                block_source = [block_itr](FullBlock& block) mutable -> bool {
+                                    if (!block_itr.valid()) return false;
                                     
+                                    block = block_itr.value();
+                                    ++block_itr;
+                                    return true;
+                                };
+                                
                             } else {
                                 const uint32_t last_known_block_num = num_to_id.crbegin()->first;
                                 
                                 if (last_known_block_num > ALP_BLOCKCHAIN_MAX_UNDO_HISTORY)
                                     my->_min_undo_block = last_known_block_num - ALP_BLOCKCHAIN_MAX_UNDO_HISTORY;
                                     
-                                for (const auto& num_id : num_to_id) {
-                                    const auto oblock = block_id_to_data_original.fetch_optional(num_id.second);
+                                auto num_id_itr = num_to_id.cbegin();
+                                block_source = [&num_to_id, &block_id_to_data_original, num_id_itr](FullBlock& block) mutable -> bool {
+                                    while (num_id_itr != num_to_id.cend()) {
+                                        const auto oblock = block_id_to_data_original.fetch_optional((num_id_itr++)->second);
+                                        
+                                        if (oblock.valid()) {
+                                            block = *oblock;
+                                            return true;
+                                        }
+                                    }
                                     
-                                    if (oblock.valid()) insert_block(*oblock);
-                                }
+                                    return false;
+                                };
                             }
                             
+                            ReplayPipeline pipeline(my->_thread_pool, block_source, get_chain_id(),
+                                                    _verify_transaction_signatures, detail::LAST_CHECKPOINT_BLOCK_NUM);
+                            RecoveredBlock recovered;
+                            
+                            while (pipeline.next(recovered))
+                                insert_block(recovered, pipeline);
+                                
                         } catch (thinkyoung::blockchain::store_and_index_a_seen_block&  e) {
                             block_id_to_data_original.close();
                             fc::remove_all(data_dir / "raw_chain/block_id_to_data_original");
@@ -1461,6 +2241,7 @@ namespace thinkyoung {
                         
                         // Re-enable flushing on all cached databases we disabled it on above
                         toggle_leveldb(true);
+                        my->_replaying = false;
                         block_id_to_data_original.close();
                         fc::remove_all(data_dir / "raw_chain/block_id_to_data_original");
                         const size_t final_size = fc::directory_size(data_dir / "raw_chain/block_id_to_block_data_db");
@@ -1491,6 +2272,7 @@ namespace thinkyoung {
                 }
                 
                 if (error_opening_database) {
+                    my->_replaying = false;
                     elog("Error opening database!");
                     close();
                     fc::remove_all(data_dir / "index");
@@ -1503,9 +2285,17 @@ namespace thinkyoung {
         
         void ChainDatabase::close() {
             try {
+                my->_contract_simulator.reset();
                 my->_pending_transaction_db.close();
                 my->_block_id_to_full_block.close();
-                my->_block_id_to_undo_state.close();
+                my->_block_id_to_header.close();
+                {
+                    std::lock_guard<std::mutex> lock(my->_block_header_tail_mutex);
+                    my->_block_header_tail.clear();
+                }
+                my->_block_timestamps.close();
+                my->_block_num_to_undo_journal.close();
+                my->_undo_journal_tail.clear();
                 my->_fork_number_db.close();
                 my->_fork_db.close();
                 my->_revalidatable_future_blocks_db.close();
@@ -1519,19 +2309,24 @@ namespace thinkyoung {
                 my->_contract_id_to_entry.close();
                 my->_result_to_request_iddb.close();
                 my->_contract_name_to_id.close();
-                my->_contract_id_to_storage.close();
+                my->_contract_storage_key_to_item.close();
+                my->_contract_event_index.close();
                 my->_asset_id_to_entry.close();
                 my->_asset_symbol_to_id.close();
                 my->_slate_id_to_entry.close();
                 my->_balance_id_to_entry.close();
+                my->_balance_owner_index.close();
                 my->_transaction_id_to_entry.close();
-                my->_address_to_transaction_ids.close();
+                my->_address_transaction_index.close();
                 my->_alp_input_balance_entry.close();
                 my->_alp_full_entry.close();
-                my->_block_extend_status.close();
                 my->_slot_index_to_entry.close();
                 my->_slot_timestamp_to_delegate.close();
                 my->_request_to_result_iddb.close();
+                my->_trx_to_contract_iddb.close();
+                my->_contract_to_trx_iddb.close();
+                // after its tables, which write what they still hold back as they close
+                my->_chain_state_db.close();
             }
             
             FC_CAPTURE_AND_RETHROW()
@@ -1596,13 +2391,24 @@ namespace thinkyoung {
         }
         
         TransactionEvaluationStatePtr ChainDatabase::evaluate_transaction(const SignedTransaction& trx,
-                const ShareType required_fees, bool contract_vm_exec, bool skip_signature_check, bool throw_exec_exception) {
+                const ShareType required_fees, bool contract_vm_exec, bool skip_signature_check, bool throw_exec_exception,
+                PendingTrxDependencies* dependencies) {
             try {
                 if (!my->_pending_trx_state)
                     my->_pending_trx_state = std::make_shared<PendingChainState>(shared_from_this());
                     
                 PendingChainStatePtr          pend_state = std::make_shared<PendingChainState>(my->_pending_trx_state);
                 PendingChainStatePtr          pend_state_res = std::make_shared<PendingChainState>(my->_pending_trx_state);
+                
+                if (dependencies != nullptr) {
+                    dependencies->read_keys->clear();
+                    pend_state->track_reads(dependencies->read_keys);
+                    pend_state_res->track_reads(dependencies->read_keys);
+                    // read past the tracking, revalidate_pending compares them on their own
+                    dependencies->base_asset = my->_pending_trx_state->get_asset_entry(AssetIdType(0));
+                    dependencies->now = my->_pending_trx_state->now();
+                }
+                
                 TransactionEvaluationStatePtr trx_eval_state = std::make_shared<TransactionEvaluationState>(pend_state.get());
                 
                 if (skip_signature_check)
@@ -1649,6 +2455,12 @@ namespace thinkyoung {
                 if (trx_eval_state->p_result_trx.operations.size() < 1) {
                     pend_state->apply_changes();
                     
+                    if (dependencies != nullptr) {
+                        dependencies->changes = pend_state;
+                        dependencies->eval_state = trx_eval_state;
+                        dependencies->fees = fees;
+                    }
+                    
                 } else {
                     //verify the result trx.
                     TransactionEvaluationStatePtr trx_eval_state_res = std::make_shared<TransactionEvaluationState>(pend_state_res.get());
@@ -1659,6 +2471,13 @@ namespace thinkyoung {
                     TransactionEvaluationStatePtr eval_state = std::make_shared<TransactionEvaluationState>(pend_state.get());
                     eval_state->p_result_trx = trx_eval_state->p_result_trx;
                     eval_state->trx = trx;
+                    
+                    if (dependencies != nullptr) {
+                        dependencies->changes = pend_state_res;
+                        dependencies->eval_state = eval_state;
+                        dependencies->fees = fees;
+                    }
+                    
                     return eval_state;
                 }
                 
@@ -1668,6 +2487,21 @@ namespace thinkyoung {
             FC_CAPTURE_AND_RETHROW((trx))
         }
         
+        TransactionEvaluationStatePtr ChainDatabase::simulate_transaction(const SignedTransaction& trx,
+                const std::function<void(TransactionEvaluationState&)>& configure) {
+            try {
+                if (my->has_lazy_index())
+                    return ContractSimulator::evaluate(shared_from_this(), trx, configure);
+                    
+                if (my->_contract_simulator == nullptr)
+                    my->_contract_simulator.reset(new ContractSimulator());
+                    
+                return my->_contract_simulator->simulate(shared_from_this(), trx, configure);
+            }
+            
+            FC_CAPTURE_AND_RETHROW((trx))
+        }
+        
         optional<fc::exception> ChainDatabase::get_transaction_error(const SignedTransaction& transaction, const ShareType min_fee) {
             try {
                 try {
@@ -1694,6 +2528,14 @@ namespace thinkyoung {
         
         SignedBlockHeader ChainDatabase::get_block_header(const BlockIdType& block_id)const {
             try {
+                if (block_id == my->_head_block_id)
+                    return my->_head_block_header;
+                    
+                const optional<SignedBlockHeader> header = my->_block_id_to_header.fetch_optional(block_id);
+                
+                if (header.valid())
+                    return *header;
+                    
                 return get_block(block_id);
             }
             
@@ -1702,6 +2544,14 @@ namespace thinkyoung {
         
         SignedBlockHeader ChainDatabase::get_block_header(uint32_t block_num)const {
             try {
+                {
+                    std::lock_guard<std::mutex> lock(my->_block_header_tail_mutex);
+                    const auto tail_iter = my->_block_header_tail.find(block_num);
+                    
+                    if (tail_iter != my->_block_header_tail.end())
+                        return tail_iter->second;
+                }
+                
                 return get_block_header(get_block_id(block_num));
             }
             
@@ -1794,6 +2644,51 @@ namespace thinkyoung {
             FC_CAPTURE_AND_RETHROW((block_num))
         }
         
+        RawBlockPtr ChainDatabase::get_raw_block(const BlockIdType& block_id)const {
+            try {
+                {
+                    std::lock_guard<std::mutex> lock(my->_raw_block_mutex);
+                    const auto iter = my->_raw_block_index.find(block_id);
+                    
+                    if (iter != my->_raw_block_index.end()) {
+                        my->_raw_block_lru.splice(my->_raw_block_lru.begin(), my->_raw_block_lru, iter->second);
+                        return iter->second->second;
+                    }
+                }
+                
+                fc::optional<std::vector<char>> raw_block = my->_block_id_to_full_block.fetch_raw_optional(block_id);
+                
+                if (!raw_block.valid())
+                    return RawBlockPtr();
+                    
+                const RawBlockPtr result = std::make_shared<const std::vector<char>>(std::move(*raw_block));
+                std::lock_guard<std::mutex> lock(my->_raw_block_mutex);
+                
+                // blocks are immutable, another thread may have cached the same bytes meanwhile
+                if (my->_raw_block_index.count(block_id) == 0) {
+                    my->_raw_block_lru.emplace_front(block_id, result);
+                    my->_raw_block_index[block_id] = my->_raw_block_lru.begin();
+                    
+                    if (my->_raw_block_lru.size() > ALP_BLOCKCHAIN_RAW_BLOCK_CACHE_SIZE) {
+                        my->_raw_block_index.erase(my->_raw_block_lru.back().first);
+                        my->_raw_block_lru.pop_back();
+                    }
+                }
+                
+                return result;
+            }
+            
+            FC_CAPTURE_AND_RETHROW((block_id))
+        }
+        
+        RawBlockPtr ChainDatabase::get_raw_block(uint32_t block_num)const {
+            try {
+                return get_raw_block(get_block_id(block_num));
+            }
+            
+            FC_CAPTURE_AND_RETHROW((block_num))
+        }
+        
         SignedBlockHeader ChainDatabase::get_head_block()const {
             try {
                 return my->_head_block_header;
@@ -1802,46 +2697,35 @@ namespace thinkyoung {
             FC_CAPTURE_AND_RETHROW()
         }
         
-        uint32_t ChainDatabase::find_block_num(fc::time_point_sec &time)const {
+        uint32_t ChainDatabase::find_block_num(const fc::time_point_sec& time)const {
             try {
-                uint32_t start = 1, end = get_head_block_num();
-                auto start_block_time = get_block_header(start).timestamp;
-                
-                if (start_block_time >= time) {
-                    return start;
-                }
-                
-                auto end_block_time = get_block_header(end).timestamp;
-                
-                if (end_block_time <= time) {
-                    return end;
-                }
+                FC_ASSERT(get_head_block_num() > 0, "no block in the chain");
+                return my->_block_timestamps.find_block_num(time);
+            }
+            
+            FC_CAPTURE_AND_RETHROW((time))
+        }
+        
+        vector<pair<uint32_t, uint32_t>> ChainDatabase::find_block_ranges(const vector<pair<fc::time_point_sec, fc::time_point_sec>>& time_ranges)const {
+            try {
+                vector<pair<uint32_t, uint32_t>> block_ranges;
+                block_ranges.reserve(time_ranges.size());
                 
-                while (end > start + 1) {
-                    double relative = double(time.sec_since_epoch() - start_block_time.sec_since_epoch())
-                                      / (end_block_time.sec_since_epoch() - start_block_time.sec_since_epoch());
-                    uint32_t mid = start + ((end - start) * relative);
+                for (const auto& range : time_ranges) {
+                    const uint32_t first = my->_block_timestamps.find_first_block_num(range.first);
+                    const uint32_t last = range.second < my->_block_timestamps.at(1) ? 0 : my->_block_timestamps.find_block_num(range.second);
                     
-                    if (mid == start) {
-                        mid++;
-                    }
-                    
-                    auto mid_block_time = get_block_header(mid).timestamp;
-                    
-                    if (mid_block_time > time) {
-                        end = mid;
-                        end_block_time = mid_block_time;
+                    if (first > last)
+                        block_ranges.emplace_back(0, 0);
                         
-                    } else {
-                        start = mid;
-                        start_block_time = mid_block_time;
-                    }
+                    else
+                        block_ranges.emplace_back(first, last);
                 }
                 
-                return start;
+                return block_ranges;
             }
             
-            FC_CAPTURE_AND_RETHROW((time))
+            FC_CAPTURE_AND_RETHROW((time_ranges))
         }
         
         /**
@@ -1869,6 +2753,8 @@ namespace thinkyoung {
                 // only allow a single fiber attempt to push blocks at any given time,
                 // this method is not re-entrant.
                 fc::unique_lock<fc::mutex> lock(my->_push_block_mutex);
+                // running contract simulations read the state this block changes
+                ContractSimulator::WriteGuard simulation_guard(my->_contract_simulator.get());
                 // The above check probably isn't enough.  We need to make certain that
                 // no other code sees the chain_database in an inconsistent state.
                 // The lock above prevents two push_blocks from happening at the same time,
@@ -2074,10 +2960,9 @@ namespace thinkyoung {
         
         void ChainDatabase::scan_balances(const function<void(const BalanceEntry&)> callback)const {
             try {
-                for (auto iter = my->_balance_id_to_entry.unordered_begin();
-                        iter != my->_balance_id_to_entry.unordered_end(); ++iter) {
-                    callback(iter->second);
-                }
+                my->_balance_id_to_entry.scan([&callback](const BalanceIdType&, const BalanceEntry& entry) {
+                    callback(entry);
+                });
             }
             
             FC_CAPTURE_AND_RETHROW()
@@ -2085,10 +2970,9 @@ namespace thinkyoung {
         
         void  ChainDatabase::scan_contracts(const function<void(const ContractEntry&)> callback)const {
             try {
-                for (auto iter = my->_contract_id_to_entry.unordered_begin();
-                        iter != my->_contract_id_to_entry.unordered_end(); ++iter) {
-                    callback(iter->second);
-                }
+                my->_contract_id_to_entry.scan([&callback](const ContractIdType&, const ContractEntry& entry) {
+                    callback(entry);
+                });
             }
             
             FC_CAPTURE_AND_RETHROW()
@@ -2107,10 +2991,9 @@ namespace thinkyoung {
         
         void ChainDatabase::scan_unordered_accounts(const function<void(const AccountEntry&)> callback)const {
             try {
-                for (auto iter = my->_account_id_to_entry.unordered_begin();
-                        iter != my->_account_id_to_entry.unordered_end(); ++iter) {
-                    callback(iter->second);
-                }
+                my->_account_id_to_entry.scan([&callback](const AccountIdType, const AccountEntry& entry) {
+                    callback(entry);
+                });
             }
             
             FC_CAPTURE_AND_RETHROW()
@@ -2130,10 +3013,9 @@ namespace thinkyoung {
         
         void ChainDatabase::scan_unordered_assets(const function<void(const AssetEntry&)> callback)const {
             try {
-                for (auto iter = my->_asset_id_to_entry.unordered_begin();
-                        iter != my->_asset_id_to_entry.unordered_end(); ++iter) {
-                    callback(iter->second);
-                }
+                my->_asset_id_to_entry.scan([&callback](const AssetIdType, const AssetEntry& entry) {
+                    callback(entry);
+                });
             }
             
             FC_CAPTURE_AND_RETHROW()
@@ -2173,7 +3055,8 @@ namespace thinkyoung {
                     }
                 }
                 
-                TransactionEvaluationStatePtr eval_state = evaluate_transaction(trx, relay_fee, contract_vm_exec, false, cache);
+                PendingTrxDependencies dependencies;
+                TransactionEvaluationStatePtr eval_state = evaluate_transaction(trx, relay_fee, contract_vm_exec, false, cache, &dependencies);
                 const ShareType fees = eval_state->get_fees() + eval_state->alt_fees_paid.amount;
 
                 /*
@@ -2186,7 +3069,12 @@ namespace thinkyoung {
                 }
                 
                 my->_pending_fee_index[fee_index(fees, trx_id)] = eval_state;
-                my->_pending_transaction_db.store(trx_id, trx);//ײ浽pendingdb
+                my->_pending_transaction_db.store(trx_id, trx);
+                
+                if (dependencies.changes) {
+                    dependencies.sequence = ++my->_pending_trx_sequence;
+                    my->_pending_trx_dependencies[trx_id] = std::move(dependencies);
+                }//ײ浽pendingdb
                 return eval_state;
             }
             
@@ -2290,8 +3178,40 @@ namespace thinkyoung {
                 if (config.block_max_transaction_count > 0 && config.block_max_size > block_size) {
                     // Evaluate pending transactions
                     const vector<TransactionEvaluationStatePtr> pending_trx = get_pending_transactions();
+                    const auto new_eval_state = [&config](const SignedTransaction&, const PendingChainStatePtr& state) {
+                        TransactionEvaluationStatePtr trx_eval_state = std::make_shared<TransactionEvaluationState>(state.get());
+                        trx_eval_state->_enforce_canonical_signatures = config.transaction_canonical_signatures_required;
+                        trx_eval_state->_skip_signature_check = true;
+                        trx_eval_state->skipexec = false;
+                        return trx_eval_state;
+                    };
+                    // Evaluate the highest fee transactions against the head state in parallel, only the ones
+                    // that conflict with a transaction packed before them are evaluated again below
+                    vector<SignedTransaction> candidate_trxs;
+                    
+                    for (const TransactionEvaluationStatePtr& item : pending_trx) {
+                        if (candidate_trxs.size() >= config.block_max_transaction_count)
+                            break;
+                            
+                        candidate_trxs.push_back(item->trx);
+                    }
+                    
+                    const bool speculate = my->can_speculate_transactions(candidate_trxs);
+                    vector<detail::SpeculativeTransaction> speculative;
+                    detail::SpeculativeMerge merge;
+                    
+                    if (speculate) {
+                        merge.base_asset = pending_state->get_asset_entry(AssetIdType(0));
+                        FC_ASSERT(merge.base_asset.valid(), "Invalid asset");
+                        my->speculate_transactions(candidate_trxs, pending_state, new_eval_state, speculative,
+                                                   start_time + config.block_max_production_time);
+                    }
+                    
+                    size_t trx_index = 0;
                     
                     for (const TransactionEvaluationStatePtr& item : pending_trx) {
+                        const size_t index = trx_index++;
+                        
                         // Check block production time limit
                         if (time_point::now() - start_time >= config.block_max_production_time)
                             break;
@@ -2351,12 +3271,19 @@ namespace thinkyoung {
                             auto res_trx_state = std::make_shared<PendingChainState>(pending_state);
                             SignedTransaction trx = new_transaction;
                             auto pending_trx_state = origin_trx_state;
+                            const bool speculated = speculate && index < speculative.size()
+                                                    && my->is_speculation_valid(new_transaction, speculative[index], pending_state, merge);
                             {
-                                auto trx_eval_state = std::make_shared<TransactionEvaluationState>(pending_trx_state.get());
-                                trx_eval_state->_enforce_canonical_signatures = config.transaction_canonical_signatures_required;
-                                trx_eval_state->_skip_signature_check = true;
-                                trx_eval_state->skipexec = false;
-                                trx_eval_state->evaluate(new_transaction);
+                                TransactionEvaluationStatePtr trx_eval_state;
+                                
+                                if (speculated) {
+                                    pending_trx_state = speculative[index].layer;
+                                    trx_eval_state = speculative[index].eval_state;
+                                    
+                                } else {
+                                    trx_eval_state = new_eval_state(new_transaction, pending_trx_state);
+                                    trx_eval_state->evaluate(new_transaction);
+                                }
                                 
                                 if (trx_eval_state->p_result_trx.operations.size() > 0) {
                                     auto result_eval_state = std::make_shared<TransactionEvaluationState>(res_trx_state.get());
@@ -2433,7 +3360,11 @@ namespace thinkyoung {
                                 continue;
                             }
                             
-                            pending_trx_state->apply_changes();
+                            if (speculate)
+                                my->merge_layer(pending_trx_state, speculated, pending_state, merge);
+                            else
+                                pending_trx_state->apply_changes();
+                                
                             new_block.user_transactions.push_back(trx);
                             block_size += trx.data_size();
                             
@@ -2456,6 +3387,9 @@ namespace thinkyoung {
                 new_block.block_num = head_block.block_num + 1;
                 new_block.timestamp = block_timestamp;
                 new_block.transaction_digest = DigestBlock(new_block).calculate_transaction_digest();
+                my->_generated_block_num = new_block.block_num;
+                my->_generated_block_timestamp = new_block.timestamp;
+                my->_generated_block_assembly_time = time_point::now() - start_time;
                 return new_block;
             }
             
@@ -2526,6 +3460,80 @@ namespace thinkyoung {
             return my->get_events(block_index, trx_id);
         }
         
+        vector<ContractEventEntry> ChainDatabase::fetch_contract_events(const ContractIdType& contract_id, const string& event_type,
+                const uint32_t from_block, const uint32_t to_block, const uint32_t limit)const {
+            try {
+                vector<ContractEventEntry> results;
+                const uint32_t last_block = to_block > 0 ? to_block : get_head_block_num();
+                
+                if (from_block > last_block)
+                    return results;
+                    
+                const auto& index = my->_contract_event_index;
+                vector<ContractEventKey> keys;
+                // the events of one name come out in chain order, stop after the block that reaches the limit
+                const auto scan_type = [&](const string& type) {
+                    const size_t first = results.size();
+                    uint32_t page_end_block = 0;
+                    
+                    for (auto iter = index.lower_bound(ContractEventKey(contract_id, type, from_block)); iter.valid(); ++iter) {
+                        const ContractEventKey key = iter.key();
+                        
+                        if (key.contract_id != contract_id || key.event_type != type || key.block_num > last_block)
+                            break;
+                            
+                        if (limit > 0 && results.size() - first >= limit && key.block_num != page_end_block)
+                            break;
+                            
+                        page_end_block = key.block_num;
+                        keys.push_back(key);
+                        results.push_back(iter.value());
+                    }
+                };
+                
+                if (!event_type.empty()) {
+                    scan_type(event_type);
+                    return results;
+                }
+                
+                // seek from one event name of the contract to the next and merge them
+                auto iter = index.lower_bound(ContractEventKey(contract_id, string(), 0));
+                
+                while (iter.valid() && iter.key().contract_id == contract_id) {
+                    const string type = iter.key().event_type;
+                    scan_type(type);
+                    iter = index.lower_bound(ContractEventKey(contract_id, type, std::numeric_limits<uint32_t>::max(),
+                                                              std::numeric_limits<uint32_t>::max(), std::numeric_limits<uint32_t>::max()));
+                                                              
+                    if (iter.valid() && iter.key().event_type == type)
+                        ++iter;
+                }
+                
+                vector<size_t> order(results.size());
+                
+                for (size_t i = 0; i < order.size(); ++i)
+                    order[i] = i;
+                    
+                std::sort(order.begin(), order.end(), [&keys](const size_t a, const size_t b) {
+                    return std::tie(keys[a].block_num, keys[a].trx_num, keys[a].op_num)
+                        < std::tie(keys[b].block_num, keys[b].trx_num, keys[b].op_num);
+                });
+                vector<ContractEventEntry> merged;
+                merged.reserve(order.size());
+                
+                for (const size_t i : order) {
+                    if (limit > 0 && merged.size() >= limit && keys[i].block_num != merged.back().block_num)
+                        break;
+                        
+                    merged.push_back(std::move(results[i]));
+                }
+                
+                return merged;
+            }
+            
+            FC_CAPTURE_AND_RETHROW((contract_id)(event_type)(from_block)(to_block)(limit))
+        }
+        
         BlockIdType ChainDatabase::get_head_block_id()const {
             try {
                 return my->_head_block_id;
@@ -2553,11 +3561,19 @@ namespace thinkyoung {
         unordered_map<BalanceIdType, BalanceEntry> ChainDatabase::get_balances_for_address(const Address& addr)const {
             try {
                 unordered_map<BalanceIdType, BalanceEntry> entrys;
-                const auto scan_balance = [&addr, &entrys](const BalanceEntry& entry) {
-                    if (entry.is_owner(addr))
-                        entrys[entry.id()] = entry;
-                };
-                scan_balances(scan_balance);
+                
+                for (auto iter = my->_balance_owner_index.lower_bound(BalanceOwnerKey(addr, BalanceIdType())); iter.valid(); ++iter) {
+                    const BalanceOwnerKey key = iter.key();
+                    
+                    if (key.owner != addr)
+                        break;
+                        
+                    const oBalanceEntry entry = balance_lookup_by_id(key.balance_id);
+                    
+                    if (entry.valid())
+                        entrys[key.balance_id] = *entry;
+                }
+                
                 return entrys;
             }
             
@@ -2574,15 +3590,12 @@ namespace thinkyoung {
                     Address(PtsAddress(key, false, 0)),
                     Address(PtsAddress(key, true, 0))
                 };
-                const auto scan_balance = [&addrs, &entrys](const BalanceEntry& entry) {
-                    for (const Address& addr : addrs) {
-                        if (entry.is_owner(addr)) {
-                            entrys[entry.id()] = entry;
-                            break;
-                        }
-                    }
-                };
-                scan_balances(scan_balance);
+                
+                for (const Address& addr : addrs) {
+                    const unordered_map<BalanceIdType, BalanceEntry> addr_entrys = get_balances_for_address(addr);
+                    entrys.insert(addr_entrys.begin(), addr_entrys.end());
+                }
+                
                 return entrys;
             }
             
@@ -2840,7 +3853,10 @@ namespace thinkyoung {
         }
         
         bool ChainDatabase::store_balance_entries_for_sandbox() {
-            my->_sandbox_pending_state->_balance_id_to_entry.insert(my->_balance_id_to_entry.unordered_begin(), my->_balance_id_to_entry.unordered_end());
+            auto& sandbox_balances = my->_sandbox_pending_state->_balance_id_to_entry;
+            my->_balance_id_to_entry.scan([&sandbox_balances](const BalanceIdType& id, const BalanceEntry& entry) {
+                sandbox_balances.emplace(id, entry);
+            });
             return true;
         }
         
@@ -2949,11 +3965,8 @@ namespace thinkyoung {
                 snapshot.initial_balances.clear();
                 snapshot.sharedrop_balances.reserve_balances.clear();
                 
-                for (auto iter = my->_balance_id_to_entry.unordered_begin();
-                        iter != my->_balance_id_to_entry.unordered_end(); ++iter) {
-                    const BalanceEntry& entry = iter->second;
-                    
-                    if (entry.asset_id() != 0) continue;
+                my->_balance_id_to_entry.scan([&snapshot](const BalanceIdType&, const BalanceEntry& entry) {
+                    if (entry.asset_id() != 0) return;
                     
                     GenesisBalance balance;
                     
@@ -2963,7 +3976,7 @@ namespace thinkyoung {
                     } else {
                         const auto owner = entry.owner();
                         
-                        if (!owner.valid()) continue;
+                        if (!owner.valid()) return;
                         
                         balance.raw_address = string(*owner);
                     }
@@ -2972,22 +3985,19 @@ namespace thinkyoung {
                     
                     if (entry.condition.type == withdraw_signature_type)
                         snapshot.initial_balances.push_back(balance);
-                }
+                });
                 
                 // Add outstanding delegate pay balances
-                for (auto iter = my->_account_id_to_entry.unordered_begin();
-                        iter != my->_account_id_to_entry.unordered_end(); ++iter) {
-                    const AccountEntry& entry = iter->second;
-                    
-                    if (!entry.is_delegate()) continue;
+                my->_account_id_to_entry.scan([&snapshot](const AccountIdType, const AccountEntry& entry) {
+                    if (!entry.is_delegate()) return;
                     
-                    if (entry.is_retracted()) continue;
+                    if (entry.is_retracted()) return;
                     
                     GenesisBalance balance;
                     balance.raw_address = string(entry.owner_address());
                     balance.balance = entry.delegate_pay_balance();
                     snapshot.initial_balances.push_back(balance);
-                }
+                });
                 
                 fc::json::save_to_file(snapshot, filename);
             }
@@ -3002,24 +4012,18 @@ namespace thinkyoung {
             Asset total(entry->collected_fees, asset_id);
             
             // Add balances
-            for (auto iter = my->_balance_id_to_entry.unordered_begin();
-                    iter != my->_balance_id_to_entry.unordered_end(); ++iter) {
-                const BalanceEntry& balance = iter->second;
-                
+            my->_balance_id_to_entry.scan([&total](const BalanceIdType&, const BalanceEntry& balance) {
                 if (balance.asset_id() == total.asset_id)
                     total.amount += balance.balance;
-            }
+            });
             
             // If base asset
             if (asset_id == AssetIdType(0)) {
                 // Add pay balances
-                for (auto account_itr = my->_account_id_to_entry.unordered_begin();
-                        account_itr != my->_account_id_to_entry.unordered_end(); ++account_itr) {
-                    const AccountEntry& account = account_itr->second;
-                    
+                my->_account_id_to_entry.scan([&total](const AccountIdType, const AccountEntry& account) {
                     if (account.delegate_info.valid())
                         total.amount += account.delegate_info->pay_balance;
-                }
+                });
                 
             } else { // If non-base asset
                 //
@@ -3054,16 +4058,15 @@ namespace thinkyoung {
             try {
                 vector < AlpTrxidBalance > results;
                 
-                for (auto iter = my->_alp_input_balance_entry.unordered_begin();
-                        iter != my->_alp_input_balance_entry.unordered_end(); ++iter) {
+                my->_alp_input_balance_entry.scan([&results, block_num](const string&, const set<AlpTrxidBalance>& balances) {
                     AlpTrxidBalance alpTemp;
                     alpTemp.block_num = block_num + 1;
-                    set<AlpTrxidBalance>::iterator block_iter = iter->second.lower_bound(alpTemp);
+                    set<AlpTrxidBalance>::iterator block_iter = balances.lower_bound(alpTemp);
                     
-                    for (; block_iter != iter->second.end(); ++block_iter) {
+                    for (; block_iter != balances.end(); ++block_iter) {
                         results.push_back(*block_iter);
                     }
-                }
+                });
                 
                 return results;
             }
@@ -3078,16 +4081,15 @@ namespace thinkyoung {
                     return results;
                 }
                 
-                for (auto iter = my->_alp_full_entry.unordered_begin();
-                        iter != my->_alp_full_entry.unordered_end(); ++iter) {
-                    auto block_iter = iter->second.alp_block_sort.lower_bound(block_num + 1);
+                my->_alp_full_entry.scan([&results, block_num, last_scan_block_num](const string&, const AlpBalanceEntry& entry) {
+                    auto block_iter = entry.alp_block_sort.lower_bound(block_num + 1);
                     
-                    for (; block_iter != iter->second.alp_block_sort.end(); block_iter++) {
+                    for (; block_iter != entry.alp_block_sort.end(); block_iter++) {
                         if (block_iter->second.block_num <= last_scan_block_num) {
                             results.emplace_back(block_iter->second);
                         }
                     }
-                }
+                });
                 
                 return results;
             }
@@ -3165,23 +4167,53 @@ namespace thinkyoung {
                 }
             }
         }
-        vector<TransactionEntry> ChainDatabase::fetch_address_transactions(const Address& addr) {
+        vector<TransactionEntry> ChainDatabase::fetch_address_transactions(const Address& addr, const uint32_t since_block,
+                const uint32_t limit, const bool reverse) {
             try {
                 vector<TransactionEntry> results;
-                const auto transaction_ids = my->_address_to_transaction_ids.fetch_optional(addr);
+                auto& index = my->_address_transaction_index;
+                const uint32_t last_block = since_block > 0 ? since_block : get_head_block_num();
+                // seek to the last key of last_block, last_block + 1 would wrap at the maximum block number
+                const AddressTransactionKey reverse_start(addr, last_block, std::numeric_limits<uint32_t>::max());
+                auto iter = index.lower_bound(reverse ? reverse_start : AddressTransactionKey(addr, since_block, 0));
+                
+                if (reverse) {
+                    if (!iter.valid())
+                        iter = index.last();
+                        
+                    else if (!(iter.key() == reverse_start))
+                        --iter;
+                }
                 
-                if (transaction_ids.valid()) {
-                    for (const TransactionIdType& transaction_id : *transaction_ids) {
-                        oTransactionEntry entry = get_transaction(transaction_id);
+                uint32_t page_end_block = 0;
+                
+                while (iter.valid()) {
+                    const AddressTransactionKey key = iter.key();
+                    
+                    if (key.address != addr)
+                        break;
+                        
+                    if (limit > 0 && results.size() >= limit && key.block_num != page_end_block)
+                        break;
                         
-                        if (entry.valid()) results.push_back(std::move(*entry));
+                    oTransactionEntry entry = get_transaction(iter.value(), true);
+                    
+                    if (entry.valid()) {
+                        page_end_block = key.block_num;
+                        results.push_back(std::move(*entry));
                     }
+                    
+                    if (reverse)
+                        --iter;
+                        
+                    else
+                        ++iter;
                 }
                 
                 return results;
             }
             
-            FC_CAPTURE_AND_RETHROW((addr))
+            FC_CAPTURE_AND_RETHROW((addr)(since_block)(limit)(reverse))
         }
         
         oPropertyEntry ChainDatabase::property_lookup_by_id(const PropertyIdType id)const {
@@ -3313,21 +4345,26 @@ namespace thinkyoung {
         }
         
         void ChainDatabase::balance_insert_into_id_map(const BalanceIdType& id, const BalanceEntry& entry) {
+            const oBalanceEntry prev_entry = balance_lookup_by_id(id);
+            const bool owners_changed = !prev_entry.valid() || prev_entry->owners() != entry.owners();
+            
+            if (prev_entry.valid() && owners_changed)
+                my->index_balance_owners(id, *prev_entry, false);
+                
             my->_balance_id_to_entry.store(id, entry);
+            
+            if (owners_changed)
+                my->index_balance_owners(id, entry, true);
         }
         
         void ChainDatabase::balance_erase_from_id_map(const BalanceIdType& id) {
+            const oBalanceEntry prev_entry = balance_lookup_by_id(id);
+            
+            if (prev_entry.valid())
+                my->index_balance_owners(id, *prev_entry, false);
+                
             my->_balance_id_to_entry.remove(id);
         }
-        void ChainDatabase::status_insert_into_block_map(const BlockIdType& id, const int& version) {
-            data_version temp_version;
-            temp_version.id = id;
-            temp_version.version = version;
-            my->_block_extend_status.store(1, temp_version);
-        }
-        void ChainDatabase::status_erase_from_block_map() {
-            my->_block_extend_status.remove(1);
-        }
         
         oTransactionEntry ChainDatabase::transaction_lookup_by_id(const TransactionIdType& id)const {
             return my->_transaction_id_to_entry.fetch_optional(id);
@@ -3338,12 +4375,7 @@ namespace thinkyoung {
             
             if (get_statistics_enabled()) {
                 const auto scan_address = [&](const Address& addr) {
-                    auto ids = my->_address_to_transaction_ids.fetch_optional(addr);
-                    
-                    if (!ids.valid()) ids = unordered_set<TransactionIdType>();
-                    
-                    ids->insert(id);
-                    my->_address_to_transaction_ids.store(addr, *ids);
+                    my->_address_transaction_index.store(AddressTransactionKey(addr, entry.chain_location.block_num, entry.chain_location.trx_num), id);
                 };
                 entry.scan_addresses(*this, scan_address);
                 
@@ -3362,15 +4394,7 @@ namespace thinkyoung {
                 
                 if (entry.valid()) {
                     const auto scan_address = [&](const Address& addr) {
-                        auto ids = my->_address_to_transaction_ids.fetch_optional(addr);
-                        
-                        if (!ids.valid()) return;
-                        
-                        ids->erase(id);
-                        
-                        if (!ids->empty()) my->_address_to_transaction_ids.store(addr, *ids);
-                        
-                        else my->_address_to_transaction_ids.remove(addr);
+                        my->_address_transaction_index.remove(AddressTransactionKey(addr, entry->chain_location.block_num, entry->chain_location.trx_num));
                     };
                     entry->scan_addresses(*this, scan_address);
                 }
@@ -3413,42 +4437,9 @@ namespace thinkyoung {
         uint32_t    ChainDatabase::get_forkdb_num() {
             return m_fork_num_before;
         }
-        void ChainDatabase::store_extend_status(const BlockIdType& id, int version) {
-            status_insert_into_block_map(id, version);
-        }
-        std::pair<BlockIdType, int>  ChainDatabase::get_last_extend_status() {
-            try {
-                auto iter = my->_block_extend_status.begin();
-                
-                if (iter.valid())
-                    return std::make_pair<BlockIdType, int>(iter.value().id, iter.value().version);
-                    
-                else {
-                    if (my->_block_extend_status.size() > 0) {
-                        my->_block_extend_status.remove(my->_block_extend_status.begin().key());
-                    }
-                    
-                    return std::make_pair<BlockIdType, int>(BlockIdType(), 0);
-                }
-                
-            } catch (...) {
-                if (my->_block_extend_status.size() > 0) {
-                    my->_block_extend_status.remove(my->_block_extend_status.begin().key());
-                }
-                
-                return std::make_pair<BlockIdType, int>(BlockIdType(), 0);
-            }
-        }
         void    ChainDatabase::set_forkdb_num(uint32_t forkdb_num) {
             m_fork_num_before = forkdb_num;
         }
-        void   ChainDatabase::repair_database() {
-            auto last_status = get_last_extend_status();
-            
-            if (last_status.second == 1) {
-                my->repair_block(last_status.first);
-            }
-        }
         
         void ChainDatabase::dump_state(const fc::path& path, const fc::string& ldbname)const {
             try {
@@ -3461,15 +4452,12 @@ namespace thinkyoung {
                 if ("ALL" == ldbname) {
                     fc::path next_path;
                     ulog("This will take a while...");
-                    next_path = dir / "_block_extend_status.json";
-                    FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
-                    my->_block_extend_status.export_to_json(next_path);
                     next_path = dir / "block_id_to_block_data_db.json";
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
                     my->_block_id_to_full_block.export_to_json(next_path);
-                    next_path = dir / "block_id_to_undo_state.json";
+                    next_path = dir / "block_num_to_undo_journal.json";
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
-                    my->_block_id_to_undo_state.export_to_json(next_path);
+                    my->_block_num_to_undo_journal.export_to_json(next_path);
                     next_path = dir / "fork_db.json";
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
                     my->_fork_db.export_to_json(next_path);
@@ -3509,9 +4497,9 @@ namespace thinkyoung {
                     next_path = dir / "transaction_id_to_entry.json";
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
                     my->_transaction_id_to_entry.export_to_json(next_path);
-                    next_path = dir / "address_to_transaction_ids.json";
+                    next_path = dir / "address_transaction_index.json";
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
-                    my->_address_to_transaction_ids.export_to_json(next_path);
+                    my->_address_transaction_index.export_to_json(next_path);
                     next_path = dir / "slot_index_to_entry.json";
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
                     my->_slot_index_to_entry.export_to_json(next_path);
@@ -3527,9 +4515,12 @@ namespace thinkyoung {
                     next_path = dir / "contract_id_to_entry.json";
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
                     my->_contract_id_to_entry.export_to_json(next_path);
-                    next_path = dir / "contract_id_to_storage.json";
+                    next_path = dir / "contract_storage_key_to_item.json";
+                    FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
+                    my->_contract_storage_key_to_item.export_to_json(next_path);
+                    next_path = dir / "contract_event_index.json";
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
-                    my->_contract_id_to_storage.export_to_json(next_path);
+                    my->_contract_event_index.export_to_json(next_path);
                     next_path = dir / "contract_name_to_id.json";
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
                     my->_contract_name_to_id.export_to_json(next_path);
@@ -3572,11 +4563,6 @@ namespace thinkyoung {
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
                     my->_alp_input_balance_entry.export_to_json(next_path);
                     
-                } else if ("_block_extend_status" == ldbname) {
-                    fc::path next_path = dir / (ldbname + ".json");
-                    FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
-                    my->_block_extend_status.export_to_json(next_path);
-                    
                 } else if ("_contract_to_trx_iddb" == ldbname) {
                     fc::path next_path = dir / (ldbname + ".json");
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
@@ -3612,10 +4598,10 @@ namespace thinkyoung {
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
                     my->_account_name_to_id.export_to_json(next_path);
                     
-                } else if ("address_to_transaction_ids" == ldbname) {
+                } else if ("address_transaction_index" == ldbname) {
                     fc::path next_path = dir / (ldbname + ".json");
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
-                    my->_address_to_transaction_ids.export_to_json(next_path);
+                    my->_address_transaction_index.export_to_json(next_path);
                     
                 } else if ("asset_id_to_entry" == ldbname) {
                     fc::path next_path = dir / (ldbname + ".json");
@@ -3637,20 +4623,25 @@ namespace thinkyoung {
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
                     my->_block_id_to_block_entry_db.export_to_json(next_path);
                     
-                } else if ("block_id_to_undo_state" == ldbname) {
+                } else if ("block_num_to_undo_journal" == ldbname) {
                     fc::path next_path = dir / (ldbname + ".json");
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
-                    my->_block_id_to_undo_state.export_to_json(next_path);
+                    my->_block_num_to_undo_journal.export_to_json(next_path);
                     
                 } else if ("contract_id_to_entry" == ldbname) {
                     fc::path next_path = dir / (ldbname + ".json");
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
                     my->_contract_id_to_entry.export_to_json(next_path);
                     
-                } else if ("contract_id_to_storage" == ldbname) {
+                } else if ("contract_storage_key_to_item" == ldbname) {
+                    fc::path next_path = dir / (ldbname + ".json");
+                    FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
+                    my->_contract_storage_key_to_item.export_to_json(next_path);
+                    
+                } else if ("contract_event_index" == ldbname) {
                     fc::path next_path = dir / (ldbname + ".json");
                     FC_ASSERT(!fc::exists(next_path), "File ${n} already exsits!", ("n", next_path));
-                    my->_contract_id_to_storage.export_to_json(next_path);
+                    my->_contract_event_index.export_to_json(next_path);
                     
                 } else if ("contract_name_to_id" == ldbname) {
                     fc::path next_path = dir / (ldbname + ".json");
@@ -3727,19 +4718,32 @@ namespace thinkyoung {
         }
         
         oContractStorage ChainDatabase::contractstorage_lookup_by_id(const ContractIdType& id)const {
-            const auto iter = my->_contract_id_to_storage.unordered_find(id);
+            ContractStorageEntry entry;
+            entry.id = id;
             
-            if (iter != my->_contract_id_to_storage.unordered_end()) return iter->second;
+            for (auto iter = my->_contract_storage_key_to_item.lower_bound(ContractStorageKey(id, std::string())); iter.valid(); ++iter) {
+                const ContractStorageKey key = iter.key();
+                
+                if (key.contract_id != id) break;
+                
+                entry.contract_storages.emplace(key.storage_name, iter.value().storage_data);
+            }
+            
+            if (entry.contract_storages.empty()) return oContractStorage();
             
-            return oContractStorage();
+            return entry;
+        }
+        
+        oContractStorageItem ChainDatabase::contractstorage_lookup_by_key(const ContractStorageKey& key)const {
+            return my->_contract_storage_key_to_item.fetch_optional(key);
         }
         
         void ChainDatabase::contract_insert_into_id_map(const ContractIdType& id, const ContractEntry& info) {
             my->_contract_id_to_entry.store(id, info);
         }
         
-        void ChainDatabase::contractstorage_insert_into_id_map(const ContractIdType& id, const ContractStorageEntry& storage) {
-            my->_contract_id_to_storage.store(id, storage);
+        void ChainDatabase::contractstorage_insert_into_key_map(const ContractStorageKey& key, const ContractStorageItem& item) {
+            my->_contract_storage_key_to_item.store(key, item);
         }
         
         void ChainDatabase::contract_insert_into_name_map(const ContractName& name, const ContractIdType& id) {
@@ -3750,8 +4754,8 @@ namespace thinkyoung {
             my->_contract_id_to_entry.remove(id);
         }
         
-        void ChainDatabase::contractstorage_erase_from_id_map(const ContractIdType& id) {
-            my->_contract_id_to_storage.remove(id);
+        void ChainDatabase::contractstorage_erase_from_key_map(const ContractStorageKey& key) {
+            my->_contract_storage_key_to_item.remove(key);
         }
         
         void ChainDatabase::contract_erase_from_name_map(const ContractName& name) {
@@ -3829,9 +4833,9 @@ namespace thinkyoung {
         vector<ContractIdType> ChainDatabase::get_all_contract_entries() const {
             vector<ContractIdType> vec_contract;
             
-            for (auto iter = my->_contract_id_to_entry.unordered_begin(); iter != my->_contract_id_to_entry.unordered_end(); ++iter) {
-                vec_contract.push_back(iter->first);
-            }
+            my->_contract_id_to_entry.scan([&vec_contract](const ContractIdType& id, const ContractEntry&) {
+                vec_contract.push_back(id);
+            });
             
             return vec_contract;
         }
@@ -628,6 +628,27 @@ namespace thinkyoung {
             } FC_CAPTURE_AND_RETHROW((entry))
         }
 
+        oContractStorageItem ChainInterface::get_contractstorage_item(const ContractIdType& id, const std::string& name) const
+        {
+            try {
+                return lookup<ContractStorageItem>(ContractStorageKey(id, name));
+            } FC_CAPTURE_AND_RETHROW((id)(name))
+        }
+
+        void ChainInterface::remove_contractstorage_item(const ContractIdType& id, const std::string& name)
+        {
+            try {
+                return remove<ContractStorageItem>(ContractStorageKey(id, name));
+            } FC_CAPTURE_AND_RETHROW((id)(name))
+        }
+
+        void ChainInterface::store_contractstorage_item(const ContractIdType& id, const std::string& name, const StorageDataType& data)
+        {
+            try {
+                store(ContractStorageKey(id, name), ContractStorageItem(data));
+            } FC_CAPTURE_AND_RETHROW((id)(name)(data))
+        }
+
         bool ChainInterface::is_destroyed_contract(const ContractState state) const
         {
             if (state == ContractState::deleted)
@@ -171,7 +171,18 @@ namespace thinkyoung {
         {
             try
             {
-                db.contractstorage_insert_into_id_map(id, storage);
+                const oContractStorage prev_storage = db.lookup<ContractStorageEntry>(id);
+                if (prev_storage.valid())
+                {
+                    for (const auto& item : prev_storage->contract_storages)
+                    {
+                        if (storage.contract_storages.count(item.first) == 0)
+                            db.contractstorage_erase_from_key_map(ContractStorageKey(id, item.first));
+                    }
+                }
+
+                for (const auto& item : storage.contract_storages)
+                    db.contractstorage_insert_into_key_map(ContractStorageKey(id, item.first), ContractStorageItem(item.second));
             }FC_CAPTURE_AND_RETHROW((id)(storage))
 
 
@@ -186,13 +197,46 @@ namespace thinkyoung {
 
                 if (storage.valid())
                 {
-                    db.contractstorage_erase_from_id_map(id);
+                    for (const auto& item : storage->contract_storages)
+                        db.contractstorage_erase_from_key_map(ContractStorageKey(id, item.first));
                 }
             }FC_CAPTURE_AND_RETHROW((id))
 
         }
 
 
+        oContractStorageItem ContractStorageItem::lookup(const ChainInterface& db, const ContractStorageKey& key)
+        {
+            try
+            {
+                return db.contractstorage_lookup_by_key(key);
+            }FC_CAPTURE_AND_RETHROW((key))
+        }
+
+
+        void ContractStorageItem::store(ChainInterface& db, const ContractStorageKey& key, const ContractStorageItem& item)
+        {
+            try
+            {
+                db.contractstorage_insert_into_key_map(key, item);
+            }FC_CAPTURE_AND_RETHROW((key)(item))
+        }
+
+
+        void ContractStorageItem::remove(ChainInterface& db, const ContractStorageKey& key)
+        {
+            try
+            {
+                const oContractStorageItem item = db.lookup<ContractStorageItem>(key);
+
+                if (item.valid())
+                {
+                    db.contractstorage_erase_from_key_map(key);
+                }
+            }FC_CAPTURE_AND_RETHROW((key))
+        }
+
+
         Code::Code(const fc::path& path)
         {
             if (!fc::exists(path))
@@ -2,9 +2,13 @@
 #include "blockchain/TransactionEvaluationState.hpp"
 #include "blockchain/ChainInterface.hpp"
 #include "blockchain/Exceptions.hpp"
+#include "blockchain/ForkBlocks.hpp"
 #include "fc/crypto/ripemd160.hpp"
 #include "fc/crypto/sha512.hpp"
 #include <glua/thinkyoung_lua_lib.h>
+#include <glua/glua_contract_module_cache.h>
+#include <glua/glua_state_arena.h>
+#include <glua/lstate.h>
 #include "blockchain/BalanceOperations.hpp"
 #include <sstream>
 #include <blockchain/TransactionOperations.hpp>
@@ -35,6 +39,16 @@ namespace thinkyoung
             return false;
         }
 
+        //lvm changes that decide when a contract runs out of memory only apply from their activation block on, older blocks replay as they were applied
+        void apply_lvm_fork_rules(lua::lib::GluaStateScope& scope, TransactionEvaluationState& eval_state)
+        {
+            const uint32_t head_block_num = eval_state._current_state->get_head_block_num();
+            if (head_block_num >= ALP_LVM_MEMORY_LIMIT_BLOCK_NUM)
+                scope.set_memory_limit(GLUA_STATE_DEFAULT_MEMORY_LIMIT);
+            if (head_block_num >= ALP_LVM_MALLOC_SIZE_CLASSES_BLOCK_NUM)
+                lua_malloc_use_size_classes(scope.L());
+        }
+
         ShareType get_amount_sum(ShareType amount_l, ShareType amount_r)
         {
             ShareType amount_sum = amount_l + amount_r;
@@ -223,7 +237,7 @@ namespace thinkyoung
                             auto contract_entry = eval_state._current_state->get_contract_entry(id);
                             lua::lib::add_global_string_variable(scope.L(), "caller", ((string)(contract_entry->owner)).c_str());
                             lua::lib::add_global_string_variable(scope.L(), "caller_address", ((string)(Address(contract_entry->owner))).c_str());
-                            lua::lib::set_lua_state_value(scope.L(), "evaluate_state", statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
+                            lua::lib::set_lua_state_value(scope.L(), GLUA_STATE_SLOT_EVALUATE_STATE, statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
                             lua::api::global_glua_chain_api->clear_exceptions(scope.L());
 
                             int limit = eval_state._current_state->get_limit(0, exec_limit.amount);
@@ -231,15 +245,16 @@ namespace thinkyoung
                                 FC_CAPTURE_AND_THROW(thinkyoung::blockchain::contract_run_out_of_money);
 
                             scope.set_instructions_limit(limit);
+                            apply_lvm_fork_rules(scope, eval_state);
                             //the arg of on_destroy is empty
                             string default_arg = "";
                             scope.execute_contract_api_by_address(id.AddressToString(AddressType::contract_address).c_str(), CON_ON_UPGRADE_INTERFACE, default_arg.c_str(), nullptr);
                             if (scope.L()->force_stopping == true && scope.L()->exit_code == LUA_API_INTERNAL_ERROR)
                                 FC_CAPTURE_AND_THROW(lua_executor_internal_error, (""));
-                            exception_code = lua::lib::get_lua_state_value(scope.L(), "exception_code").int_value;
+                            exception_code = lua::lib::get_lua_state_value(scope.L(), GLUA_STATE_SLOT_EXCEPTION_CODE).int_value;
                             if (exception_code > 0)
                             {
-                                exception_msg = (char*)lua::lib::get_lua_state_value(scope.L(), "exception_msg").string_value;
+                                exception_msg = (char*)lua::lib::get_lua_state_value(scope.L(), GLUA_STATE_SLOT_EXCEPTION_MSG).string_value;
                                 if (exception_code == THINKYOUNG_API_LVM_LIMIT_OVER_ERROR)
                                     FC_CAPTURE_AND_THROW(thinkyoung::blockchain::contract_run_out_of_money);
                                 else
@@ -251,6 +266,7 @@ namespace thinkyoung
 
                             ShareType exec_cost = eval_state._current_state->get_amount(scope.get_instructions_executed_count()).amount;
                             eval_state.exec_cost = Asset(exec_cost, 0);
+                            eval_state.exec_memory_peak = scope.get_memory_peak();
                             FC_ASSERT(exec_cost <= exec_limit.amount && exec_cost > 0, "costs of execution can be only between 0 and costlimit");
                             ShareType required = get_amount_sum(exec_cost, transaction_fee.amount);
 
@@ -331,6 +347,7 @@ namespace thinkyoung
                 entry->contract_name = name;
                 entry->description = desc;
                 eval_state._current_state->store_contract_entry(*entry);
+                lua::lib::GluaContractModuleCache::instance().invalidate(entry->id.AddressToString(AddressType::contract_address));
             }FC_CAPTURE_AND_RETHROW((*this))
         }
 
@@ -442,7 +459,7 @@ namespace thinkyoung
 
                             lua::lib::add_global_string_variable(scope.L(), "caller", ((string)(entry->owner)).c_str());
                             lua::lib::add_global_string_variable(scope.L(), "caller_address", ((string)(Address(entry->owner))).c_str());
-                            lua::lib::set_lua_state_value(scope.L(), "evaluate_state", statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
+                            lua::lib::set_lua_state_value(scope.L(), GLUA_STATE_SLOT_EVALUATE_STATE, statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
                             lua::api::global_glua_chain_api->clear_exceptions(scope.L());
 
                             int limit = eval_state._current_state->get_limit(0, exec_limit.amount);
@@ -450,15 +467,16 @@ namespace thinkyoung
                                 FC_CAPTURE_AND_THROW(thinkyoung::blockchain::contract_run_out_of_money);
 
                             scope.set_instructions_limit(limit);
+                            apply_lvm_fork_rules(scope, eval_state);
                             //the arg of on_destroy is empty
                             string default_arg = "";
                             scope.execute_contract_api_by_address(id.AddressToString(AddressType::contract_address).c_str(), CON_ON_DESTROY_INTERFACE, default_arg.c_str(), nullptr);
                             if (scope.L()->force_stopping == true && scope.L()->exit_code == LUA_API_INTERNAL_ERROR)
                                 FC_CAPTURE_AND_THROW(lua_executor_internal_error, (""));
-                            exception_code = lua::lib::get_lua_state_value(scope.L(), "exception_code").int_value;
+                            exception_code = lua::lib::get_lua_state_value(scope.L(), GLUA_STATE_SLOT_EXCEPTION_CODE).int_value;
                             if (exception_code > 0)
                             {
-                                exception_msg = (char*)lua::lib::get_lua_state_value(scope.L(), "exception_msg").string_value;
+                                exception_msg = (char*)lua::lib::get_lua_state_value(scope.L(), GLUA_STATE_SLOT_EXCEPTION_MSG).string_value;
                                 if (exception_code == THINKYOUNG_API_LVM_LIMIT_OVER_ERROR)
                                     FC_CAPTURE_AND_THROW(thinkyoung::blockchain::contract_run_out_of_money);
                                 else
@@ -470,6 +488,7 @@ namespace thinkyoung
 
                             ShareType exec_cost = eval_state._current_state->get_amount(scope.get_instructions_executed_count()).amount;
                             eval_state.exec_cost = Asset(exec_cost, 0);
+                            eval_state.exec_memory_peak = scope.get_memory_peak();
                             FC_ASSERT(exec_cost <= exec_limit.amount && exec_cost > 0, "costs of execution can be only between 0 and costlimit");
                             ShareType required = get_amount_sum(exec_cost, transaction_fee.amount);
 
@@ -594,6 +613,7 @@ namespace thinkyoung
 
                 entry->state = ContractState::deleted;
                 eval_state._current_state->store_contract_entry(*entry);
+                lua::lib::GluaContractModuleCache::instance().invalidate(entry->id.AddressToString(AddressType::contract_address));
 
             }FC_CAPTURE_AND_RETHROW((*this))
 
@@ -677,7 +697,7 @@ namespace thinkyoung
 
                     GluaStateValue statevalue;
                     statevalue.pointer_value = &eval_state;
-                    lua::lib::set_lua_state_value(scope.L(), "evaluate_state", statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
+                    lua::lib::set_lua_state_value(scope.L(), GLUA_STATE_SLOT_EVALUATE_STATE, statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
                     lua::lib::add_global_string_variable(scope.L(), "caller", ((string)(this->owner)).c_str());
                     lua::lib::add_global_string_variable(scope.L(), "caller_address", ((string)(Address(this->owner))).c_str());
                     lua::api::global_glua_chain_api->clear_exceptions(scope.L());
@@ -686,16 +706,17 @@ namespace thinkyoung
                         FC_CAPTURE_AND_THROW(thinkyoung::blockchain::contract_run_out_of_money);
 
                     scope.set_instructions_limit(limit);
+                    apply_lvm_fork_rules(scope, eval_state);
                     eval_state.p_result_trx.operations.resize(0);
                     eval_state.p_result_trx.push_transaction(eval_state.trx);
                     eval_state.p_result_trx.expiration = eval_state.trx.expiration;
                     eval_state.p_result_trx.operations.push_back(ContractInfoOperation(get_contract_id(), owner, contract_code, register_time));
                     scope.execute_contract_init_by_address(get_contract_id().AddressToString(AddressType::contract_address).c_str(), nullptr, nullptr);
-                    exception_code = lua::lib::get_lua_state_value(scope.L(), "exception_code").int_value;
+                    exception_code = lua::lib::get_lua_state_value(scope.L(), GLUA_STATE_SLOT_EXCEPTION_CODE).int_value;
 
                     if (exception_code > 0)
                     {
-                        exception_msg = ((char*)lua::lib::get_lua_state_value(scope.L(), "exception_msg").string_value);
+                        exception_msg = ((char*)lua::lib::get_lua_state_value(scope.L(), GLUA_STATE_SLOT_EXCEPTION_MSG).string_value);
                         if (exception_code == THINKYOUNG_API_LVM_LIMIT_OVER_ERROR)
                             FC_CAPTURE_AND_THROW(thinkyoung::blockchain::contract_run_out_of_money);
                         else
@@ -706,6 +727,7 @@ namespace thinkyoung
                     }
                     ShareType exec_cost = eval_state._current_state->get_amount(scope.get_instructions_executed_count()).amount;
                     eval_state.exec_cost = Asset(exec_cost, 0);
+                    eval_state.exec_memory_peak = scope.get_memory_peak();
                     FC_ASSERT(exec_cost <= initcost.amount&&exec_cost > 0, "costs of execution can be only between 0 and initcost");
                     if (!eval_state.evaluate_contract_testing)
                     {
@@ -827,7 +849,7 @@ namespace thinkyoung
 
                         lua::lib::add_global_string_variable(scope.L(), "caller", ((string)(this->caller)).c_str());
                         lua::lib::add_global_string_variable(scope.L(), "caller_address", ((string)(Address(this->caller))).c_str());
-                        lua::lib::set_lua_state_value(scope.L(), "evaluate_state", statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
+                        lua::lib::set_lua_state_value(scope.L(), GLUA_STATE_SLOT_EVALUATE_STATE, statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
 
                         if (!eval_state.evaluate_contract_testing)
                             FC_ASSERT(all_amount >= transaction_fee.amount, "call limit amount not enough!");
@@ -841,13 +863,18 @@ namespace thinkyoung
                             FC_CAPTURE_AND_THROW(thinkyoung::blockchain::contract_run_out_of_money);
                         }
                         scope.set_instructions_limit(limit);
+                        apply_lvm_fork_rules(scope, eval_state);
+                        if (eval_state.profile_contract_execution)
+                            scope.enable_profiler();
                         scope.execute_contract_api_by_address(this->contract.AddressToString(AddressType::contract_address).c_str(), method.c_str(), this->args.c_str(), nullptr);
+                        if (scope.profiler_enabled())
+                            eval_state.exec_profile = scope.get_profile_report();
                         if (scope.L()->force_stopping == true && scope.L()->exit_code == LUA_API_INTERNAL_ERROR)
                             FC_CAPTURE_AND_THROW(lua_executor_internal_error, (""));
-                        exception_code = lua::lib::get_lua_state_value(scope.L(), "exception_code").int_value;
+                        exception_code = lua::lib::get_lua_state_value(scope.L(), GLUA_STATE_SLOT_EXCEPTION_CODE).int_value;
                         if (exception_code > 0)
                         {
-                            exception_msg = (char*)lua::lib::get_lua_state_value(scope.L(), "exception_msg").string_value;
+                            exception_msg = (char*)lua::lib::get_lua_state_value(scope.L(), GLUA_STATE_SLOT_EXCEPTION_MSG).string_value;
                             if (exception_code == THINKYOUNG_API_LVM_LIMIT_OVER_ERROR)
                                 FC_CAPTURE_AND_THROW(thinkyoung::blockchain::contract_run_out_of_money);
                             else
@@ -859,6 +886,8 @@ namespace thinkyoung
 
                         int left = limit - scope.get_instructions_executed_count();
                         eval_state.exec_cost = eval_state._current_state->get_amount(scope.get_instructions_executed_count());
+                        eval_state.exec_memory_peak = scope.get_memory_peak();
+                        dlog("contract call ${c}.${m} storage cache hits: ${h}, misses: ${n}", ("c", this->contract)("m", method)("h", eval_state.storage_cache_hits)("n", eval_state.storage_cache_misses));
                         if (left > 0)
                         {
                             //Լóʼûл
@@ -1015,7 +1044,7 @@ namespace thinkyoung
 
                             lua::lib::add_global_string_variable(scope.L(), "caller", ((string)(from)).c_str());
                             lua::lib::add_global_string_variable(scope.L(), "caller_address", ((string)(Address(from))).c_str());
-                            lua::lib::set_lua_state_value(scope.L(), "evaluate_state", statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
+                            lua::lib::set_lua_state_value(scope.L(), GLUA_STATE_SLOT_EVALUATE_STATE, statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
                             lua::api::global_glua_chain_api->clear_exceptions(scope.L());
 
                             int limit = eval_state._current_state->get_limit(0, costlimit.amount);
@@ -1027,6 +1056,7 @@ namespace thinkyoung
                             std::string transfer_str = transfer_stream.str();
                             DepositContractOperation deposit_contract_op(contract_id, transfer_amount, deposit_contract_normal);
                             scope.set_instructions_limit(limit);
+                            apply_lvm_fork_rules(scope, eval_state);
                             oBalanceEntry obalance_entry = eval_state._current_state->get_balance_entry(deposit_contract_op.balance_id());
                             BalanceEntry balance_entry(WithdrawCondition(WithdrawWithSignature(contract_id), transfer_amount.asset_id, 0, withdraw_contract_type));
                             if (obalance_entry.valid())
@@ -1044,10 +1074,10 @@ namespace thinkyoung
                             eval_state._current_state->store_balance_entry(balance_entry);
                             if (scope.L()->force_stopping == true && scope.L()->exit_code == LUA_API_INTERNAL_ERROR)
                                 FC_CAPTURE_AND_THROW(lua_executor_internal_error, (""));
-                            exception_code = lua::lib::get_lua_state_value(scope.L(), "exception_code").int_value;
+                            exception_code = lua::lib::get_lua_state_value(scope.L(), GLUA_STATE_SLOT_EXCEPTION_CODE).int_value;
                             if (exception_code > 0)
                             {
-                                exception_msg = (char*)lua::lib::get_lua_state_value(scope.L(), "exception_msg").string_value;
+                                exception_msg = (char*)lua::lib::get_lua_state_value(scope.L(), GLUA_STATE_SLOT_EXCEPTION_MSG).string_value;
                                 if (exception_code == THINKYOUNG_API_LVM_LIMIT_OVER_ERROR)
                                     FC_CAPTURE_AND_THROW(thinkyoung::blockchain::contract_run_out_of_money);
                                 else
@@ -1058,6 +1088,7 @@ namespace thinkyoung
                             }
                             ShareType exec_cost = eval_state._current_state->get_amount(scope.get_instructions_executed_count()).amount;
                             eval_state.exec_cost = Asset(exec_cost, 0);
+                            eval_state.exec_memory_peak = scope.get_memory_peak();
                             FC_ASSERT(exec_cost <= costlimit.amount&&exec_cost > 0, "costs of execution can be only between 0 and costlimit");
                             ShareType required = get_amount_sum(exec_cost, transfer_amount.amount);
                             required = get_amount_sum(required, transaction_fee.amount);
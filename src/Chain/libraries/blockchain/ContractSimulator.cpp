@@ -0,0 +1,121 @@
+#include <blockchain/ContractSimulator.hpp>
+#include <blockchain/PendingChainState.hpp>
+
+#include <fc/thread/thread.hpp>
+#include <fc/thread/unique_lock.hpp>
+
+namespace thinkyoung {
+    namespace blockchain {
+
+        namespace {
+            //the evaluation state together with the layer its _current_state points at
+            struct Simulation
+            {
+                PendingChainStatePtr                    layer;
+                TransactionEvaluationStatePtr           eval_state;
+            };
+        }
+
+        ContractSimulator::WriteGuard::WriteGuard(ContractSimulator* simulator)
+            : _simulator(simulator)
+        {
+            if (_simulator != nullptr)
+                _simulator->begin_write();
+        }
+
+        ContractSimulator::WriteGuard::~WriteGuard()
+        {
+            if (_simulator != nullptr)
+                _simulator->end_write();
+        }
+
+        ContractSimulator::ReadGuard::ReadGuard(ContractSimulator* simulator)
+            : _simulator(simulator)
+        {
+            _simulator->begin_read();
+        }
+
+        ContractSimulator::ReadGuard::~ReadGuard()
+        {
+            _simulator->end_read();
+        }
+
+        ContractSimulator::ContractSimulator(const uint32_t thread_count)
+            : _next_thread(0), _state_released("simulation_state_released"), _readers(0), _waiting_writers(0), _writing(false)
+        {
+            for (uint32_t i = 0; i < std::max<uint32_t>(thread_count, 1); ++i)
+                _threads.emplace_back(new fc::thread("contract simulation"));
+        }
+
+        ContractSimulator::~ContractSimulator()
+        {
+            for (auto& thread : _threads)
+                thread->quit();
+        }
+
+        TransactionEvaluationStatePtr ContractSimulator::evaluate(const ChainInterfacePtr& base,
+            const SignedTransaction& trx,
+            const Configure& configure)
+        {
+            try {
+                const auto simulation = std::make_shared<Simulation>();
+                simulation->layer = std::make_shared<PendingChainState>(base);
+                simulation->eval_state = std::make_shared<TransactionEvaluationState>(simulation->layer.get());
+                simulation->eval_state->skipexec = false;
+                simulation->eval_state->evaluate_contract_testing = true;
+                if (configure)
+                    configure(*simulation->eval_state);
+                simulation->eval_state->evaluate(trx);
+                return TransactionEvaluationStatePtr(simulation, simulation->eval_state.get());
+            } FC_CAPTURE_AND_RETHROW((trx))
+        }
+
+        TransactionEvaluationStatePtr ContractSimulator::simulate(const ChainInterfacePtr& base,
+            const SignedTransaction& trx,
+            const Configure& configure)
+        {
+            try {
+                // the fiber yields on the lock and on the result, the thread keeps running other fibers
+                ReadGuard guard(this);
+                fc::thread* worker = _threads[_next_thread++ % _threads.size()].get();
+                return worker->async([base, trx, configure]() -> TransactionEvaluationStatePtr {
+                    return evaluate(base, trx, configure);
+                }, "simulate_contract_testing").wait();
+            } FC_CAPTURE_AND_RETHROW((trx))
+        }
+
+        void ContractSimulator::begin_read()
+        {
+            fc::unique_lock<fc::mutex> lock(_state_mutex);
+            // a waiting block goes first, otherwise a steady stream of simulations would hold it back
+            while (_writing || _waiting_writers > 0)
+                _state_released.wait(lock);
+            ++_readers;
+        }
+
+        void ContractSimulator::end_read()
+        {
+            fc::unique_lock<fc::mutex> lock(_state_mutex);
+            if (--_readers == 0)
+                _state_released.notify_all();
+        }
+
+        void ContractSimulator::begin_write()
+        {
+            fc::unique_lock<fc::mutex> lock(_state_mutex);
+            ++_waiting_writers;
+            while (_writing || _readers > 0)
+                _state_released.wait(lock);
+            --_waiting_writers;
+            _writing = true;
+        }
+
+        void ContractSimulator::end_write()
+        {
+            fc::unique_lock<fc::mutex> lock(_state_mutex);
+            _writing = false;
+            _state_released.notify_all();
+        }
+
+    }
+} // thinkyoung::blockchain
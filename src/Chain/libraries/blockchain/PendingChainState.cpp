@@ -1,11 +1,54 @@
 #include <blockchain/Exceptions.hpp>
 #include <blockchain/PendingChainState.hpp>
+#include <blockchain/StorageOperations.hpp>
 #include <blockchain/Time.hpp>
 #include <fc/io/raw_variant.hpp>
 
 namespace thinkyoung {
     namespace blockchain {
 
+        template<typename T>
+        static bool sets_intersect(const set<T>& a, const set<T>& b)
+        {
+            const set<T>& smaller = a.size() < b.size() ? a : b;
+            const set<T>& larger = a.size() < b.size() ? b : a;
+            for (const auto& key : smaller)
+                if (larger.count(key) > 0) return true;
+            return false;
+        }
+
+        bool ChainStateKeys::intersects(const ChainStateKeys& other)const
+        {
+            return (head_block && other.head_block)
+                || sets_intersect(account_ids, other.account_ids)
+                || sets_intersect(account_names, other.account_names)
+                || sets_intersect(account_addresses, other.account_addresses)
+                || sets_intersect(asset_ids, other.asset_ids)
+                || sets_intersect(asset_symbols, other.asset_symbols)
+                || sets_intersect(slate_ids, other.slate_ids)
+                || sets_intersect(balance_ids, other.balance_ids)
+                || sets_intersect(contract_ids, other.contract_ids)
+                || sets_intersect(contract_names, other.contract_names)
+                || sets_intersect(contract_storage_keys, other.contract_storage_keys)
+                || sets_intersect(property_ids, other.property_ids)
+                || sets_intersect(transaction_ids, other.transaction_ids)
+                || sets_intersect(slot_indexes, other.slot_indexes)
+                || sets_intersect(slot_timestamps, other.slot_timestamps);
+        }
+
+        bool ChainStateKeys::empty()const
+        {
+            return !head_block && !now && account_ids.empty() && account_names.empty() && account_addresses.empty()
+                && asset_ids.empty() && asset_symbols.empty() && slate_ids.empty() && balance_ids.empty()
+                && contract_ids.empty() && contract_names.empty() && contract_storage_keys.empty()
+                && property_ids.empty() && transaction_ids.empty() && slot_indexes.empty() && slot_timestamps.empty();
+        }
+
+        void ChainStateKeys::clear()
+        {
+            *this = ChainStateKeys();
+        }
+
         PendingChainState::PendingChainState(ChainInterfacePtr prev_state)
             : _prev_state(prev_state)
         {
@@ -20,6 +63,7 @@ namespace thinkyoung {
         {
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return 1;
+            if (_read_keys) _read_keys->head_block = true;
             return prev_state->get_head_block_num();
         }
 
@@ -27,6 +71,7 @@ namespace thinkyoung {
         {
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return fc::time_point_sec(0);
+            if (_read_keys) _read_keys->head_block = true;
             return prev_state->get_head_block_timestamp();
         }
 
@@ -34,6 +79,7 @@ namespace thinkyoung {
         {
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return get_slot_start_time(blockchain::now());
+            if (_read_keys) _read_keys->now = true;
             return prev_state->now();
         }
 
@@ -52,7 +98,8 @@ namespace thinkyoung {
             apply_entrys(prev_state, _slot_index_to_entry, _slot_index_remove);
             //contract related
             apply_entrys(prev_state, _contract_id_to_entry, _contract_id_remove);
-            apply_entrys(prev_state, _contract_id_to_storage, _contract_id_remove);
+            for (const auto& id : _contract_id_remove) prev_state->remove<ContractStorageEntry>(id);
+            apply_entrys(prev_state, _contract_storage_key_to_item, _contract_storage_key_remove);
 			apply_entrys(prev_state, _request_id_to_result_id, _req_to_res_to_remove);
 			apply_entrys(prev_state, _result_id_to_request_id, _res_to_req_to_remove);
 			apply_entrys(prev_state, _trx_to_contract_id, _trx_to_contract_id_remove);
@@ -137,26 +184,96 @@ namespace thinkyoung {
             store(id, rec);
         }
 
-        void PendingChainState::get_undo_state(const ChainInterfacePtr& undo_state_arg)const
+        void PendingChainState::get_undo_journal(UndoJournal& journal)const
         {
-            auto undo_state = std::dynamic_pointer_cast<PendingChainState>(undo_state_arg);
             ChainInterfacePtr prev_state = _prev_state.lock();
             FC_ASSERT(prev_state, "Get preview state failed!");
 
-            populate_undo_state(undo_state, prev_state, _property_id_to_entry, _property_id_remove);
-            populate_undo_state(undo_state, prev_state, _account_id_to_entry, _account_id_remove);
-            populate_undo_state(undo_state, prev_state, _asset_id_to_entry, _asset_id_remove);
-            populate_undo_state(undo_state, prev_state, _slate_id_to_entry, _slate_id_remove);
-            populate_undo_state(undo_state, prev_state, _balance_id_to_entry, _balance_id_remove);
-            populate_undo_state(undo_state, prev_state, _transaction_id_to_entry, _transaction_id_remove);
-            populate_undo_state(undo_state, prev_state, _slot_index_to_entry, _slot_index_remove);
+            populate_undo_journal(journal, prev_state, undo_property_entry, _property_id_to_entry, _property_id_remove);
+            populate_undo_journal(journal, prev_state, undo_account_entry, _account_id_to_entry, _account_id_remove);
+            populate_undo_journal(journal, prev_state, undo_asset_entry, _asset_id_to_entry, _asset_id_remove);
+            populate_undo_journal(journal, prev_state, undo_slate_entry, _slate_id_to_entry, _slate_id_remove);
+            populate_undo_journal(journal, prev_state, undo_balance_entry, _balance_id_to_entry, _balance_id_remove);
+            populate_undo_journal(journal, prev_state, undo_transaction_entry, _transaction_id_to_entry, _transaction_id_remove);
+            populate_undo_journal(journal, prev_state, undo_slot_entry, _slot_index_to_entry, _slot_index_remove);
             //contract related
-            populate_undo_state(undo_state, prev_state, _contract_id_to_entry, _contract_id_remove);
-            populate_undo_state(undo_state, prev_state, _contract_id_to_storage, _contract_id_remove);
-			populate_undo_state(undo_state, prev_state, _request_id_to_result_id, _req_to_res_to_remove);
-			populate_undo_state(undo_state, prev_state, _result_id_to_request_id, _res_to_req_to_remove);
-			populate_undo_state(undo_state, prev_state, _trx_to_contract_id,_trx_to_contract_id_remove);
-			populate_undo_state(undo_state, prev_state, _contract_to_trx_id, _contract_to_trx_id_remove);
+            populate_undo_journal(journal, prev_state, undo_contract_entry, _contract_id_to_entry, _contract_id_remove);
+            for (const auto& id : _contract_id_remove)
+            {
+                const oContractStorage prev_storage = prev_state->lookup<ContractStorageEntry>(id);
+                if (prev_storage.valid()) journal.append(undo_contract_storage_entry, id, prev_storage);
+            }
+            //a table keeping its type only journals the entries the block changed
+            for (const auto& key : _contract_storage_key_remove)
+            {
+                const oContractStorageItem prev_item = prev_state->lookup<ContractStorageItem>(key);
+                if (prev_item.valid()) journal.append(undo_contract_storage_item, key, prev_item);
+            }
+            for (const auto& item : _contract_storage_key_to_item)
+            {
+                const oContractStorageItem prev_item = prev_state->lookup<ContractStorageItem>(item.first);
+                const auto storage_type = item.second.storage_data.storage_type;
+                if (prev_item.valid() && prev_item->storage_data.storage_type == storage_type &&
+                    StorageTablePatchType::is_patchable_type(storage_type))
+                {
+                    const fc::optional<StorageTablePatchType> delta =
+                        StorageTablePatchType::diff(item.second.storage_data, prev_item->storage_data);
+                    journal.append(undo_contract_storage_table_delta, item.first, delta);
+                }
+                else
+                {
+                    journal.append(undo_contract_storage_item, item.first, prev_item);
+                }
+            }
+			populate_undo_journal(journal, prev_state, undo_result_id_entry, _request_id_to_result_id, _req_to_res_to_remove);
+			populate_undo_journal(journal, prev_state, undo_request_id_entry, _result_id_to_request_id, _res_to_req_to_remove);
+			populate_undo_journal(journal, prev_state, undo_contractin_trx_entry, _trx_to_contract_id, _trx_to_contract_id_remove);
+			populate_undo_journal(journal, prev_state, undo_contract_trx_entry, _contract_to_trx_id, _contract_to_trx_id_remove);
+        }
+
+        void PendingChainState::track_reads(const std::shared_ptr<ChainStateKeys>& read_keys)
+        {
+            _read_keys = read_keys;
+        }
+
+        void PendingChainState::get_written_keys(ChainStateKeys& written_keys)const
+        {
+            for (const auto& item : _account_id_to_entry) written_keys.account_ids.insert(item.first);
+            written_keys.account_ids.insert(_account_id_remove.begin(), _account_id_remove.end());
+            for (const auto& item : _account_name_to_id) written_keys.account_names.insert(item.first);
+            for (const auto& item : _account_address_to_id) written_keys.account_addresses.insert(item.first);
+            for (const auto& item : _asset_id_to_entry) written_keys.asset_ids.insert(item.first);
+            written_keys.asset_ids.insert(_asset_id_remove.begin(), _asset_id_remove.end());
+            for (const auto& item : _asset_symbol_to_id) written_keys.asset_symbols.insert(item.first);
+            for (const auto& item : _slate_id_to_entry) written_keys.slate_ids.insert(item.first);
+            written_keys.slate_ids.insert(_slate_id_remove.begin(), _slate_id_remove.end());
+            for (const auto& item : _balance_id_to_entry) written_keys.balance_ids.insert(item.first);
+            written_keys.balance_ids.insert(_balance_id_remove.begin(), _balance_id_remove.end());
+            for (const auto& item : _contract_id_to_entry) written_keys.contract_ids.insert(item.first);
+            written_keys.contract_ids.insert(_contract_id_remove.begin(), _contract_id_remove.end());
+            for (const auto& item : _contract_name_to_id) written_keys.contract_names.insert(item.first);
+            for (const auto& item : _property_id_to_entry) written_keys.property_ids.insert(item.first);
+            written_keys.property_ids.insert(_property_id_remove.begin(), _property_id_remove.end());
+            for (const auto& item : _transaction_id_to_entry) written_keys.transaction_ids.insert(item.first);
+            written_keys.transaction_ids.insert(_transaction_id_remove.begin(), _transaction_id_remove.end());
+            for (const auto& item : _slot_index_to_entry) written_keys.slot_indexes.insert(item.first);
+            for (const auto& index : _slot_index_remove)
+            {
+                written_keys.slot_indexes.insert(index);
+                written_keys.slot_timestamps.insert(index.timestamp);
+            }
+            for (const auto& item : _slot_timestamp_to_delegate) written_keys.slot_timestamps.insert(item.first);
+            // whole storage reads are recorded against the contract id
+            for (const auto& item : _contract_storage_key_to_item)
+            {
+                written_keys.contract_storage_keys.insert(item.first);
+                written_keys.contract_ids.insert(item.first.contract_id);
+            }
+            for (const auto& key : _contract_storage_key_remove)
+            {
+                written_keys.contract_storage_keys.insert(key);
+                written_keys.contract_ids.insert(key.contract_id);
+            }
         }
 
         /** load the state from a variant */
@@ -181,6 +298,7 @@ namespace thinkyoung {
             if (_property_id_remove.count(id) > 0) return oPropertyEntry();
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return oPropertyEntry();
+            if (_read_keys) _read_keys->property_ids.insert(id);
             return prev_state->lookup<PropertyEntry>(id);
         }
 
@@ -203,6 +321,7 @@ namespace thinkyoung {
             if (_account_id_remove.count(id) > 0) return oAccountEntry();
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return oAccountEntry();
+            if (_read_keys) _read_keys->account_ids.insert(id);
             return prev_state->lookup<AccountEntry>(id);
         }
 
@@ -213,6 +332,11 @@ namespace thinkyoung {
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return oAccountEntry();
             const oAccountEntry entry = prev_state->lookup<AccountEntry>(name);
+            if (_read_keys)
+            {
+                _read_keys->account_names.insert(name);
+                if (entry.valid()) _read_keys->account_ids.insert(entry->id);
+            }
             if (entry.valid() && _account_id_remove.count(entry->id) == 0) return *entry;
             return oAccountEntry();
         }
@@ -224,6 +348,11 @@ namespace thinkyoung {
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return oAccountEntry();
             const oAccountEntry entry = prev_state->lookup<AccountEntry>(addr);
+            if (_read_keys)
+            {
+                _read_keys->account_addresses.insert(addr);
+                if (entry.valid()) _read_keys->account_ids.insert(entry->id);
+            }
             if (entry.valid() && _account_id_remove.count(entry->id) == 0) return *entry;
             return oAccountEntry();
         }
@@ -275,6 +404,7 @@ namespace thinkyoung {
             if (_asset_id_remove.count(id) > 0) return oAssetEntry();
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return oAssetEntry();
+            if (_read_keys) _read_keys->asset_ids.insert(id);
             return prev_state->lookup<AssetEntry>(id);
         }
 
@@ -285,6 +415,11 @@ namespace thinkyoung {
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return oAssetEntry();
             const oAssetEntry entry = prev_state->lookup<AssetEntry>(symbol);
+            if (_read_keys)
+            {
+                _read_keys->asset_symbols.insert(symbol);
+                if (entry.valid()) _read_keys->asset_ids.insert(entry->id);
+            }
             if (entry.valid() && _asset_id_remove.count(entry->id) == 0) return *entry;
             return oAssetEntry();
         }
@@ -318,6 +453,7 @@ namespace thinkyoung {
             if (_slate_id_remove.count(id) > 0) return oSlateEntry();
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return oSlateEntry();
+            if (_read_keys) _read_keys->slate_ids.insert(id);
             return prev_state->lookup<SlateEntry>(id);
         }
 
@@ -340,6 +476,7 @@ namespace thinkyoung {
             if (_balance_id_remove.count(id) > 0) return oBalanceEntry();
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return oBalanceEntry();
+            if (_read_keys) _read_keys->balance_ids.insert(id);
             return prev_state->lookup<BalanceEntry>(id);
         }
 
@@ -362,6 +499,7 @@ namespace thinkyoung {
             if (_transaction_id_remove.count(id) > 0) return oTransactionEntry();
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return oTransactionEntry();
+            if (_read_keys) _read_keys->transaction_ids.insert(id);
             return prev_state->lookup<TransactionEntry>(id);
         }
 
@@ -395,6 +533,7 @@ namespace thinkyoung {
             if (_slot_index_remove.count(index) > 0) return oSlotEntry();
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return oSlotEntry();
+            if (_read_keys) _read_keys->slot_indexes.insert(index);
             return prev_state->lookup<SlotEntry>(index);
         }
 
@@ -404,6 +543,7 @@ namespace thinkyoung {
             if (iter != _slot_timestamp_to_delegate.end()) return _slot_index_to_entry.at(SlotIndex(iter->second, timestamp));
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return oSlotEntry();
+            if (_read_keys) _read_keys->slot_timestamps.insert(timestamp);
             const oSlotEntry entry = prev_state->lookup<SlotEntry>(timestamp);
             if (entry.valid() && _slot_index_remove.count(entry->index) == 0) return *entry;
             return oSlotEntry();
@@ -438,6 +578,7 @@ namespace thinkyoung {
             if (_contract_id_remove.count(id) > 0) return oContractEntry();
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return oContractEntry();
+            if (_read_keys) _read_keys->contract_ids.insert(id);
             return prev_state->lookup<ContractEntry>(id);
         }
 
@@ -448,19 +589,49 @@ namespace thinkyoung {
             const ChainInterfacePtr prev_state = _prev_state.lock();
             if (!prev_state) return oContractEntry();
             const oContractEntry entry = prev_state->lookup<ContractEntry>(name);
+            if (_read_keys)
+            {
+                _read_keys->contract_names.insert(name);
+                if (entry.valid()) _read_keys->contract_ids.insert(entry->id);
+            }
             if (entry.valid() && _contract_id_remove.count(entry->id) == 0) return *entry;
             return oContractEntry();
         }
 
         oContractStorage PendingChainState::contractstorage_lookup_by_id(const ContractIdType& id)const
         {
-            const auto iter = _contract_id_to_storage.find(id);
-            if (iter != _contract_id_to_storage.end()) return iter->second;
+            ContractStorageEntry entry;
+            entry.id = id;
             const ChainInterfacePtr prev_state = _prev_state.lock();
-            if (!prev_state) return oContractStorage();
-            oContractStorage entry = prev_state->lookup<ContractStorageEntry>(id);
-            if (entry.valid() && _contract_id_remove.count(id) == 0) return entry;
-            return oContractStorage();
+            if (prev_state && _contract_id_remove.count(id) == 0)
+            {
+                if (_read_keys) _read_keys->contract_ids.insert(id);
+                const oContractStorage prev_entry = prev_state->lookup<ContractStorageEntry>(id);
+                if (prev_entry.valid()) entry.contract_storages = prev_entry->contract_storages;
+            }
+
+            const ContractStorageKey first(id, std::string());
+            for (auto iter = _contract_storage_key_remove.lower_bound(first);
+                iter != _contract_storage_key_remove.end() && iter->contract_id == id; ++iter)
+                entry.contract_storages.erase(iter->storage_name);
+            for (auto iter = _contract_storage_key_to_item.lower_bound(first);
+                iter != _contract_storage_key_to_item.end() && iter->first.contract_id == id; ++iter)
+                entry.contract_storages[iter->first.storage_name] = iter->second.storage_data;
+
+            if (entry.contract_storages.empty()) return oContractStorage();
+            return entry;
+        }
+
+        oContractStorageItem PendingChainState::contractstorage_lookup_by_key(const ContractStorageKey& key)const
+        {
+            const auto iter = _contract_storage_key_to_item.find(key);
+            if (iter != _contract_storage_key_to_item.end()) return iter->second;
+            if (_contract_storage_key_remove.count(key) > 0) return oContractStorageItem();
+            if (_contract_id_remove.count(key.contract_id) > 0) return oContractStorageItem();
+            const ChainInterfacePtr prev_state = _prev_state.lock();
+            if (!prev_state) return oContractStorageItem();
+            if (_read_keys) _read_keys->contract_storage_keys.insert(key);
+            return prev_state->lookup<ContractStorageItem>(key);
         }
 
         void PendingChainState::contract_insert_into_id_map(const ContractIdType& id, const ContractEntry& entry)
@@ -475,10 +646,10 @@ namespace thinkyoung {
             _contract_name_to_id[name] = id;
         }
 
-        void PendingChainState::contractstorage_insert_into_id_map(const ContractIdType& id, const ContractStorageEntry& storage)
+        void PendingChainState::contractstorage_insert_into_key_map(const ContractStorageKey& key, const ContractStorageItem& item)
         {
-            //_contract_id_remove.erase(id);
-            _contract_id_to_storage[id] = storage;
+            _contract_storage_key_remove.erase(key);
+            _contract_storage_key_to_item[key] = item;
         }
 
         void PendingChainState::contract_erase_from_id_map(const ContractIdType& id)
@@ -585,10 +756,10 @@ namespace thinkyoung {
 			this->_trx_to_contract_id.erase(id);
 			_trx_to_contract_id_remove.insert(id);
 		}
-        void PendingChainState::contractstorage_erase_from_id_map(const ContractIdType& id)
+        void PendingChainState::contractstorage_erase_from_key_map(const ContractStorageKey& key)
         {
-            _contract_id_to_storage.erase(id);
-            //_contract_id_remove.insert(id);
+            _contract_storage_key_to_item.erase(key);
+            _contract_storage_key_remove.insert(key);
         }
 
         thinkyoung::blockchain::BlockIdType PendingChainState::get_block_id(uint32_t block_num) const
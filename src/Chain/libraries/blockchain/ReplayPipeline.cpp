@@ -0,0 +1,154 @@
+#include <blockchain/ReplayPipeline.hpp>
+#include <utilities/ThreadPool.hpp>
+
+#include <chrono>
+
+namespace thinkyoung {
+    namespace blockchain {
+
+        ReplayPipeline::ReplayPipeline(ThreadPool& thread_pool,
+            const BlockSource& source,
+            const DigestType& chain_id,
+            const bool recover_trx_signees,
+            const uint32_t last_checkpoint_block_num,
+            const size_t depth)
+            : _thread_pool(thread_pool),
+            _source(source),
+            _chain_id(chain_id),
+            _recover_trx_signees(recover_trx_signees),
+            _last_checkpoint_block_num(last_checkpoint_block_num),
+            _depth(std::max<size_t>(depth, 1))
+        {
+            _reader = std::thread(&ReplayPipeline::read_blocks, this);
+        }
+
+        ReplayPipeline::~ReplayPipeline()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+            }
+            _not_full.notify_all();
+            if (_reader.joinable())
+                _reader.join();
+            // recoveries still queued on the thread pool reference this pipeline
+            for (auto& pending : _queue)
+                if (pending.valid()) pending.wait();
+        }
+
+        void ReplayPipeline::read_blocks()
+        {
+            try {
+                while (true)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _not_full.wait(lock, [this] { return _stopping || _queue.size() < _depth; });
+                        if (_stopping) break;
+                    }
+
+                    const auto block = std::make_shared<FullBlock>();
+                    if (!_source(*block)) break;
+
+                    auto recovered = _thread_pool.submit([this, block]() -> RecoveredBlock { return recover(block); });
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _queue.push_back(std::move(recovered));
+                    }
+                    _not_empty.notify_one();
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _finished = true;
+            }
+            _not_empty.notify_all();
+        }
+
+        RecoveredBlock ReplayPipeline::recover(const std::shared_ptr<FullBlock>& block)const
+        {
+            RecoveredBlock recovered;
+            recovered.block_id = block->id();
+
+            // a signature that fails to recover is left to extend_chain, which rejects the block as before
+            try {
+                if (block->block_num > _last_checkpoint_block_num)
+                    recovered.signees.block_signee = block->signee();
+            }
+            catch (const fc::exception&)
+            {
+                recovered.signees.block_signee = fc::optional<PublicKeyType>();
+            }
+
+            if (_recover_trx_signees)
+            {
+                try {
+                    recovered.signees.trx_signees.reserve(block->user_transactions.size());
+                    for (const auto& trx : block->user_transactions)
+                    {
+                        const auto trx_digest = trx.digest(_chain_id);
+                        std::vector<RecoveredSignature> signees;
+                        signees.reserve(trx.signatures.size());
+                        for (const auto& sig : trx.signatures)
+                            signees.push_back(SignatureCache::recover_uncached(trx_digest, sig, false));
+                        recovered.signees.trx_signees.push_back(std::move(signees));
+                    }
+                }
+                catch (const fc::exception&)
+                {
+                    recovered.signees.trx_signees.clear();
+                }
+            }
+
+            recovered.block = std::move(*block);
+            return recovered;
+        }
+
+        bool ReplayPipeline::next(RecoveredBlock& recovered)
+        {
+            std::future<RecoveredBlock> pending;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _not_empty.wait(lock, [this] { return _finished || !_queue.empty(); });
+                if (_queue.empty())
+                {
+                    if (_error) std::rethrow_exception(_error);
+                    return false;
+                }
+                pending = std::move(_queue.front());
+                _queue.pop_front();
+            }
+            _not_full.notify_one();
+
+            recovered = pending.get();
+            return true;
+        }
+
+        size_t ReplayPipeline::count_recovering()const
+        {
+            size_t count = 0;
+            for (const auto& pending : _queue)
+                if (pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) ++count;
+            return count;
+        }
+
+        size_t ReplayPipeline::fetched_depth()const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return count_recovering();
+        }
+
+        size_t ReplayPipeline::recovered_depth()const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _queue.size() - count_recovering();
+        }
+
+    }
+} // thinkyoung::blockchain
@@ -0,0 +1,85 @@
+#include <blockchain/PtsAddress.hpp>
+#include <blockchain/SignatureCache.hpp>
+
+namespace thinkyoung {
+    namespace blockchain {
+
+        SignatureCache& SignatureCache::instance()
+        {
+            static SignatureCache cache;
+            return cache;
+        }
+
+        SignatureCache::SignatureCache(const size_t capacity)
+            : _capacity(std::max<size_t>(capacity, 1)), _hits(0), _misses(0)
+        {
+        }
+
+        RecoveredSignature SignatureCache::recover(const DigestType& digest, const fc::ecc::compact_signature& sig, const bool enforce_canonical)
+        {
+            const CacheKey cache_key(digest, sig);
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                const auto iter = _index.find(cache_key);
+                // an entry recovered without the canonical check is recovered again when it is required
+                if (iter != _index.end() && (!enforce_canonical || iter->second->second.canonical))
+                {
+                    _lru.splice(_lru.begin(), _lru, iter->second);
+                    ++_hits;
+                    return iter->second->second;
+                }
+            }
+            ++_misses;
+
+            // recover outside the lock so the signature check threads do not serialize on it
+            const RecoveredSignature recovered = recover_uncached(digest, sig, enforce_canonical);
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            const auto iter = _index.find(cache_key);
+            if (iter != _index.end())
+            {
+                iter->second->second.canonical |= recovered.canonical;
+            }
+            else
+            {
+                _lru.emplace_front(cache_key, recovered);
+                _index[cache_key] = _lru.begin();
+                while (_index.size() > _capacity)
+                {
+                    _index.erase(_lru.back().first);
+                    _lru.pop_back();
+                }
+            }
+            return recovered;
+        }
+
+        RecoveredSignature SignatureCache::recover_uncached(const DigestType& digest, const fc::ecc::compact_signature& sig, const bool enforce_canonical)
+        {
+            RecoveredSignature recovered;
+            const auto key = fc::ecc::public_key(sig, digest, enforce_canonical).serialize();
+            recovered.key = key;
+            recovered.addresses.reserve(5);
+            recovered.addresses.push_back(Address(key));
+            recovered.addresses.push_back(Address(PtsAddress(key, false, 56)));
+            recovered.addresses.push_back(Address(PtsAddress(key, true, 56)));
+            recovered.addresses.push_back(Address(PtsAddress(key, false, 0)));
+            recovered.addresses.push_back(Address(PtsAddress(key, true, 0)));
+            recovered.canonical = enforce_canonical;
+            return recovered;
+        }
+
+        void SignatureCache::clear()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _index.clear();
+            _lru.clear();
+        }
+
+        size_t SignatureCache::size()const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _index.size();
+        }
+
+    }
+} // thinkyoung::blockchain
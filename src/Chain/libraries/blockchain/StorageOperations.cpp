@@ -2,10 +2,13 @@
 #include <blockchain/TransactionEvaluationState.hpp>
 #include <blockchain/Exceptions.hpp>
 #include <blockchain/ChainInterface.hpp>
+#include <blockchain/ForkBlocks.hpp>
 
 namespace thinkyoung {
     namespace blockchain {
 
+        const uint8_t StorageTablePatchType::type = storage_value_table_patch;
+
         template<typename StorageBaseType, typename StorageContainerType>
         void StorageOperation::update_contract_map_storage(const StorageDataChangeType& change_storage, StorageDataType& storage)const
         {
@@ -30,9 +33,120 @@ namespace thinkyoung {
             storage = StorageDataType(new_storage);
         }
 
+        template<typename StorageContainerType>
+        static void patch_map_storage(const StorageTablePatchType& patch, StorageDataType& storage)
+        {
+            StorageContainerType new_storage = storage.as<StorageContainerType>();
+            const auto changed_table = patch.changed_items.as<StorageContainerType>().raw_storage_map;
+
+            for (const auto& key : patch.removed_keys)
+                new_storage.raw_storage_map.erase(key);
+
+            for (const auto& item : changed_table)
+                new_storage.raw_storage_map[item.first] = item.second;
+
+            storage = StorageDataType(new_storage);
+        }
+
+        template<typename StorageContainerType>
+        static StorageTablePatchType diff_map_storage(const StorageDataType& before, const StorageDataType& after)
+        {
+            const auto before_table = before.as<StorageContainerType>().raw_storage_map;
+            const auto after_table = after.as<StorageContainerType>().raw_storage_map;
+
+            StorageTablePatchType patch;
+            StorageContainerType changed_items;
+            for (const auto& item : after_table)
+            {
+                const auto iter = before_table.find(item.first);
+                if (iter == before_table.end() || !(iter->second == item.second))
+                    changed_items.raw_storage_map.insert(item);
+            }
+            for (const auto& item : before_table)
+            {
+                if (after_table.count(item.first) == 0)
+                    patch.removed_keys.insert(item.first);
+            }
+
+            patch.changed_items = StorageDataType(changed_items);
+            return patch;
+        }
+
+        bool StorageTablePatchType::is_patchable_type(StorageValueTypes type)
+        {
+            return (StorageDataType::is_table_type(type) && type != StorageValueTypes::storage_value_unknown_table) ||
+                (StorageDataType::is_array_type(type) && type != StorageValueTypes::storage_value_unknown_array);
+        }
+
+        StorageTablePatchType StorageTablePatchType::diff(const StorageDataType& before, const StorageDataType& after)
+        {
+            auto storage_type = before.storage_type;
+            FC_ASSERT(storage_type == after.storage_type, "the type of storage after is not match the before");
+
+            if (storage_type == StorageValueTypes::storage_value_int_table)
+                return diff_map_storage<StorageIntTableType>(before, after);
+            else if (storage_type == StorageValueTypes::storage_value_number_table)
+                return diff_map_storage<StorageNumberTableType>(before, after);
+            else if (storage_type == StorageValueTypes::storage_value_bool_table)
+                return diff_map_storage<StorageBoolTableType>(before, after);
+            else if (storage_type == StorageValueTypes::storage_value_string_table)
+                return diff_map_storage<StorageStringTableType>(before, after);
+            else if (storage_type == StorageValueTypes::storage_value_int_array)
+                return diff_map_storage<StorageIntArrayType>(before, after);
+            else if (storage_type == StorageValueTypes::storage_value_number_array)
+                return diff_map_storage<StorageNumberArrayType>(before, after);
+            else if (storage_type == StorageValueTypes::storage_value_bool_array)
+                return diff_map_storage<StorageBoolArrayType>(before, after);
+            else if (storage_type == StorageValueTypes::storage_value_string_array)
+                return diff_map_storage<StorageStringArrayType>(before, after);
+
+            FC_ASSERT(false, "the type of storage can not be patched");
+            return StorageTablePatchType();
+        }
+
+        void StorageTablePatchType::apply(StorageDataType& storage)const
+        {
+            auto storage_type = storage.storage_type;
+            FC_ASSERT(storage_type == changed_items.storage_type, "the type of storage from entry is not match the patch");
+
+            if (storage_type == StorageValueTypes::storage_value_int_table)
+                patch_map_storage<StorageIntTableType>(*this, storage);
+            else if (storage_type == StorageValueTypes::storage_value_number_table)
+                patch_map_storage<StorageNumberTableType>(*this, storage);
+            else if (storage_type == StorageValueTypes::storage_value_bool_table)
+                patch_map_storage<StorageBoolTableType>(*this, storage);
+            else if (storage_type == StorageValueTypes::storage_value_string_table)
+                patch_map_storage<StorageStringTableType>(*this, storage);
+            else if (storage_type == StorageValueTypes::storage_value_int_array)
+                patch_map_storage<StorageIntArrayType>(*this, storage);
+            else if (storage_type == StorageValueTypes::storage_value_number_array)
+                patch_map_storage<StorageNumberArrayType>(*this, storage);
+            else if (storage_type == StorageValueTypes::storage_value_bool_array)
+                patch_map_storage<StorageBoolArrayType>(*this, storage);
+            else if (storage_type == StorageValueTypes::storage_value_string_array)
+                patch_map_storage<StorageStringArrayType>(*this, storage);
+            else
+                FC_ASSERT(false, "the type of storage can not be patched");
+        }
+
+        void StorageOperation::patch_contract_storages(const std::string storage_name, const StorageTablePatchType& patch,
+            std::map<std::string, StorageDataType>& contract_storages)const
+        {
+            auto iter = contract_storages.find(storage_name);
+            FC_ASSERT(iter != contract_storages.end(), "can not get storage_name");
+
+            patch.apply(iter->second);
+        }
+
         void StorageOperation::update_contract_storages(const std::string storage_name, const StorageDataChangeType& change_storage,
             std::map<std::string, StorageDataType>& contract_storages)const
         {
+            if (change_storage.is_table_patch())
+            {
+                patch_contract_storages(storage_name, change_storage.storage_after.as<StorageTablePatchType>(), contract_storages);
+                return;
+            }
+
             if (change_storage.storage_before.storage_type == StorageValueTypes::storage_value_null &&
                 change_storage.storage_after.storage_type != StorageValueTypes::storage_value_null)
             {
@@ -90,17 +204,27 @@ namespace thinkyoung {
                 if (!eval_state.evaluate_contract_result)
                     FC_CAPTURE_AND_THROW(not_be_result_of_execute, (type));
                 //contract_idȡϺԼstorage
-                oContractStorage ocontractstorage = eval_state._current_state->get_contractstorage_entry(this->contract_id);
-
+                //only the storage items touched by this operation are loaded
                 std::map<std::string, StorageDataType> contract_storages;
-                if (ocontractstorage.valid())
-                    contract_storages = ocontractstorage->contract_storages;
+                for (const auto& change : contract_change_storages)
+                {
+                    const oContractStorageItem oitem = eval_state._current_state->get_contractstorage_item(this->contract_id, change.first);
+                    if (oitem.valid())
+                        contract_storages.emplace(change.first, oitem->storage_data);
+                }
 
                 auto iter_change = contract_change_storages.begin();
                 auto iter = contract_storages.begin();
 
                 for (; iter_change != contract_change_storages.end(); ++iter_change)
                 {
+                    if (iter_change->second.is_table_patch())
+                    {
+                        FC_ASSERT(eval_state._current_state->get_head_block_num() >= ALP_STORAGE_TABLE_PATCH_BLOCK_NUM,
+                            "storage table patch is not enabled yet");
+                        continue;
+                    }
+
                     //storage_afterstorage_beforeͲһ
                     if (iter_change->second.storage_before.storage_type != StorageValueTypes::storage_value_null 
                         && iter_change->second.storage_after.storage_type != StorageValueTypes::storage_value_null)
@@ -119,11 +243,14 @@ namespace thinkyoung {
                 for (; iter_change != contract_change_storages.end(); ++iter_change)
                     update_contract_storages(iter_change->first, iter_change->second, contract_storages);
 
-                ContractStorageEntry entry;
-                entry.id = this->contract_id;
-                entry.contract_storages = contract_storages;
-
-                eval_state._current_state->store_contractstorage_entry(entry);
+                for (const auto& change : contract_change_storages)
+                {
+                    eval_state.invalidate_cached_contractstorage_item(this->contract_id, change.first);
+                    if ((iter = contract_storages.find(change.first)) != contract_storages.end())
+                        eval_state._current_state->store_contractstorage_item(this->contract_id, change.first, iter->second);
+                    else
+                        eval_state._current_state->remove_contractstorage_item(this->contract_id, change.first);
+                }
 
             } FC_CAPTURE_AND_RETHROW((*this))
         }
@@ -22,7 +22,8 @@ namespace thinkyoung {
                 make_pair(storage_value_int_array, std::string("Array<int>")),
                 make_pair(storage_value_number_array, std::string("Array<number>")),
                 make_pair(storage_value_bool_array, std::string("Array<bool>")),
-                make_pair(storage_value_string_array, std::string("Array<string>"))
+                make_pair(storage_value_string_array, std::string("Array<string>")),
+                make_pair(storage_value_table_patch, std::string("TablePatch"))
         };
 
         const uint8_t StorageNullType::type = storage_value_null;
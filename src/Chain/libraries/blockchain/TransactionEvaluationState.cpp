@@ -9,9 +9,14 @@
 #include <blockchain/ForkBlocks.hpp>
 #include "wallet/Wallet.hpp"
 
+#include <atomic>
+
 namespace thinkyoung {
     namespace blockchain {
     
+        static std::atomic<uint64_t> storage_cache_hit_count(0);
+        static std::atomic<uint64_t> storage_cache_miss_count(0);
+        
         TransactionEvaluationState::TransactionEvaluationState(PendingChainState* current_state)
             :_current_state(current_state),
              imessage_length(0), evaluate_contract_result(false), throw_exec_exception(false) {
@@ -45,6 +50,10 @@ namespace thinkyoung {
             FC_CAPTURE_AND_RETHROW((a))
         }
         
+        void TransactionEvaluationState::add_signed_keys(const RecoveredSignature& recovered) {
+            signed_keys.insert(recovered.addresses.begin(), recovered.addresses.end());
+        }
+        
         bool TransactionEvaluationState::check_multisig(const MultisigCondition& condition)const {
             try {
                 uint32_t valid = 0;
@@ -90,6 +99,35 @@ namespace thinkyoung {
             FC_CAPTURE_AND_RETHROW()
         }
         
+        oContractStorageItem TransactionEvaluationState::get_cached_contractstorage_item(const ContractIdType& contract_id, const std::string& name) {
+            const auto key = std::make_pair(contract_id, name);
+            auto iter = storage_read_cache.find(key);
+            
+            if (iter != storage_read_cache.end()) {
+                ++storage_cache_hits;
+                ++storage_cache_hit_count;
+                return iter->second;
+            }
+            
+            ++storage_cache_misses;
+            ++storage_cache_miss_count;
+            oContractStorageItem item = _current_state->get_contractstorage_item(contract_id, name);
+            storage_read_cache.emplace(key, item);
+            return item;
+        }
+        
+        uint64_t TransactionEvaluationState::total_storage_cache_hits() {
+            return storage_cache_hit_count;
+        }
+        
+        uint64_t TransactionEvaluationState::total_storage_cache_misses() {
+            return storage_cache_miss_count;
+        }
+        
+        void TransactionEvaluationState::invalidate_cached_contractstorage_item(const ContractIdType& contract_id, const std::string& name) {
+            storage_read_cache.erase(std::make_pair(contract_id, name));
+        }
+        
         void TransactionEvaluationState::validate_required_fee() {
             try {
                 Asset xts_fees;
@@ -238,15 +276,15 @@ namespace thinkyoung {
         }
         
         bool TransactionEvaluationState::transaction_signature_check(const SignedTransaction& trx_arg, const std::vector<BalanceEntry> all_balances, const std::vector<AccountEntry> all_account) {
-            const auto trx_digest = trx_arg.digest(_current_state->get_chain_id());
-            
-            for (const auto& sig : trx_arg.signatures) {
-                const auto key = fc::ecc::public_key(sig, trx_digest, _enforce_canonical_signatures).serialize();
-                signed_keys.insert(Address(key));
-                signed_keys.insert(Address(PtsAddress(key, false, 56)));
-                signed_keys.insert(Address(PtsAddress(key, true, 56)));
-                signed_keys.insert(Address(PtsAddress(key, false, 0)));
-                signed_keys.insert(Address(PtsAddress(key, true, 0)));
+            if (_recovered_signees.valid() && _recovered_signees->size() == trx_arg.signatures.size() && !_enforce_canonical_signatures) {
+                for (const auto& recovered : *_recovered_signees)
+                    add_signed_keys(recovered);
+                    
+            } else {
+                const auto trx_digest = trx_arg.digest(_current_state->get_chain_id());
+                
+                for (const auto& sig : trx_arg.signatures)
+                    add_signed_keys(SignatureCache::instance().recover(trx_digest, sig, _enforce_canonical_signatures));
             }
             
             for (const auto& balance_entry : all_balances) {
@@ -344,14 +382,8 @@ namespace thinkyoung {
                             sig_set.insert(sig);
                         }
                         
-                        for (const auto& sig : sig_set) {
-                            const auto key = fc::ecc::public_key(sig, trx_digest, _enforce_canonical_signatures).serialize();
-                            signed_keys.insert(Address(key));
-                            signed_keys.insert(Address(PtsAddress(key, false, 56)));
-                            signed_keys.insert(Address(PtsAddress(key, true, 56)));
-                            signed_keys.insert(Address(PtsAddress(key, false, 0)));
-                            signed_keys.insert(Address(PtsAddress(key, true, 0)));
-                        }
+                        for (const auto& sig : sig_set)
+                            add_signed_keys(SignatureCache::instance().recover(trx_digest, sig, _enforce_canonical_signatures));
                     }
                     
                     current_op_index = 0;
@@ -450,14 +482,8 @@ namespace thinkyoung {
                     if (!_skip_signature_check) {
                         const auto trx_digest = trx_arg.digest(_current_state->get_chain_id());
                         
-                        for (const auto& sig : trx_arg.signatures) {
-                            const auto key = fc::ecc::public_key(sig, trx_digest, _enforce_canonical_signatures).serialize();
-                            signed_keys.insert(Address(key));
-                            signed_keys.insert(Address(PtsAddress(key, false, 56)));
-                            signed_keys.insert(Address(PtsAddress(key, true, 56)));
-                            signed_keys.insert(Address(PtsAddress(key, false, 0)));
-                            signed_keys.insert(Address(PtsAddress(key, true, 0)));
-                        }
+                        for (const auto& sig : trx_arg.signatures)
+                            add_signed_keys(SignatureCache::instance().recover(trx_digest, sig, _enforce_canonical_signatures));
                     }
                     
                     current_op_index = 0;
@@ -0,0 +1,86 @@
+#include <blockchain/UndoJournal.hpp>
+#include <blockchain/ChainInterface.hpp>
+#include <blockchain/StorageOperations.hpp>
+
+namespace thinkyoung {
+    namespace blockchain {
+
+        template<typename K, typename V>
+        static void revert_undo_record(ChainInterface& db, const UndoRecord& record)
+        {
+            const K key = fc::raw::unpack<K>(record.key);
+            if (record.prior_value.valid()) db.store(key, fc::raw::unpack<V>(*record.prior_value));
+            else db.remove<V>(key);
+        }
+
+        static void revert_storage_table_delta(ChainInterface& db, const UndoRecord& record)
+        {
+            const ContractStorageKey key = fc::raw::unpack<ContractStorageKey>(record.key);
+            FC_ASSERT(record.prior_value.valid(), "table delta without a patch");
+            oContractStorageItem item = db.lookup<ContractStorageItem>(key);
+            FC_ASSERT(item.valid(), "can not get storage_name");
+            fc::raw::unpack<StorageTablePatchType>(*record.prior_value).apply(item->storage_data);
+            db.store(key, *item);
+        }
+
+        void UndoJournal::revert(ChainInterface& db)const
+        {
+            try {
+                for (auto iter = records.rbegin(); iter != records.rend(); ++iter)
+                {
+                    switch (iter->entry_type)
+                    {
+                    case undo_property_entry:
+                        revert_undo_record<PropertyIdType, PropertyEntry>(db, *iter);
+                        break;
+                    case undo_account_entry:
+                        revert_undo_record<AccountIdType, AccountEntry>(db, *iter);
+                        break;
+                    case undo_asset_entry:
+                        revert_undo_record<AssetIdType, AssetEntry>(db, *iter);
+                        break;
+                    case undo_slate_entry:
+                        revert_undo_record<SlateIdType, SlateEntry>(db, *iter);
+                        break;
+                    case undo_balance_entry:
+                        revert_undo_record<BalanceIdType, BalanceEntry>(db, *iter);
+                        break;
+                    case undo_transaction_entry:
+                        revert_undo_record<TransactionIdType, TransactionEntry>(db, *iter);
+                        break;
+                    case undo_slot_entry:
+                        revert_undo_record<SlotIndex, SlotEntry>(db, *iter);
+                        break;
+                    case undo_contract_entry:
+                        revert_undo_record<ContractIdType, ContractEntry>(db, *iter);
+                        break;
+                    case undo_contract_storage_entry:
+                        revert_undo_record<ContractIdType, ContractStorageEntry>(db, *iter);
+                        break;
+                    case undo_contract_storage_item:
+                        revert_undo_record<ContractStorageKey, ContractStorageItem>(db, *iter);
+                        break;
+                    case undo_result_id_entry:
+                        revert_undo_record<TransactionIdType, ResultTIdEntry>(db, *iter);
+                        break;
+                    case undo_request_id_entry:
+                        revert_undo_record<TransactionIdType, RequestIdEntry>(db, *iter);
+                        break;
+                    case undo_contractin_trx_entry:
+                        revert_undo_record<TransactionIdType, ContractinTrxEntry>(db, *iter);
+                        break;
+                    case undo_contract_trx_entry:
+                        revert_undo_record<ContractIdType, ContractTrxEntry>(db, *iter);
+                        break;
+                    case undo_contract_storage_table_delta:
+                        revert_storage_table_delta(db, *iter);
+                        break;
+                    default:
+                        FC_ASSERT(false, "Unknown undo entry type ${t}", ("t", iter->entry_type));
+                    }
+                }
+            } FC_CAPTURE_AND_RETHROW((block_id))
+        }
+
+    }
+} // thinkyoung::blockchain
@@ -468,18 +468,11 @@ namespace thinkyoung {
                         addr = Address(PtsAddress(raw_addr));
                     }
                     
-                    auto transactions = _chain_db->fetch_address_transactions(addr);
-                    ilog("Found ${num} transactions for ${addr}", ("num", transactions.size())("addr", raw_addr));
-                    
-                    if (after_block > 0)
-                        transactions.erase(std::remove_if(transactions.begin(), transactions.end(),
-                        [after_block](const blockchain::TransactionEntry& t) -> bool {
-                        return t.chain_location.block_num <= after_block;
-                    }), transactions.end());
-                    ilog("Found ${num} transactions after block ${after_block}", ("num", transactions.size())("after_block", after_block));
+                    const auto transactions = _chain_db->fetch_address_transactions(addr, after_block > 0 ? after_block + 1 : 0);
+                    ilog("Found ${num} transactions for ${addr} after block ${after_block}", ("num", transactions.size())("addr", raw_addr)("after_block", after_block));
                     
                     for (const auto& trx : transactions) {
-                        fc::mutable_variant_object bundle("timestamp", _chain_db->get_block(trx.chain_location.block_num).timestamp);
+                        fc::mutable_variant_object bundle("timestamp", _chain_db->get_block_header(trx.chain_location.block_num).timestamp);
                         bundle["trx"] = trx;
                         results[string(trx.trx.id())] = bundle;
                     }
@@ -490,6 +483,28 @@ namespace thinkyoung {
                 FC_CAPTURE_AND_RETHROW((raw_addr)(after_block))
             }
             
+            vector<blockchain::TransactionEntry> detail::ClientImpl::blockchain_list_address_transactions_paged(const string& raw_addr,
+                    uint32_t since_block, uint32_t limit, bool reverse)const {
+                // set limit in  sandbox state
+                if (_chain_db->get_is_in_sandbox())
+                    FC_THROW_EXCEPTION(sandbox_command_forbidden, "in sandbox, this command is forbidden, you cannot call it!");
+                    
+                try {
+                    Address addr;
+                    
+                    try {
+                        addr = Address(raw_addr);
+                        
+                    } catch (...) {
+                        addr = Address(PtsAddress(raw_addr));
+                    }
+                    
+                    return _chain_db->fetch_address_transactions(addr, since_block, limit, reverse);
+                }
+                
+                FC_CAPTURE_AND_RETHROW((raw_addr)(since_block)(limit)(reverse))
+            }
+            
             unordered_map<BalanceIdType, BalanceEntry> detail::ClientImpl::blockchain_list_key_balances(const PublicKeyType& key)const {
                 // set limit in  sandbox state
                 if (_chain_db->get_is_in_sandbox())
@@ -979,6 +994,29 @@ namespace thinkyoung {
                 
                 return ops;
             }
+            vector<pair<uint32_t, uint32_t>> ClientImpl::blockchain_get_block_ranges_by_time(const vector<pair<fc::time_point, fc::time_point>>& time_ranges) const {
+                try {
+                    vector<pair<fc::time_point_sec, fc::time_point_sec>> ranges;
+                    ranges.reserve(time_ranges.size());
+                    
+                    for (const auto& range : time_ranges)
+                        ranges.emplace_back(fc::time_point_sec(range.first), fc::time_point_sec(range.second));
+                        
+                    return _chain_db->find_block_ranges(ranges);
+                }
+                
+                FC_CAPTURE_AND_RETHROW((time_ranges))
+            }
+            
+            vector<ContractEventEntry> ClientImpl::blockchain_list_contract_events(const string& contract, const string& event_type,
+                    uint32_t from_block, uint32_t to_block, uint32_t limit) const {
+                try {
+                    return _chain_db->fetch_contract_events(get_contract_address(contract), event_type, from_block, to_block, limit);
+                }
+                
+                FC_CAPTURE_AND_RETHROW((contract)(event_type)(from_block)(to_block)(limit))
+            }
+            
             thinkyoung::blockchain::TransactionIdType ClientImpl::blockchain_get_transaction_id(const thinkyoung::blockchain::SignedTransaction& transaction_to_broadcast) {
                 return transaction_to_broadcast.id();
             }
@@ -1273,7 +1273,7 @@ namespace thinkyoung {
                     // if it's <= non_fork_high_block_num, we grab it from the main blockchain;
                     // if it's not, we pull it from the fork history
                     if (low_block_num <= non_fork_high_block_num)
-                        synopsis.push_back(_chain_db->get_block(low_block_num).id());
+                        synopsis.push_back(_chain_db->get_block_id(low_block_num));
                         
                     else
                         synopsis.push_back(fork_history[low_block_num - non_fork_high_block_num - 1]);
@@ -1288,11 +1288,19 @@ namespace thinkyoung {
             //client supply item for on_fetch_items_message from other peer.  item could be block or trx
             thinkyoung::net::Message ClientImpl::get_item(const thinkyoung::net::ItemId& id) {
                 if (id.item_type == block_message_type) {
-                    //   uint32_t block_number = _chain_db->get_block_num(id.item_hash);
-                    thinkyoung::client::BlockMessage block_message_to_send(_chain_db->get_block(id.item_hash));
-                    FC_ASSERT(id.item_hash == block_message_to_send.block_id); //.id());
-                    //   block_message_to_send.signature = block_message_to_send.block.delegate_signature;
-                    return block_message_to_send;
+                    // A BlockMessage is the packed block followed by its id, so the stored bytes are sent as they are
+                    const RawBlockPtr raw_block = _chain_db->get_raw_block(id.item_hash);
+                    
+                    if (raw_block) {
+                        const std::vector<char> packed_id = fc::raw::pack(BlockIdType(id.item_hash));
+                        thinkyoung::net::Message block_message_to_send;
+                        block_message_to_send.msg_type = BlockMessage::type;
+                        block_message_to_send.data.reserve(raw_block->size() + packed_id.size());
+                        block_message_to_send.data.insert(block_message_to_send.data.end(), raw_block->begin(), raw_block->end());
+                        block_message_to_send.data.insert(block_message_to_send.data.end(), packed_id.begin(), packed_id.end());
+                        block_message_to_send.size = (uint32_t)block_message_to_send.data.size();
+                        return block_message_to_send;
+                    }
                 }
                 
                 if (id.item_type == trx_message_type) {
@@ -1491,6 +1499,7 @@ namespace thinkyoung {
                 try {
                     if (my->_config.statistics_enabled) ulog("Additional blockchain statistics enabled");
                     
+                    my->_chain_db->set_db_cache_sizes(my->_config.chain_db_cache_sizes);
                     my->_chain_db->open(data_dir / "chain", genesis_file_path, my->_config.statistics_enabled, replay_status_callback);
                     
                 } catch (const db::level_map_open_failure& e) {
@@ -1864,7 +1873,6 @@ namespace thinkyoung {
             }
             
             my->_chain_db->set_relay_fee(my->_config.min_relay_fee);
-            my->_chain_db->repair_database();
         } //configure_from_command_line
         
         fc::future<void> Client::start() {
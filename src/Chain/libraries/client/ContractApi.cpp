@@ -30,7 +30,7 @@ namespace thinkyoung {
                     
                 GluaStateValue statevalue;
                 statevalue.pointer_value = args_list->front();
-                lua::lib::set_lua_state_value(L, "evaluate_state", statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
+                lua::lib::set_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE, statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
             }
             
             int ClientImpl::save_code_to_file(const string& name, GluaModuleByteStream *stream, char* err_msg) const {
@@ -357,6 +357,12 @@ namespace thinkyoung {
                 event_op = _wallet->call_contract_local_emit(caller_name, contract_address, function_name, params);
                 return event_op;
             }
+            thinkyoung::lua::lib::GluaProfileReport ClientImpl::call_contract_profile(const std::string& contract, const std::string& caller_name, const std::string& function_name, const std::string& params) {
+                // runs on the sandbox state when the sandbox is open, like sandbox_call_contract_testing
+                Address contract_address;
+                contract_address = get_contract_address(contract);
+                return _wallet->call_contract_profile(caller_name, contract_address, function_name, params);
+            }
             std::string ClientImpl::call_contract_offline(const std::string& contract, const std::string& caller_name, const std::string& function_name, const std::string& params) {
                 // set limit in  sandbox state
                 if (_chain_db->get_is_in_sandbox())
@@ -1,6 +1,9 @@
+#include <blockchain/SignatureCache.hpp>
 #include <blockchain/Time.hpp>
 #include <client/Client.hpp>
 #include <client/ClientImpl.hpp>
+#include <glua/glua_state_pool.h>
+#include <glua/glua_contract_module_cache.h>
 
 namespace thinkyoung {
     namespace client {
@@ -72,6 +75,27 @@ namespace thinkyoung {
 
                 info["blockchain_random_seed"] = _chain_db->get_current_random_seed();
 
+                const auto& signature_cache = blockchain::SignatureCache::instance();
+                info["blockchain_signature_cache_size"] = signature_cache.size();
+                info["blockchain_signature_cache_hits"] = signature_cache.hits();
+                info["blockchain_signature_cache_misses"] = signature_cache.misses();
+                info["blockchain_contract_storage_cache_hits"] = blockchain::TransactionEvaluationState::total_storage_cache_hits();
+                info["blockchain_contract_storage_cache_misses"] = blockchain::TransactionEvaluationState::total_storage_cache_misses();
+
+                const auto& lua_state_pool = lua::lib::GluaStatePool::instance();
+                info["glua_state_pool_ready"] = lua_state_pool.ready_count();
+                info["glua_state_pool_hits"] = lua_state_pool.hits();
+                info["glua_state_pool_misses"] = lua_state_pool.misses();
+                info["glua_state_pool_resets"] = lua_state_pool.resets();
+                info["glua_state_pool_reset_time_us"] = lua_state_pool.reset_time_us();
+                info["glua_state_pool_closes"] = lua_state_pool.closes();
+                info["glua_state_pool_close_time_us"] = lua_state_pool.close_time_us();
+                info["glua_state_pool_prefill_time_us"] = lua_state_pool.prefill_time_us();
+                const auto& contract_module_cache = lua::lib::GluaContractModuleCache::instance();
+                info["glua_contract_module_cache_size"] = contract_module_cache.size();
+                info["glua_contract_module_cache_hits"] = contract_module_cache.hits();
+                info["glua_contract_module_cache_misses"] = contract_module_cache.misses();
+
                 /* Client */
                 info["client_data_dir"] = fc::absolute(_data_dir);
                 //info["client_httpd_port"]                                 = _config.is_valid() ? _config.httpd_endpoint.port() : 0;
@@ -0,0 +1,182 @@
+#include <db/Exception.hpp>
+#include <db/LevelDatabase.hpp>
+
+#include <leveldb/cache.h>
+
+#include <fc/log/logger.hpp>
+
+#include <clocale>
+#include <cstring>
+
+namespace thinkyoung {
+    namespace db {
+
+        namespace ldb = leveldb;
+
+        LevelDatabase::table_compare::table_compare()
+        {
+            _tables.fill(nullptr);
+        }
+
+        int LevelDatabase::table_compare::Compare(const ldb::Slice& a, const ldb::Slice& b)const
+        {
+            // a key without a table sorts first, tables sort by their byte
+            if (a.empty() || b.empty())
+                return int(!a.empty()) - int(!b.empty());
+
+            const uint8_t table_a = uint8_t(a[0]);
+            const uint8_t table_b = uint8_t(b[0]);
+            if (table_a != table_b)
+                return table_a < table_b ? -1 : 1;
+
+            // a seek to the start of a table has no key after the table byte
+            const ldb::Slice key_a(a.data() + 1, a.size() - 1);
+            const ldb::Slice key_b(b.data() + 1, b.size() - 1);
+            if (key_a.empty() || key_b.empty())
+                return int(!key_a.empty()) - int(!key_b.empty());
+
+            const ldb::Comparator* comparator = _tables[table_a];
+            return comparator != nullptr ? comparator->Compare(key_a, key_b) : key_a.compare(key_b);
+        }
+
+        LevelDatabase::LevelDatabase()
+        {
+            _writers.fill(nullptr);
+        }
+
+        LevelDatabase::~LevelDatabase()
+        {
+            try {
+                close();
+            } catch (const fc::exception& e) {
+                elog("unexpected exception closing database\n ${e}", ("e", e.to_detail_string()));
+            }
+        }
+
+        void LevelDatabase::add_table(const uint8_t table, const ldb::Comparator* comparator)
+        {
+            FC_ASSERT(!is_open(), "Tables are added before the database opens!");
+            FC_ASSERT(_comparer._tables[table] == nullptr || _comparer._tables[table] == comparator, "Table ${t} is already added!", ("t", table));
+            _comparer._tables[table] = comparator;
+        }
+
+        void LevelDatabase::attach(const uint8_t table, DeferredTable* writer)
+        {
+            FC_ASSERT(_comparer._tables[table] != nullptr, "Table ${t} was not added!", ("t", table));
+            _writers[table] = writer;
+        }
+
+        void LevelDatabase::detach(const uint8_t table)
+        {
+            _writers[table] = nullptr;
+        }
+
+        void LevelDatabase::open(const fc::path& dir, const size_t cache_size)
+        {
+            try {
+                FC_ASSERT(!is_open(), "Database is already open!");
+
+                ldb::Options opts;
+                opts.comparator = &_comparer;
+                opts.create_if_missing = true;
+                opts.max_open_files = 64;
+                opts.compression = leveldb::kNoCompression;
+
+                if (cache_size > 0)
+                {
+                    opts.write_buffer_size = cache_size / 4; // up to two write buffers may be held in memory simultaneously
+                    _cache.reset(leveldb::NewLRUCache(cache_size / 2));
+                    opts.block_cache = _cache.get();
+                }
+
+                if (ldb::kMajorVersion > 1 || (leveldb::kMajorVersion == 1 && leveldb::kMinorVersion >= 16))
+                {
+                    // LevelDB versions before 1.16 consider short writes to be corruption. Only trigger error
+                    // on corruption in later versions.
+                    opts.paranoid_checks = true;
+                }
+
+                // Given path must exist to succeed toNativeAnsiPath
+                fc::create_directories(dir);
+                std::string curLocale = setlocale(LC_ALL, NULL);
+                std::wstring ws = dir.wstring();
+                setlocale(LC_ALL, "chs");
+                std::vector<char> ldbPath(2 * ws.size() + 1, 0);
+                wcstombs(ldbPath.data(), ws.c_str(), ldbPath.size());
+                setlocale(LC_ALL, curLocale.c_str());
+
+                ldb::DB* ndb = nullptr;
+                const auto ntrxstat = ldb::DB::Open(opts, ldbPath.data(), &ndb);
+                if (!ntrxstat.ok())
+                {
+                    elog("Failure opening database: ${db}\nStatus: ${msg}", ("db", dir)("msg", ntrxstat.ToString()));
+                    FC_THROW_EXCEPTION(level_map_open_failure, "Failure opening database: ${db}\nStatus: ${msg}",
+                        ("db", dir)("msg", ntrxstat.ToString()));
+                }
+                _db.reset(ndb);
+            } FC_CAPTURE_AND_RETHROW((dir)(cache_size))
+        }
+
+        void LevelDatabase::close()
+        {
+            if (is_open() && _deferring) commit_deferred_writes();
+            _deferring = false;
+            _db.reset();
+            _cache.reset();
+        }
+
+        bool LevelDatabase::is_open()const
+        {
+            return !!_db;
+        }
+
+        ldb::DB* LevelDatabase::get()const
+        {
+            return _db.get();
+        }
+
+        void LevelDatabase::defer_writes()
+        {
+            FC_ASSERT(is_open(), "Database is not open!");
+            _deferring = true;
+        }
+
+        bool LevelDatabase::deferring()const
+        {
+            return _deferring;
+        }
+
+        void LevelDatabase::commit_deferred_writes()
+        {
+            try {
+                // a block that fails before its writes are deferred still commits them
+                if (!_deferring)
+                    return;
+
+                FC_ASSERT(is_open(), "Database is not open!");
+
+                ldb::WriteBatch batch;
+                for (const DeferredTable* writer : _writers)
+                {
+                    if (writer != nullptr)
+                        writer->append_deferred_writes(batch);
+                }
+
+                auto status = _db->Write(_write_options, &batch);
+                if (!status.ok())
+                {
+                    FC_THROW_EXCEPTION(level_map_failure, "database error while applying deferred writes: ${msg}", ("msg", status.ToString()));
+                }
+
+                // cleared only once written, a reader that misses the held writes finds them in leveldb
+                for (DeferredTable* writer : _writers)
+                {
+                    if (writer != nullptr)
+                        writer->clear_deferred_writes();
+                }
+                _deferring = false;
+            } FC_RETHROW_EXCEPTIONS(warn, "error committing deferred writes")
+        }
+
+    }
+} // thinkyoung::db
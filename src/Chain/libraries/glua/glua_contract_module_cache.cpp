@@ -0,0 +1,118 @@
+﻿#include <glua/glua_contract_module_cache.h>
+
+namespace thinkyoung
+{
+    namespace lua
+    {
+        namespace lib
+        {
+            GluaContractModuleCache &GluaContractModuleCache::instance()
+            {
+                static GluaContractModuleCache cache;
+                return cache;
+            }
+            
+            GluaContractModuleCache::GluaContractModuleCache(size_t max_size)
+                : _max_size(max_size) {}
+                
+            std::shared_ptr<GluaModuleByteStream> GluaContractModuleCache::get(const std::string &contract_id, const std::string &code_hash)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _by_contract_id.find(contract_id);
+                
+                if (it == _by_contract_id.end() || it->second->code_hash != code_hash) {
+                    ++_misses;
+                    return nullptr;
+                }
+                
+                _entries.splice(_entries.begin(), _entries, it->second);
+                ++_hits;
+                return it->second->stream;
+            }
+            
+            void GluaContractModuleCache::put(const std::string &contract_id, const std::string &code_hash,
+                                              const std::shared_ptr<GluaModuleByteStream> &stream)
+            {
+                if (!stream || 0 == _max_size)
+                    return;
+                    
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _by_contract_id.find(contract_id);
+                
+                if (it != _by_contract_id.end())
+                    erase(it->second);
+                    
+                Entry entry;
+                entry.contract_id = contract_id;
+                entry.code_hash = code_hash;
+                entry.stream = stream;
+                _entries.push_front(std::move(entry));
+                _by_contract_id[contract_id] = _entries.begin();
+                _by_stream[stream.get()] = _entries.begin();
+                
+                while (_entries.size() > _max_size)
+                    erase(std::prev(_entries.end()));
+            }
+            
+            bool GluaContractModuleCache::is_proto_checked(const GluaModuleByteStream *stream) const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _by_stream.find(stream);
+                return it != _by_stream.end() && it->second->proto_checked;
+            }
+            
+            void GluaContractModuleCache::set_proto_checked(const GluaModuleByteStream *stream)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _by_stream.find(stream);
+                
+                // a stream evicted meanwhile is not marked, its address may be reused
+                if (it != _by_stream.end())
+                    it->second->proto_checked = true;
+            }
+            
+            void GluaContractModuleCache::invalidate(const std::string &contract_id)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _by_contract_id.find(contract_id);
+                
+                if (it != _by_contract_id.end())
+                    erase(it->second);
+            }
+            
+            void GluaContractModuleCache::clear()
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _by_stream.clear();
+                _by_contract_id.clear();
+                _entries.clear();
+            }
+            
+            uint64_t GluaContractModuleCache::hits() const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _hits;
+            }
+            
+            uint64_t GluaContractModuleCache::misses() const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _misses;
+            }
+            
+            size_t GluaContractModuleCache::size() const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _entries.size();
+            }
+            
+            void GluaContractModuleCache::erase(EntryIter it)
+            {
+                _by_stream.erase(it->stream.get());
+                _by_contract_id.erase(it->contract_id);
+                _entries.erase(it);
+            }
+            
+        }
+    }
+}
@@ -0,0 +1,122 @@
+﻿#include <glua/glua_contract_profiler.h>
+#include <glua/lobject.h>
+#include <glua/lopcodes.h>
+#include <glua/lstate.h>
+
+namespace thinkyoung
+{
+    namespace lua
+    {
+        namespace lib
+        {
+            static uint64_t elapsed_ns(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+            {
+                return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+            }
+            
+            static std::string function_name_of(const Proto *proto)
+            {
+                std::string source((nullptr == proto->source) ? "(*no name)" : getstr(proto->source));
+                return source + ":" + std::to_string(proto->linedefined);
+            }
+            
+            GluaContractProfiler::GluaContractProfiler()
+                : _opcodes(NUM_OPCODES)
+            {
+            }
+            
+            GluaContractProfiler *GluaContractProfiler::of(lua_State *L)
+            {
+                return (nullptr == L) ? nullptr : L->profiler;
+            }
+            
+            void GluaContractProfiler::on_instruction(const Proto *proto, int opcode)
+            {
+                auto now = Clock::now();
+                charge_last_instruction(now);
+                
+                if (proto != _last_proto) {
+                    auto found = _function_index.find(proto);
+                    
+                    if (found == _function_index.end()) {
+                        found = _function_index.emplace(proto, _functions.size()).first;
+                        _functions.emplace_back(function_name_of(proto), GluaProfileCounter());
+                    }
+                    
+                    _last_proto = proto;
+                    _last_function = found->second;
+                }
+                
+                _last_opcode = opcode;
+                _last_time = now;
+            }
+            
+            void GluaContractProfiler::stop()
+            {
+                charge_last_instruction(Clock::now());
+            }
+            
+            void GluaContractProfiler::charge_last_instruction(Clock::time_point now)
+            {
+                if (_last_opcode < 0 || _last_opcode >= NUM_OPCODES)
+                    return;
+                    
+                auto ns = elapsed_ns(_last_time, now);
+                auto &op = _opcodes[_last_opcode];
+                ++op.count;
+                op.total_ns += ns;
+                auto &func = _functions[_last_function].second;
+                ++func.count;
+                func.total_ns += ns;
+                _last_opcode = -1;
+            }
+            
+            void GluaContractProfiler::add_api_call(const char *api_name, uint64_t ns)
+            {
+                auto &api = _apis[api_name];
+                ++api.count;
+                api.total_ns += ns;
+            }
+            
+            GluaProfileReport GluaContractProfiler::report() const
+            {
+                GluaProfileReport result;
+                
+                for (int i = 0; i < NUM_OPCODES; ++i) {
+                    const auto &op = _opcodes[i];
+                    
+                    if (op.count < 1)
+                        continue;
+                        
+                    result.opcodes[luaP_opnames[i]] = op;
+                    result.instructions += op.count;
+                    result.total_ns += op.total_ns;
+                }
+                
+                for (const auto &func : _functions) {
+                    // protos of one name may be loaded more than once
+                    auto &item = result.functions[func.first];
+                    item.count += func.second.count;
+                    item.total_ns += func.second.total_ns;
+                }
+                
+                result.apis = _apis;
+                return result;
+            }
+            
+            GluaProfilerApiScope::GluaProfilerApiScope(lua_State *L, const char *api_name)
+                : _profiler(GluaContractProfiler::of(L)), _api_name(api_name)
+            {
+                if (nullptr != _profiler)
+                    _start = std::chrono::steady_clock::now();
+            }
+            
+            GluaProfilerApiScope::~GluaProfilerApiScope()
+            {
+                if (nullptr != _profiler)
+                    _profiler->add_api_call(_api_name, elapsed_ns(_start, std::chrono::steady_clock::now()));
+            }
+            
+        }
+    }
+}
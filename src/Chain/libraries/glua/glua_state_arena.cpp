@@ -0,0 +1,200 @@
+#include <glua/glua_state_arena.h>
+#include <glua/lua.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace thinkyoung
+{
+    namespace lua
+    {
+        namespace lib
+        {
+            static size_t size_class_of(size_t size)
+            {
+                return (size + 15) / 16 - 1;
+            }
+            
+            GluaStateArena::GluaStateArena(size_t memory_limit)
+                : _memory_limit(memory_limit)
+            {
+                memset(_free_blocks, 0x0, sizeof(_free_blocks));
+            }
+            
+            GluaStateArena::~GluaStateArena()
+            {
+                for (auto chunk : _chunks)
+                    free(chunk);
+                    
+                while (nullptr != _large_blocks) {
+                    LargeBlock *next = _large_blocks->next;
+                    free(_large_blocks);
+                    _large_blocks = next;
+                }
+            }
+            
+            void *GluaStateArena::alloc(void *ud, void *ptr, size_t osize, size_t nsize)
+            {
+                auto arena = (GluaStateArena*)ud;
+                size_t old_size = nullptr != ptr ? osize : 0;
+                
+                if (0 == nsize) {
+                    arena->deallocate(ptr, old_size);
+                    arena->_used_bytes -= old_size;
+                    return nullptr;
+                }
+                
+                if (nsize > old_size && nsize - old_size > arena->_memory_limit - arena->_used_bytes) {
+                    arena->_over_limit = true;
+                    return nullptr;
+                }
+                
+                arena->_over_limit = false;
+                
+                // blocks of the same size class are used in place
+                if (nullptr != ptr && old_size <= GLUA_STATE_ARENA_MAX_SMALL_BLOCK && nsize <= GLUA_STATE_ARENA_MAX_SMALL_BLOCK
+                        && size_class_of(old_size) == size_class_of(nsize)) {
+                    arena->_used_bytes = arena->_used_bytes - old_size + nsize;
+                } else {
+                    void *block = arena->allocate(nsize);
+                    
+                    if (nullptr == block)
+                        return nullptr;
+                        
+                    if (nullptr != ptr) {
+                        memcpy(block, ptr, old_size < nsize ? old_size : nsize);
+                        arena->deallocate(ptr, old_size);
+                    }
+                    
+                    arena->_used_bytes = arena->_used_bytes - old_size + nsize;
+                    ptr = block;
+                }
+                
+                if (arena->_used_bytes > arena->_peak_bytes)
+                    arena->_peak_bytes = arena->_used_bytes;
+                    
+                return ptr;
+            }
+            
+            GluaStateArena *GluaStateArena::of(lua_State *L)
+            {
+                if (nullptr == L)
+                    return nullptr;
+                    
+                void *ud = nullptr;
+                
+                if (lua_getallocf(L, &ud) != &GluaStateArena::alloc)
+                    return nullptr;
+                    
+                return (GluaStateArena*)ud;
+            }
+            
+            void GluaStateArena::set_memory_limit(size_t memory_limit)
+            {
+                _memory_limit = memory_limit < _used_bytes ? _used_bytes : memory_limit;
+            }
+            
+            size_t GluaStateArena::memory_limit() const
+            {
+                return _memory_limit;
+            }
+            
+            size_t GluaStateArena::used_bytes() const
+            {
+                return _used_bytes;
+            }
+            
+            size_t GluaStateArena::peak_bytes() const
+            {
+                return _peak_bytes;
+            }
+            
+            void GluaStateArena::reset_peak()
+            {
+                _peak_bytes = _used_bytes;
+            }
+            
+            bool GluaStateArena::over_limit() const
+            {
+                return _over_limit;
+            }
+            
+            void GluaStateArena::begin_release()
+            {
+                _releasing = true;
+            }
+            
+            void *GluaStateArena::allocate(size_t size)
+            {
+                if (size > GLUA_STATE_ARENA_MAX_SMALL_BLOCK) {
+                    auto block = (LargeBlock*)malloc(sizeof(LargeBlock) + size);
+                    
+                    if (nullptr == block)
+                        return nullptr;
+                        
+                    block->prev = nullptr;
+                    block->next = _large_blocks;
+                    block->size = size;
+                    
+                    if (nullptr != _large_blocks)
+                        _large_blocks->prev = block;
+                        
+                    _large_blocks = block;
+                    return block + 1;
+                }
+                
+                size_t size_class = size_class_of(size);
+                void *block = _free_blocks[size_class];
+                
+                if (nullptr != block) {
+                    _free_blocks[size_class] = *(void**)block;
+                    return block;
+                }
+                
+                size_t block_size = (size_class + 1) * 16;
+                
+                if (nullptr == _chunk_pos || (size_t)(_chunk_end - _chunk_pos) < block_size) {
+                    auto chunk = (char*)malloc(GLUA_STATE_ARENA_CHUNK_SIZE);
+                    
+                    if (nullptr == chunk)
+                        return nullptr;
+                        
+                    _chunks.push_back(chunk);
+                    _chunk_pos = chunk;
+                    _chunk_end = chunk + GLUA_STATE_ARENA_CHUNK_SIZE;
+                }
+                
+                block = _chunk_pos;
+                _chunk_pos += block_size;
+                return block;
+            }
+            
+            void GluaStateArena::deallocate(void *ptr, size_t size)
+            {
+                // everything goes back to the system with the arena
+                if (nullptr == ptr || _releasing)
+                    return;
+                    
+                if (size > GLUA_STATE_ARENA_MAX_SMALL_BLOCK) {
+                    auto block = (LargeBlock*)ptr - 1;
+                    
+                    if (nullptr != block->prev)
+                        block->prev->next = block->next;
+                    else
+                        _large_blocks = block->next;
+                        
+                    if (nullptr != block->next)
+                        block->next->prev = block->prev;
+                        
+                    free(block);
+                    return;
+                }
+                
+                size_t size_class = size_class_of(size);
+                *(void**)ptr = _free_blocks[size_class];
+                _free_blocks[size_class] = ptr;
+            }
+            
+        }
+    }
+}
@@ -0,0 +1,510 @@
+#include <glua/glua_state_pool.h>
+#include <glua/glua_state_arena.h>
+#include <glua/thinkyoung_lua_lib.h>
+#include <glua/lapi.h>
+#include <glua/ldo.h>
+#include <glua/lfunc.h>
+#include <glua/lgc.h>
+#include <glua/lstate.h>
+#include <glua/lstring.h>
+#include <glua/ltable.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+namespace thinkyoung
+{
+    namespace lua
+    {
+        namespace lib
+        {
+            static uint64_t elapsed_us(const std::chrono::steady_clock::time_point &start)
+            {
+                return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            }
+            
+            // registry key of the table anchoring the objects of a baseline
+            static const char baseline_anchors_key = 0;
+            
+            static void push_value(lua_State *L, const TValue *value)
+            {
+                setobj2s(L, L->top, value);
+                api_incr_top(L);
+            }
+            
+            void GluaStateBaseline::take(lua_State *L, bool use_contract)
+            {
+                auto baseline = new GluaStateBaseline();
+                baseline->_use_contract = use_contract;
+                baseline->record(L);
+                delete L->baseline;
+                L->baseline = baseline;
+            }
+            
+            bool GluaStateBaseline::use_contract() const
+            {
+                return _use_contract;
+            }
+            
+            void GluaStateBaseline::anchor(lua_State *L, const TValue *value)
+            {
+                TValue *slot = luaH_set(L, _anchors, value);
+                setbvalue(slot, 1);
+                luaC_barrierback(L, _anchors, value);
+            }
+            
+            void GluaStateBaseline::visit(lua_State *L, const TValue *value, std::unordered_set<GCObject*> &visited, std::vector<GCObject*> &pending)
+            {
+                if (!iscollectable(value) || !visited.insert(gcvalue(value)).second)
+                    return;
+                    
+                anchor(L, value);
+                
+                if (ttistable(value) || ttisLclosure(value) || ttisCclosure(value) || ttisfulluserdata(value))
+                    pending.push_back(gcvalue(value));
+            }
+            
+            void GluaStateBaseline::record(lua_State *L)
+            {
+                lua_createtable(L, 0, 0);
+                _anchors = hvalue(L->top - 1);
+                // tables without a hash part share one static node
+                _dummy_node = _anchors->node;
+                lua_rawsetp(L, LUA_REGISTRYINDEX, &baseline_anchors_key);
+                std::unordered_set<GCObject*> visited;
+                std::vector<GCObject*> pending;
+                visited.insert(obj2gco(_anchors));
+                visit(L, &G(L)->l_registry, visited, pending);
+                
+                for (int i = 0; i < LUA_NUMTAGS; ++i) {
+                    _type_metatables[i] = G(L)->mt[i];
+                    
+                    if (nullptr != _type_metatables[i]) {
+                        TValue metatable;
+                        sethvalue(L, &metatable, _type_metatables[i]);
+                        visit(L, &metatable, visited, pending);
+                    }
+                }
+                
+                while (!pending.empty()) {
+                    GCObject *o = pending.back();
+                    pending.pop_back();
+                    
+                    if (o->tt == LUA_TTABLE) {
+                        Table *t = gco2t(o);
+                        TableRecord table_record;
+                        table_record.table = t;
+                        table_record.metatable = t->metatable;
+                        table_record.sizearray = t->sizearray;
+                        table_record.sizenode = _dummy_node == t->node ? 0 : (unsigned int)sizenode(t);
+                        
+                        if (nullptr != t->metatable) {
+                            TValue metatable;
+                            sethvalue(L, &metatable, t->metatable);
+                            visit(L, &metatable, visited, pending);
+                        }
+                        
+                        for (unsigned int i = 0; i < t->sizearray; ++i) {
+                            if (ttisnil(&t->array[i]))
+                                continue;
+                                
+                            TValue key;
+                            setivalue(&key, (lua_Integer)i + 1);
+                            table_record.entries.push_back(std::make_pair(key, t->array[i]));
+                            visit(L, &t->array[i], visited, pending);
+                        }
+                        
+                        for (unsigned int i = 0; i < table_record.sizenode; ++i) {
+                            Node *n = gnode(t, i);
+                            
+                            if (ttisnil(gval(n)))
+                                continue;
+                                
+                            table_record.entries.push_back(std::make_pair(*gkey(n), *gval(n)));
+                            visit(L, gkey(n), visited, pending);
+                            visit(L, gval(n), visited, pending);
+                        }
+                        
+                        _tables.push_back(std::move(table_record));
+                    }
+                    else if (o->tt == LUA_TLCL || o->tt == LUA_TCCL) {
+                        UpvalueRecord upvalue_record;
+                        int nupvalues = 0;
+                        
+                        if (o->tt == LUA_TLCL) {
+                            setclLvalue(L, &upvalue_record.closure, gco2lcl(o));
+                            nupvalues = gco2lcl(o)->nupvalues;
+                        }
+                        else {
+                            setclCvalue(L, &upvalue_record.closure, gco2ccl(o));
+                            nupvalues = gco2ccl(o)->nupvalues;
+                        }
+                        
+                        for (int i = 0; i < nupvalues; ++i) {
+                            upvalue_record.index = i + 1;
+                            upvalue_record.value = o->tt == LUA_TLCL ? *gco2lcl(o)->upvals[i]->v : gco2ccl(o)->upvalue[i];
+                            visit(L, &upvalue_record.value, visited, pending);
+                            _upvalues.push_back(upvalue_record);
+                        }
+                    }
+                    else {
+                        Udata *u = gco2u(o);
+                        UserdataRecord udata_record;
+                        setuvalue(L, &udata_record.udata, u);
+                        udata_record.metatable = u->metatable;
+                        
+                        if (nullptr != u->metatable) {
+                            TValue metatable;
+                            sethvalue(L, &metatable, u->metatable);
+                            visit(L, &metatable, visited, pending);
+                        }
+                        
+                        _udatas.push_back(udata_record);
+                    }
+                }
+                
+                luaE_freeCI(L);
+                lua_gc(L, LUA_GCRESTART, 0);
+                lua_gc(L, LUA_GCCOLLECT, 0);
+                _stacksize = L->stacksize;
+                _strt_size = G(L)->strt.size;
+                _gcpause = G(L)->gcpause;
+                _gcstepmul = G(L)->gcstepmul;
+                _finalizers = count_finalizers(L);
+                _total_bytes = (size_t)gettotalbytes(G(L));
+                auto arena = GluaStateArena::of(L);
+                
+                if (nullptr != arena)
+                    arena->reset_peak();
+            }
+            
+            size_t GluaStateBaseline::count_finalizers(lua_State *L) const
+            {
+                size_t count = 0;
+                
+                for (GCObject *o = G(L)->finobj; nullptr != o; o = o->next)
+                    ++count;
+                    
+                for (GCObject *o = G(L)->tobefnz; nullptr != o; o = o->next)
+                    ++count;
+                    
+                return count;
+            }
+            
+            bool GluaStateBaseline::restore(lua_State *L)
+            {
+                // only a state back at its base level can be reset, one left inside a call is closed
+                if (L->status != LUA_OK || L->ci != &L->base_ci || L->nCcalls != 0 || nullptr != L->profiler
+                        || L->bytecode_debugger_opened || L->debugger_pausing)
+                    return false;
+                    
+                auto arena = GluaStateArena::of(L);
+                
+                if (nullptr != arena && arena->over_limit())
+                    return false;
+                    
+                // finalizers of objects the contract created would run contract code during the reset
+                if (count_finalizers(L) != _finalizers)
+                    return false;
+                    
+                lua_settop(L, 0);
+                luaF_close(L, L->stack);
+                lua_sethook(L, nullptr, 0, 0);
+                L->errfunc = 0;
+                memset(L->compile_error, 0x0, LUA_COMPILE_ERROR_MAX_LENGTH);
+                memset(L->runerror, 0x0, LUA_VM_EXCEPTION_STRNG_MAX_LENGTH);
+                L->in = stdin;
+                L->out = stdout;
+                L->err = stderr;
+                L->force_stopping = false;
+                L->exit_code = 0;
+                L->preprocessor = nullptr;
+                G(L)->chain_api_error = 0;
+                lua_malloc_reset(L);
+                
+                if (nullptr != arena)
+                    arena->set_memory_limit(GLUA_STATE_UNLIMITED_MEMORY);
+                    
+                for (int i = 0; i < LUA_NUMTAGS; ++i)
+                    G(L)->mt[i] = _type_metatables[i];
+                    
+                for (const auto &table_record : _tables) {
+                    Table *t = table_record.table;
+                    
+                    for (unsigned int i = 0; i < t->sizearray; ++i)
+                        setnilvalue(&t->array[i]);
+                        
+                    if (_dummy_node != t->node) {
+                        for (int i = 0; i < sizenode(t); ++i)
+                            setnilvalue(gval(gnode(t, i)));
+                    }
+                    
+                    // emptied, so the resize only allocates the parts, and the entries fit without a rehash
+                    luaH_resize(L, t, table_record.sizearray, table_record.sizenode);
+                    
+                    for (const auto &entry : table_record.entries) {
+                        TValue *slot = luaH_set(L, t, &entry.first);
+                        setobj2t(L, slot, &entry.second);
+                    }
+                    
+                    t->metatable = table_record.metatable;
+                    invalidateTMcache(t);
+                    
+                    if (isblack(t))
+                        luaC_barrierback_(L, t);
+                }
+                
+                for (const auto &upvalue_record : _upvalues) {
+                    push_value(L, &upvalue_record.closure);
+                    push_value(L, &upvalue_record.value);
+                    lua_setupvalue(L, -2, upvalue_record.index);
+                    lua_pop(L, 1);
+                }
+                
+                for (const auto &udata_record : _udatas) {
+                    push_value(L, &udata_record.udata);
+                    
+                    if (nullptr != udata_record.metatable) {
+                        sethvalue2s(L, L->top, udata_record.metatable);
+                    }
+                    else {
+                        setnilvalue(L->top);
+                    }
+                    
+                    api_incr_top(L);
+                    lua_setmetatable(L, -2);
+                    lua_pop(L, 1);
+                }
+                
+                G(L)->gcpause = _gcpause;
+                G(L)->gcstepmul = _gcstepmul;
+                luaE_freeCI(L);
+                lua_gc(L, LUA_GCRESTART, 0);
+                lua_gc(L, LUA_GCCOLLECT, 0);
+                
+                if (L->stacksize != _stacksize)
+                    luaD_reallocstack(L, _stacksize);
+                    
+                if (G(L)->strt.size != _strt_size)
+                    luaS_resize(L, _strt_size);
+                    
+                if (nullptr != arena)
+                    arena->reset_peak();
+                    
+                // anything the contract left reachable shows up as memory the baseline did not have
+                return (size_t)gettotalbytes(G(L)) == _total_bytes;
+            }
+            
+            GluaStatePool &GluaStatePool::instance()
+            {
+                static GluaStatePool pool;
+                return pool;
+            }
+            
+            GluaStatePool::GluaStatePool(size_t states_per_thread, size_t malloc_buffers)
+                : _states_per_thread(states_per_thread), _max_malloc_buffers(malloc_buffers) {}
+                
+            GluaStatePool::~GluaStatePool()
+            {
+                // ready states are left to the process exit, their threads may be gone already
+                for (auto buffer : _malloc_buffers)
+                    free(buffer);
+            }
+            
+            lua_State *GluaStatePool::acquire(bool use_contract)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    auto it = _ready.find(std::this_thread::get_id());
+                    
+                    if (it != _ready.end()) {
+                        auto &states = use_contract ? it->second.contract_states : it->second.plain_states;
+                        
+                        if (!states.empty()) {
+                            lua_State *L = states.front();
+                            states.pop_front();
+                            ++_hits;
+                            return L;
+                        }
+                    }
+                    
+                    ++_misses;
+                }
+                return create_state(use_contract);
+            }
+            
+            lua_State *GluaStatePool::create_state(bool use_contract)
+            {
+                lua_State *L = create_lua_state(use_contract);
+                GluaStateBaseline::take(L, use_contract);
+                return L;
+            }
+            
+            void GluaStatePool::release(lua_State *L)
+            {
+                if (nullptr == L)
+                    return;
+                    
+                auto start = std::chrono::steady_clock::now();
+                bool use_contract = nullptr == L->baseline || L->baseline->use_contract();
+                bool wanted = false;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    auto &thread_states = _ready[std::this_thread::get_id()];
+                    wanted = (use_contract ? thread_states.contract_states : thread_states.plain_states).size() < _states_per_thread;
+                }
+                release_lua_state_values(L);
+                
+                if (wanted && nullptr != L->baseline && L->baseline->restore(L)) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    auto &thread_states = _ready[std::this_thread::get_id()];
+                    (use_contract ? thread_states.contract_states : thread_states.plain_states).push_front(L);
+                    ++_resets;
+                    _reset_time_us += elapsed_us(start);
+                    return;
+                }
+                
+                lua_close(L);
+                std::lock_guard<std::mutex> lock(_mutex);
+                ++_closes;
+                _close_time_us += elapsed_us(start);
+            }
+            
+            void GluaStatePool::prefill(bool use_contract)
+            {
+                auto start = std::chrono::steady_clock::now();
+                size_t missing = 0;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    auto &thread_states = _ready[std::this_thread::get_id()];
+                    auto &states = use_contract ? thread_states.contract_states : thread_states.plain_states;
+                    missing = states.size() < _states_per_thread ? _states_per_thread - states.size() : 0;
+                }
+                
+                if (missing == 0)
+                    return;
+                    
+                std::vector<lua_State*> created;
+                
+                for (size_t i = 0; i < missing; ++i)
+                    created.push_back(create_state(use_contract));
+                    
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto &thread_states = _ready[std::this_thread::get_id()];
+                auto &states = use_contract ? thread_states.contract_states : thread_states.plain_states;
+                states.insert(states.end(), created.begin(), created.end());
+                _prefill_time_us += elapsed_us(start);
+            }
+            
+            void GluaStatePool::clear()
+            {
+                ThreadStates states;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    auto it = _ready.find(std::this_thread::get_id());
+                    
+                    if (it == _ready.end())
+                        return;
+                        
+                    states = std::move(it->second);
+                    _ready.erase(it);
+                }
+                
+                for (auto L : states.contract_states)
+                    close_lua_state(L);
+                    
+                for (auto L : states.plain_states)
+                    close_lua_state(L);
+            }
+            
+            void *GluaStatePool::acquire_malloc_buffer()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    
+                    if (!_malloc_buffers.empty()) {
+                        void *buffer = _malloc_buffers.back();
+                        _malloc_buffers.pop_back();
+                        return buffer;
+                    }
+                }
+                return malloc(LUA_MALLOC_TOTAL_SIZE);
+            }
+            
+            void GluaStatePool::release_malloc_buffer(void *buffer, size_t used_size)
+            {
+                if (nullptr == buffer)
+                    return;
+                    
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    
+                    if (_malloc_buffers.size() >= _max_malloc_buffers) {
+                        free(buffer);
+                        return;
+                    }
+                }
+                
+                // a fresh buffer reads as zeros, keep it that way so states do not see what the last one left
+                memset(buffer, 0, used_size < LUA_MALLOC_TOTAL_SIZE ? used_size : LUA_MALLOC_TOTAL_SIZE);
+                std::lock_guard<std::mutex> lock(_mutex);
+                _malloc_buffers.push_back(buffer);
+            }
+            
+            uint64_t GluaStatePool::hits() const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _hits;
+            }
+            
+            uint64_t GluaStatePool::misses() const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _misses;
+            }
+            
+            uint64_t GluaStatePool::resets() const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _resets;
+            }
+            
+            uint64_t GluaStatePool::reset_time_us() const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _reset_time_us;
+            }
+            
+            uint64_t GluaStatePool::closes() const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _closes;
+            }
+            
+            uint64_t GluaStatePool::close_time_us() const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _close_time_us;
+            }
+            
+            uint64_t GluaStatePool::prefill_time_us() const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                return _prefill_time_us;
+            }
+            
+            size_t GluaStatePool::ready_count() const
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                size_t count = 0;
+                
+                for (const auto &item : _ready)
+                    count += item.second.contract_states.size() + item.second.plain_states.size();
+                    
+                return count;
+            }
+            
+        }
+    }
+}
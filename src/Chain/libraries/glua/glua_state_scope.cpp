@@ -14,6 +14,8 @@
 
 #include <glua/thinkyoung_lua_api.h>
 #include <glua/thinkyoung_lua_lib.h>
+#include <glua/glua_state_pool.h>
+#include <glua/glua_contract_profiler.h>
 
 #include <glua/glua_lutil.h>
 #include <glua/lobject.h>
@@ -39,12 +41,17 @@ namespace thinkyoung
         {
             GluaStateScope::GluaStateScope(bool use_contract)
                 :_use_contract(use_contract) {
-                this->_L = create_lua_state(use_contract);
+                this->_L = GluaStatePool::instance().acquire(use_contract);
             }
             GluaStateScope::GluaStateScope(const GluaStateScope &other) : _L(other._L) {}
             GluaStateScope::~GluaStateScope() {
-                if (nullptr != _L)
-                    close_lua_state(_L);
+                if (nullptr == _L)
+                    return;
+                    
+                // pooled states are handed out again, never with a profiler attached
+                delete _L->profiler;
+                _L->profiler = nullptr;
+                GluaStatePool::instance().release(_L);
             }
 
             void GluaStateScope::change_in_file(FILE *in)
@@ -111,6 +118,35 @@ namespace thinkyoung
             {
                 return get_lua_state_instructions_executed_count(_L);
             }
+            void GluaStateScope::set_memory_limit(size_t limit)
+            {
+                set_lua_state_memory_limit(_L, limit);
+            }
+            size_t GluaStateScope::get_memory_limit()
+            {
+                return get_lua_state_memory_limit(_L);
+            }
+            size_t GluaStateScope::get_memory_peak()
+            {
+                return get_lua_state_memory_peak(_L);
+            }
+            void GluaStateScope::enable_profiler()
+            {
+                if (nullptr == _L->profiler)
+                    _L->profiler = new GluaContractProfiler();
+            }
+            bool GluaStateScope::profiler_enabled() const
+            {
+                return nullptr != _L->profiler;
+            }
+            GluaProfileReport GluaStateScope::get_profile_report()
+            {
+                if (nullptr == _L->profiler)
+                    return GluaProfileReport();
+                    
+                _L->profiler->stop();
+                return _L->profiler->report();
+            }
             int GluaStateScope::check_thinkyoung_contract_api_instructions_over_limit()
             {
                 return global_glua_chain_api->check_contract_api_instructions_over_limit(_L);
@@ -37,6 +37,7 @@
 #include <glua/thinkyoung_lua_api.h>
 #include <glua/thinkyoung_lua_lib.h>
 #include <glua/glua_lutil.h>
+#include <glua/glua_state_arena.h>
 #include <glua/exceptions.h>
 
 using thinkyoung::lua::api::global_glua_chain_api;
@@ -1160,7 +1161,7 @@ static bool contract_table_traverser_to_wrap_api(lua_State *L, void *ud)
 
 static bool lua_get_contract_apis_direct(lua_State *L, GluaModuleByteStream *stream, char *error)
 {
-    int *stopped_pointer = thinkyoung::lua::lib::get_lua_state_value(L, LUA_STATE_STOP_TO_RUN_IN_LVM_STATE_MAP_KEY).int_pointer_value;
+    int *stopped_pointer = thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_STOP_IN_LVM).int_pointer_value;
     if (nullptr != stopped_pointer && (*stopped_pointer) > 0)
         return false;
     intptr_t stream_p = (intptr_t)stream;
@@ -2077,11 +2078,12 @@ LUA_API int lua_execute_contract_api(lua_State *L, const char *contract_name,
 	{
 		GluaStateValue value;
 		value.string_value = contract_address;
-		thinkyoung::lua::lib::set_lua_state_value(L, STARTING_CONTRACT_ADDRESS, value, LUA_STATE_VALUE_STRING);
+		thinkyoung::lua::lib::set_lua_state_value(L, GLUA_STATE_SLOT_STARTING_CONTRACT_ADDRESS, value, LUA_STATE_VALUE_STRING);
 	}
 
 	lua_createtable(L, 0, 0);
 	lua_setglobal(L, "last_return");
+    thinkyoung::lua::lib::reset_lua_state_memory_peak(L);
     
     /*
     lua_pushcfunction(L, lua_real_execute_contract_api);
@@ -3032,6 +3034,15 @@ LUALIB_API lua_State *luaL_newstate(void) {
 }
 
 
+LUALIB_API lua_State *luaL_newstate_with_arena(size_t memory_limit) {
+    auto arena = new thinkyoung::lua::lib::GluaStateArena(memory_limit);
+    lua_State *L = lua_newstate(&thinkyoung::lua::lib::GluaStateArena::alloc, arena);
+    if (L) lua_atpanic(L, &panic);
+    else delete arena;
+    return L;
+}
+
+
 LUALIB_API void luaL_checkversion_(lua_State *L, lua_Number ver, size_t sz) {
     const lua_Number *v = lua_version(L);
     if (sz != LUAL_NUMSIZES)  /* check numeric types */
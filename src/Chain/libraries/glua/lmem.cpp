@@ -20,6 +20,10 @@
 #include "glua/lmem.h"
 #include "glua/lobject.h"
 #include "glua/lstate.h"
+#include "glua/glua_state_arena.h"
+#include "glua/thinkyoung_lua_api.h"
+
+using thinkyoung::lua::api::global_glua_chain_api;
 
 
 
@@ -90,8 +94,12 @@ void *luaM_realloc_(lua_State *L, void *block, size_t osize, size_t nsize) {
             luaC_fullgc(L, 1);  /* try to free some memory... */
             newblock = (*g->frealloc)(g->ud, block, osize, nsize);  /* try again */
         }
-        if (newblock == nullptr)
+        if (newblock == nullptr) {
+            auto arena = thinkyoung::lua::lib::GluaStateArena::of(L);
+            if (arena && arena->over_limit() && g->version)
+                global_glua_chain_api->throw_exception(L, THINKYOUNG_API_LVM_LIMIT_OVER_ERROR, "over memory limit");
             luaD_throw(L, LUA_ERRMEM);
+        }
     }
     lua_assert((nsize == 0) == (newblock == nullptr));
     g->GCdebt = (g->GCdebt + nsize) - realosize;
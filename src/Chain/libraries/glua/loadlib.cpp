@@ -25,6 +25,7 @@
 #include <glua/thinkyoung_lua_api.h>
 #include <glua/thinkyoung_lua_lib.h>
 #include <glua/glua_lutil.h>
+#include <glua/glua_contract_module_cache.h>
 
 using thinkyoung::lua::api::global_glua_chain_api;
 
@@ -503,16 +504,22 @@ static int searcher_thinkyoung(lua_State *L) {
             }
         }
     } stream_scope(L, name, stream.get());
-    LClosure *closure = thinkyoung::lua::lib::luaU_undump_from_stream(L, stream.get(), thinkyoung::lua::lib::unwrap_any_contract_name(origin_contract_name).c_str());
-
-    if (!thinkyoung::lua::lib::check_contract_proto(L, closure->p, error))
+    // bytecode of a cached module that passed the check once is only undumped by the load below
+    auto &module_cache = thinkyoung::lua::lib::GluaContractModuleCache::instance();
+    if (!module_cache.is_proto_checked(stream.get()))
     {
-        if (strlen(L->compile_error) < 1)
+        LClosure *closure = thinkyoung::lua::lib::luaU_undump_from_stream(L, stream.get(), thinkyoung::lua::lib::unwrap_any_contract_name(origin_contract_name).c_str());
+
+        if (!thinkyoung::lua::lib::check_contract_proto(L, closure->p, error))
         {
-            memcpy(L->compile_error, error, sizeof(char)*(strlen(error) + 1));
+            if (strlen(L->compile_error) < 1)
+            {
+                memcpy(L->compile_error, error, sizeof(char)*(strlen(error) + 1));
+            }
+            global_glua_chain_api->throw_exception(L, THINKYOUNG_API_SIMPLE_ERROR, error ? error : "contract bytecode stream error");
+            return 1;
         }
-        global_glua_chain_api->throw_exception(L, THINKYOUNG_API_SIMPLE_ERROR, error ? error : "contract bytecode stream error");
-        return 1;
+        module_cache.set_proto_checked(stream.get());
     }
 
     return checkload(L, (luaL_loadbufferx(L, stream->buff.data(), stream->buff.size(), stream->is_bytes ? "binary" : "text", nullptr) == LUA_OK), name);
@@ -28,6 +28,9 @@
 #include "glua/ltable.h"
 #include "glua/ltm.h"
 #include "glua/thinkyoung_lua_api.h"
+#include "glua/glua_state_pool.h"
+#include "glua/glua_state_arena.h"
+#include "glua/glua_contract_profiler.h"
 #include "glua/thinkyoung_lua_lib.h"
 
 
@@ -239,6 +242,7 @@ static void preinit_thread(lua_State *L, global_State *g) {
     L->nny = 1;
     L->status = LUA_OK;
     L->errfunc = 0;
+    L->context = nullptr;
 }
 
 
@@ -291,6 +295,7 @@ void luaE_freethread(lua_State *L, lua_State *L1) {
     luaF_close(L1, L1->stack);  /* close all upvalues for this thread */
     lua_assert(L1->openupval == nullptr);
     luai_userstatefree(L, L1);
+    thinkyoung::lua::lib::close_lua_state_values(L1);
     freestack(L1);
     luaM_free(L, l);
 }
@@ -308,12 +313,16 @@ LUA_API lua_State *lua_newstate(lua_Alloc f, void *ud) {
     L->tt = LUA_TTHREAD;
     g->currentwhite = bitmask(WHITE0BIT);
     L->marked = luaC_white(g);
-    L->malloc_buffer = malloc(LUA_MALLOC_TOTAL_SIZE);
+    L->malloc_buffer = nullptr;
     L->malloc_pos = 0;
     L->malloced_buffers = new std::list<std::pair<ptrdiff_t, ptrdiff_t>>();
+    L->malloc_free_lists = new LuaMallocFreeLists();
+    for (i = 0; i < LUA_MALLOC_SIZE_CLASSES; i++) L->malloc_free_lists->small_blocks[i] = -1;
+    L->malloc_size_classes = false;
     memset(L->compile_error, 0x0, LUA_COMPILE_ERROR_MAX_LENGTH);
 	memset(L->runerror, 0x0, LUA_VM_EXCEPTION_STRNG_MAX_LENGTH);
 	L->bytecode_debugger_opened = false;
+    L->profiler = nullptr;
     L->in = stdin;
     L->out = stdout;
     L->err = stderr;
@@ -321,6 +330,7 @@ LUA_API lua_State *lua_newstate(lua_Alloc f, void *ud) {
 	L->exit_code = 0;
     L->debugger_pausing = false;
     L->preprocessor = nullptr;
+    L->baseline = nullptr;
     preinit_thread(L, g);
     g->frealloc = f;
     g->ud = ud;
@@ -345,6 +355,7 @@ LUA_API lua_State *lua_newstate(lua_Alloc f, void *ud) {
     g->gcfinnum = 0;
     g->gcpause = LUAI_GCPAUSE;
     g->gcstepmul = LUAI_GCMUL;
+    g->chain_api_error = 0;
     for (i = 0; i < LUA_NUMTAGS; i++) g->mt[i] = nullptr;
     if (luaD_rawrunprotected(L, f_luaopen, nullptr) != LUA_OK) {
         /* memory allocation error: free partial state */
@@ -358,10 +369,22 @@ LUA_API lua_State *lua_newstate(lua_Alloc f, void *ud) {
 LUA_API void lua_close(lua_State *L) {
     L = G(L)->mainthread;  /* only the main thread can be closed */
     thinkyoung::lua::lib::close_lua_state_values(L);
+    delete L->profiler;
+    L->profiler = nullptr;
+    delete L->baseline;
+    L->baseline = nullptr;
     delete L->malloced_buffers;
-    free(L->malloc_buffer);
+    delete L->malloc_free_lists;
+    void *malloc_buffer = L->malloc_buffer;
+    size_t malloc_used = (size_t)L->malloc_pos;
+    auto arena = thinkyoung::lua::lib::GluaStateArena::of(L);
+    if (arena)
+        arena->begin_release();
     lua_lock(L);
     close_state(L);
+    delete arena;
+    /* the buffer is handed to the next state only once nothing here can touch it */
+    thinkyoung::lua::lib::GluaStatePool::instance().release_malloc_buffer(malloc_buffer, malloc_used);
 }
 
 static size_t align8(size_t s) {
@@ -370,9 +393,35 @@ static size_t align8(size_t s) {
     return ((s >> 3) + 1) << 3;
 };
 
-// FIXME: use memory page, and use best fit malloc strategy
-// TODO: ĳɸҪֽڴأһʼڴأֳɶʽСڴأ
-void *lua_malloc(lua_State *L, size_t size)
+/* header in front of every block handed out by lua_malloc */
+struct LuaMallocBlockHeader {
+    uint32_t size_info; // size class, or page count with LUA_MALLOC_LARGE_BLOCK set
+    uint32_t tag;
+};
+
+#define LUA_MALLOC_SMALLEST_BLOCK 32
+#define LUA_MALLOC_LARGE_BLOCK 0x80000000u
+#define LUA_MALLOC_BLOCK_USED 0x55534544u
+#define LUA_MALLOC_BLOCK_FREE 0x46524545u
+
+static LuaMallocBlockHeader *malloc_block_at(lua_State *L, ptrdiff_t offset) {
+    return (LuaMallocBlockHeader*)((intptr_t)(L->malloc_buffer) + offset);
+}
+
+/* take a new block from the unused end of the buffer, -1 when the budget is exhausted */
+static ptrdiff_t bump_malloc_block(lua_State *L, size_t block_size) {
+    if ((size_t)L->malloc_pos + block_size > LUA_MALLOC_TOTAL_SIZE)
+        return -1;
+    ptrdiff_t offset = L->malloc_pos;
+    L->malloc_pos += block_size;
+    return offset;
+}
+
+/*
+** first fit over the live blocks sorted by offset, linear in the number of live blocks.
+** the point where it runs out of the buffer is part of the result of older blocks
+*/
+static void *first_fit_malloc(lua_State *L, size_t size)
 {
     size = align8(size);
     if (size > LUA_MALLOC_TOTAL_SIZE)
@@ -426,19 +475,8 @@ void *lua_malloc(lua_State *L, size_t size)
     return p;
 }
 
-void *lua_calloc(lua_State *L, size_t element_count, size_t element_size)
-{
-    void *p = lua_malloc(L, element_count * element_size);
-    if (nullptr == p)
-        return nullptr;
-    memset(p, 0, element_count * element_size);
-    return p;
-}
-
-void lua_free(lua_State *L, void *address)
+static void first_fit_free(lua_State *L, void *address)
 {
-    if (nullptr == address || nullptr == L)
-        return;
     auto offset = (intptr_t)address - (intptr_t)L->malloc_buffer;
     if (offset < 0 || offset > LUA_MALLOC_TOTAL_SIZE)
         return;
@@ -452,3 +490,130 @@ void lua_free(lua_State *L, void *address)
         }
     }
 }
+
+/*
+** blocks up to a page come from power of two size classes with a free list each,
+** larger blocks are whole pages and are reused by exact page count.
+** freed blocks are never merged
+*/
+static void *size_class_malloc(lua_State *L, size_t size)
+{
+    if (size > LUA_MALLOC_TOTAL_SIZE)
+    {
+        thinkyoung::lua::lib::notify_lua_state_stop(L);
+        return nullptr;
+    }
+    size_t block_size = align8(size) + sizeof(LuaMallocBlockHeader);
+    auto free_lists = L->malloc_free_lists;
+    ptrdiff_t offset = -1;
+    uint32_t size_info;
+    if (block_size <= LUA_MALLOC_PAGE_SIZE)
+    {
+        uint32_t size_class = 0;
+        while (((size_t)LUA_MALLOC_SMALLEST_BLOCK << size_class) < block_size)
+            ++size_class;
+        size_info = size_class;
+        offset = free_lists->small_blocks[size_class];
+        if (offset >= 0)
+            free_lists->small_blocks[size_class] = *(ptrdiff_t*)(malloc_block_at(L, offset) + 1);
+        else
+            offset = bump_malloc_block(L, (size_t)LUA_MALLOC_SMALLEST_BLOCK << size_class);
+    }
+    else
+    {
+        size_t pages = (block_size + LUA_MALLOC_PAGE_SIZE - 1) / LUA_MALLOC_PAGE_SIZE;
+        size_info = LUA_MALLOC_LARGE_BLOCK | (uint32_t)pages;
+        auto it = free_lists->large_blocks.find(pages);
+        if (it != free_lists->large_blocks.end() && !it->second.empty())
+        {
+            offset = it->second.back();
+            it->second.pop_back();
+        }
+        else
+            offset = bump_malloc_block(L, pages * LUA_MALLOC_PAGE_SIZE);
+    }
+    if (offset < 0)
+    {
+        thinkyoung::lua::lib::notify_lua_state_stop(L);
+        return nullptr;
+    }
+    auto header = malloc_block_at(L, offset);
+    header->size_info = size_info;
+    header->tag = LUA_MALLOC_BLOCK_USED;
+    return header + 1;
+}
+
+static void size_class_free(lua_State *L, void *address)
+{
+    auto offset = (intptr_t)address - (intptr_t)L->malloc_buffer - (intptr_t)sizeof(LuaMallocBlockHeader);
+    if (offset < 0 || offset >= L->malloc_pos)
+        return;
+    auto header = malloc_block_at(L, offset);
+    // addresses not returned by lua_malloc and blocks freed already are ignored
+    if (header->tag != LUA_MALLOC_BLOCK_USED)
+        return;
+    header->tag = LUA_MALLOC_BLOCK_FREE;
+    auto free_lists = L->malloc_free_lists;
+    if (header->size_info & LUA_MALLOC_LARGE_BLOCK)
+    {
+        free_lists->large_blocks[header->size_info & ~LUA_MALLOC_LARGE_BLOCK].push_back(offset);
+    }
+    else
+    {
+        *(ptrdiff_t*)(header + 1) = free_lists->small_blocks[header->size_info];
+        free_lists->small_blocks[header->size_info] = offset;
+    }
+}
+
+void lua_malloc_use_size_classes(lua_State *L)
+{
+    if (nullptr == L->malloc_buffer)
+        L->malloc_size_classes = true;
+}
+
+void lua_malloc_reset(lua_State *L)
+{
+    void *malloc_buffer = L->malloc_buffer;
+    size_t malloc_used = (size_t)L->malloc_pos;
+    L->malloc_buffer = nullptr;
+    L->malloc_pos = 0;
+    L->malloced_buffers->clear();
+    for (int i = 0; i < LUA_MALLOC_SIZE_CLASSES; i++) L->malloc_free_lists->small_blocks[i] = -1;
+    L->malloc_free_lists->large_blocks.clear();
+    L->malloc_size_classes = false;
+    thinkyoung::lua::lib::GluaStatePool::instance().release_malloc_buffer(malloc_buffer, malloc_used);
+}
+
+/* the buffer itself is only taken on first use */
+void *lua_malloc(lua_State *L, size_t size)
+{
+    if (nullptr == L->malloc_buffer)
+        L->malloc_buffer = thinkyoung::lua::lib::GluaStatePool::instance().acquire_malloc_buffer();
+    if (nullptr == L->malloc_buffer)
+    {
+        thinkyoung::lua::lib::notify_lua_state_stop(L);
+        return nullptr;
+    }
+    if (L->malloc_size_classes)
+        return size_class_malloc(L, size);
+    return first_fit_malloc(L, size);
+}
+
+void *lua_calloc(lua_State *L, size_t element_count, size_t element_size)
+{
+    void *p = lua_malloc(L, element_count * element_size);
+    if (nullptr == p)
+        return nullptr;
+    memset(p, 0, element_count * element_size);
+    return p;
+}
+
+void lua_free(lua_State *L, void *address)
+{
+    if (nullptr == address || nullptr == L || nullptr == L->malloc_buffer)
+        return;
+    if (L->malloc_size_classes)
+        size_class_free(L, address);
+    else
+        first_fit_free(L, address);
+}
@@ -93,7 +93,7 @@ static int register_storage(lua_State *L)
 
 static GluaStorageTableReadList *get_or_init_storage_table_read_list(lua_State *L)
 {
-    GluaStateValueNode state_value_node = thinkyoung::lua::lib::get_lua_state_value_node(L, LUA_STORAGE_READ_TABLES_KEY);
+    GluaStateValueNode state_value_node = thinkyoung::lua::lib::get_lua_state_value_node(L, GLUA_STATE_SLOT_STORAGE_READ_TABLES);
     GluaStorageTableReadList *list = nullptr;;
     if (state_value_node.type != LUA_STATE_VALUE_POINTER || nullptr == state_value_node.value.pointer_value)
     {
@@ -101,7 +101,7 @@ static GluaStorageTableReadList *get_or_init_storage_table_read_list(lua_State *
         new (list)GluaStorageTableReadList();
         GluaStateValue value_to_store;
         value_to_store.pointer_value = list;
-        thinkyoung::lua::lib::set_lua_state_value(L, LUA_STORAGE_READ_TABLES_KEY, value_to_store, LUA_STATE_VALUE_POINTER);
+        thinkyoung::lua::lib::set_lua_state_value(L, GLUA_STATE_SLOT_STORAGE_READ_TABLES, value_to_store, LUA_STATE_VALUE_POINTER);
     }
     else
     {
@@ -148,7 +148,7 @@ static struct GluaStorageValue get_last_storage_changed_value(lua_State *L, cons
           new (list)GluaStorageChangeList();
           GluaStateValue value_to_store;
           value_to_store.pointer_value = list;
-          thinkyoung::lua::lib::set_lua_state_value(L, LUA_STORAGE_CHANGELIST_KEY, value_to_store, LUA_STATE_VALUE_POINTER);
+          thinkyoung::lua::lib::set_lua_state_value(L, GLUA_STATE_SLOT_STORAGE_CHANGELIST, value_to_store, LUA_STATE_VALUE_POINTER);
         }
         GluaStorageChangeItem change_item;
         change_item.before = value;
@@ -311,7 +311,7 @@ bool luaL_commit_storage_changes(lua_State *L)
     // printf("");
   }*/
 
-    GluaStateValueNode storage_changelist_node = thinkyoung::lua::lib::get_lua_state_value_node(L, LUA_STORAGE_CHANGELIST_KEY);
+    GluaStateValueNode storage_changelist_node = thinkyoung::lua::lib::get_lua_state_value_node(L, GLUA_STATE_SLOT_STORAGE_CHANGELIST);
     if (global_glua_chain_api->has_exception(L))
     {
         if (storage_changelist_node.type == LUA_STATE_VALUE_POINTER && nullptr != storage_changelist_node.value.pointer_value)
@@ -332,7 +332,7 @@ bool luaL_commit_storage_changes(lua_State *L)
         new (list)GluaStorageChangeList();
         GluaStateValue value_to_store;
         value_to_store.pointer_value = list;
-        thinkyoung::lua::lib::set_lua_state_value(L, LUA_STORAGE_CHANGELIST_KEY, value_to_store, LUA_STATE_VALUE_POINTER);
+        thinkyoung::lua::lib::set_lua_state_value(L, GLUA_STATE_SLOT_STORAGE_CHANGELIST, value_to_store, LUA_STATE_VALUE_POINTER);
         storage_changelist_node.value.pointer_value = list;
     }
     if (storage_changelist_node.type == LUA_STATE_VALUE_POINTER && nullptr != storage_changelist_node.value.pointer_value)
@@ -670,6 +670,7 @@ namespace glua {
 		int thinkyounglib_get_storage_impl(lua_State *L,
 			const char *contract_id, const char *name)
 		{
+            thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "get_storage");
             thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
 			
 			const auto &code_contract_id = get_contract_id_string_in_storage_operation(L);
@@ -689,7 +690,7 @@ namespace glua {
 			}
 			lua_pop(L, 1);
 			// printf("get storage %s:%s\n", contract_name, name);
-			const auto &state_value_node = thinkyoung::lua::lib::get_lua_state_value_node(L, LUA_STORAGE_CHANGELIST_KEY);
+			const auto &state_value_node = thinkyoung::lua::lib::get_lua_state_value_node(L, GLUA_STATE_SLOT_STORAGE_CHANGELIST);
 			int result;
 			if (state_value_node.type != LUA_STATE_VALUE_POINTER || !state_value_node.value.pointer_value)
 			{
@@ -762,6 +763,7 @@ namespace glua {
         int thinkyounglib_set_storage_impl(lua_State *L,
           const char *contract_id, const char *name, int value_index)
         {
+          thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "set_storage");
           const auto &code_contract_id = get_contract_id_string_in_storage_operation(L);
           if (code_contract_id != contract_id && code_contract_id != contract_id)
           {
@@ -820,7 +822,7 @@ namespace glua {
           */
 
           // log the value before and the new value
-          GluaStateValueNode state_value_node = thinkyoung::lua::lib::get_lua_state_value_node(L, LUA_STORAGE_CHANGELIST_KEY);
+          GluaStateValueNode state_value_node = thinkyoung::lua::lib::get_lua_state_value_node(L, GLUA_STATE_SLOT_STORAGE_CHANGELIST);
           GluaStorageChangeList *list;
           if (state_value_node.type != LUA_STATE_VALUE_POINTER || nullptr == state_value_node.value.pointer_value)
           {
@@ -828,7 +830,7 @@ namespace glua {
             new (list)GluaStorageChangeList();
             GluaStateValue value_to_store;
             value_to_store.pointer_value = list;
-            thinkyoung::lua::lib::set_lua_state_value(L, LUA_STORAGE_CHANGELIST_KEY, value_to_store, LUA_STATE_VALUE_POINTER);
+            thinkyoung::lua::lib::set_lua_state_value(L, GLUA_STATE_SLOT_STORAGE_CHANGELIST, value_to_store, LUA_STATE_VALUE_POINTER);
           }
           else
           {
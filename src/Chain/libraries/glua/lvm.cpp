@@ -39,6 +39,7 @@
 #include <glua/thinkyoung_lua_api.h>
 #include <glua/thinkyoung_lua_lib.h>
 #include <glua/glua_debug_file.h>
+#include <glua/glua_contract_profiler.h>
 
 using thinkyoung::lua::api::global_glua_chain_api;
 
@@ -798,9 +799,28 @@ void luaV_finishOp(lua_State *L) {
            luai_threadyield(L); }
 
 
+/*
+** with GNU C the opcode handlers are reached through a table of label addresses,
+** vmbreak goes back to the instruction fetch, an opcode without handler is skipped
+** like a switch without matching case would do
+*/
+#if !defined(LUA_USE_JUMPTABLE)
+#if defined(__GNUC__)
+#define LUA_USE_JUMPTABLE	1
+#else
+#define LUA_USE_JUMPTABLE	0
+#endif
+#endif
+
+#if LUA_USE_JUMPTABLE
+#define vmdispatch(o)	if ((o) >= NUM_OPCODES) continue; goto *disptab[o];
+#define vmcase(l)	L_##l:
+#define vmbreak		continue
+#else
 #define vmdispatch(o)	switch(o)
 #define vmcase(l)	case l:
 #define vmbreak		break
+#endif
 
 
 /*
@@ -949,6 +969,98 @@ static int get_line_in_current_proto(CallInfo* ci, Proto *proto)
 		return 0;
 }
 
+/*
+** debugger work done before an instruction while the bytecode debugger is opened,
+** kept out of luaV_execute so the instruction loop stays small
+*/
+static void lvm_debugger_step(lua_State *L, CallInfo *ci, LClosure *cl, int *last_debug_line_in_file)
+{
+	while (remote_debugger && remote_debugger->is_pausing_lvm())
+	{
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+	}
+	// TODO: 添加断点调试, 外部socket设置文件名，断点位置（字节码指令offset)列表，继续/暂停等
+	// TODO
+	if(!remote_debugger)
+	{
+		remote_debugger = new glua::debugger::LRemoteDebugger();
+	}
+	L->debugger_pausing = false;
+	
+	int line_pre_defined = 7;
+	//std::unordered_map<std::string, std::vector<int>> debugger_source_lines = {
+		// {"@tests_typed/full_correct_typed.lua", { 15 + line_pre_defined, 15, 16, 17 }}
+	//	{"@tests_typed/full_correct_typed.lua",{ 15 }}
+	// };
+	if(!remote_debugger->is_running())
+	{
+		remote_debugger->start_async();
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+	}
+
+	auto debugger_source_lines = remote_debugger->debugger_source_lines();
+	Proto *proto = cl->p;
+	std::string proto_source((proto->source == nullptr) ? "(*no name)" : getstr(proto->source));
+	std::string proto_source_ldf_filename = proto_source + ".ldf";
+	thinkyoung::lua::core::LuaDebugFileInfo *ldf = nullptr;
+	if (proto_source_ldf_filename[0] == '@')
+	{
+		proto_source_ldf_filename = proto_source_ldf_filename.substr(1);
+		FILE *ldf_file = fopen(proto_source_ldf_filename.c_str(), "r");
+		if (ldf_file)
+		{
+			auto ldf_deserialized = thinkyoung::lua::core::LuaDebugFileInfo::deserialize_from_file(ldf_file);
+			ldf = new thinkyoung::lua::core::LuaDebugFileInfo();
+			*ldf = ldf_deserialized;
+			fclose(ldf_file);
+		}
+	}
+	// TODO: 考虑碰到debugger时把上下文环境socket传回去
+	auto source_found_in_debugger = debugger_source_lines.find(proto_source);
+	if (source_found_in_debugger != debugger_source_lines.end())
+	{
+		auto debugger_lines = source_found_in_debugger->second;
+		// Instruction i2 = *(ci->u.l.savedpc);
+		int idx = (int)(ci->u.l.savedpc - proto->code); // 在proto中执行到的指令的偏移量
+		if(idx<proto->sizecode)
+		{
+			int line_in_proto = proto->lineinfo[idx];
+			for(const auto &need_debug_line : debugger_lines)
+			{
+				auto lua_need_debug_line = need_debug_line;
+				if (ldf)
+					lua_need_debug_line = (int) ldf->find_lua_line_by_glua_line(need_debug_line);
+				if(lua_need_debug_line == proto->linedefined + line_in_proto)
+				{
+					int line_in_lua_file = proto->linedefined + line_in_proto -line_pre_defined; // FIXME
+					
+					if (line_in_lua_file != *last_debug_line_in_file)
+					{
+						*last_debug_line_in_file = line_in_lua_file;
+						// TODO: paused to debug
+						// TODO: 反汇编这条指令让其可读，获取上下文的局部变量的值，让remote调式方知道断点的代码位置
+
+						// enter_lua_debugger(L);
+						lua_pushcfunction(L, enter_lua_debugger);
+						lua_pcall(L, 0, 0, 0);
+						// exit_lua_debugger(L);
+
+						// TODO: wait remote debugger tool to resume running
+						// TODO: remote debugger tool can send back variable or functioncall to get result back
+						lua_pushcfunction(L, exit_lua_debugger);
+						lua_pcall(L, 0, 0, 0);
+
+						remote_debugger->set_pausing_lvm(true);
+						// remote_debugger->shutdown(); // FIXME: 暂时一次性就关闭，以后可能要改成根据远程调试器来关闭
+					}
+				}
+			}
+		}
+	}
+	if (ldf)
+		delete ldf;
+}
+
 #define lua_check_in_vm_error(cond, error_msg) {    \
 if (!(cond)) {      \
   L->force_stopping = true; \
@@ -958,6 +1070,23 @@ if (!(cond)) {      \
 }
 void luaV_execute(lua_State *L)
 {
+#if LUA_USE_JUMPTABLE
+    /* handler addresses in the order of enum OpCode */
+    static const void *const disptab[NUM_OPCODES] = {
+        &&L_OP_MOVE, &&L_OP_LOADK, &&L_OP_LOADKX, &&L_OP_LOADBOOL,
+        &&L_OP_LOADNIL, &&L_OP_GETUPVAL, &&L_OP_GETTABUP, &&L_OP_GETTABLE,
+        &&L_OP_SETTABUP, &&L_OP_SETUPVAL, &&L_OP_SETTABLE, &&L_OP_NEWTABLE,
+        &&L_OP_SELF, &&L_OP_ADD, &&L_OP_SUB, &&L_OP_MUL,
+        &&L_OP_MOD, &&L_OP_POW, &&L_OP_DIV, &&L_OP_IDIV,
+        &&L_OP_BAND, &&L_OP_BOR, &&L_OP_BXOR, &&L_OP_SHL,
+        &&L_OP_SHR, &&L_OP_UNM, &&L_OP_BNOT, &&L_OP_NOT,
+        &&L_OP_LEN, &&L_OP_CONCAT, &&L_OP_JMP, &&L_OP_EQ,
+        &&L_OP_LT, &&L_OP_LE, &&L_OP_TEST, &&L_OP_TESTSET,
+        &&L_OP_CALL, &&L_OP_TAILCALL, &&L_OP_RETURN, &&L_OP_FORLOOP,
+        &&L_OP_FORPREP, &&L_OP_TFORCALL, &&L_OP_TFORLOOP, &&L_OP_SETLIST,
+        &&L_OP_CLOSURE, &&L_OP_VARARG, &&L_OP_EXTRAARG
+    };
+#endif
     if (L->force_stopping)
         return;
     CallInfo *ci = L->ci;
@@ -965,131 +1094,57 @@ void luaV_execute(lua_State *L)
     TValue *k;
     StkId base;
     ci->callstatus |= CIST_FRESH;  /* fresh invocation of 'luaV_execute" */
-newframe:  /* reentry point when frame changes (call/return) */
-    lua_assert(ci == L->ci);
-    cl = clLvalue(ci->func);  /* local reference to function's closure */
-    k = cl->p->k;  /* local reference to function's constant table */
-    base = ci->u.l.base;  /* local copy of function's base */
 
-    int insts_limit = thinkyoung::lua::lib::get_lua_state_value(L, INSTRUCTIONS_LIMIT_LUA_STATE_MAP_KEY).int_value;
-    int *stopped_pointer = thinkyoung::lua::lib::get_lua_state_value(L, LUA_STATE_STOP_TO_RUN_IN_LVM_STATE_MAP_KEY).int_pointer_value;
+    /* state values don't change while the interpreter runs, read them once per invocation */
+    int insts_limit = thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_INSTRUCTIONS_LIMIT).int_value;
+    int *stopped_pointer = thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_STOP_IN_LVM).int_pointer_value;
     if (nullptr == stopped_pointer)
     {
         thinkyoung::lua::lib::notify_lua_state_stop(L);
         thinkyoung::lua::lib::resume_lua_state_running(L);
-        stopped_pointer = thinkyoung::lua::lib::get_lua_state_value(L, LUA_STATE_STOP_TO_RUN_IN_LVM_STATE_MAP_KEY).int_pointer_value;
+        stopped_pointer = thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_STOP_IN_LVM).int_pointer_value;
     }
-    int has_insts_limit = insts_limit > 0 ? 1 : 0;
-    int *insts_executed_count = thinkyoung::lua::lib::get_lua_state_value(L, INSTRUCTIONS_EXECUTED_COUNT_LUA_STATE_MAP_KEY).int_pointer_value;
+    /* a state without limit compares against INT_MAX so each instruction needs one test */
+    int insts_limit_effective = insts_limit > 0 ? insts_limit : INT_MAX;
+    int *insts_executed_count = thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_INSTRUCTIONS_EXECUTED_COUNT).int_pointer_value;
     if (nullptr == insts_executed_count)
     {
         insts_executed_count = static_cast<int*>(lua_malloc(L, sizeof(int)));
         *insts_executed_count = 0;
         GluaStateValue lua_state_value_of_exected_count;
         lua_state_value_of_exected_count.int_pointer_value = insts_executed_count;
-        thinkyoung::lua::lib::set_lua_state_value(L, INSTRUCTIONS_EXECUTED_COUNT_LUA_STATE_MAP_KEY, lua_state_value_of_exected_count, LUA_STATE_VALUE_INT_POINTER);
+        thinkyoung::lua::lib::set_lua_state_value(L, GLUA_STATE_SLOT_INSTRUCTIONS_EXECUTED_COUNT, lua_state_value_of_exected_count, LUA_STATE_VALUE_INT_POINTER);
     }
     if (*insts_executed_count < 0)
         *insts_executed_count = 0;
 
-    lua_getglobal(L, "last_return");
-	bool use_last_return = true; // lua_istable(L, -1);
-    lua_pop(L, 1);
+    const bool use_last_return = true;
+    /* the lookup only has effects through a metatable of the globals table */
+    {
+        Table *reg = hvalue(&G(L)->l_registry);
+        const TValue *gt = luaH_getint(reg, LUA_RIDX_GLOBALS);
+        if (ttistable(gt) && hvalue(gt)->metatable != nullptr)
+        {
+            lua_getglobal(L, "last_return");
+            lua_pop(L, 1);
+        }
+    }
+
+newframe:  /* reentry point when frame changes (call/return) */
+    lua_assert(ci == L->ci);
+    cl = clLvalue(ci->func);  /* local reference to function's closure */
+    k = cl->p->k;  /* local reference to function's constant table */
+    base = ci->u.l.base;  /* local copy of function's base */
 
 	int last_debug_line_in_file = -1;
 
     /* main loop of interpreter */
     for (;;) {
-		while (L->bytecode_debugger_opened && remote_debugger && remote_debugger->is_pausing_lvm())
-		{
-			std::this_thread::sleep_for(std::chrono::seconds(1));
-		}
-		// TODO: 添加断点调试, 外部socket设置文件名，断点位置（字节码指令offset)列表，继续/暂停等
-		if(L->bytecode_debugger_opened)
-		{
-			// TODO
-			if(!remote_debugger)
-			{
-				remote_debugger = new glua::debugger::LRemoteDebugger();
-			}
-			L->debugger_pausing = false;
-			
-			int line_pre_defined = 7;
-			//std::unordered_map<std::string, std::vector<int>> debugger_source_lines = {
-				// {"@tests_typed/full_correct_typed.lua", { 15 + line_pre_defined, 15, 16, 17 }}
-			//	{"@tests_typed/full_correct_typed.lua",{ 15 }}
-			// };
-			if(!remote_debugger->is_running())
-			{
-				remote_debugger->start_async();
-				std::this_thread::sleep_for(std::chrono::seconds(1));
-			}
-
-			auto debugger_source_lines = remote_debugger->debugger_source_lines();
-			Proto *proto = cl->p;
-			std::string proto_source((proto->source == nullptr) ? "(*no name)" : getstr(proto->source));
-			std::string proto_source_ldf_filename = proto_source + ".ldf";
-			thinkyoung::lua::core::LuaDebugFileInfo *ldf = nullptr;
-			if (proto_source_ldf_filename[0] == '@')
-			{
-				proto_source_ldf_filename = proto_source_ldf_filename.substr(1);
-				FILE *ldf_file = fopen(proto_source_ldf_filename.c_str(), "r");
-				if (ldf_file)
-				{
-					auto ldf_deserialized = thinkyoung::lua::core::LuaDebugFileInfo::deserialize_from_file(ldf_file);
-					ldf = new thinkyoung::lua::core::LuaDebugFileInfo();
-					*ldf = ldf_deserialized;
-					fclose(ldf_file);
-				}
-			}
-			// TODO: 考虑碰到debugger时把上下文环境socket传回去
-			auto source_found_in_debugger = debugger_source_lines.find(proto_source);
-			if (source_found_in_debugger != debugger_source_lines.end())
-			{
-				auto debugger_lines = source_found_in_debugger->second;
-				// Instruction i2 = *(ci->u.l.savedpc);
-				int idx = (int)(ci->u.l.savedpc - proto->code); // 在proto中执行到的指令的偏移量
-				if(idx<proto->sizecode)
-				{
-					int line_in_proto = proto->lineinfo[idx];
-					for(const auto &need_debug_line : debugger_lines)
-					{
-						auto lua_need_debug_line = need_debug_line;
-						if (ldf)
-							lua_need_debug_line = (int) ldf->find_lua_line_by_glua_line(need_debug_line);
-						if(lua_need_debug_line == proto->linedefined + line_in_proto)
-						{
-							int line_in_lua_file = proto->linedefined + line_in_proto -line_pre_defined; // FIXME
-							
-							if (line_in_lua_file != last_debug_line_in_file)
-							{
-								last_debug_line_in_file = line_in_lua_file;
-								// TODO: paused to debug
-								// TODO: 反汇编这条指令让其可读，获取上下文的局部变量的值，让remote调式方知道断点的代码位置
-
-								// enter_lua_debugger(L);
-								lua_pushcfunction(L, enter_lua_debugger);
-								lua_pcall(L, 0, 0, 0);
-								// exit_lua_debugger(L);
-
-								// TODO: wait remote debugger tool to resume running
-								// TODO: remote debugger tool can send back variable or functioncall to get result back
-								lua_pushcfunction(L, exit_lua_debugger);
-								lua_pcall(L, 0, 0, 0);
-
-								remote_debugger->set_pausing_lvm(true);
-								// remote_debugger->shutdown(); // FIXME: 暂时一次性就关闭，以后可能要改成根据远程调试器来关闭
-							}
-						}
-					}
-				}
-			}
-			if (ldf)
-				delete ldf;
-		}
+		if (L->bytecode_debugger_opened)
+			lvm_debugger_step(L, ci, cl, &last_debug_line_in_file);
         if (!ci || ci->u.l.savedpc == nullptr) {
           global_glua_chain_api->throw_exception(L, THINKYOUNG_API_LVM_LIMIT_OVER_ERROR, "wrong bytecode instruction, can't find savedpc");
-          vmbreak;
+          break;
         }
         Instruction i = *(ci->u.l.savedpc++);
         // printf("%d\n", i);
@@ -1097,16 +1152,17 @@ newframe:  /* reentry point when frame changes (call/return) */
 
 		*insts_executed_count += 1; // executed instructions count
 
+        if (L->profiler)
+            L->profiler->on_instruction(cl->p, GET_OPCODE(i));
+
         // limit instructions count, and executed instructions
-        if (has_insts_limit && *insts_executed_count > insts_limit)
+        if (*insts_executed_count > insts_limit_effective)
         {
             global_glua_chain_api->throw_exception(L, THINKYOUNG_API_LVM_LIMIT_OVER_ERROR, "over instructions limit");
-            vmbreak;
+            break;
         }
-        if (stopped_pointer && *stopped_pointer > 0)
-            vmbreak;
-        if (L->force_stopping)
-            vmbreak;
+        if (*stopped_pointer > 0 || L->force_stopping)
+            break;
         
 
         // when over contract api limit, also vmbreak
@@ -1114,7 +1170,7 @@ newframe:  /* reentry point when frame changes (call/return) */
             && global_glua_chain_api->check_contract_api_instructions_over_limit(L))
         {
             global_glua_chain_api->throw_exception(L, THINKYOUNG_API_LVM_LIMIT_OVER_ERROR, "over instructions limit");
-            vmbreak;
+            break;
         }
 
         if (L->hookmask & (LUA_MASKLINE | LUA_MASKCOUNT))
@@ -11,6 +11,9 @@
 #include <iostream>
 #include <ctime>
 #include <chrono>
+#include <list>
+#include <random>
+#include <algorithm>
 
 
 #include <glua/lua.h>
@@ -19,6 +22,9 @@
 #include <glua/lauxlib.h>
 
 #include <glua/thinkyoung_lua_lib.h>
+#include <glua/glua_contract_module_cache.h>
+#include <glua/glua_state_arena.h>
+#include <glua/glua_state_pool.h>
 #include <glua/lcompile.h>
 #include <glua/glua_tokenparser.h>
 #include <glua/lparsercombinator.h>
@@ -501,6 +507,310 @@ GTEST(TEST_STORAGE_PERFORMANCE)
   printf("executed lua instructions count %d\n", scope.get_instructions_executed_count());
 }
 
+// the lua_malloc of the lua_State before size classes, the point where it runs out decides blocks before ALP_LVM_MALLOC_SIZE_CLASSES_BLOCK_NUM
+struct FirstFitMallocModel
+{
+	std::list<std::pair<ptrdiff_t, ptrdiff_t>> blocks;
+	ptrdiff_t pos = 0;
+	bool stopped = false;
+
+	ptrdiff_t fail()
+	{
+		// notify_lua_state_stop takes an int from lua_malloc the first time
+		if (!stopped)
+		{
+			stopped = true;
+			malloc(sizeof(int));
+		}
+		return -1;
+	}
+
+	ptrdiff_t malloc(size_t size)
+	{
+		size = (size + 7) & ~(size_t)7;
+		if (size > LUA_MALLOC_TOTAL_SIZE)
+			return fail();
+		if (blocks.empty())
+		{
+			blocks.push_back(std::make_pair(pos, (ptrdiff_t)size));
+			pos += size;
+			return blocks.back().first;
+		}
+		std::pair<ptrdiff_t, ptrdiff_t> last_pair;
+		for (auto it = blocks.begin(); it != blocks.end(); ++it)
+		{
+			if (it == blocks.begin())
+			{
+				if (it->first > (ptrdiff_t)size)
+				{
+					blocks.push_front(std::make_pair((ptrdiff_t)0, (ptrdiff_t)size));
+					return 0;
+				}
+				last_pair = *it;
+				continue;
+			}
+			if (it->first >= last_pair.first + last_pair.second + (ptrdiff_t)size)
+			{
+				ptrdiff_t offset = last_pair.first + last_pair.second;
+				blocks.insert(it, std::make_pair(offset, (ptrdiff_t)size));
+				return offset;
+			}
+			last_pair = *it;
+		}
+		if (pos + (ptrdiff_t)size > LUA_MALLOC_TOTAL_SIZE)
+			return fail();
+		blocks.push_back(std::make_pair(pos, (ptrdiff_t)size));
+		pos += size;
+		return blocks.back().first;
+	}
+
+	void free(ptrdiff_t offset)
+	{
+		for (auto it = blocks.begin(); it != blocks.end(); ++it)
+		{
+			if (it->first == offset)
+			{
+				blocks.erase(it);
+				return;
+			}
+		}
+	}
+};
+
+// sizes like the contract apis ask for: counters, strings, exception messages and module streams
+static size_t next_lua_malloc_test_size(std::mt19937 &rng)
+{
+	auto r = rng() % 100;
+	if (r < 40)
+		return sizeof(int);
+	if (r < 80)
+		return 8 + rng() % 248;
+	if (r < 95)
+		return 256 + rng() % 3840;
+	return 4096 + rng() % 65536;
+}
+
+GTEST(TEST_LUA_MALLOC_FIRST_FIT_UNCHANGED)
+{
+	printf("TEST_LUA_MALLOC_FIRST_FIT_UNCHANGED\n");
+	lua_State *L = thinkyoung::lua::lib::create_lua_state();
+	FirstFitMallocModel model;
+	std::mt19937 rng(20171018);
+	std::vector<std::pair<void*, ptrdiff_t>> live;
+	size_t mismatches = 0;
+	for (int i = 0; i < 100000; ++i)
+	{
+		if (live.empty() || rng() % 100 < 55)
+		{
+			auto size = next_lua_malloc_test_size(rng);
+			void *p = lua_malloc(L, size);
+			ptrdiff_t expected = model.malloc(size);
+			ptrdiff_t offset = nullptr == p ? -1 : (intptr_t)p - (intptr_t)L->malloc_buffer;
+			if (offset != expected)
+				++mismatches;
+			if (nullptr != p)
+				live.push_back(std::make_pair(p, offset));
+		}
+		else
+		{
+			auto index = rng() % live.size();
+			lua_free(L, live[index].first);
+			model.free(live[index].second);
+			live[index] = live.back();
+			live.pop_back();
+		}
+	}
+	// the budget runs out after the same allocation
+	int big_blocks = 0;
+	for (;;)
+	{
+		void *p = lua_malloc(L, 1024 * 1024);
+		ptrdiff_t expected = model.malloc(1024 * 1024);
+		ptrdiff_t offset = nullptr == p ? -1 : (intptr_t)p - (intptr_t)L->malloc_buffer;
+		if (offset != expected)
+			++mismatches;
+		if (nullptr == p || expected < 0)
+			break;
+		++big_blocks;
+	}
+	GCHECK_EQUAL(mismatches, 0);
+	GCHECK(model.stopped);
+	GCHECK(thinkyoung::lua::lib::check_lua_state_notified_stop(L));
+	printf("first fit lua_malloc ran out after %d more blocks of 1M, %d blocks live\n", big_blocks, (int)model.blocks.size());
+	thinkyoung::lua::lib::close_lua_state(L);
+}
+
+#if defined(_DEBUG)
+#define LUA_MALLOC_PERFORMANCE_TEST_REPEAT_COUNT 10000
+#else
+#define LUA_MALLOC_PERFORMANCE_TEST_REPEAT_COUNT 200000
+#endif
+
+// lua_malloc/lua_free with a few thousand live blocks, first fit against size classes
+GTEST(TEST_LUA_MALLOC_PERFORMANCE)
+{
+	printf("TEST_LUA_MALLOC_PERFORMANCE\n");
+	for (int size_classes = 0; size_classes < 2; ++size_classes)
+	{
+		lua_State *L = thinkyoung::lua::lib::create_lua_state();
+		if (size_classes)
+			lua_malloc_use_size_classes(L);
+		std::mt19937 rng(20171018);
+		std::vector<void*> live;
+		size_t failed = 0;
+		auto start_time = std::chrono::steady_clock::now();
+		for (int i = 0; i < LUA_MALLOC_PERFORMANCE_TEST_REPEAT_COUNT; ++i)
+		{
+			if (live.size() < 4000 && (live.empty() || rng() % 100 < 55))
+			{
+				void *p = lua_malloc(L, sizeof(int) + rng() % 252);
+				if (nullptr == p)
+					++failed;
+				else
+					live.push_back(p);
+			}
+			else
+			{
+				auto index = rng() % live.size();
+				lua_free(L, live[index]);
+				live[index] = live.back();
+				live.pop_back();
+			}
+		}
+		std::chrono::duration<double> diff = std::chrono::steady_clock::now() - start_time;
+		GCHECK_EQUAL(failed, 0);
+		std::cout << (size_classes ? "size classes" : "first fit") << " lua_malloc/lua_free " << LUA_MALLOC_PERFORMANCE_TEST_REPEAT_COUNT
+			<< " calls using " << diff.count() << "s, buffer used " << L->malloc_pos << " bytes" << std::endl;
+		thinkyoung::lua::lib::close_lua_state(L);
+	}
+}
+
+// a contract stops after the same instruction and is charged the same count whatever the limit
+GTEST(TEST_LVM_INSTRUCTIONS_LIMIT)
+{
+	printf("TEST_LVM_INSTRUCTIONS_LIMIT\n");
+	GCHECK(thinkyoung::lua::lib::compilefile_to_file("tests_lua/test_opcode_mix.lua", "tmp_to_run", nullptr));
+	int full_count = 0;
+	{
+		thinkyoung::lua::lib::GluaStateScope scope;
+		thinkyoung::lua::lib::add_system_extra_libs(scope.L());
+		GCHECK(thinkyoung::lua::lib::run_compiledfile(scope.L(), "tmp_to_run"));
+		full_count = scope.get_instructions_executed_count();
+	}
+	// every limit while the first calls are made, then a stride that lands on each kind of instruction
+	std::vector<int> limits;
+	for (int limit = 1; limit <= full_count + 1; limit += (limit < 200 ? 1 : 37))
+		limits.push_back(limit);
+	limits.push_back(full_count - 1);
+	limits.push_back(full_count);
+	limits.push_back(full_count + 1);
+	uint64_t checksum = 0;
+	for (auto limit : limits)
+	{
+		thinkyoung::lua::lib::GluaStateScope scope;
+		thinkyoung::lua::lib::add_system_extra_libs(scope.L());
+		scope.set_instructions_limit(limit);
+		global_glua_chain_api->clear_exceptions(scope.L());
+		bool run_status = thinkyoung::lua::lib::run_compiledfile(scope.L(), "tmp_to_run")
+			&& !global_glua_chain_api->has_exception(scope.L());
+		int count = scope.get_instructions_executed_count();
+		GCHECK(run_status == (limit >= full_count));
+		GCHECK(count <= limit + 1);
+		checksum = checksum * 1000003 + (uint64_t) count * 2 + (run_status ? 1 : 0);
+	}
+	printf("executed lua instructions count %d, %d limits checksum %llu\n", full_count, (int) limits.size(), (unsigned long long) checksum);
+}
+
+#if defined(_DEBUG)
+#define LVM_OPCODE_MIX_TEST_REPEAT_COUNT 20
+#else
+#define LVM_OPCODE_MIX_TEST_REPEAT_COUNT 500
+#endif
+
+// which opcodes a typical contract runs and the average cost of an instruction
+GTEST(TEST_LVM_OPCODE_MIX)
+{
+	printf("TEST_LVM_OPCODE_MIX\n");
+	GCHECK(thinkyoung::lua::lib::compilefile_to_file("tests_lua/test_opcode_mix.lua", "tmp_to_run", nullptr));
+	thinkyoung::lua::lib::GluaProfileReport report;
+	{
+		thinkyoung::lua::lib::GluaStateScope scope;
+		thinkyoung::lua::lib::add_system_extra_libs(scope.L());
+		scope.enable_profiler();
+		GCHECK(thinkyoung::lua::lib::run_compiledfile(scope.L(), "tmp_to_run"));
+		report = scope.get_profile_report();
+		GCHECK_EQUAL(report.instructions, (uint64_t) scope.get_instructions_executed_count());
+	}
+	std::vector<std::pair<uint64_t, std::string>> mix;
+	for (const auto &opcode : report.opcodes)
+		mix.push_back(std::make_pair(opcode.second.count, opcode.first));
+	std::sort(mix.rbegin(), mix.rend());
+	for (const auto &item : mix)
+		printf("  %-10s %6llu %5.1f%%\n", item.second.c_str(), (unsigned long long) item.first, 100.0 * item.first / report.instructions);
+	uint64_t instructions = 0;
+	auto start_time = std::chrono::steady_clock::now();
+	for (int i = 0; i < LVM_OPCODE_MIX_TEST_REPEAT_COUNT; ++i)
+	{
+		thinkyoung::lua::lib::GluaStateScope scope;
+		thinkyoung::lua::lib::add_system_extra_libs(scope.L());
+		GCHECK(thinkyoung::lua::lib::run_compiledfile(scope.L(), "tmp_to_run"));
+		instructions += scope.get_instructions_executed_count();
+	}
+	std::chrono::duration<double> diff = std::chrono::steady_clock::now() - start_time;
+	std::cout << LVM_OPCODE_MIX_TEST_REPEAT_COUNT << " runs of " << report.instructions << " instructions using " << diff.count() << "s, "
+		<< diff.count() * 1e9 / instructions << "ns per instruction including state setup" << std::endl;
+}
+
+// the profile report charges every instruction to one opcode and one function, and counts the chain api calls
+GTEST(TEST_CONTRACT_PROFILER_REPORT)
+{
+	printf("TEST_CONTRACT_PROFILER_REPORT\n");
+	const std::string code = "local function square(x)\n"
+		"  return x * x\n"
+		"end\n"
+		"local s = 0\n"
+		"for i = 1, 100 do s = s + square(i) end\n";
+	thinkyoung::lua::lib::GluaProfileReport report;
+	{
+		thinkyoung::lua::lib::GluaStateScope scope;
+		GCHECK(scope.get_profile_report().instructions == 0);
+		scope.enable_profiler();
+		GCHECK(scope.profiler_enabled());
+		GCHECK_EQUAL(luaL_loadbuffer(scope.L(), code.c_str(), code.size(), "=profiled"), LUA_OK);
+		GCHECK_EQUAL(lua_pcall(scope.L(), 0, 0, 0), LUA_OK);
+		for (int i = 0; i < 3; ++i)
+			thinkyoung::lua::lib::GluaProfilerApiScope api_scope(scope.L(), "test_api");
+		report = scope.get_profile_report();
+		GCHECK_EQUAL(report.instructions, (uint64_t) scope.get_instructions_executed_count());
+	}
+	GCHECK_EQUAL(report.functions.size(), 2);
+	GCHECK(report.functions.find("=profiled:0") != report.functions.end());
+	GCHECK(report.functions.find("=profiled:1") != report.functions.end());
+	// MUL and RETURN in each of the 100 calls of square
+	GCHECK_EQUAL(report.functions["=profiled:1"].count, 200);
+	GCHECK_EQUAL(report.opcodes["MUL"].count, 100);
+	GCHECK_EQUAL(report.opcodes["CALL"].count, 100);
+	uint64_t function_instructions = 0, function_ns = 0, opcode_ns = 0;
+	for (const auto &function : report.functions)
+	{
+		function_instructions += function.second.count;
+		function_ns += function.second.total_ns;
+	}
+	for (const auto &opcode : report.opcodes)
+		opcode_ns += opcode.second.total_ns;
+	GCHECK_EQUAL(function_instructions, report.instructions);
+	GCHECK_EQUAL(function_ns, report.total_ns);
+	GCHECK_EQUAL(opcode_ns, report.total_ns);
+	GCHECK_EQUAL(report.apis.size(), 1);
+	GCHECK_EQUAL(report.apis["test_api"].count, 3);
+	// a state handed out again does not keep profiling
+	{
+		thinkyoung::lua::lib::GluaStateScope scope;
+		GCHECK(!scope.profiler_enabled());
+	}
+	printf("%llu instructions profiled in %lluns\n", (unsigned long long) report.instructions, (unsigned long long) report.total_ns);
+}
+
 
 GTEST(TEST_TYPED_FOR_VARIABLE_1)
 {
@@ -1669,6 +1979,186 @@ GTEST(TEST_TYPED_VARIABLE_SCOPE)
 	printf("executed lua instructions count %d\n", scope.get_instructions_executed_count());
 }
 
+#if defined(_DEBUG)
+#define GLUA_STATE_POOL_RESET_REPEAT_COUNT 100
+#else
+#define GLUA_STATE_POOL_RESET_REPEAT_COUNT 1000
+#endif
+
+static const char *glua_state_pool_dirty_code = R"END(
+	dirty_global = { 1, 2, 3 }
+	for i = 1, 500 do _G['dirty_' .. tostring(i)] = tostring(i) .. 'x' end
+	string.upper = function(s) return s end
+	table.insert = nil
+	package.loaded.dirty_module = { value = 1 }
+	package.loaded.string = nil
+	last_return.value = 5
+	thinkyoung.storage_mt.__index = nil
+	setmetatable(_G, { __index = function(t, k) return 1 end })
+	pairs = nil
+)END";
+
+static const char *glua_state_pool_check_code = R"END(
+	local mt = getmetatable(_G)
+	if mt ~= nil then error('metatable of _G left') end
+	if rawget(_G, 'dirty_global') ~= nil or rawget(_G, 'dirty_1') ~= nil or rawget(_G, 'dirty_500') ~= nil then error('global left') end
+	if string.upper('a') ~= 'A' then error('string.upper left') end
+	if table.insert == nil then error('table.insert not restored') end
+	if package.loaded.dirty_module ~= nil then error('package.loaded left') end
+	if package.loaded.string ~= string then error('package.loaded.string not restored') end
+	if last_return.value ~= nil then error('last_return left') end
+	if thinkyoung.storage_mt.__index == nil then error('storage_mt not restored') end
+	if pairs == nil then error('pairs not restored') end
+)END";
+
+// a released state comes back from the pool as it was created, and the reset is cheaper than a new state
+GTEST(TEST_GLUA_STATE_POOL_RESET)
+{
+	printf("TEST_GLUA_STATE_POOL_RESET\n");
+	auto &pool = thinkyoung::lua::lib::GluaStatePool::instance();
+	pool.clear();
+	lua_State *first = nullptr;
+	size_t baseline_bytes = 0;
+	{
+		thinkyoung::lua::lib::GluaStateScope scope;
+		first = scope.L();
+		baseline_bytes = thinkyoung::lua::lib::GluaStateArena::of(scope.L())->used_bytes();
+		GCHECK_EQUAL(luaL_dostring(scope.L(), glua_state_pool_dirty_code), LUA_OK);
+		GCHECK(lua_malloc(scope.L(), 1024) != nullptr);
+		GCHECK(thinkyoung::lua::lib::GluaStateArena::of(scope.L())->used_bytes() > baseline_bytes);
+	}
+	auto resets = pool.resets();
+	GCHECK(resets > 0);
+	{
+		thinkyoung::lua::lib::GluaStateScope scope;
+		GCHECK(scope.L() == first);
+		GCHECK_EQUAL(thinkyoung::lua::lib::GluaStateArena::of(scope.L())->used_bytes(), baseline_bytes);
+		GCHECK(scope.L()->malloc_buffer == nullptr);
+		int status = luaL_dostring(scope.L(), glua_state_pool_check_code);
+		if (status != LUA_OK)
+			printf("%s\n", lua_tostring(scope.L(), -1));
+		GCHECK_EQUAL(status, LUA_OK);
+	}
+	GCHECK_EQUAL(pool.resets(), resets + 1);
+
+	// the same dirty run on a pooled state and on a state of its own, timing only what is around the run
+	auto reset_time_us = pool.reset_time_us();
+	for (int i = 0; i < GLUA_STATE_POOL_RESET_REPEAT_COUNT; ++i)
+	{
+		thinkyoung::lua::lib::GluaStateScope scope;
+		luaL_dostring(scope.L(), glua_state_pool_dirty_code);
+	}
+	reset_time_us = pool.reset_time_us() - reset_time_us;
+	GCHECK_EQUAL(pool.resets(), resets + 1 + GLUA_STATE_POOL_RESET_REPEAT_COUNT);
+	std::chrono::duration<double> created(0);
+	for (int i = 0; i < GLUA_STATE_POOL_RESET_REPEAT_COUNT; ++i)
+	{
+		auto start_time = std::chrono::steady_clock::now();
+		lua_State *L = thinkyoung::lua::lib::create_lua_state();
+		created += std::chrono::steady_clock::now() - start_time;
+		luaL_dostring(L, glua_state_pool_dirty_code);
+		start_time = std::chrono::steady_clock::now();
+		thinkyoung::lua::lib::close_lua_state(L);
+		created += std::chrono::steady_clock::now() - start_time;
+	}
+	std::cout << GLUA_STATE_POOL_RESET_REPEAT_COUNT << " used states reset in " << reset_time_us << "us, created and closed in "
+		<< (uint64_t)(created.count() * 1000000) << "us" << std::endl;
+	pool.clear();
+}
+
+// modules are found by contract id and code hash, a changed or invalidated contract loads and checks its code again
+GTEST(TEST_GLUA_CONTRACT_MODULE_CACHE)
+{
+	printf("TEST_GLUA_CONTRACT_MODULE_CACHE\n");
+	thinkyoung::lua::lib::GluaContractModuleCache cache(2);
+	auto stream_a = std::make_shared<GluaModuleByteStream>();
+	auto stream_b = std::make_shared<GluaModuleByteStream>();
+	auto stream_c = std::make_shared<GluaModuleByteStream>();
+	GCHECK(cache.get("id_a", "hash_a1") == nullptr);
+	GCHECK_EQUAL(cache.misses(), 1);
+	cache.put("id_a", "hash_a1", stream_a);
+	GCHECK(cache.get("id_a", "hash_a1") == stream_a);
+	GCHECK_EQUAL(cache.hits(), 1);
+	// the code of the contract changed
+	GCHECK(cache.get("id_a", "hash_a2") == nullptr);
+	GCHECK_EQUAL(cache.misses(), 2);
+
+	GCHECK(!cache.is_proto_checked(stream_a.get()));
+	cache.set_proto_checked(stream_a.get());
+	GCHECK(cache.is_proto_checked(stream_a.get()));
+	cache.invalidate("id_a");
+	GCHECK_EQUAL(cache.size(), 0);
+	GCHECK(cache.get("id_a", "hash_a1") == nullptr);
+	GCHECK(!cache.is_proto_checked(stream_a.get()));
+	// a stream put again is checked again
+	cache.put("id_a", "hash_a1", stream_a);
+	GCHECK(!cache.is_proto_checked(stream_a.get()));
+	cache.set_proto_checked(stream_a.get());
+
+	// the least recently used module goes first
+	cache.put("id_b", "hash_b", stream_b);
+	GCHECK(cache.get("id_a", "hash_a1") == stream_a);
+	cache.put("id_c", "hash_c", stream_c);
+	GCHECK_EQUAL(cache.size(), 2);
+	GCHECK(cache.get("id_b", "hash_b") == nullptr);
+	GCHECK(cache.get("id_a", "hash_a1") == stream_a);
+	GCHECK(cache.is_proto_checked(stream_a.get()));
+	GCHECK(cache.get("id_c", "hash_c") == stream_c);
+	// a set_proto_checked after the stream was evicted is dropped
+	cache.set_proto_checked(stream_b.get());
+	cache.put("id_b", "hash_b", stream_b);
+	GCHECK(!cache.is_proto_checked(stream_b.get()));
+
+	cache.clear();
+	GCHECK_EQUAL(cache.size(), 0);
+	GCHECK(cache.get("id_c", "hash_c") == nullptr);
+}
+
+#if defined(_DEBUG)
+#define GLUA_STATE_SLOTS_PERFORMANCE_REPEAT_COUNT 100000
+#else
+#define GLUA_STATE_SLOTS_PERFORMANCE_REPEAT_COUNT 2000000
+#endif
+
+// the values luaV_execute needs per instruction, read through typed slots against the string keys they replace
+GTEST(TEST_GLUA_STATE_SLOTS_PERFORMANCE)
+{
+	printf("TEST_GLUA_STATE_SLOTS_PERFORMANCE\n");
+	thinkyoung::lua::lib::GluaStateScope scope;
+	lua_State *L = scope.L();
+	std::string loop_code = "local s = 0 for i = 1, " + std::to_string(GLUA_STATE_SLOTS_PERFORMANCE_REPEAT_COUNT) + " do s = s + i end";
+	auto start_time = std::chrono::steady_clock::now();
+	GCHECK_EQUAL(luaL_dostring(L, loop_code.c_str()), LUA_OK);
+	std::chrono::duration<double, std::nano> run_time = std::chrono::steady_clock::now() - start_time;
+	int instructions = scope.get_instructions_executed_count();
+	GCHECK(instructions >= GLUA_STATE_SLOTS_PERFORMANCE_REPEAT_COUNT);
+
+	volatile intptr_t sink = 0;
+	start_time = std::chrono::steady_clock::now();
+	for (int i = 0; i < GLUA_STATE_SLOTS_PERFORMANCE_REPEAT_COUNT; ++i)
+	{
+		sink += thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_INSTRUCTIONS_LIMIT).int_value;
+		sink += (intptr_t)thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_INSTRUCTIONS_EXECUTED_COUNT).int_pointer_value;
+		sink += (intptr_t)thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_STOP_IN_LVM).int_pointer_value;
+	}
+	std::chrono::duration<double, std::nano> slot_time = std::chrono::steady_clock::now() - start_time;
+	start_time = std::chrono::steady_clock::now();
+	for (int i = 0; i < GLUA_STATE_SLOTS_PERFORMANCE_REPEAT_COUNT; ++i)
+	{
+		sink += thinkyoung::lua::lib::get_lua_state_value(L, INSTRUCTIONS_LIMIT_LUA_STATE_MAP_KEY).int_value;
+		sink += (intptr_t)thinkyoung::lua::lib::get_lua_state_value(L, INSTRUCTIONS_EXECUTED_COUNT_LUA_STATE_MAP_KEY).int_pointer_value;
+		sink += (intptr_t)thinkyoung::lua::lib::get_lua_state_value(L, LUA_STATE_STOP_TO_RUN_IN_LVM_STATE_MAP_KEY).int_pointer_value;
+	}
+	std::chrono::duration<double, std::nano> key_time = std::chrono::steady_clock::now() - start_time;
+	// both ways read the same values
+	GCHECK_EQUAL(thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_INSTRUCTIONS_EXECUTED_COUNT).int_pointer_value,
+		thinkyoung::lua::lib::get_lua_state_value(L, INSTRUCTIONS_EXECUTED_COUNT_LUA_STATE_MAP_KEY).int_pointer_value);
+	GCHECK(slot_time.count() < key_time.count());
+	printf("%d lua instructions at %.2fns each; the values of one instruction read in %.2fns by slot, %.2fns by string key\n",
+		instructions, run_time.count() / instructions, slot_time.count() / GLUA_STATE_SLOTS_PERFORMANCE_REPEAT_COUNT,
+		key_time.count() / GLUA_STATE_SLOTS_PERFORMANCE_REPEAT_COUNT);
+}
+
 
 // BOOST_AUTO_TEST_SUITE_END()
  
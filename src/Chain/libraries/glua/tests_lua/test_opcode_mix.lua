@@ -0,0 +1,37 @@
+local function fib(n)
+	if n < 2 then
+		return n
+	end
+	return fib(n - 1) + fib(n - 2)
+end
+
+local function counter()
+	local count = 0
+	return function(step)
+		count = count + step
+		return count
+	end
+end
+
+local items = {}
+for i = 1, 40 do
+	items[i] = { id = i, name = "item" .. tostring(i), price = i * 3 % 7 }
+end
+
+local total = 0
+local next_value = counter()
+for i, item in ipairs(items) do
+	if item.price > 3 then
+		total = total + item.price * 2
+	else
+		total = total - item.id // 2
+	end
+	next_value(item.price)
+end
+
+local names = {}
+for k = 1, #items, 4 do
+	names[#names + 1] = items[k].name
+end
+
+result = total + fib(10) + next_value(0) + #table.concat(names, ",")
@@ -17,12 +17,14 @@
 #include "glua/thinkyoung_lua_api.h"
 #include "glua/thinkyoung_lua_lib.h"
 #include "glua/glua_lutil.h"
+#include "glua/glua_contract_module_cache.h"
 #include "glua/lstate.h"
 #include "glua/lobject.h"
 
 #include <blockchain/GluaChainApi.hpp>
 #include <blockchain/Address.hpp>
 #include <blockchain/ChainInterface.hpp>
+#include <blockchain/ForkBlocks.hpp>
 #include <blockchain/StorageOperations.hpp>
 #include <blockchain/TransactionEvaluationState.hpp>
 #include <blockchain/Exceptions.hpp>
@@ -38,8 +40,6 @@ namespace thinkyoung {
 
             // TODO: all these apis need TODO
 
-            static int has_error = 0;
-
 
             static std::string get_file_name_str_from_contract_module_name(std::string name)
             {
@@ -53,7 +53,7 @@ namespace thinkyoung {
             */
             bool GluaChainApi::has_exception(lua_State *L)
             {
-                return has_error ? true : false;
+                return G(L)->chain_api_error ? true : false;
             }
 
             /**
@@ -61,7 +61,7 @@ namespace thinkyoung {
             */
             void GluaChainApi::clear_exceptions(lua_State *L)
             {
-                has_error = 0;
+                G(L)->chain_api_error = 0;
             }
 
             /**
@@ -73,7 +73,7 @@ namespace thinkyoung {
             */
             void GluaChainApi::throw_exception(lua_State *L, int code, const char *error_format, ...)
             {
-                has_error = 1;
+                G(L)->chain_api_error = 1;
                 char *msg = (char*)lua_malloc(L, LUA_EXCEPTION_MULTILINE_STRNG_MAX_LENGTH);
                 memset(msg, 0x0, LUA_EXCEPTION_MULTILINE_STRNG_MAX_LENGTH);
 
@@ -96,7 +96,7 @@ namespace thinkyoung {
 
                 //如果上次的exception code为THINKYOUNG_API_LVM_LIMIT_OVER_ERROR, 不能被其他异常覆盖
                 //只有调用clear清理后，才能继续记录异常
-                int last_code = lua::lib::get_lua_state_value(L, "exception_code").int_value;
+                int last_code = lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EXCEPTION_CODE).int_value;
                 if (last_code == THINKYOUNG_API_LVM_LIMIT_OVER_ERROR
                     && code != THINKYOUNG_API_LVM_LIMIT_OVER_ERROR)
                 {
@@ -109,8 +109,8 @@ namespace thinkyoung {
                 GluaStateValue val_msg;
                 val_msg.string_value = msg;
 
-                lua::lib::set_lua_state_value(L, "exception_code", val_code, GluaStateValueType::LUA_STATE_VALUE_INT);
-                lua::lib::set_lua_state_value(L, "exception_msg", val_msg, GluaStateValueType::LUA_STATE_VALUE_STRING);
+                lua::lib::set_lua_state_value(L, GLUA_STATE_SLOT_EXCEPTION_CODE, val_code, GluaStateValueType::LUA_STATE_VALUE_INT);
+                lua::lib::set_lua_state_value(L, GLUA_STATE_SLOT_EXCEPTION_MSG, val_msg, GluaStateValueType::LUA_STATE_VALUE_STRING);
             }
 
             /**
@@ -125,7 +125,7 @@ namespace thinkyoung {
 
             int GluaChainApi::get_stored_contract_info(lua_State *L, const char *name, std::shared_ptr<GluaContractInfo> contract_info_ret)
             {
-                blockchain::TransactionEvaluationState* pevaluate_state = (blockchain::TransactionEvaluationState*)lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value;
+                blockchain::TransactionEvaluationState* pevaluate_state = (blockchain::TransactionEvaluationState*)lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value;
                 // name = lua::lib::unwrap_any_contract_name(name).c_str();
                 blockchain::oContractEntry entry = pevaluate_state->_current_state->get_contract_entry(name);
                 if (!entry.valid())
@@ -138,7 +138,7 @@ namespace thinkyoung {
 
             int GluaChainApi::get_stored_contract_info_by_address(lua_State *L, const char *address, std::shared_ptr<GluaContractInfo> contract_info_ret)
             {
-                blockchain::TransactionEvaluationState* pevaluate_state = (blockchain::TransactionEvaluationState*)lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value;
+                blockchain::TransactionEvaluationState* pevaluate_state = (blockchain::TransactionEvaluationState*)lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value;
                 blockchain::oContractEntry entry = pevaluate_state->_current_state->get_contract_entry(thinkyoung::blockchain::Address(std::string(address), AddressType::contract_address));
 
                 if (!entry.valid())
@@ -157,7 +157,7 @@ namespace thinkyoung {
             {
                 thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                     (thinkyoung::blockchain::TransactionEvaluationState*)
-                    (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                    (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                 if (!eval_state_ptr)
                 {
@@ -181,7 +181,7 @@ namespace thinkyoung {
             {
                 thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                     (thinkyoung::blockchain::TransactionEvaluationState*)
-                    (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                    (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                 if (!eval_state_ptr)
                     return NULL;
@@ -197,7 +197,7 @@ namespace thinkyoung {
             {
                 thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                     (thinkyoung::blockchain::TransactionEvaluationState*)
-                    (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                    (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                 if (!eval_state_ptr)
                     return NULL;
@@ -233,17 +233,37 @@ namespace thinkyoung {
 
                 return p_luamodule;
             }
+
+            /**
+            * byte stream of a contract on the chain, shared through the contract module cache
+            */
+            static std::shared_ptr<GluaModuleByteStream> get_cached_bytestream(GluaChainApi *api, lua_State *L, const ContractEntry& entry)
+            {
+                auto &cache = thinkyoung::lua::lib::GluaContractModuleCache::instance();
+                const std::string contract_id = entry.id.AddressToString(AddressType::contract_address);
+                const std::string code_hash = entry.code.code_hash.empty() ? entry.code.GetHash() : entry.code.code_hash;
+
+                auto stream = cache.get(contract_id, code_hash);
+                if (stream)
+                    return stream;
+
+                stream = api->get_bytestream_from_code(L, entry.code);
+                cache.put(contract_id, code_hash, stream);
+                return stream;
+            }
+
             /**
             * load contract lua byte stream from thinkyoung api
             */
             std::shared_ptr<GluaModuleByteStream> GluaChainApi::open_contract(lua_State *L, const char *name)
             {
+                thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "open_contract");
                 // FXIME
               thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
 
                 thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                     (thinkyoung::blockchain::TransactionEvaluationState*)
-                    (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                    (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                 if (!eval_state_ptr)
                     return NULL;
@@ -253,7 +273,7 @@ namespace thinkyoung {
                 oContractEntry entry = cur_state->get_contract_entry(std::string(name));
                 if (entry.valid() && (entry->code.byte_code.size() <= LUA_MODULE_BYTE_STREAM_BUF_SIZE))
                 {
-                    return get_bytestream_from_code(L, entry->code);
+                    return get_cached_bytestream(this, L, *entry);
                 }
 
                 return NULL;
@@ -261,10 +281,11 @@ namespace thinkyoung {
 
             std::shared_ptr<GluaModuleByteStream> GluaChainApi::open_contract_by_address(lua_State *L, const char *address)
             {
+              thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "open_contract_by_address");
               thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
                 thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                     (thinkyoung::blockchain::TransactionEvaluationState*)
-                    (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                    (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                 if (!eval_state_ptr)
                     return NULL;
@@ -274,7 +295,7 @@ namespace thinkyoung {
                 oContractEntry entry = cur_state->get_contract_entry(thinkyoung::blockchain::Address(std::string(address), AddressType::contract_address));
                 if (entry.valid() && (entry->code.byte_code.size() <= LUA_MODULE_BYTE_STREAM_BUF_SIZE))
                 {
-                    return get_bytestream_from_code(L, entry->code);
+                    return get_cached_bytestream(this, L, *entry);
                 }
 
                 return NULL;
@@ -287,7 +308,7 @@ namespace thinkyoung {
 
                 thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                     (thinkyoung::blockchain::TransactionEvaluationState*)
-                    (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                    (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                 if (!eval_state_ptr)
                     return null_storage;
@@ -304,40 +325,46 @@ namespace thinkyoung {
 
             GluaStorageValue GluaChainApi::get_storage_value_from_thinkyoung_by_address(lua_State *L, const char *contract_address, std::string name)
             {
+                thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "get_storage_value_from_thinkyoung_by_address");
                 GluaStorageValue null_storage;
                 null_storage.type = thinkyoung::blockchain::StorageValueTypes::storage_value_null;
 
                 thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                     (thinkyoung::blockchain::TransactionEvaluationState*)
-                    (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                    (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                 if (!eval_state_ptr)
                     return null_storage;
 
-                thinkyoung::blockchain::ChainInterface* cur_state = eval_state_ptr->_current_state;
-
-                oContractStorage entry = cur_state->get_contractstorage_entry(Address(std::string(contract_address), AddressType::contract_address));
-                if (NOT entry.valid())
+                oContractStorageItem item = eval_state_ptr->get_cached_contractstorage_item(Address(std::string(contract_address), AddressType::contract_address), name);
+                if (NOT item.valid())
                     return null_storage;
 
-                auto iter = entry->contract_storages.find(std::string(name));
-                if (iter == entry->contract_storages.end())
-                    return null_storage;
-
-                thinkyoung::blockchain::StorageDataType storage_data = iter->second;
+                thinkyoung::blockchain::StorageDataType storage_data = item->storage_data;
 
                 return thinkyoung::blockchain::StorageDataType::create_lua_storage_from_storage_data(L, storage_data);
             }
 
+            static bool is_patchable_storage_type(StorageValueTypes type)
+            {
+                return (StorageDataType::is_table_type(type) || StorageDataType::is_array_type(type))
+                    && type != StorageValueTypes::storage_value_unknown_table
+                    && type != StorageValueTypes::storage_value_unknown_array;
+            }
+
             bool GluaChainApi::commit_storage_changes_to_thinkyoung(lua_State *L, AllContractsChangesMap &changes)
             {
+                thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "commit_storage_changes_to_thinkyoung");
                 thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                     (thinkyoung::blockchain::TransactionEvaluationState*)
-                    (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                    (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                 if (!eval_state_ptr)
                     return false;
 
+                // after activation, a table/array storage keeping its type is committed as a patch of the changed entries
+                const bool use_table_patch = eval_state_ptr->_current_state->get_head_block_num() >= ALP_STORAGE_TABLE_PATCH_BLOCK_NUM;
+
                 for (auto all_con_chg_iter = changes.begin(); all_con_chg_iter != changes.end(); ++all_con_chg_iter)
                 {
                     StorageOperation storage_op;
@@ -350,9 +377,27 @@ namespace thinkyoung {
                     {
                         std::string contract_name = con_chg_iter->first;
 
+                        const auto& before = con_chg_iter->second.before;
+                        const auto& after = con_chg_iter->second.after;
+
                         StorageDataChangeType storage_change;
-                        storage_change.storage_before = StorageDataType::get_storage_data_from_lua_storage(con_chg_iter->second.before);
-                        storage_change.storage_after = StorageDataType::get_storage_data_from_lua_storage(con_chg_iter->second.after);
+                        if (use_table_patch && before.type == after.type && is_patchable_storage_type(after.type))
+                        {
+                            // before and after only hold the entries changed by the call here
+                            StorageTablePatchType patch;
+                            patch.changed_items = StorageDataType::get_storage_data_from_lua_storage(after);
+                            for (const auto& item : *before.value.table_value)
+                            {
+                                if (after.value.table_value->find(item.first) == after.value.table_value->end())
+                                    patch.removed_keys.insert(item.first);
+                            }
+                            storage_change.storage_after = StorageDataType(patch);
+                        }
+                        else
+                        {
+                            storage_change.storage_before = StorageDataType::get_storage_data_from_lua_storage(before);
+                            storage_change.storage_after = StorageDataType::get_storage_data_from_lua_storage(after);
+                        }
 
                         storage_op.contract_change_storages.insert(make_pair(contract_name, storage_change));
                     }
@@ -373,7 +418,7 @@ namespace thinkyoung {
 
             intptr_t GluaChainApi::register_object_in_pool(lua_State *L, intptr_t object_addr, GluaOutsideObjectTypes type)
 			{
-				auto node = thinkyoung::lua::lib::get_lua_state_value_node(L, GLUA_OUTSIDE_OBJECT_POOLS_KEY);
+				auto node = thinkyoung::lua::lib::get_lua_state_value_node(L, GLUA_STATE_SLOT_OUTSIDE_OBJECT_POOLS);
 				// Map<type, Map<object_key, object_addr>>
 				std::map<GluaOutsideObjectTypes, std::shared_ptr<std::map<intptr_t, intptr_t>>> *object_pools = nullptr;
 				if (node.type == GluaStateValueType::LUA_STATE_VALUE_nullptr)
@@ -381,7 +426,7 @@ namespace thinkyoung {
 					node.type = GluaStateValueType::LUA_STATE_VALUE_POINTER;
 					object_pools = new std::map<GluaOutsideObjectTypes, std::shared_ptr<std::map<intptr_t, intptr_t>>>();
 					node.value.pointer_value = (void*)object_pools;
-					thinkyoung::lua::lib::set_lua_state_value(L, GLUA_OUTSIDE_OBJECT_POOLS_KEY, node.value, node.type);
+					thinkyoung::lua::lib::set_lua_state_value(L, GLUA_STATE_SLOT_OUTSIDE_OBJECT_POOLS, node.value, node.type);
 				}
 				else
 				{
@@ -399,7 +444,7 @@ namespace thinkyoung {
 
             intptr_t GluaChainApi::is_object_in_pool(lua_State *L, intptr_t object_key, GluaOutsideObjectTypes type)
 			{
-				auto node = thinkyoung::lua::lib::get_lua_state_value_node(L, GLUA_OUTSIDE_OBJECT_POOLS_KEY);
+				auto node = thinkyoung::lua::lib::get_lua_state_value_node(L, GLUA_STATE_SLOT_OUTSIDE_OBJECT_POOLS);
 				// Map<type, Map<object_key, object_addr>>
 				std::map<GluaOutsideObjectTypes, std::shared_ptr<std::map<intptr_t, intptr_t>>> *object_pools = nullptr;
 				if (node.type == GluaStateValueType::LUA_STATE_VALUE_nullptr)
@@ -420,7 +465,7 @@ namespace thinkyoung {
 
             void GluaChainApi::release_objects_in_pool(lua_State *L)
 			{
-				auto node = thinkyoung::lua::lib::get_lua_state_value_node(L, GLUA_OUTSIDE_OBJECT_POOLS_KEY);
+				auto node = thinkyoung::lua::lib::get_lua_state_value_node(L, GLUA_STATE_SLOT_OUTSIDE_OBJECT_POOLS);
 				// Map<type, Map<object_key, object_addr>>
 				std::map<GluaOutsideObjectTypes, std::shared_ptr<std::map<intptr_t, intptr_t>>> *object_pools = nullptr;
 				if (node.type == GluaStateValueType::LUA_STATE_VALUE_nullptr)
@@ -455,12 +500,13 @@ namespace thinkyoung {
 				delete object_pools;
 				GluaStateValue null_state_value;
 				null_state_value.int_value = 0;
-				thinkyoung::lua::lib::set_lua_state_value(L, GLUA_OUTSIDE_OBJECT_POOLS_KEY, null_state_value, GluaStateValueType::LUA_STATE_VALUE_nullptr);
+				thinkyoung::lua::lib::set_lua_state_value(L, GLUA_STATE_SLOT_OUTSIDE_OBJECT_POOLS, null_state_value, GluaStateValueType::LUA_STATE_VALUE_nullptr);
 			}
 
             lua_Integer GluaChainApi::transfer_from_contract_to_address(lua_State *L, const char *contract_address, const char *to_address,
                 const char *asset_type, int64_t amount)
             {
+              thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "transfer_from_contract_to_address");
               thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
                 //printf("contract transfer from %s to %s, asset[%s] amount %ld\n", contract_address, to_address, asset_type, amount_str);
                 //return true;
@@ -469,7 +515,7 @@ namespace thinkyoung {
                     return -6;
                 thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                     (thinkyoung::blockchain::TransactionEvaluationState*)
-                    (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                    (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                 if (!eval_state_ptr)
                 {
@@ -519,10 +565,11 @@ namespace thinkyoung {
             lua_Integer GluaChainApi::transfer_from_contract_to_public_account(lua_State *L, const char *contract_address, const char *to_account_name,
                 const char *asset_type, int64_t amount)
             {
+              thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "transfer_from_contract_to_public_account");
               thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
                 thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                     (thinkyoung::blockchain::TransactionEvaluationState*)
-                    (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                    (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                 if (!eval_state_ptr || !eval_state_ptr->_current_state)
                 {
@@ -540,11 +587,12 @@ namespace thinkyoung {
 
             int64_t GluaChainApi::get_contract_balance_amount(lua_State *L, const char *contract_address, const char* asset_symbol)
             {
+              thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "get_contract_balance_amount");
               thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
                 try{
                     thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                         (thinkyoung::blockchain::TransactionEvaluationState*)
-                        (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                        (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
                     thinkyoung::blockchain::ChainInterface* cur_state;
                     if (!eval_state_ptr || (cur_state = eval_state_ptr->_current_state) == NULL)
                     {
@@ -595,11 +643,12 @@ namespace thinkyoung {
 
             int64_t GluaChainApi::get_transaction_fee(lua_State *L)
             {
+              thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "get_transaction_fee");
               thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
                 try{
                     thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                         (thinkyoung::blockchain::TransactionEvaluationState*)
-                        (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                        (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
                     ChainInterface*  db_interface = NULL;
                     if (!eval_state_ptr || !(db_interface = eval_state_ptr->_current_state))
                     {
@@ -623,11 +672,12 @@ namespace thinkyoung {
 
             uint32_t GluaChainApi::get_chain_now(lua_State *L)
             {
+              thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "get_chain_now");
               thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
                 try{
                     thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                         (thinkyoung::blockchain::TransactionEvaluationState*)
-                        (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                        (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
                     thinkyoung::blockchain::ChainInterface* cur_state;
                     if (!eval_state_ptr || !(cur_state = eval_state_ptr->_current_state))
                     {
@@ -645,11 +695,12 @@ namespace thinkyoung {
             }
             uint32_t GluaChainApi::get_chain_random(lua_State *L)
             {
+              thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "get_chain_random");
               thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
                 try{
                     thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                         (thinkyoung::blockchain::TransactionEvaluationState*)
-                        (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                        (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
                     thinkyoung::blockchain::ChainInterface* cur_state;
                     if (!eval_state_ptr || !(cur_state = eval_state_ptr->_current_state))
                     {
@@ -669,11 +720,12 @@ namespace thinkyoung {
 
             std::string GluaChainApi::get_transaction_id(lua_State *L)
             {
+              thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "get_transaction_id");
               thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
                 try{
                     thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                         (thinkyoung::blockchain::TransactionEvaluationState*)
-                        (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                        (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                     if (!eval_state_ptr)
                         FC_CAPTURE_AND_THROW(lua_executor_internal_error, (""));
@@ -690,11 +742,12 @@ namespace thinkyoung {
 
             uint32_t GluaChainApi::get_header_block_num(lua_State *L)
             {
+              thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "get_header_block_num");
               thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
                 try{
                     thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                         (thinkyoung::blockchain::TransactionEvaluationState*)
-                        (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                        (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                     if (!eval_state_ptr || !eval_state_ptr->_current_state)
                         FC_CAPTURE_AND_THROW(lua_executor_internal_error, (""));
@@ -710,11 +763,12 @@ namespace thinkyoung {
 
             uint32_t GluaChainApi::wait_for_future_random(lua_State *L, int next)
             {
+              thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "wait_for_future_random");
               thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
                 try{
                     thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                         (thinkyoung::blockchain::TransactionEvaluationState*)
-                        (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                        (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                     if (!eval_state_ptr || !eval_state_ptr->_current_state)
                         FC_CAPTURE_AND_THROW(lua_executor_internal_error, (""));
@@ -736,13 +790,14 @@ namespace thinkyoung {
             //如投注彩票，只允许在目标块被产出前投注
             int32_t GluaChainApi::get_waited(lua_State *L, uint32_t num)
             {
+              thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "get_waited");
               thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
                 try{
                     if (num <= 1)
                         return -2;
                     thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                         (thinkyoung::blockchain::TransactionEvaluationState*)
-                        (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                        (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
                     thinkyoung::blockchain::ChainInterface* cur_state;
                     if (!eval_state_ptr || !(cur_state = eval_state_ptr->_current_state))
                         FC_CAPTURE_AND_THROW(lua_executor_internal_error, (""));
@@ -774,11 +829,12 @@ namespace thinkyoung {
 
             void GluaChainApi::emit(lua_State *L, const char* contract_id, const char* event_name, const char* event_param)
             {
+              thinkyoung::lua::lib::GluaProfilerApiScope profiler_scope(L, "emit");
               thinkyoung::lua::lib::increment_lvm_instructions_executed_count(L, CHAIN_GLUA_API_EACH_INSTRUCTIONS_COUNT - 1);
                 try {
                     thinkyoung::blockchain::TransactionEvaluationState* eval_state_ptr =
                         (thinkyoung::blockchain::TransactionEvaluationState*)
-                        (thinkyoung::lua::lib::get_lua_state_value(L, "evaluate_state").pointer_value);
+                        (thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_EVALUATE_STATE).pointer_value);
 
                     if (eval_state_ptr == NULL)
                         FC_CAPTURE_AND_THROW(lua_executor_internal_error, (""));
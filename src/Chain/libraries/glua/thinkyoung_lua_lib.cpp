@@ -22,6 +22,7 @@
 #include <glua/lparsercombinator.h>
 #include <glua/ltypechecker.h>
 #include <glua/glua_lutil.h>
+#include <glua/glua_state_arena.h>
 #include <glua/lobject.h>
 #include <glua/lzio.h>
 #include <glua/lundump.h>
@@ -333,35 +334,25 @@ next: (table) => bool
                 return &globalvar_type_infos;
             }
             
-            typedef lua_State* L_Key1;
-            
-            typedef std::unordered_map<std::string, GluaStateValueNode> L_VM1;
-            
-            typedef std::shared_ptr<L_VM1> L_V1;
-            
-            typedef std::unordered_map<L_Key1, L_V1> LStatesMap;
-            
-            static LStatesMap states_map;
-            
-            static LStatesMap *get_lua_states_value_hashmap() {
-                return &states_map;
-            }
-            
-            static std::mutex states_map_mutex;
+            // string keys of the values that have a slot in GluaStateContext
+            static const std::unordered_map<std::string, GluaStateSlot> lua_state_slot_keys = {
+                { "evaluate_state", GLUA_STATE_SLOT_EVALUATE_STATE },
+                { INSTRUCTIONS_LIMIT_LUA_STATE_MAP_KEY, GLUA_STATE_SLOT_INSTRUCTIONS_LIMIT },
+                { INSTRUCTIONS_EXECUTED_COUNT_LUA_STATE_MAP_KEY, GLUA_STATE_SLOT_INSTRUCTIONS_EXECUTED_COUNT },
+                { LUA_STATE_STOP_TO_RUN_IN_LVM_STATE_MAP_KEY, GLUA_STATE_SLOT_STOP_IN_LVM },
+                { "exception_code", GLUA_STATE_SLOT_EXCEPTION_CODE },
+                { "exception_msg", GLUA_STATE_SLOT_EXCEPTION_MSG },
+                { LUA_STORAGE_CHANGELIST_KEY, GLUA_STATE_SLOT_STORAGE_CHANGELIST },
+                { LUA_STORAGE_READ_TABLES_KEY, GLUA_STATE_SLOT_STORAGE_READ_TABLES },
+                { GLUA_OUTSIDE_OBJECT_POOLS_KEY, GLUA_STATE_SLOT_OUTSIDE_OBJECT_POOLS },
+                { STARTING_CONTRACT_ADDRESS, GLUA_STATE_SLOT_STARTING_CONTRACT_ADDRESS }
+            };
             
-            static L_V1 create_value_map_for_lua_state(lua_State *L) {
-                LStatesMap *states_map = get_lua_states_value_hashmap();
-                auto it = states_map->find(L);
-                
-                if (it == states_map->end()) {
-                    states_map_mutex.lock();
-                    L_V1 map = std::make_shared<L_VM1>();
-                    states_map->insert(std::make_pair(L, map));
-                    states_map_mutex.unlock();
-                    return map;
+            static GluaStateContext *get_lua_state_context(lua_State *L) {
+                if (nullptr == L->context)
+                    L->context = new GluaStateContext();
                     
-                } else
-                    return it->second;
+                return L->context;
             }
             
             // 从当前合约总转账到
@@ -892,12 +883,7 @@ next: (table) => bool
                 auto ret_count = glua::lib::thinkyounglib_get_storage_impl(L, contract_id, key); // top=ret_count + 4
                 
                 if(ret_count>0) {
-                    auto tmp_global_key = "_glua_core_lib_thinkyoung_get_storage_tmp_value";
-                    lua_setglobal(L, tmp_global_key); // top=ret_count + 3
-                    lua_pop(L, ret_count + 1); // top=2
-                    lua_getglobal(L, tmp_global_key); // top=3
-                    lua_pushnil(L); // top=4
-                    lua_setglobal(L, tmp_global_key); // top=3
+                    // the value is on the top of the stack, return it directly
                     return 1;
                     
                 } else {
@@ -987,7 +973,7 @@ end
 
             lua_State *create_lua_state(bool use_contract)
             {
-                lua_State *L = luaL_newstate();
+                lua_State *L = luaL_newstate_with_arena(GLUA_STATE_UNLIMITED_MEMORY);
                 luaL_openlibs(L);
                 // run init lua code here, eg. init storage api, load some modules
                 add_global_c_function(L, "debugger", &enter_lua_debugger);
@@ -1088,11 +1074,15 @@ end
             }
 
             void close_lua_state(lua_State *L) {
+                release_lua_state_values(L);
+                lua_close(L);
+            }
+
+            void release_lua_state_values(lua_State *L) {
                 luaL_commit_storage_changes(L);
                 thinkyoung::lua::api::global_glua_chain_api->release_objects_in_pool(L);
-                LStatesMap *states_map = get_lua_states_value_hashmap();
 
-                if (nullptr != states_map) {
+                if (nullptr != L->context) {
                     auto lua_table_map_list_p = get_lua_state_value(L, LUA_TABLE_MAP_LIST_STATE_MAP_KEY).pointer_value;
 
                     if (nullptr != lua_table_map_list_p) {
@@ -1108,9 +1098,14 @@ end
                         delete list_p;
                     }
 
-                    L_V1 map = create_value_map_for_lua_state(L);
+                    for (auto &node : L->context->slots) {
+                        if (node.type == LUA_STATE_VALUE_INT_POINTER) {
+                            lua_free(L, node.value.int_pointer_value);
+                            node.value.int_pointer_value = nullptr;
+                        }
+                    }
 
-                    for (auto it = map->begin(); it != map->end(); ++it) {
+                    for (auto it = L->context->values.begin(); it != L->context->values.end(); ++it) {
                         if (it->second.type == LUA_STATE_VALUE_INT_POINTER) {
                             lua_free(L, it->second.value.int_pointer_value);
                             it->second.value.int_pointer_value = nullptr;
@@ -1118,7 +1113,7 @@ end
                     }
 
                     // close values in state values(some pointers need free), eg. storage infos, contract infos
-                    GluaStateValueNode storage_changelist_node = get_lua_state_value_node(L, LUA_STORAGE_CHANGELIST_KEY);
+                    GluaStateValueNode storage_changelist_node = get_lua_state_value_node(L, GLUA_STATE_SLOT_STORAGE_CHANGELIST);
 
                     if (storage_changelist_node.type == LUA_STATE_VALUE_POINTER && nullptr != storage_changelist_node.value.pointer_value) {
                         GluaStorageChangeList *list = (GluaStorageChangeList*)storage_changelist_node.value.pointer_value;
@@ -1140,7 +1135,7 @@ end
                         lua_free(L, list);
                     }
 
-                    GluaStateValueNode storage_table_read_list_node = get_lua_state_value_node(L, LUA_STORAGE_READ_TABLES_KEY);
+                    GluaStateValueNode storage_table_read_list_node = get_lua_state_value_node(L, GLUA_STATE_SLOT_STORAGE_READ_TABLES);
 
                     if (storage_table_read_list_node.type == LUA_STATE_VALUE_POINTER && nullptr != storage_table_read_list_node.value.pointer_value) {
                         GluaStorageTableReadList *list = (GluaStorageTableReadList*)storage_table_read_list_node.value.pointer_value;
@@ -1154,13 +1149,13 @@ end
                         lua_free(L, repl_state_node.value.int_pointer_value);
                     }
 
-                    int *insts_executed_count = get_lua_state_value(L, INSTRUCTIONS_EXECUTED_COUNT_LUA_STATE_MAP_KEY).int_pointer_value;
+                    int *insts_executed_count = get_lua_state_value(L, GLUA_STATE_SLOT_INSTRUCTIONS_EXECUTED_COUNT).int_pointer_value;
 
                     if (nullptr != insts_executed_count) {
                         lua_free(L, insts_executed_count);
                     }
 
-                    int *stopped_pointer = thinkyoung::lua::lib::get_lua_state_value(L, LUA_STATE_STOP_TO_RUN_IN_LVM_STATE_MAP_KEY).int_pointer_value;
+                    int *stopped_pointer = thinkyoung::lua::lib::get_lua_state_value(L, GLUA_STATE_SLOT_STOP_IN_LVM).int_pointer_value;
 
                     if (nullptr != stopped_pointer) {
                         lua_free(L, stopped_pointer);
@@ -1172,22 +1167,34 @@ end
                         lua_free(L, repl_running_node.value.int_pointer_value);
                     }
 
-                    states_map->erase(L);
+                    close_lua_state_values(L);
                 }
-
-                lua_close(L);
             }
 
             /**
             * share some values in L
             */
             void close_all_lua_state_values() {
-                LStatesMap *states_map = get_lua_states_value_hashmap();
-                states_map->clear();
+                // values are owned by their lua_State and released in close_lua_state_values
             }
             void close_lua_state_values(lua_State *L) {
-                LStatesMap *states_map = get_lua_states_value_hashmap();
-                states_map->erase(L);
+                delete L->context;
+                L->context = nullptr;
+            }
+
+            GluaStateValueNode get_lua_state_value_node(lua_State *L, GluaStateSlot slot) {
+                GluaStateValueNode nil_value_node;
+                memset(&nil_value_node, 0x0, sizeof(nil_value_node));
+
+                if (nullptr == L || nullptr == L->context || slot < 0 || slot >= GLUA_STATE_SLOT_COUNT) {
+                    return nil_value_node;
+                }
+
+                return L->context->slots[slot];
+            }
+
+            GluaStateValue get_lua_state_value(lua_State *L, GluaStateSlot slot) {
+                return get_lua_state_value_node(L, slot).value;
             }
 
             GluaStateValueNode get_lua_state_value_node(lua_State *L, const char *key) {
@@ -1200,16 +1207,22 @@ end
                     return nil_value_node;
                 }
 
-                LStatesMap *states_map = get_lua_states_value_hashmap();
-                L_V1 map = create_value_map_for_lua_state(L);
                 std::string key_str(key);
-                auto it = map->find(key_str);
+                auto slot_it = lua_state_slot_keys.find(key_str);
+
+                if (slot_it != lua_state_slot_keys.end())
+                    return get_lua_state_value_node(L, slot_it->second);
+
+                if (nullptr == L->context)
+                    return nil_value_node;
+
+                auto it = L->context->values.find(key_str);
 
-                if (it == map->end())
+                if (it == L->context->values.end())
                     return nil_value_node;
 
                 else
-                    return map->at(key_str);
+                    return it->second;
             }
 
             GluaStateValue get_lua_state_value(lua_State *L, const char *key) {
@@ -1217,15 +1230,39 @@ end
             }
             void set_lua_state_instructions_limit(lua_State *L, int limit) {
                 GluaStateValue value = { limit };
-                set_lua_state_value(L, INSTRUCTIONS_LIMIT_LUA_STATE_MAP_KEY, value, LUA_STATE_VALUE_INT);
+                set_lua_state_value(L, GLUA_STATE_SLOT_INSTRUCTIONS_LIMIT, value, LUA_STATE_VALUE_INT);
             }
 
             int get_lua_state_instructions_limit(lua_State *L) {
-                return get_lua_state_value(L, INSTRUCTIONS_LIMIT_LUA_STATE_MAP_KEY).int_value;
+                return get_lua_state_value(L, GLUA_STATE_SLOT_INSTRUCTIONS_LIMIT).int_value;
+            }
+
+            void set_lua_state_memory_limit(lua_State *L, size_t limit) {
+                auto arena = GluaStateArena::of(L);
+
+                if (nullptr != arena)
+                    arena->set_memory_limit(limit);
+            }
+
+            size_t get_lua_state_memory_limit(lua_State *L) {
+                auto arena = GluaStateArena::of(L);
+                return nullptr != arena ? arena->memory_limit() : 0;
+            }
+
+            size_t get_lua_state_memory_peak(lua_State *L) {
+                auto arena = GluaStateArena::of(L);
+                return nullptr != arena ? arena->peak_bytes() : 0;
+            }
+
+            void reset_lua_state_memory_peak(lua_State *L) {
+                auto arena = GluaStateArena::of(L);
+
+                if (nullptr != arena)
+                    arena->reset_peak();
             }
 
             int get_lua_state_instructions_executed_count(lua_State *L) {
-                int *insts_executed_count = get_lua_state_value(L, INSTRUCTIONS_EXECUTED_COUNT_LUA_STATE_MAP_KEY).int_pointer_value;
+                int *insts_executed_count = get_lua_state_value(L, GLUA_STATE_SLOT_INSTRUCTIONS_EXECUTED_COUNT).int_pointer_value;
 
                 if (nullptr == insts_executed_count) {
                     return 0;
@@ -1258,14 +1295,14 @@ end
             * notify lvm to stop running the lua stack
             */
             void notify_lua_state_stop(lua_State *L) {
-                int *pointer = get_lua_state_value(L, LUA_STATE_STOP_TO_RUN_IN_LVM_STATE_MAP_KEY).int_pointer_value;
+                int *pointer = get_lua_state_value(L, GLUA_STATE_SLOT_STOP_IN_LVM).int_pointer_value;
 
                 if (nullptr == pointer) {
                     pointer = (int*)lua_malloc(L, sizeof(int));
                     *pointer = 1;
                     GluaStateValue value;
                     value.int_pointer_value = pointer;
-                    set_lua_state_value(L, LUA_STATE_STOP_TO_RUN_IN_LVM_STATE_MAP_KEY, value, LUA_STATE_VALUE_INT_POINTER);
+                    set_lua_state_value(L, GLUA_STATE_SLOT_STOP_IN_LVM, value, LUA_STATE_VALUE_INT_POINTER);
 
                 } else {
                     *pointer = 1;
@@ -1276,7 +1313,7 @@ end
             * check whether the lua state notified stop before
             */
             bool check_lua_state_notified_stop(lua_State *L) {
-                int *pointer = get_lua_state_value(L, LUA_STATE_STOP_TO_RUN_IN_LVM_STATE_MAP_KEY).int_pointer_value;
+                int *pointer = get_lua_state_value(L, GLUA_STATE_SLOT_STOP_IN_LVM).int_pointer_value;
 
                 if (nullptr == pointer)
                     return false;
@@ -1288,19 +1325,41 @@ end
             * resume lua_State to be available running again
             */
             void resume_lua_state_running(lua_State *L) {
-                int *pointer = get_lua_state_value(L, LUA_STATE_STOP_TO_RUN_IN_LVM_STATE_MAP_KEY).int_pointer_value;
+                int *pointer = get_lua_state_value(L, GLUA_STATE_SLOT_STOP_IN_LVM).int_pointer_value;
 
                 if (nullptr != pointer) {
                     *pointer = 0;
                 }
             }
 
+            void set_lua_state_value(lua_State *L, GluaStateSlot slot, GluaStateValue value, enum GluaStateValueType type) {
+                if (nullptr == L || slot < 0 || slot >= GLUA_STATE_SLOT_COUNT) {
+                    return;
+                }
+
+                GluaStateValueNode node_v;
+                node_v.type = type;
+                node_v.value = value;
+
+                if (node_v.type == LUA_STATE_VALUE_STRING)
+                    node_v.value.string_value = thinkyoung::lua::lib::malloc_and_copy_string(L, value.string_value);
+
+                get_lua_state_context(L)->slots[slot] = node_v;
+            }
+
             void set_lua_state_value(lua_State *L, const char *key, GluaStateValue value, enum GluaStateValueType type) {
                 if (nullptr == L || nullptr == key || strlen(key) < 1) {
                     return;
                 }
 
-                L_V1 map = create_value_map_for_lua_state(L);
+                std::string key_str(key);
+                auto slot_it = lua_state_slot_keys.find(key_str);
+
+                if (slot_it != lua_state_slot_keys.end()) {
+                    set_lua_state_value(L, slot_it->second, value, type);
+                    return;
+                }
+
                 GluaStateValueNode node_v;
                 node_v.type = type;
                 node_v.value = value;
@@ -1308,9 +1367,7 @@ end
                 if (node_v.type == LUA_STATE_VALUE_STRING)
                     node_v.value.string_value = thinkyoung::lua::lib::malloc_and_copy_string(L, value.string_value);
 
-                std::string key_str(key);
-                map->erase(key_str);
-                map->insert(std::make_pair(key_str, node_v));
+                get_lua_state_context(L)->values[key_str] = node_v;
             }
 
             static const char* reader_of_stream(lua_State *L, void *ud, size_t *size) {
@@ -2343,7 +2400,7 @@ end
 
             void reset_lvm_instructions_executed_count(lua_State *L)
             {
-                int *insts_executed_count = get_lua_state_value(L, INSTRUCTIONS_EXECUTED_COUNT_LUA_STATE_MAP_KEY).int_pointer_value;
+                int *insts_executed_count = get_lua_state_value(L, GLUA_STATE_SLOT_INSTRUCTIONS_EXECUTED_COUNT).int_pointer_value;
                 if (insts_executed_count)
                 {
                     *insts_executed_count = 0;
@@ -2352,7 +2409,7 @@ end
 
             void increment_lvm_instructions_executed_count(lua_State *L, int add_count)
             {
-              int *insts_executed_count = get_lua_state_value(L, INSTRUCTIONS_EXECUTED_COUNT_LUA_STATE_MAP_KEY).int_pointer_value;
+              int *insts_executed_count = get_lua_state_value(L, GLUA_STATE_SLOT_INSTRUCTIONS_EXECUTED_COUNT).int_pointer_value;
               if (insts_executed_count)
               {
                 *insts_executed_count = *insts_executed_count + add_count;
@@ -2370,7 +2427,7 @@ end
                 {
                     GluaStateValue value;
                     value.string_value = contract_address;
-                    set_lua_state_value(L, STARTING_CONTRACT_ADDRESS, value, LUA_STATE_VALUE_STRING);
+                    set_lua_state_value(L, GLUA_STATE_SLOT_STARTING_CONTRACT_ADDRESS, value, LUA_STATE_VALUE_STRING);
                 }
                 return lua_execute_contract_api(L, contract_name, api_name, arg1, result_json_string);
             }
@@ -2383,7 +2440,7 @@ end
                 memset(str, 0x0, strlen(contract_address) + 1);
                 strncpy(str, contract_address, strlen(contract_address));
                 value.string_value = str;
-                set_lua_state_value(L, STARTING_CONTRACT_ADDRESS, value, LUA_STATE_VALUE_STRING);
+                set_lua_state_value(L, GLUA_STATE_SLOT_STARTING_CONTRACT_ADDRESS, value, LUA_STATE_VALUE_STRING);
                 return lua_execute_contract_api_by_address(L, contract_address, api_name, arg1, result_json_string);
             }
 
@@ -2401,7 +2458,7 @@ end
 
             std::string get_starting_contract_address(lua_State *L)
             {
-                auto starting_contract_address_node = thinkyoung::lua::lib::get_lua_state_value_node(L, STARTING_CONTRACT_ADDRESS);
+                auto starting_contract_address_node = thinkyoung::lua::lib::get_lua_state_value_node(L, GLUA_STATE_SLOT_STARTING_CONTRACT_ADDRESS);
                 if (starting_contract_address_node.type == GluaStateValueType::LUA_STATE_VALUE_STRING)
                 {
                     return starting_contract_address_node.value.string_value;
@@ -95,6 +95,14 @@ namespace thinkyoung {
              * @return uint32_t
              */
             virtual uint32_t blockchain_get_block_count() const = 0;
+            /**
+             * Converts time ranges into the first and last block produced within each of them, 0 and 0 when a range holds no block.
+             *
+             * @param time_ranges pairs of first and last time, both included (time_range_array, required)
+             *
+             * @return block_range_array
+             */
+            virtual std::vector<std::pair<uint32_t, uint32_t>> blockchain_get_block_ranges_by_time(const std::vector<std::pair<fc::time_point, fc::time_point>>& time_ranges) const = 0;
             /**
              * Returns information about blockchain security level.
              *
@@ -243,6 +251,17 @@ namespace thinkyoung {
              * @return variant_object
              */
             virtual fc::variant_object blockchain_list_address_transactions(const std::string& addr, uint32_t filter_before = fc::json::from_string("\"0\"").as<uint32_t>()) const = 0;
+            /**
+             * Lists one page of the transactions involving an address, pages end on whole blocks.
+             *
+             * @param addr address to scan for (string, required)
+             * @param since_block first block to list, or the newest when reverse; 0 for no bound (uint32_t, optional, defaults to 0)
+             * @param limit transactions to list before stopping at the end of a block (uint32_t, optional, defaults to 100)
+             * @param reverse list the newest transactions first (bool, optional, defaults to false)
+             *
+             * @return transaction_entry_array
+             */
+            virtual std::vector<thinkyoung::blockchain::TransactionEntry> blockchain_list_address_transactions_paged(const std::string& addr, uint32_t since_block = fc::json::from_string("0").as<uint32_t>(), uint32_t limit = fc::json::from_string("100").as<uint32_t>(), bool reverse = fc::json::from_string("false").as<bool>()) const = 0;
             /**
              * Get the account entry for a given name.
              *
@@ -421,6 +440,18 @@ namespace thinkyoung {
              * @return eventoperation_array
              */
             virtual std::vector<thinkyoung::blockchain::EventOperation> blockchain_get_events(uint32_t block_number, const thinkyoung::blockchain::TransactionIdType& trx_id) const = 0;
+            /**
+             * Lists the events a contract emitted in a block range from the event index, results end on whole blocks.
+             *
+             * @param contract contract name or address (string, required)
+             * @param event_type event name to list, empty for all events of the contract (string, optional, defaults to "")
+             * @param from_block first block to list (uint32_t, optional, defaults to 0)
+             * @param to_block last block to list, 0 for the head block (uint32_t, optional, defaults to 0)
+             * @param limit events to list before stopping at the end of a block (uint32_t, optional, defaults to 100)
+             *
+             * @return contract_event_entry_array
+             */
+            virtual std::vector<thinkyoung::blockchain::ContractEventEntry> blockchain_list_contract_events(const std::string& contract, const std::string& event_type = fc::json::from_string("\"\"").as<std::string>(), uint32_t from_block = fc::json::from_string("0").as<uint32_t>(), uint32_t to_block = fc::json::from_string("0").as<uint32_t>(), uint32_t limit = fc::json::from_string("100").as<uint32_t>()) const = 0;
             /**
              * Get a transaction id.
              *
@@ -1669,6 +1700,17 @@ namespace thinkyoung {
              * @return eventoperation_array
              */
             virtual std::vector<thinkyoung::blockchain::EventOperation> call_contract_local_emit(const std::string& contract, const std::string& caller_name, const std::string& function_name, const std::string& params) = 0;
+            /**
+             * call contract function on local endpoint without spreading it, and report the time spent per opcode, lua function and chain api.
+             *
+             * @param contract contract name or contract address need to be called (string, required)
+             * @param caller_name caller name (string, required)
+             * @param function_name function in contract (string, required)
+             * @param params parameters which would be passed to function (string, required)
+             *
+             * @return contract_profile_report
+             */
+            virtual thinkyoung::lua::lib::GluaProfileReport call_contract_profile(const std::string& contract, const std::string& caller_name, const std::string& function_name, const std::string& params) = 0;
             /**
              * call contract offline function by contract name or contract address.
              *
@@ -18,6 +18,27 @@ namespace thinkyoung {
         };
         typedef fc::optional<SnapshotEntry> oSnapshotEntry;
 
+        //one balance an address owns, ordered by owner so the balances of an address are adjacent
+        struct BalanceOwnerKey
+        {
+            Address          owner;
+            BalanceIdType    balance_id;
+
+            BalanceOwnerKey() {}
+            BalanceOwnerKey(const Address& addr, const BalanceIdType& id)
+                : owner(addr), balance_id(id) {}
+
+            friend bool operator < (const BalanceOwnerKey& a, const BalanceOwnerKey& b)
+            {
+                return std::tie(a.owner, a.balance_id) < std::tie(b.owner, b.balance_id);
+            }
+
+            friend bool operator == (const BalanceOwnerKey& a, const BalanceOwnerKey& b)
+            {
+                return std::tie(a.owner, a.balance_id) == std::tie(b.owner, b.balance_id);
+            }
+        };
+
         struct BalanceEntry;
         typedef fc::optional<BalanceEntry> oBalanceEntry;
 
@@ -78,4 +99,5 @@ namespace thinkyoung {
 } // thinkyoung::blockchain
 
 FC_REFLECT(thinkyoung::blockchain::SnapshotEntry, (original_address)(original_balance))
+FC_REFLECT(thinkyoung::blockchain::BalanceOwnerKey, (owner)(balance_id))
 FC_REFLECT(thinkyoung::blockchain::BalanceEntry, (condition)(balance)(restricted_owner)(snapshot_info)(deposit_date)(last_update)(meta_data))
@@ -15,7 +15,9 @@ namespace thinkyoung {
             ShareType          signee_fees_destroyed = 0;
             fc::ripemd160       random_seed;
 
+            fc::microseconds    assembly_time; /* Time taken for generate_block to run, only for blocks produced here */
             fc::microseconds    processing_time; /* Time taken for extend_chain to run */
+            uint64_t            undo_bytes = 0; /* Size of the undo journal saved for the block */
         };
         typedef optional<BlockEntry> oBlockEntry;
 
@@ -31,5 +33,7 @@ FC_REFLECT_DERIVED(thinkyoung::blockchain::BlockEntry,
     (signee_fees_collected)
     (signee_fees_destroyed)
     (random_seed)
+    (assembly_time)
     (processing_time)
+    (undo_bytes)
     )
@@ -0,0 +1,84 @@
+#pragma once
+#include <blockchain/Types.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/time.hpp>
+
+#include <memory>
+
+namespace fc {
+    class file_mapping;
+    class mapped_region;
+}
+
+namespace thinkyoung {
+    namespace blockchain {
+
+        /**
+         *  Timestamps of the blocks on the current chain, stored as a dense array of seconds since epoch
+         *  indexed by block number in a memory mapped file. The chain writes the head block into it and
+         *  shrinks it when blocks are popped, so a block number can be found from a time by a binary
+         *  search in memory instead of reading block headers.
+         */
+        class BlockTimestampIndex
+        {
+        public:
+            BlockTimestampIndex();
+            ~BlockTimestampIndex();
+
+            void open(const fc::path& file);
+            void close();
+            bool is_open()const { return _timestamps != nullptr; }
+
+            //number of blocks indexed, the head block number once the chain is in sync with it
+            uint32_t size()const { return _size; }
+
+            /**
+            * Forget the blocks after block_count, entries are kept in the file until they are overwritten
+            * @param  block_count  uint32_t
+            *
+            * @return void
+            */
+            void resize(const uint32_t block_count);
+
+            /**
+            * Write the timestamp of block_num, which becomes the last block indexed
+            * @param  block_num  uint32_t
+            * @param  timestamp  fc::time_point_sec
+            *
+            * @return void
+            */
+            void store(const uint32_t block_num, const fc::time_point_sec& timestamp);
+
+            //timestamp of block_num, 0 when it was never written
+            fc::time_point_sec at(const uint32_t block_num)const;
+
+            /**
+            * Find the last block produced at or before time
+            * @param  time  fc::time_point_sec
+            *
+            * @return uint32_t  the first block when time is before it, 0 when nothing is indexed
+            */
+            uint32_t find_block_num(const fc::time_point_sec& time)const;
+
+            /**
+            * Find the first block produced at or after time
+            * @param  time  fc::time_point_sec
+            *
+            * @return uint32_t  size() + 1 when time is after the last block
+            */
+            uint32_t find_first_block_num(const fc::time_point_sec& time)const;
+
+        private:
+            void map(const uint32_t capacity);
+
+            fc::path                                    _file;
+            std::unique_ptr<fc::file_mapping>           _mapping;
+            std::unique_ptr<fc::mapped_region>          _region;
+            uint32_t*                                   _timestamps;
+            uint32_t                                    _capacity;
+            uint32_t                                    _size;
+        };
+
+    }
+} // thinkyoung::blockchain
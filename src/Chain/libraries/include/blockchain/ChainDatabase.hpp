@@ -12,14 +12,32 @@ namespace thinkyoung {
             class ChainDatabaseImpl;
         }
         
+        namespace test {
+            struct ChainFixture;
+        }
+        
         class TransactionEvaluationState;
         typedef std::shared_ptr<TransactionEvaluationState> TransactionEvaluationStatePtr;
+        typedef std::shared_ptr<const std::vector<char>> RawBlockPtr; // FullBlock packed with fc::raw
         
         struct BlockSummary {
             FullBlock                                    block_data;
             PendingChainStatePtr                       applied_changes;
         };
         
+        /** What a pending transaction read while it was evaluated and what it changed, so that it
+         *  only has to be evaluated again once a block writes one of the keys it read
+         */
+        struct PendingTrxDependencies {
+            std::shared_ptr<ChainStateKeys>            read_keys = std::make_shared<ChainStateKeys>();
+            PendingChainStatePtr                       changes;
+            TransactionEvaluationStatePtr              eval_state;
+            ShareType                                  fees = 0; // paid, compared against the relay fee
+            uint64_t                                   sequence = 0; // order the transaction was accepted in
+            oAssetEntry                                base_asset; // as it was read, the changes only add the fee to it
+            fc::time_point_sec                         now; // what the changes stamped into last_update, deposit_date and the like
+        };
+        
         struct BlockForkData {
             BlockForkData() :is_linked(false), is_included(false), is_known(false) {}
             
@@ -103,6 +121,15 @@ namespace thinkyoung {
             void open(const fc::path& data_dir, const fc::optional<fc::path>& genesis_file, const bool statistics_enabled,
                       const std::function<void(float)> replay_status_callback = std::function<void(float)>());
                       
+            /**  Set how many entries of each index db are kept in memory, must be called before open
+            *
+            * @param  cache_sizes  index db name (e.g. "balance_id_to_entry") to entry count,
+            *                      dbs not listed or set to 0 are fully loaded at open
+            *
+            * @return void
+            */
+            void set_db_cache_sizes(const std::map<std::string, uint32_t>& cache_sizes);
+                      
             /**  Close leveldb file
             *
             *
@@ -320,13 +347,19 @@ namespace thinkyoung {
             optional<time_point_sec>    get_next_producible_block_timestamp(const vector<AccountIdType>& delegate_ids)const;
             
             /**
-            * Fetches all transactions that involve the provided address.
+            * Fetches the transactions that involve the provided address in chain order.
+            * A page always ends on a whole block, so the next page starts from the block after the
+            * last one returned, or before it when reverse.
             *
             * @param addr address to scan for (string, required)
+            * @param since_block first block to return, the newest one to start from when reverse, 0 for no bound
+            * @param limit transactions to return before stopping at the end of a block, 0 for no limit
+            * @param reverse newest transactions first
             *
-            * @return variant_object
+            * @return vector<TransactionEntry>
             */
-            vector<TransactionEntry>  fetch_address_transactions(const Address& addr);
+            vector<TransactionEntry>  fetch_address_transactions(const Address& addr, const uint32_t since_block = 0,
+                                                                 const uint32_t limit = 0, const bool reverse = false);
             
             /**  Fetch ALP input balance in blocks that block_num of them are lower of the given block_num
             *  or equal to
@@ -361,13 +394,21 @@ namespace thinkyoung {
             void transaction_erase_from_alp_full_entry(const string& alp_accout, const AlpTrxidBalance& alp_balance_entry);
             
             
-            /**  Find block num by time (use the method of bisection)
+            /**  Find the last block produced at or before time, or the first block when time is before it
             *
             * @param  time  fc::time_point_sec
             *
             * @return uint32_t
             */
-            uint32_t                    find_block_num(fc::time_point_sec &time)const;
+            uint32_t                    find_block_num(const fc::time_point_sec& time)const;
+            
+            /**  Convert time ranges into the ranges of blocks produced within them
+            *
+            * @param  time_ranges  vector<pair<fc::time_point_sec, fc::time_point_sec>>  first and last time, both included
+            *
+            * @return vector<pair<uint32_t, uint32_t>>  first and last block of each range, 0 and 0 when no block is in it
+            */
+            vector<pair<uint32_t, uint32_t>> find_block_ranges(const vector<pair<fc::time_point_sec, fc::time_point_sec>>& time_ranges)const;
             
             /**  Get block_num by block_id
             *
@@ -425,6 +466,22 @@ namespace thinkyoung {
             */
             FullBlock                  get_block(uint32_t block_num)const;
             
+            /**  Get the serialized FullBlock by block_id as it is stored, for sending to peers without unpacking it
+            *
+            * @param  block_id  BlockIdType
+            *
+            * @return RawBlockPtr, null if the block is unknown
+            */
+            RawBlockPtr                get_raw_block(const BlockIdType&)const;
+            
+            /**  Get the serialized FullBlock by block_num as it is stored
+            *
+            * @param  block_num  uint32_t
+            *
+            * @return RawBlockPtr, null if the block is unknown
+            */
+            RawBlockPtr                get_raw_block(uint32_t block_num)const;
+            
             /**
             * Retrieves the detailed transaction information for a block.
             *
@@ -466,6 +523,22 @@ namespace thinkyoung {
             */
             vector<EventOperation>    get_events(uint32_t block_index, const thinkyoung::blockchain::TransactionIdType& trx_id);
             
+            /**  Get the events a contract emitted in a block range from the event index
+            * A result ends on a whole block when it reaches the limit, so the next query starts from
+            * the block after the last one returned.
+            *
+            * @param  contract_id  ContractIdType
+            * @param  event_type  string  only events with this name, empty for all of them
+            * @param  from_block  uint32_t  first block
+            * @param  to_block  uint32_t  last block, 0 for the head block
+            * @param  limit  uint32_t  events to return before stopping at the end of a block, 0 for no limit
+            *
+            * @return vector<ContractEventEntry>  in chain order
+            */
+            vector<ContractEventEntry> fetch_contract_events(const ContractIdType& contract_id, const string& event_type = string(),
+                                                             const uint32_t from_block = 0, const uint32_t to_block = 0,
+                                                             const uint32_t limit = 0)const;
+            
             /**  Get block_id by block_num
             *
             * @param  block_num  uint32_t
@@ -641,10 +714,12 @@ namespace thinkyoung {
             *
             * @param  trx  SignedTransaction
             * @param  required_fees  ShareType
+            * @param  dependencies  filled with the keys read and the changes made, may be null
             *
             * @return TransactionEvaluationStatePtr
             */
-            virtual TransactionEvaluationStatePtr   evaluate_transaction(const SignedTransaction& trx, const ShareType required_fees = 0, bool contract_vm_exec = false, bool skip_signature_check = false, bool throw_exec_exception=false);
+            virtual TransactionEvaluationStatePtr   evaluate_transaction(const SignedTransaction& trx, const ShareType required_fees = 0, bool contract_vm_exec = false, bool skip_signature_check = false, bool throw_exec_exception=false,
+                                                                         PendingTrxDependencies* dependencies = nullptr);
             
             /**  Evaluate the transaction and return exception
             *
@@ -655,6 +730,17 @@ namespace thinkyoung {
             */
             optional<fc::exception>                    get_transaction_error(const SignedTransaction& transaction, const ShareType min_fee);
             
+            /**  Evaluate a contract testing transaction on a layer over the head state without applying it
+            *    Runs on the contract simulation threads and the calling fiber yields until it is done
+            *
+            * @param  trx  SignedTransaction
+            * @param  configure  adjusts the evaluation state before it runs, may be empty
+            *
+            * @return TransactionEvaluationStatePtr
+            */
+            TransactionEvaluationStatePtr              simulate_transaction(const SignedTransaction& trx,
+                                                                            const std::function<void(TransactionEvaluationState&)>& configure = nullptr);
+            
             /** Return the timestamp from the head block
             /**  now
             *
@@ -832,8 +918,6 @@ namespace thinkyoung {
             */
             uint32_t    get_forkdb_num();
             
-            void store_extend_status(const BlockIdType& id, int version);
-            std::pair<BlockIdType, int> get_last_extend_status();
             /**  Set forkdb num
             *
             * @param  forkdb_num  uint32_t
@@ -841,12 +925,6 @@ namespace thinkyoung {
             * @return void
             */
             void    set_forkdb_num(uint32_t forkdb_num);
-            /**  Repair error block data
-            *
-            *
-            * @return void
-            */
-            void   repair_database();
             SignedTransaction transfer_asset_from_contract(
                 double real_amount_to_transfer,
                 const string& amount_to_transfer_symbol,
@@ -868,6 +946,8 @@ namespace thinkyoung {
             vector<ContractIdType> get_all_contract_entries() const;
             
           private:
+            friend struct test::ChainFixture;
+            
             unique_ptr<detail::ChainDatabaseImpl> my;
             uint32_t m_fork_num_before;
             
@@ -1087,8 +1167,6 @@ namespace thinkyoung {
             */
             virtual void balance_erase_from_id_map(const BalanceIdType&)override;
             
-            virtual void status_insert_into_block_map(const BlockIdType&, const int&);
-            virtual void status_erase_from_block_map();
             /**  Get TransactionEntry from db by transaction_id
             *
             * @param  id  TransactionIdType
@@ -1207,6 +1285,15 @@ namespace thinkyoung {
             * @return oContractStorage
             */
             virtual oContractStorage contractstorage_lookup_by_id(const ContractIdType&)const override;
+
+            /**
+            * Lookup a single contract storage item by contract id and storage name from blockchain db.
+            *
+            * @param  key  ContractStorageKey
+            *
+            * @return oContractStorageItem
+            */
+            virtual oContractStorageItem contractstorage_lookup_by_key(const ContractStorageKey&)const override;
             
             /**  Store contractInfo to db by contract_id
             *
@@ -1217,14 +1304,14 @@ namespace thinkyoung {
             */
             virtual void contract_insert_into_id_map(const ContractIdType&, const ContractEntry&) override;
             
-            /**  Store contractStorage to db by contract_id
+            /**  Store a contract storage item to db by contract id and storage name
             *
-            * @param  id  ContractIdType
-            * @param  storage  contractStorage
+            * @param  key  ContractStorageKey
+            * @param  item  ContractStorageItem
             *
             * @return void
             */
-            virtual void contractstorage_insert_into_id_map(const ContractIdType&, const ContractStorageEntry&) override;
+            virtual void contractstorage_insert_into_key_map(const ContractStorageKey&, const ContractStorageItem&) override;
             
             /**  Store contractId to db by contract_name
             *
@@ -1243,13 +1330,13 @@ namespace thinkyoung {
             */
             virtual void contract_erase_from_id_map(const ContractIdType&) override;
             
-            /**  Erase from db by contract_id
+            /**  Erase a contract storage item from db by contract id and storage name
             *
-            * @param  id  ContractIdType
+            * @param  key  ContractStorageKey
             *
             * @return void
             */
-            virtual void contractstorage_erase_from_id_map(const ContractIdType&) override;
+            virtual void contractstorage_erase_from_key_map(const ContractStorageKey&) override;
             
             /**  Erase from  db by contract_name
             *
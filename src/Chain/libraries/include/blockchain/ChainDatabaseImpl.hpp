@@ -2,10 +2,16 @@
 
 #include <blockchain/ChainDatabase.hpp>
 #include <db/CachedLevelMap.hpp>
+#include <blockchain/BlockTimestampIndex.hpp>
+#include <blockchain/ContractSimulator.hpp>
+#include <blockchain/ReplayPipeline.hpp>
 #include <db/FastLevelMap.hpp>
 #include <fc/thread/mutex.hpp>
 #include <utilities/ThreadPool.hpp>
 
+#include <list>
+#include <mutex>
+
 namespace thinkyoung {
     namespace blockchain {
 
@@ -29,13 +35,59 @@ namespace thinkyoung {
             }
         };
 
-        struct data_version
-        {
-            BlockIdType id;
-            int version;
-        };
         namespace detail
         {
+            /** The tables of the chain state database, the number is the first byte of every key */
+            enum ChainStateTable : uint8_t
+            {
+                property_id_to_entry_table = 1,
+                account_id_to_entry_table = 2,
+                account_name_to_id_table = 3,
+                account_address_to_id_table = 4,
+                asset_id_to_entry_table = 5,
+                asset_symbol_to_id_table = 6,
+                slate_id_to_entry_table = 7,
+                balance_id_to_entry_table = 8,
+                balance_owner_index_table = 9,
+                alp_input_balance_entry_table = 10,
+                alp_full_entry_table = 11,
+                contract_id_to_entry_table = 12,
+                contract_name_to_id_table = 13,
+                request_to_result_iddb_table = 14,
+                result_to_request_iddb_table = 15,
+                trx_to_contract_iddb_table = 16,
+                contract_to_trx_iddb_table = 17,
+                pending_transaction_db_table = 18,
+                fork_number_db_table = 19,
+                fork_db_table = 20,
+                revalidatable_future_blocks_db_table = 21,
+                block_id_to_block_entry_db_table = 22,
+                transaction_id_to_entry_table = 23,
+                address_transaction_index_table = 24,
+                slot_index_to_entry_table = 25,
+                slot_timestamp_to_delegate_table = 26,
+                contract_storage_key_to_item_table = 27,
+                contract_event_index_table = 28,
+                block_num_to_undo_journal_table = 29
+            };
+
+            //one block transaction evaluated ahead of time on its own layer over the block state
+            struct SpeculativeTransaction
+            {
+                PendingChainStatePtr                layer;
+                TransactionEvaluationStatePtr       eval_state;
+                std::shared_ptr<ChainStateKeys>     read_keys;
+            };
+
+            //changes merged so far while applying a block with speculative transactions
+            struct SpeculativeMerge
+            {
+                oAssetEntry                         base_asset; // base asset as the speculative layers saw it
+                bool                                base_asset_changed = false;
+                ChainStateKeys                      written_keys;
+                uint32_t                            reexecuted = 0;
+            };
+
             class ChainDatabaseImpl
             {
             public:
@@ -48,8 +100,9 @@ namespace thinkyoung {
                 void                                        load_checkpoints(const fc::path& data_dir)const;
                 /**
                 * Checks whether replaying is require
-                * Get database_version from property database and check whether it equals to ALP_BLOCKCHAIN_DATABASE_VERSION
-                * @param  data_dir  path of property database
+                * Open the chain state database and check whether its database_version equals to ALP_BLOCKCHAIN_DATABASE_VERSION,
+                * the database stays open when no replay is required
+                * @param  data_dir  path of the blockchain data
                 *
                 * @return bool
                 */
@@ -61,6 +114,56 @@ namespace thinkyoung {
                 * @return void
                 */
                 void                                        open_database(const fc::path& data_dir);
+                /**
+                * convert the legacy per-contract storage database into the per-key storage database
+                * @param  data_dir    path of database
+                *
+                * @return void
+                */
+                void                                        upgrade_contract_storage_db(const fc::path& data_dir);
+                /**
+                * fill the block header database from the stored blocks when it was created after them
+                *
+                * @return void
+                */
+                void                                        upgrade_block_header_db();
+                /**
+                * bring the block timestamp index in line with the current chain after it was opened,
+                * filling blocks it never saw and rewriting the ones within the undo history
+                *
+                * @return void
+                */
+                void                                        sync_block_timestamps();
+                /**
+                * convert the per-address transaction id sets into the address transaction index
+                * @param  data_dir    path of database
+                *
+                * @return void
+                */
+                void                                        upgrade_address_transaction_db(const fc::path& data_dir);
+                /**
+                * fill the balance owner index from the balance database when it was created after it
+                *
+                * @return void
+                */
+                void                                        upgrade_balance_owner_db();
+                /**  index_balance_owners
+                * Add or remove a balance under every address that owns it
+                * @param  id  BalanceIdType
+                * @param  entry  BalanceEntry
+                * @param  add  bool
+                *
+                * @return void
+                */
+                void                                        index_balance_owners(const BalanceIdType& id, const BalanceEntry& entry, const bool add);
+                /**  index_contract_events
+                * Add or remove the events carried by the result transactions of a block
+                * @param  block_data  FullBlock
+                * @param  add  bool
+                *
+                * @return void
+                */
+                void                                        index_contract_events(const FullBlock& block_data, const bool add);
                 /**  clear_invalidation_of_future_blocks
                 * Remove blocks whose block time is 2 days ago from future block list and clear other blocks' invalid flag
                 *
@@ -151,7 +254,14 @@ namespace thinkyoung {
                 */
                 void                                        pop_block();
 
-                void                                        repair_block(BlockIdType block_id);
+                /**  sync_block_num_to_id
+                * Make the block number index end at the head block the chain state was written for
+                *
+                * The index lives with the raw blocks and is written after the chain state commits,
+                * so a crash in between leaves it one block ahead or behind.
+                * @return void
+                */
+                void                                        sync_block_num_to_id();
                 /**  mark_invalid
                 * fetch the fork data for block_id, mark it as invalid and
                 * then mark every item after it as invalid as well.
@@ -249,11 +359,128 @@ namespace thinkyoung {
                 * Apply transactions contained in the block
                 * @param  block_data   the block that contains transactions
                 * @param  pending_state  PendingChainStatePtr
+                * @param  trx_signees  keys already recovered from the transaction signatures, may be null
+                * @param  allow_speculation  false to evaluate every transaction in order
                 *
                 * @return void
                 */
                 void                                        apply_transactions(const FullBlock& block_data,
-                    const PendingChainStatePtr& pending_state);
+                    const PendingChainStatePtr& pending_state,
+                    const vector<vector<RecoveredSignature>>* trx_signees = nullptr,
+                    const bool allow_speculation = true);
+
+                /**  applied_transactions_digest
+                * Apply the transactions of a block on a layer over pending_state that is dropped afterwards
+                * @param  block_data   the block that contains transactions
+                * @param  pending_state  PendingChainStatePtr
+                * @param  trx_signees  keys already recovered from the transaction signatures, may be null
+                * @param  allow_speculation  false to evaluate every transaction in order
+                *
+                * @return fc::sha256  digest of every entry the layer wrote and the events it emitted
+                */
+                fc::sha256                                  applied_transactions_digest(const FullBlock& block_data,
+                    const PendingChainStatePtr& pending_state,
+                    const vector<vector<RecoveredSignature>>* trx_signees,
+                    const bool allow_speculation);
+
+                /**  check_speculative_transactions
+                * Apply the transactions of a block in order and speculatively, each on a layer over pending_state
+                * that is dropped afterwards, and assert that both write the same entries. Debug builds run it during replay
+                * @param  block_data   the block that contains transactions
+                * @param  pending_state  PendingChainStatePtr
+                * @param  trx_signees  keys already recovered from the transaction signatures, may be null
+                *
+                * @return void
+                */
+                void                                        check_speculative_transactions(const FullBlock& block_data,
+                    const PendingChainStatePtr& pending_state,
+                    const vector<vector<RecoveredSignature>>* trx_signees);
+
+                /**  new_block_eval_state
+                * Create the state a block transaction is evaluated with, signatures are checked separately
+                * @param  trx  SignedTransaction
+                * @param  state  PendingChainStatePtr the transaction writes to
+                *
+                * @return TransactionEvaluationStatePtr
+                */
+                TransactionEvaluationStatePtr               new_block_eval_state(const SignedTransaction& trx,
+                    const PendingChainStatePtr& state)const;
+
+                /**  can_speculate_transactions
+                * Check whether the transactions are worth evaluating in parallel
+                * Lazy index maps change on every lookup, so every map must be fully loaded
+                * @param  trxs  transactions in the order they are applied
+                *
+                * @return bool
+                */
+                bool                                        can_speculate_transactions(const vector<SignedTransaction>& trxs)const;
+
+                /**  has_lazy_index
+                * Check whether an index map faults entries in on lookups, those can only be read from the main thread
+                *
+                * @return bool
+                */
+                bool                                        has_lazy_index()const;
+
+                /**  speculate_transactions
+                * Evaluate the transactions without contract operations concurrently, each on a layer over pending_state
+                * Failed evaluations are left empty and run again in order
+                * @param  trxs  transactions in the order they are applied
+                * @param  pending_state  PendingChainStatePtr
+                * @param  new_eval_state  creates the evaluation state of a transaction on its layer
+                * @param  speculative  one entry per transaction
+                * @param  deadline  evaluations not started by then are left empty
+                *
+                * @return void
+                */
+                void                                        speculate_transactions(const vector<SignedTransaction>& trxs,
+                    const PendingChainStatePtr& pending_state,
+                    const std::function<TransactionEvaluationStatePtr(const SignedTransaction&, const PendingChainStatePtr&)>& new_eval_state,
+                    vector<SpeculativeTransaction>& speculative,
+                    const fc::time_point deadline = fc::time_point::maximum());
+
+                /**  is_speculation_valid
+                * Check that nothing merged since a speculative evaluation changed what it read or wrote
+                * @param  trx  SignedTransaction
+                * @param  speculative  SpeculativeTransaction
+                * @param  pending_state  PendingChainStatePtr
+                * @param  merge  SpeculativeMerge
+                *
+                * @return bool
+                */
+                bool                                        is_speculation_valid(const SignedTransaction& trx,
+                    const SpeculativeTransaction& speculative,
+                    const PendingChainStatePtr& pending_state,
+                    const SpeculativeMerge& merge)const;
+
+                /**  merge_layer
+                * Apply the changes of one transaction layer to pending_state and remember the keys it wrote
+                * @param  layer  PendingChainStatePtr
+                * @param  speculated  whether the layer was evaluated against the state before the first merge
+                * @param  pending_state  PendingChainStatePtr
+                * @param  merge  SpeculativeMerge
+                *
+                * @return void
+                */
+                void                                        merge_layer(const PendingChainStatePtr& layer,
+                    const bool speculated,
+                    const PendingChainStatePtr& pending_state,
+                    SpeculativeMerge& merge);
+
+                /**  merge_speculative_transaction
+                * Merge a speculative result into pending_state in block order, or evaluate the transaction
+                * again when it read anything an earlier transaction of the block wrote
+                * @param  trx  SignedTransaction
+                * @param  speculative  SpeculativeTransaction
+                * @param  pending_state  PendingChainStatePtr
+                * @param  merge  SpeculativeMerge
+                *
+                * @return TransactionEvaluationStatePtr
+                */
+                TransactionEvaluationStatePtr               merge_speculative_transaction(const SignedTransaction& trx,
+                    SpeculativeTransaction& speculative,
+                    const PendingChainStatePtr& pending_state,
+                    SpeculativeMerge& merge);
 
                 /**  update_active_delegate_list
                 * Get a list of active delegate that would participate in generating blocks in next round
@@ -278,16 +505,40 @@ namespace thinkyoung {
                     oBlockEntry& block_entry)const;
 
                 /**  save_undo_state
-                * Save current state and block_id into undo_state map
+                * Save the prior values of the keys changed by pending_state into the undo journal of the block
                 * @param  block_num   number of the block
                 * @param  block_id  id of the block
                 * @param  pending_state  State need to be saved
+                * @param  block_entry  records the size of the undo journal
                 *
                 * @return void
                 */
                 void                                        save_undo_state(const uint32_t block_num,
                     const BlockIdType& block_id,
-                    const PendingChainStatePtr& pending_state);
+                    const PendingChainStatePtr& pending_state,
+                    oBlockEntry& block_entry);
+                /**  revert_undo_state
+                * Load the undo journal of a block and revert the changes made by that block
+                * @param  block_num   number of the block
+                * @param  block_id  id of the block
+                *
+                * @return PendingChainStatePtr  state holding the reverted entrys, passed to observers
+                */
+                PendingChainStatePtr                        revert_undo_state(const uint32_t block_num,
+                    const BlockIdType& block_id);
+
+                /**  defer_chain_writes
+                * Hold the writes of every chain state table in memory until commit_chain_writes
+                *
+                * @return void
+                */
+                void                                        defer_chain_writes();
+                /**  commit_chain_writes
+                * Write everything held since defer_chain_writes with a single batch
+                *
+                * @return void
+                */
+                void                                        commit_chain_writes();
 
                 /**  update_head_block
                 * Update information about head block
@@ -324,19 +575,40 @@ namespace thinkyoung {
                 * @return void
                 */
                 fc::future<void>                                                            _revalidate_pending;
+                fc::future<void> /* Refills the lua state pool after a block */            _prefill_lua_states;
                 ThreadPool                                                                  _thread_pool;
                 PendingChainStatePtr                                                     _pending_trx_state = nullptr;
+                thinkyoung::db::LevelDatabase /* Declared before its tables, it closes after them */ _chain_state_db;
                 thinkyoung::db::LevelMap<TransactionIdType, SignedTransaction>                 _pending_transaction_db;
                 map<fee_index, TransactionEvaluationStatePtr>                            _pending_fee_index;
+                map<TransactionIdType, PendingTrxDependencies>                            _pending_trx_dependencies;
+                uint64_t                                                                   _pending_trx_sequence = 0;
+                ChainStateKeys /* Written by blocks since the last revalidation */         _pending_dirty_keys;
                 ShareType                                                                  _relay_fee = ALP_BLOCKCHAIN_DEFAULT_RELAY_FEE;
 
                 /* Block processing */
                 uint32_t /* Only used to skip undo states when possible during replay */    _min_undo_block = 0;
+                bool /* Set while open() replays the chain */                                _replaying = false;
+                unordered_map<BlockIdType, RecoveredSignees> /* Filled ahead by the replay pipeline */ _recovered_signees;
+                std::map<std::string, uint32_t> /* Entries kept in memory per index db, 0 loads all */ _db_cache_sizes;
+                uint32_t /* Last block built by generate_block, matched by number and timestamp */ _generated_block_num = 0;
+                time_point_sec                                                              _generated_block_timestamp;
+                fc::microseconds                                                            _generated_block_assembly_time;
 
                 fc::mutex                                                                   _push_block_mutex;
+                std::unique_ptr<ContractSimulator>                                          _contract_simulator; // created by the first simulated transaction
                 ShareType															_block_per_account_reword_amount = ALP_MAX_DELEGATE_PAY_PER_BLOCK;
                 thinkyoung::db::LevelMap<BlockIdType, FullBlock>                               _block_id_to_full_block;
-                thinkyoung::db::fast_level_map<BlockIdType, PendingChainState>                 _block_id_to_undo_state;
+                thinkyoung::db::LevelMap<BlockIdType, SignedBlockHeader>                       _block_id_to_header; // Headers of every stored block, read without unpacking the transactions
+                map<uint32_t, SignedBlockHeader>                                            _block_header_tail; // Current chain headers within the undo history
+                std::mutex                                                                  _block_header_tail_mutex; // get_block_header is called by the chain server threads
+                BlockTimestampIndex                                                         _block_timestamps; // Timestamp of every block on the current chain, by block number
+                // Recently served serialized blocks, most recent first, read by the chain server threads
+                std::list<std::pair<BlockIdType, RawBlockPtr>>                                 _raw_block_lru;
+                unordered_map<BlockIdType, std::list<std::pair<BlockIdType, RawBlockPtr>>::iterator> _raw_block_index;
+                std::mutex                                                                  _raw_block_mutex;
+                thinkyoung::db::LevelMap<uint32_t, UndoJournal>                                _block_num_to_undo_journal;
+                map<uint32_t, UndoJournal>                                                  _undo_journal_tail; // Most recent journals
 
                 thinkyoung::db::LevelMap<uint32_t, vector<BlockIdType>>                         _fork_number_db; // All siblings
                 thinkyoung::db::LevelMap<BlockIdType, BlockForkData>                          _fork_db;
@@ -364,19 +636,18 @@ namespace thinkyoung {
                 thinkyoung::db::fast_level_map<SlateIdType, SlateEntry>                        _slate_id_to_entry;
 
                 thinkyoung::db::fast_level_map<BalanceIdType, BalanceEntry>                    _balance_id_to_entry;
+                thinkyoung::db::LevelMap<BalanceOwnerKey, int32_t>                              _balance_owner_index; //int32_t is unused, this is a set
                 thinkyoung::db::fast_level_map<string, set<AlpTrxidBalance>>							_alp_input_balance_entry;
                 thinkyoung::db::fast_level_map<string, AlpBalanceEntry>						_alp_full_entry;
                 thinkyoung::db::LevelMap<TransactionIdType, TransactionEntry>                 _transaction_id_to_entry;
                 set<UniqueTransactionKey>                                                 _unique_transactions;
-                thinkyoung::db::LevelMap<Address, unordered_set<TransactionIdType>>             _address_to_transaction_ids;
+                thinkyoung::db::LevelMap<AddressTransactionKey, TransactionIdType>             _address_transaction_index; // Append only, one key per address a transaction touches
 
 
 
 
                 thinkyoung::db::LevelMap<SlotIndex, SlotEntry>                                 _slot_index_to_entry;
                 thinkyoung::db::LevelMap<time_point_sec, AccountIdType>                         _slot_timestamp_to_delegate;
-
-                thinkyoung::db::LevelMap<int, data_version>                      _block_extend_status;
                 // TODO: Just store whitelist in asset_entry
                 //thinkyoung::db::level_map<pair<asset_id_type,address>, object_id_type>             _auth_db;
 
@@ -384,7 +655,8 @@ namespace thinkyoung {
 
                 // contract related db
                 thinkyoung::db::fast_level_map<ContractIdType, ContractEntry>                  _contract_id_to_entry;
-                thinkyoung::db::fast_level_map<ContractIdType, ContractStorageEntry>               _contract_id_to_storage;
+                thinkyoung::db::LevelMap<ContractStorageKey, ContractStorageItem>                   _contract_storage_key_to_item;
+                thinkyoung::db::LevelMap<ContractEventKey, ContractEventEntry>                _contract_event_index;
                 thinkyoung::db::fast_level_map<ContractName, ContractIdType>                  _contract_name_to_id;
 				thinkyoung::db::fast_level_map<TransactionIdType, ResultTIdEntry>		  _request_to_result_iddb;
 				thinkyoung::db::fast_level_map<TransactionIdType, RequestIdEntry>		  _result_to_request_iddb;
@@ -402,4 +674,3 @@ namespace thinkyoung {
 FC_REFLECT_TYPENAME(std::vector<thinkyoung::blockchain::BlockIdType>)
 FC_REFLECT_TYPENAME(std::unordered_set<thinkyoung::blockchain::TransactionIdType>)
 FC_REFLECT(thinkyoung::blockchain::fee_index, (_fees)(_trx))
-FC_REFLECT(thinkyoung::blockchain::data_version, (id)(version))
@@ -456,6 +456,12 @@ namespace thinkyoung {
 
             void                              store_contractstorage_entry(const ContractStorageEntry& entry);
 
+            oContractStorageItem              get_contractstorage_item(const ContractIdType& id, const std::string& name) const;
+
+            void                              remove_contractstorage_item(const ContractIdType& id, const std::string& name);
+
+            void                              store_contractstorage_item(const ContractIdType& id, const std::string& name, const StorageDataType& data);
+
             bool                               is_destroyed_contract(const ContractState state) const;
 
             bool                               is_temporary_contract(const ContractLevel level) const;
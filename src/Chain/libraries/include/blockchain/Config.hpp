@@ -7,7 +7,7 @@
 
 #define ALP_TEST_NETWORK_VERSION                            83 // autogenerated
 
-#define ALP_BLOCKCHAIN_DATABASE_VERSION                     uint64_t( 201 )
+#define ALP_BLOCKCHAIN_DATABASE_VERSION                     uint64_t( 205 )
 
 /**
  *  The address prepended to string representation of
@@ -38,6 +38,12 @@
 #define ACT_DELEGATE_PAY_PER_BLOCK_TIMES                    5
 #define ALP_MAX_DELEGATE_PAY_PER_BLOCK                      int64_t( 1 * ALP_BLOCKCHAIN_PRECISION * ACT_DELEGATE_PAY_PER_BLOCK_TIMES )
 #define ALP_BLOCKCHAIN_MAX_UNDO_HISTORY                     ALP_BLOCKCHAIN_BLOCKS_PER_HOUR
+#define ALP_BLOCKCHAIN_UNDO_JOURNAL_TAIL_SIZE               16 // undo journals kept in memory
+#define ALP_BLOCKCHAIN_REPLAY_PIPELINE_DEPTH                64 // blocks read and recovered ahead of the one being replayed
+#define ALP_BLOCKCHAIN_SIGNATURE_CACHE_SIZE                 50000 // recovered transaction signatures kept
+#define ALP_BLOCKCHAIN_RAW_BLOCK_CACHE_SIZE                 512 // serialized blocks kept for serving peers
+#define ALP_BLOCKCHAIN_MIN_SPECULATIVE_TRXS                 4 // transactions without contract operations needed to evaluate a block in parallel
+#define ALP_BLOCKCHAIN_SIMULATION_THREADS                   4 // threads evaluating the contract testing calls of the rpc
 
 #define ALP_BLOCKCHAIN_REGISTER_ACCOUNT_FEE                 int64_t( 10 * ALP_BLOCKCHAIN_PRECISION )
 
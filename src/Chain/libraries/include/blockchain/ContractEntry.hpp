@@ -110,9 +110,11 @@ namespace thinkyoung {
         class ChainInterface;
         struct  ContractEntry;
         struct ContractStorageEntry;
+        struct ContractStorageItem;
         //use fc optional to hold the return value
         typedef fc::optional<ContractEntry> oContractEntry;
         typedef fc::optional<ContractStorageEntry> oContractStorage;
+        typedef fc::optional<ContractStorageItem> oContractStorageItem;
         typedef fc::optional<ContractIdType> oContractIdType;
 
 
@@ -162,7 +164,7 @@ namespace thinkyoung {
                 trx_id(entry.trx_id) {}
         };
 
-        //contract storage
+        //contract storage, assembled from all the storage items of one contract
         struct ContractStorageEntry
         {
             //std::vector<ContractChar> contract_storage;
@@ -173,6 +175,41 @@ namespace thinkyoung {
             static void store(ChainInterface&, const ContractIdType&, const ContractStorageEntry&);
             static void remove(ChainInterface&, const ContractIdType&);
 
+        };
+
+        //key of a single contract storage item, ordered by contract first so that
+        //all the items of one contract are adjacent in the database
+        struct ContractStorageKey
+        {
+            ContractIdType  contract_id; //contract address
+            std::string     storage_name; //storage name declared by the contract
+
+            ContractStorageKey() {}
+            ContractStorageKey(const ContractIdType& id, const std::string& name)
+                : contract_id(id), storage_name(name) {}
+
+            friend bool operator < (const ContractStorageKey& a, const ContractStorageKey& b)
+            {
+                return std::tie(a.contract_id, a.storage_name) < std::tie(b.contract_id, b.storage_name);
+            }
+
+            friend bool operator == (const ContractStorageKey& a, const ContractStorageKey& b)
+            {
+                return std::tie(a.contract_id, a.storage_name) == std::tie(b.contract_id, b.storage_name);
+            }
+        };
+
+        //value of a single contract storage item
+        struct ContractStorageItem
+        {
+            StorageDataType storage_data;
+
+            ContractStorageItem() {}
+            ContractStorageItem(const StorageDataType& data) : storage_data(data) {}
+
+            static oContractStorageItem lookup(const ChainInterface&, const ContractStorageKey&);
+            static void store(ChainInterface&, const ContractStorageKey&, const ContractStorageItem&);
+            static void remove(ChainInterface&, const ContractStorageKey&);
         };
 		struct  ResultTIdEntry;
 		typedef fc::optional<ResultTIdEntry> oResultTIdEntry;
@@ -224,6 +261,7 @@ namespace thinkyoung {
 
             friend struct ContractEntry;
             friend struct ContractStorageEntry;
+            friend struct ContractStorageItem;
 			friend struct ResultTIdEntry;
 			friend struct RequestIdEntry;
 			friend struct ContractinTrxEntry;
@@ -232,6 +270,7 @@ namespace thinkyoung {
             virtual  oContractEntry  contract_lookup_by_id(const ContractIdType&)const = 0;
             virtual  oContractEntry  contract_lookup_by_name(const ContractName&)const = 0;
             virtual oContractStorage contractstorage_lookup_by_id(const ContractIdType&)const = 0;
+            virtual oContractStorageItem contractstorage_lookup_by_key(const ContractStorageKey&)const = 0;
 			virtual oResultTIdEntry contract_lookup_resultid_by_reqestid(const TransactionIdType&)const = 0;
 			virtual oRequestIdEntry contract_lookup_requestid_by_resultid(const TransactionIdType&)const = 0;
 			virtual oContractinTrxEntry contract_lookup_contractid_by_trxid(const TransactionIdType&)const = 0;
@@ -240,7 +279,7 @@ namespace thinkyoung {
 			//insert related
             virtual void contract_insert_into_id_map(const ContractIdType&, const ContractEntry&) = 0;
             virtual void contract_insert_into_name_map(const ContractName&, const ContractIdType&) = 0;
-            virtual void contractstorage_insert_into_id_map(const ContractIdType&, const ContractStorageEntry&) = 0;
+            virtual void contractstorage_insert_into_key_map(const ContractStorageKey&, const ContractStorageItem&) = 0;
 			virtual void contract_store_resultid_by_reqestid(const TransactionIdType& req, const ResultTIdEntry& res) = 0;
 			virtual void contract_store_requestid_by_resultid(const TransactionIdType& req, const RequestIdEntry& res) = 0;
 			virtual void contract_store_contractid_by_trxid(const TransactionIdType& id, const ContractinTrxEntry& res) = 0;
@@ -248,7 +287,7 @@ namespace thinkyoung {
 			//erase related
             virtual void contract_erase_from_id_map(const ContractIdType&) = 0;
             virtual void contract_erase_from_name_map(const ContractName&) = 0;
-            virtual void contractstorage_erase_from_id_map(const ContractIdType&) = 0;
+            virtual void contractstorage_erase_from_key_map(const ContractStorageKey&) = 0;
 			virtual void contract_erase_resultid_by_reqestid(const TransactionIdType& req) = 0;
 			virtual void contract_erase_requestid_by_resultid(const TransactionIdType& req) = 0;
 			virtual void contract_erase_trxid_by_contract_id(const ContractIdType&) = 0;
@@ -321,6 +360,8 @@ FC_REFLECT_ENUM(thinkyoung::blockchain::ContractApiType,
     )
 
     FC_REFLECT(thinkyoung::blockchain::ContractStorageEntry, (id)(contract_storages))
+    FC_REFLECT(thinkyoung::blockchain::ContractStorageKey, (contract_id)(storage_name))
+    FC_REFLECT(thinkyoung::blockchain::ContractStorageItem, (storage_data))
 	FC_REFLECT(thinkyoung::blockchain::ResultTIdEntry, (res))
 	FC_REFLECT(thinkyoung::blockchain::RequestIdEntry, (req))
 	FC_REFLECT(thinkyoung::blockchain::ContractTrxEntry, (trx_id))
@@ -0,0 +1,103 @@
+#pragma once
+#include <blockchain/ChainInterface.hpp>
+#include <blockchain/Config.hpp>
+#include <blockchain/Transaction.hpp>
+#include <blockchain/TransactionEvaluationState.hpp>
+
+#include <fc/thread/mutex.hpp>
+#include <fc/thread/wait_condition.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace fc { class thread; }
+
+namespace thinkyoung {
+    namespace blockchain {
+
+        /**
+         *  Runs the read-only contract evaluations of the testing rpc calls on its own worker threads.
+         *  Every simulation evaluates on a new PendingChainState layer over the head state and a glua
+         *  state from the pool of its worker, and the fiber that asked for it yields until it is done.
+         *
+         *  The head state is only read between blocks. Simulations share it: the asking fiber holds a
+         *  read lock until its simulation is done. A WriteGuard taken while a block is applied waits
+         *  for the running simulations and holds back new ones. The lock is built on fc primitives,
+         *  so a fiber that waits for it yields instead of blocking the main thread.
+         */
+        class ContractSimulator
+        {
+        public:
+            typedef std::function<void(TransactionEvaluationState&)> Configure;
+
+            //exclusive access to the state the simulations read
+            class WriteGuard
+            {
+            public:
+                explicit WriteGuard(ContractSimulator* simulator);
+                ~WriteGuard();
+
+            private:
+                ContractSimulator*                      _simulator;
+            };
+
+            explicit ContractSimulator(const uint32_t thread_count = ALP_BLOCKCHAIN_SIMULATION_THREADS);
+            ~ContractSimulator();
+
+            /**
+            * Evaluate a testing transaction on one of the simulation threads
+            * @param  base  ChainInterfacePtr  state the simulation layer is put on
+            * @param  trx  SignedTransaction
+            * @param  configure  Configure  adjusts the evaluation state before it runs, may be empty
+            *
+            * @return TransactionEvaluationStatePtr  keeps the layer it evaluated on alive
+            */
+            TransactionEvaluationStatePtr simulate(const ChainInterfacePtr& base,
+                const SignedTransaction& trx,
+                const Configure& configure);
+
+            /**
+            * Evaluate a testing transaction on the calling thread
+            * @param  base  ChainInterfacePtr
+            * @param  trx  SignedTransaction
+            * @param  configure  Configure
+            *
+            * @return TransactionEvaluationStatePtr
+            */
+            static TransactionEvaluationStatePtr evaluate(const ChainInterfacePtr& base,
+                const SignedTransaction& trx,
+                const Configure& configure);
+
+            size_t thread_count()const { return _threads.size(); }
+
+        private:
+            //shared access to the head state for one simulation
+            class ReadGuard
+            {
+            public:
+                explicit ReadGuard(ContractSimulator* simulator);
+                ~ReadGuard();
+
+            private:
+                ContractSimulator*                      _simulator;
+            };
+
+            void begin_read();
+            void end_read();
+            void begin_write();
+            void end_write();
+
+            std::vector<std::unique_ptr<fc::thread>>    _threads;
+            std::atomic<uint32_t>                       _next_thread;
+
+            fc::mutex                                   _state_mutex; // guards the counts below
+            fc::wait_condition<>                        _state_released;
+            uint32_t                                    _readers;
+            uint32_t                                    _waiting_writers; // new readers wait for these
+            bool                                        _writing;
+        };
+
+    }
+} // thinkyoung::blockchain
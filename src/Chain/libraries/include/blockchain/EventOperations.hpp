@@ -3,6 +3,8 @@
 #include "blockchain/Types.hpp"
 #include "blockchain/Operations.hpp"
 
+#include <tuple>
+
 namespace thinkyoung {
     namespace blockchain {
 
@@ -35,8 +37,53 @@ namespace thinkyoung {
             void evaluate(TransactionEvaluationState& eval_state)const;
         };
 
+        //position of an event in the event index, ordered by contract, event name, then chain location
+        struct ContractEventKey
+        {
+            ContractIdType contract_id;
+            std::string event_type;
+            uint32_t block_num = 0;
+            uint32_t trx_num = 0;
+            uint32_t op_num = 0;
+
+            ContractEventKey() {}
+            ContractEventKey(const ContractIdType& id, const std::string& type, const uint32_t block, const uint32_t trx = 0, const uint32_t op = 0)
+                : contract_id(id), event_type(type), block_num(block), trx_num(trx), op_num(op) {}
+
+            friend bool operator < (const ContractEventKey& a, const ContractEventKey& b)
+            {
+                return std::tie(a.contract_id, a.event_type, a.block_num, a.trx_num, a.op_num)
+                    < std::tie(b.contract_id, b.event_type, b.block_num, b.trx_num, b.op_num);
+            }
+
+            friend bool operator == (const ContractEventKey& a, const ContractEventKey& b)
+            {
+                return std::tie(a.contract_id, a.event_type, a.block_num, a.trx_num, a.op_num)
+                    == std::tie(b.contract_id, b.event_type, b.block_num, b.trx_num, b.op_num);
+            }
+        };
+
+        //an event emitted on chain, with the result transaction that carries it
+        struct ContractEventEntry
+        {
+            ContractIdType contract_id;
+            std::string event_type;
+            std::string event_param;
+            bool is_truncated = false;
+            TransactionIdType trx_id;
+            uint32_t block_num = 0;
+            uint32_t trx_num = 0;
+
+            ContractEventEntry() {}
+            ContractEventEntry(const EventOperation& op, const TransactionIdType& id, const uint32_t block, const uint32_t trx)
+                : contract_id(op.id), event_type(op.event_type), event_param(op.event_param), is_truncated(op.is_truncated),
+                trx_id(id), block_num(block), trx_num(trx) {}
+        };
+
     }
 }
 
 
-FC_REFLECT(thinkyoung::blockchain::EventOperation, (id)(event_type)(event_param)(is_truncated))
\ No newline at end of file
+FC_REFLECT(thinkyoung::blockchain::EventOperation, (id)(event_type)(event_param)(is_truncated))
+FC_REFLECT(thinkyoung::blockchain::ContractEventKey, (contract_id)(event_type)(block_num)(trx_num)(op_num))
+FC_REFLECT(thinkyoung::blockchain::ContractEventEntry, (contract_id)(event_type)(event_param)(is_truncated)(trx_id)(block_num)(trx_num))
\ No newline at end of file
@@ -38,6 +38,22 @@
 #define ALP_V0_7_0_FORK_BLOCK_NUM   9999999
 #define ALP_V0_8_0_FORK_BLOCK_NUM   9999999
 
+// Consensus changes that have no activation height yet. A node only forks off when such a height is
+// reached without every other node running a release that knows it, so they stay at
+// ALP_FORK_NOT_SCHEDULED until a height is agreed on and released; set it here and nowhere else.
+//
+//   ALP_STORAGE_TABLE_PATCH_BLOCK_NUM      StorageOperation accepts table patches, and contract calls
+//                                          commit writes to a table or array as a patch of its entries
+//   ALP_LVM_MEMORY_LIMIT_BLOCK_NUM         the lua state of a contract call is metered by its arena and
+//                                          the call fails past GLUA_STATE_DEFAULT_MEMORY_LIMIT
+//   ALP_LVM_MALLOC_SIZE_CLASSES_BLOCK_NUM  lua_malloc of a contract call takes blocks from size classes
+//                                          instead of the first fit gap, which moves the point where a
+//                                          contract runs out of memory
+#define ALP_FORK_NOT_SCHEDULED                  UINT32_MAX
+#define ALP_STORAGE_TABLE_PATCH_BLOCK_NUM       ALP_FORK_NOT_SCHEDULED
+#define ALP_LVM_MEMORY_LIMIT_BLOCK_NUM          ALP_FORK_NOT_SCHEDULED
+#define ALP_LVM_MALLOC_SIZE_CLASSES_BLOCK_NUM   ALP_FORK_NOT_SCHEDULED
+
 #define ALP_FORK_TO_UNIX_TIME_LIST  ((ALP_V0_4_0_FORK_BLOCK_NUM,   "0.4.0",     1408064036)) \
                                     ((ALP_V0_4_9_FORK_2_BLOCK_NUM, "0.4.9",     1409193626)) \
                                     ((ALP_V0_4_10_FORK_BLOCK_NUM,  "0.4.10",    1409437355)) \
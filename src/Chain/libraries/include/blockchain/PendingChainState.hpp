@@ -1,11 +1,46 @@
 #pragma once
 #include <blockchain/ChainInterface.hpp>
+#include <blockchain/UndoJournal.hpp>
 #include <fc/reflect/reflect.hpp>
 #include <deque>
 
 namespace thinkyoung {
     namespace blockchain {
 
+        //keys of the chain state entries a pending state read or wrote, used to find the
+        //pending transactions a block can affect and the conflicts between speculative evaluations.
+        //now is not compared, every block moves it; revalidate_pending checks expiration against it instead.
+        struct ChainStateKeys
+        {
+            bool                        head_block = false; // head block number or timestamp
+            bool                        now = false; // now(), stamped into last_update, deposit_date and the like
+            set<AccountIdType>          account_ids;
+            set<string>                 account_names;
+            set<Address>                account_addresses;
+            set<AssetIdType>            asset_ids;
+            set<string>                 asset_symbols;
+            set<SlateIdType>            slate_ids;
+            set<BalanceIdType>          balance_ids;
+            set<ContractIdType>         contract_ids;
+            set<ContractName>           contract_names;
+            set<ContractStorageKey>     contract_storage_keys;
+            set<PropertyIdType>         property_ids;
+            set<TransactionIdType>      transaction_ids;
+            set<SlotIndex>              slot_indexes;
+            set<time_point_sec>         slot_timestamps;
+
+            /**
+            * Check whether any key is in both sets
+            *
+            * @param  other  ChainStateKeys
+            *
+            * @return bool
+            */
+            bool intersects(const ChainStateKeys& other)const;
+            bool empty()const;
+            void clear();
+        };
+
 		struct SandboxAccountInfo
 		{
 			AccountIdType                   id = 0;
@@ -86,35 +121,47 @@ namespace thinkyoung {
             */
             virtual TransactionEvaluationStatePtr   sandbox_evaluate_transaction(const SignedTransaction& trx, const ShareType required_fees = 0);
 
-            /** populate undo state with everything that would be necessary to revert this
-             * pending state to the previous state.
-             */
             /**
-            * populate undo state with everything that would be necessary to revert this
-            * pending state to the previous state.
+            * populate undo journal with the prior value of every key changed by this
+            * pending state, which is everything necessary to revert it to the previous state.
+            *
+            * @param  journal  UndoJournal
+            *
+            * @return void
+            */
+            virtual void                   get_undo_journal(UndoJournal& journal)const;
+
+            /**
+            * Record every key that this pending state looks up in the previous state
             *
-            * @param  undo_state_arg  ChainInterfacePtr
+            * @param  read_keys  set the keys are added to, null stops recording
             *
             * @return void
             */
-            virtual void                   get_undo_state(const ChainInterfacePtr& undo_state)const;
+            void                           track_reads(const std::shared_ptr<ChainStateKeys>& read_keys);
+            /**
+            * Add the keys stored or removed by this pending state to written_keys
+            *
+            * @param  written_keys  ChainStateKeys
+            *
+            * @return void
+            */
+            void                           get_written_keys(ChainStateKeys& written_keys)const;
 
             template<typename T, typename U>
-            void populate_undo_state(const ChainInterfacePtr& undo_state, const ChainInterfacePtr& prev_state,
+            void populate_undo_journal(UndoJournal& journal, const ChainInterfacePtr& prev_state, const UndoEntryType type,
                 const T& store_map, const U& remove_set)const
             {
                 using V = typename T::mapped_type;
                 for (const auto& key : remove_set)
                 {
                     const auto prev_entry = prev_state->lookup<V>(key);
-                    if (prev_entry.valid()) undo_state->store(key, *prev_entry);
+                    if (prev_entry.valid()) journal.append(type, key, prev_entry);
                 }
                 for (const auto& item : store_map)
                 {
                     const auto& key = item.first;
-                    const auto prev_entry = prev_state->lookup<V>(key);
-                    if (prev_entry.valid()) undo_state->store(key, *prev_entry);
-                    else undo_state->remove<V>(key);
+                    journal.append(type, key, prev_state->lookup<V>(key));
                 }
             }
 
@@ -181,7 +228,8 @@ namespace thinkyoung {
             unordered_map<ContractIdType, ContractEntry>                      _contract_id_to_entry;
             unordered_set<ContractIdType>                                     _contract_id_remove;
             unordered_map<ContractName, ContractIdType>                       _contract_name_to_id;
-            unordered_map<ContractIdType, ContractStorageEntry>                    _contract_id_to_storage;
+            map<ContractStorageKey, ContractStorageItem>                      _contract_storage_key_to_item;
+            set<ContractStorageKey>                                           _contract_storage_key_remove;
 			unordered_map<TransactionIdType, ResultTIdEntry>					_request_id_to_result_id;
 			unordered_set<TransactionIdType>								  _req_to_res_to_remove;
 			unordered_map<TransactionIdType, RequestIdEntry>					_result_id_to_request_id;
@@ -196,6 +244,7 @@ namespace thinkyoung {
         private:
             // Not serialized
             std::weak_ptr<ChainInterface>                                     _prev_state;
+            std::shared_ptr<ChainStateKeys>                                   _read_keys;
 
             /**
             * According id lookup property
@@ -526,7 +575,7 @@ namespace thinkyoung {
             virtual  oContractEntry  contract_lookup_by_name(const ContractName&)const override;
 
             /**
-            * Lookup contractStorage by contract id from _contract_id_to_stroage.
+            * Assemble contractStorage of a contract from the previous state and _contract_storage_key_to_item.
             *
             * @param  id  ContractIdType
             *
@@ -534,6 +583,15 @@ namespace thinkyoung {
             */
             virtual oContractStorage contractstorage_lookup_by_id(const ContractIdType&)const override;
 
+            /**
+            * Lookup a single contract storage item from _contract_storage_key_to_item.
+            *
+            * @param  key  ContractStorageKey
+            *
+            * @return oContractStorageItem
+            */
+            virtual oContractStorageItem contractstorage_lookup_by_key(const ContractStorageKey&)const override;
+
             /**  Insert pair(contract_id, contractInfo) into _contract_id_to_info
             *
             * @param  id  ContractIdType
@@ -552,14 +610,14 @@ namespace thinkyoung {
             */
             virtual void contract_insert_into_name_map(const ContractName&, const ContractIdType&) override;
 
-            /**  Insert pair(contract_id, contractStorage) into _contract_id_to_stroage
+            /**  Insert pair(storage_key, storage_item) into _contract_storage_key_to_item
             *
-            * @param  id  ContractIdType
-            * @param  storage ContractStorage
+            * @param  key  ContractStorageKey
+            * @param  item ContractStorageItem
             *
             * @return void
             */
-            virtual void contractstorage_insert_into_id_map(const ContractIdType&, const ContractStorageEntry&) override;
+            virtual void contractstorage_insert_into_key_map(const ContractStorageKey&, const ContractStorageItem&) override;
 
             /**  Erase from _contract_id_to_info by contract_id
             *
@@ -577,13 +635,13 @@ namespace thinkyoung {
             */
             virtual void contract_erase_from_name_map(const ContractName&) override;
 
-            /**  Erase from _contract_id_to_stroage by contract_id
+            /**  Erase from _contract_storage_key_to_item by storage key
             *
-            * @param  id  ContractIdType
+            * @param  key  ContractStorageKey
             *
             * @return void
             */
-            virtual void contractstorage_erase_from_id_map(const ContractIdType&) override;
+            virtual void contractstorage_erase_from_key_map(const ContractStorageKey&) override;
 
 			virtual oResultTIdEntry contract_lookup_resultid_by_reqestid(const TransactionIdType&) const override;
 			virtual void contract_store_resultid_by_reqestid(const TransactionIdType& req, const ResultTIdEntry& res) override;
@@ -648,7 +706,8 @@ FC_REFLECT(thinkyoung::blockchain::PendingChainState,
     (_contract_id_to_entry)
     (_contract_id_remove)
     (_contract_name_to_id)
-    (_contract_id_to_storage)
+    (_contract_storage_key_to_item)
+    (_contract_storage_key_remove)
 	(_request_id_to_result_id)
 	(_req_to_res_to_remove)
 	(_result_id_to_request_id)
@@ -29,7 +29,9 @@ namespace thinkyoung {
             */
             confirmation_requirement = 7,
             dirty_markets = 8,
-            node_vm_enabled = 9
+            node_vm_enabled = 9,
+            /** the head block the chain state was written for, see sync_block_num_to_id */
+            head_block_id = 10
         };
 
         struct PropertyEntry;
@@ -71,6 +73,7 @@ FC_REFLECT_ENUM(thinkyoung::blockchain::PropertyIdType,
 (confirmation_requirement)
 (dirty_markets)
 (node_vm_enabled)
+(head_block_id)
 );
 FC_REFLECT(thinkyoung::blockchain::PropertyEntry,
     (id)
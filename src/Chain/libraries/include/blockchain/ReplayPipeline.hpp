@@ -0,0 +1,87 @@
+#pragma once
+#include <blockchain/Block.hpp>
+#include <blockchain/Config.hpp>
+#include <blockchain/SignatureCache.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+class ThreadPool;
+
+namespace thinkyoung {
+    namespace blockchain {
+
+        //keys recovered from the signatures of a block before it is applied
+        struct RecoveredSignees
+        {
+            fc::optional<PublicKeyType>                 block_signee;
+            std::vector<std::vector<RecoveredSignature>> trx_signees; // one entry per user transaction, empty when not verified
+        };
+
+        //a stored block read back for replay
+        struct RecoveredBlock
+        {
+            FullBlock                                   block;
+            BlockIdType                                 block_id;
+            RecoveredSignees                            signees;
+        };
+
+        /**
+         *  Replays stored blocks in three stages. A reader thread fetches and unpacks the blocks in
+         *  order, the signatures of each block are recovered on the thread pool, and the caller
+         *  applies the blocks one at a time through next(). At most depth blocks are ahead of it.
+         */
+        class ReplayPipeline
+        {
+        public:
+            //fills the next block to replay, returns false once there are none left
+            typedef std::function<bool(FullBlock&)> BlockSource;
+
+            ReplayPipeline(ThreadPool& thread_pool,
+                const BlockSource& source,
+                const DigestType& chain_id,
+                const bool recover_trx_signees,
+                const uint32_t last_checkpoint_block_num,
+                const size_t depth = ALP_BLOCKCHAIN_REPLAY_PIPELINE_DEPTH);
+            ~ReplayPipeline();
+
+            /**
+            * Wait for the next block in order
+            * @param  recovered  RecoveredBlock
+            *
+            * @return bool  false when every block has been returned
+            */
+            bool   next(RecoveredBlock& recovered);
+
+            size_t fetched_depth()const;   // read, signatures still being recovered
+            size_t recovered_depth()const; // ready to be applied
+
+        private:
+            void   read_blocks();
+            RecoveredBlock recover(const std::shared_ptr<FullBlock>& block)const;
+            size_t count_recovering()const;
+
+            ThreadPool&                                 _thread_pool;
+            BlockSource                                 _source;
+            DigestType                                  _chain_id;
+            bool                                        _recover_trx_signees;
+            uint32_t                                    _last_checkpoint_block_num;
+            size_t                                      _depth;
+
+            mutable std::mutex                          _mutex;
+            std::condition_variable                     _not_full;
+            std::condition_variable                     _not_empty;
+            mutable std::deque<std::future<RecoveredBlock>> _queue;
+            bool                                        _finished = false;
+            bool                                        _stopping = false;
+            std::exception_ptr                          _error;
+            std::thread                                 _reader;
+        };
+
+    }
+} // thinkyoung::blockchain
@@ -0,0 +1,75 @@
+#pragma once
+#include <blockchain/Address.hpp>
+#include <blockchain/Config.hpp>
+#include <blockchain/Types.hpp>
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace thinkyoung {
+    namespace blockchain {
+
+        //key recovered from a transaction signature and the addresses it signs for
+        struct RecoveredSignature
+        {
+            PublicKeyType           key;
+            std::vector<Address>    addresses; // Address and the four PtsAddress forms of key
+            bool                    canonical = false; // recovered with the canonical check
+        };
+
+        /**
+         *  Bounded cache of signature recoveries keyed by (transaction digest, signature), so a
+         *  transaction validated for the pending pool is not recovered again when it arrives in a
+         *  block or when the pool is revalidated. Safe to use from the signature check threads.
+         */
+        class SignatureCache
+        {
+        public:
+            static SignatureCache& instance();
+
+            explicit SignatureCache(const size_t capacity = ALP_BLOCKCHAIN_SIGNATURE_CACHE_SIZE);
+
+            /**
+            * Return the key and addresses recovered from sig, recovering and caching them on a miss
+            * @param  digest  digest the signature was made over
+            * @param  sig  compact_signature
+            * @param  enforce_canonical  reject non canonical signatures
+            *
+            * @return RecoveredSignature
+            */
+            RecoveredSignature recover(const DigestType& digest, const fc::ecc::compact_signature& sig, const bool enforce_canonical);
+
+            //recover without consulting or filling any cache
+            static RecoveredSignature recover_uncached(const DigestType& digest, const fc::ecc::compact_signature& sig, const bool enforce_canonical);
+
+            void     clear();
+            size_t   size()const;
+            size_t   capacity()const { return _capacity; }
+            uint64_t hits()const { return _hits; }
+            uint64_t misses()const { return _misses; }
+
+        private:
+            typedef std::pair<DigestType, fc::ecc::compact_signature> CacheKey;
+
+            struct CacheKeyHash
+            {
+                size_t operator()(const CacheKey& key)const
+                {
+                    return std::hash<DigestType>()(key.first) ^ (std::hash<fc::ecc::compact_signature>()(key.second) << 1);
+                }
+            };
+
+            typedef std::list<std::pair<CacheKey, RecoveredSignature>> LruList;
+
+            size_t                                                          _capacity;
+            mutable std::mutex                                              _mutex;
+            LruList                                                         _lru; // most recently used first
+            std::unordered_map<CacheKey, LruList::iterator, CacheKeyHash>   _index;
+            std::atomic<uint64_t>                                           _hits;
+            std::atomic<uint64_t>                                           _misses;
+        };
+
+    }
+} // thinkyoung::blockchain
@@ -6,10 +6,32 @@
 namespace thinkyoung {
     namespace blockchain {
 
+        //entries of a table/array storage changed by a call, carried in storage_after instead of the table diff
+        struct StorageTablePatchType
+        {
+            static const uint8_t    type;
+
+            StorageDataType         changed_items;  //table of the storage type, holds added and updated entries
+            std::set<std::string>   removed_keys;
+
+            //only tables and arrays with a concrete value type can be patched
+            static bool is_patchable_type(StorageValueTypes type);
+
+            //patch which turns the table before into the table after, both must have the same patchable type
+            static StorageTablePatchType diff(const StorageDataType& before, const StorageDataType& after);
+
+            void apply(StorageDataType& storage)const;
+        };
+
         struct StorageDataChangeType
         {
             StorageDataType storage_before;
             StorageDataType storage_after;
+
+            bool is_table_patch()const
+            {
+                return storage_after.storage_type == StorageValueTypes::storage_value_table_patch;
+            }
         };
 
         struct StorageOperation
@@ -24,6 +46,9 @@ namespace thinkyoung {
             template<typename StorageBaseType, typename StorageContainerType>
             void update_contract_map_storage(const StorageDataChangeType& change_storage, StorageDataType& storage)const;
 
+            void patch_contract_storages(const std::string storage_name, const StorageTablePatchType& patch,
+                std::map<std::string, StorageDataType>& contract_storages)const;
+
             //void update_contract_storages(const StorageDataChangeType& change_storage, StorageDataType& storage)const;
             void update_contract_storages(const std::string storage_name, const StorageDataChangeType& change_storage,
                 std::map<std::string, StorageDataType>& contract_storages)const;
@@ -35,5 +60,6 @@ namespace thinkyoung {
 } // thinkyoung::blockchain
 
 
+FC_REFLECT(thinkyoung::blockchain::StorageTablePatchType, (changed_items)(removed_keys))
 FC_REFLECT(thinkyoung::blockchain::StorageDataChangeType, (storage_before)(storage_after))
 FC_REFLECT(thinkyoung::blockchain::StorageOperation, (contract_id)(contract_change_storages))
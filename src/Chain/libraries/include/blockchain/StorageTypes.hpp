@@ -200,6 +200,7 @@ FC_REFLECT_ENUM(thinkyoung::blockchain::StorageValueTypes,
     (storage_value_number_array)
     (storage_value_bool_array)
     (storage_value_string_array)
+    (storage_value_table_patch)
     )
 
     FC_REFLECT(thinkyoung::blockchain::StorageDataType,
@@ -24,6 +24,28 @@ namespace thinkyoung {
             }
         };
 
+        //position of a transaction in the history of one address, ordered by address then chain location
+        struct AddressTransactionKey
+        {
+            Address     address;
+            uint32_t    block_num = 0;
+            uint32_t    trx_num = 0;
+
+            AddressTransactionKey() {}
+            AddressTransactionKey(const Address& addr, const uint32_t block, const uint32_t trx)
+                : address(addr), block_num(block), trx_num(trx) {}
+
+            friend bool operator < (const AddressTransactionKey& a, const AddressTransactionKey& b)
+            {
+                return std::tie(a.address, a.block_num, a.trx_num) < std::tie(b.address, b.block_num, b.trx_num);
+            }
+
+            friend bool operator == (const AddressTransactionKey& a, const AddressTransactionKey& b)
+            {
+                return std::tie(a.address, a.block_num, a.trx_num) == std::tie(b.address, b.block_num, b.trx_num);
+            }
+        };
+
         struct TransactionEntry;
         typedef optional<TransactionEntry> oTransactionEntry;
 
@@ -59,6 +81,12 @@ namespace thinkyoung {
     }
 } // thinkyoung::blockchain
 
+FC_REFLECT(thinkyoung::blockchain::AddressTransactionKey,
+    (address)
+    (block_num)
+    (trx_num)
+    )
+
 FC_REFLECT_DERIVED(thinkyoung::blockchain::TransactionEntry,
     (thinkyoung::blockchain::TransactionEvaluationState),
     (chain_location)
@@ -4,6 +4,8 @@
 #include <blockchain/EventOperations.hpp>
 #include <blockchain/Types.hpp>
 #include <blockchain/BalanceEntry.hpp>
+#include <blockchain/SignatureCache.hpp>
+#include <glua/glua_contract_profiler.h>
 
 namespace thinkyoung {
     namespace blockchain {
@@ -47,12 +49,41 @@ namespace thinkyoung {
              */
             void validate_required_fee();
 
+            /**
+             * read a contract storage item through the per transaction cache
+             *
+             * @param  contract_id  ContractIdType
+             * @param  name  name of the storage
+             *
+             * @return oContractStorageItem
+             */
+            oContractStorageItem get_cached_contractstorage_item(const ContractIdType& contract_id, const std::string& name);
+
+            /**
+             * drop a cached storage item after it was written
+             *
+             * @param  contract_id  ContractIdType
+             * @param  name  name of the storage
+             *
+             * @return void
+             */
+            void invalidate_cached_contractstorage_item(const ContractIdType& contract_id, const std::string& name);
+
+            /**
+             * storage reads of all evaluations served from or missing the storage read cache
+             *
+             * @return uint64_t
+             */
+            static uint64_t total_storage_cache_hits();
+            static uint64_t total_storage_cache_misses();
+
             /**
              * apply collected vote changes
              */
             void update_delegate_votes();
 
             bool check_signature(const Address& a)const;
+            void add_signed_keys(const RecoveredSignature& recovered);
             bool check_multisig(const MultisigCondition& a)const;
 
             bool account_has_signed(const AccountEntry& entry)const;
@@ -133,6 +164,7 @@ namespace thinkyoung {
             bool                                           _skip_signature_check = false;
             bool                                           _enforce_canonical_signatures = false;
             bool                                           _skip_vote_adjustment = false;
+            fc::optional<vector<RecoveredSignature>>       _recovered_signees; // recovered ahead of time, used by transaction_signature_check
 
             // For pay_fee op
             unordered_map<AssetIdType, ShareType>       _max_fee;
@@ -144,6 +176,13 @@ namespace thinkyoung {
             bool                                           skipexec;//ڱʾǷԼִ
 			bool										  throw_exec_exception;
             Asset                                          exec_cost;
+            size_t                                         exec_memory_peak = 0; // most bytes held by lua objects while the contract ran
+            // storage items read by contracts of this transaction, shared by nested contract calls
+            std::map<std::pair<ContractIdType, std::string>, oContractStorageItem> storage_read_cache;
+            uint32_t                                       storage_cache_hits = 0;
+            uint32_t                                       storage_cache_misses = 0;
+            bool                                           profile_contract_execution = false; // time contract calls by opcode, function and chain api
+            thinkyoung::lua::lib::GluaProfileReport        exec_profile;
             PublicKeyType                                  contract_operator;
             bool                                           evaluate_contract_result = false; //ǷΪ, ڷֹӺԼ˻ȡǮԼ޸storageȽ׶ںԼִг
 
@@ -178,3 +217,16 @@ FC_REFLECT(thinkyoung::blockchain::TransactionEvaluationState,
     (imessage_length)
     (skipexec)
     )
+
+FC_REFLECT(thinkyoung::lua::lib::GluaProfileCounter,
+    (count)
+    (total_ns)
+    )
+
+FC_REFLECT(thinkyoung::lua::lib::GluaProfileReport,
+    (instructions)
+    (total_ns)
+    (opcodes)
+    (functions)
+    (apis)
+    )
@@ -0,0 +1,98 @@
+#pragma once
+#include <blockchain/Types.hpp>
+#include <fc/io/enum_type.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/optional.hpp>
+
+namespace thinkyoung {
+    namespace blockchain {
+
+        class ChainInterface;
+
+        //entry type of a journaled change, selects the key/entry types used to replay it
+        enum UndoEntryType
+        {
+            undo_property_entry = 0,
+            undo_account_entry = 1,
+            undo_asset_entry = 2,
+            undo_slate_entry = 3,
+            undo_balance_entry = 4,
+            undo_transaction_entry = 5,
+            undo_slot_entry = 6,
+            undo_contract_entry = 7,
+            undo_contract_storage_entry = 8,
+            undo_contract_storage_item = 9,
+            undo_result_id_entry = 10,
+            undo_request_id_entry = 11,
+            undo_contractin_trx_entry = 12,
+            undo_contract_trx_entry = 13,
+            undo_contract_storage_table_delta = 14  //prior value is a StorageTablePatchType reverting the block's changes
+        };
+
+        //one changed key and the value it had before the block, no value means the key did not exist
+        struct UndoRecord
+        {
+            fc::enum_type<uint8_t, UndoEntryType> entry_type;
+            std::vector<char>                     key;
+            fc::optional<std::vector<char>>       prior_value;
+
+            UndoRecord() {}
+            UndoRecord(const UndoEntryType type, std::vector<char>&& k, fc::optional<std::vector<char>>&& v)
+                : entry_type(type), key(std::move(k)), prior_value(std::move(v)) {}
+        };
+
+        //changes needed to revert a single block, in the order they were recorded
+        struct UndoJournal
+        {
+            BlockIdType             block_id;
+            std::vector<UndoRecord> records;
+
+            template<typename K, typename V>
+            void append(const UndoEntryType type, const K& key, const fc::optional<V>& prior_value)
+            {
+                fc::optional<std::vector<char>> packed_value;
+                if (prior_value.valid()) packed_value = fc::raw::pack(*prior_value);
+                records.emplace_back(type, fc::raw::pack(key), std::move(packed_value));
+            }
+
+            /**
+            * Replay the journal in reverse order on top of db
+            *
+            * @param  db  ChainInterface
+            *
+            * @return void
+            */
+            void revert(ChainInterface& db)const;
+        };
+
+    }
+} // thinkyoung::blockchain
+
+FC_REFLECT_ENUM(thinkyoung::blockchain::UndoEntryType,
+    (undo_property_entry)
+    (undo_account_entry)
+    (undo_asset_entry)
+    (undo_slate_entry)
+    (undo_balance_entry)
+    (undo_transaction_entry)
+    (undo_slot_entry)
+    (undo_contract_entry)
+    (undo_contract_storage_entry)
+    (undo_contract_storage_item)
+    (undo_result_id_entry)
+    (undo_request_id_entry)
+    (undo_contractin_trx_entry)
+    (undo_contract_trx_entry)
+    (undo_contract_storage_table_delta)
+    )
+
+FC_REFLECT(thinkyoung::blockchain::UndoRecord,
+    (entry_type)
+    (key)
+    (prior_value)
+    )
+
+FC_REFLECT(thinkyoung::blockchain::UndoJournal,
+    (block_id)
+    (records)
+    )
@@ -87,6 +87,8 @@ namespace thinkyoung {
 
             optional<fc::path>  genesis_config;
             bool                statistics_enabled = false;
+            /** entries kept in memory per chain index db, e.g. "balance_id_to_entry"; unlisted dbs are fully loaded */
+            std::map<std::string, uint32_t> chain_db_cache_sizes;
 
             vector<string>      default_peers = SeedNodes;
             uint16_t            maximum_number_of_connections = ALP_NET_DEFAULT_MAX_CONNECTIONS;
@@ -218,6 +220,7 @@ FC_REFLECT(thinkyoung::client::Config,
 (rpc)
 (genesis_config)
 (statistics_enabled)
+(chain_db_cache_sizes)
 (default_peers)
 (maximum_number_of_connections)
 (use_upnp)
@@ -1,17 +1,97 @@
 #pragma once
 #include <db/LevelMap.hpp>
 
+#include <functional>
+#include <list>
+#include <unordered_set>
+
 namespace thinkyoung {
     namespace db {
 
+        /**
+         *  By default every entry is loaded into memory at open. When opened with a non-zero
+         *  cache_limit the map is lazy instead: entries are faulted in on demand and at most
+         *  cache_limit clean entries are kept, evicting the least recently used one. Writes are
+         *  held in a dirty set and flushed to leveldb with a single write_batch.
+         *
+         *  A map opened on a table of a LevelDatabase writes through that database, so while it
+         *  defers writes every change goes into the batch the database commits for all its tables.
+         */
         template<typename K, typename V>
         class fast_level_map
         {
-            LevelMap<K, V>             _ldb;
-            fc::optional<fc::path>      _ldb_path;
+            mutable LevelMap<K, V>     _ldb;
             bool                        _ldb_enabled = true;
 
-            std::unordered_map<K, V>    _cache;
+            mutable std::unordered_map<K, V>    _cache;
+
+            size_t                                                          _cache_limit = 0;
+            size_t                                                          _size = 0;
+            mutable std::list<K>                                            _lru;
+            mutable std::unordered_map<K, typename std::list<K>::iterator>  _lru_index;
+            mutable std::unordered_set<K>                                   _dirty; // removed keys are absent from _cache
+
+            void touch(const K& key)const
+            {
+                const auto iter = _lru_index.find(key);
+                if (iter != _lru_index.end())
+                    _lru.splice(_lru.begin(), _lru, iter->second);
+            }
+
+            void untrack(const K& key)const
+            {
+                const auto iter = _lru_index.find(key);
+                if (iter != _lru_index.end())
+                {
+                    _lru.erase(iter->second);
+                    _lru_index.erase(iter);
+                }
+            }
+
+            void evict()const
+            {
+                while (_lru_index.size() > _cache_limit)
+                {
+                    const K& key = _lru.back();
+                    _cache.erase(key);
+                    _lru_index.erase(key);
+                    _lru.pop_back();
+                }
+            }
+
+            void track(const K& key)const
+            {
+                _lru.push_front(key);
+                _lru_index[key] = _lru.begin();
+            }
+
+            void fault_in(const K& key)const
+            {
+                if (!is_lazy() || _cache.count(key) > 0 || _dirty.count(key) > 0)
+                    return;
+
+                const fc::optional<V> value = _ldb.fetch_optional(key);
+                if (!value.valid())
+                    return;
+
+                _cache.emplace(key, *value);
+                track(key);
+                evict();
+            }
+
+            void load(const size_t cache_limit)
+            {
+                _cache_limit = cache_limit;
+                if (is_lazy())
+                {
+                    _size = 0;
+                    for (auto iter = _ldb.begin(); iter.valid(); ++iter)
+                        ++_size;
+                    return;
+                }
+                for (auto iter = _ldb.begin(); iter.valid(); ++iter)
+                    _cache.emplace(iter.key(), iter.value());
+            }
 
         public:
 
@@ -25,6 +105,8 @@ namespace thinkyoung {
             {
                 try {
                     FC_ASSERT(_ldb.is_open(), "Database is not open!");
+                    FC_ASSERT(_ldb_enabled, "Database is not written while leveldb is disabled!");
+                    flush();
                     FC_ASSERT(!fc::exists(path));
 
                     std::ofstream fs(path.string());
@@ -45,40 +127,108 @@ namespace thinkyoung {
 
 
 
-            void open(const fc::path& path)
+            void open(const fc::path& path, const size_t cache_limit = 0)
             {
                 try {
-                    FC_ASSERT(!_ldb_path.valid());
-                    _ldb_path = path;
-                    _ldb.open(*_ldb_path);
-                    for (auto iter = _ldb.begin(); iter.valid(); ++iter)
-                        _cache.emplace(iter.key(), iter.value());
-                } FC_CAPTURE_AND_RETHROW((path))
+                    FC_ASSERT(!_ldb.is_open());
+                    _ldb.open(path);
+                    load(cache_limit);
+                } FC_CAPTURE_AND_RETHROW((path)(cache_limit))
+            }
+
+            static void add_table(LevelDatabase& database, const uint8_t table)
+            {
+                LevelMap<K, V>::add_table(database, table);
+            }
+
+            void open(LevelDatabase& database, const uint8_t table, const size_t cache_limit = 0)
+            {
+                try {
+                    FC_ASSERT(!_ldb.is_open());
+                    _ldb.open(database, table);
+                    load(cache_limit);
+                } FC_CAPTURE_AND_RETHROW((table)(cache_limit))
             }
 
             void close()
             {
                 try {
-                    if (_ldb_path.valid())
+                    if (_ldb.is_open())
                     {
                         if (!_ldb_enabled) toggle_leveldb(true);
+                        flush();
                         _ldb.close();
-                        _ldb_path = fc::optional<fc::path>();
                     }
                     _cache.clear();
+                    _lru.clear();
+                    _lru_index.clear();
+                    _dirty.clear();
+                    _size = 0;
+                } FC_CAPTURE_AND_RETHROW()
+            }
+
+            bool is_lazy()const
+            {
+                return _cache_limit > 0;
+            }
+
+            /** Write the dirty set of a lazy map to leveldb in one batch, or into the held writes while deferring */
+            void flush()const
+            {
+                try {
+                    if (_dirty.empty())
+                        return;
+
+                    if (_ldb.deferring())
+                    {
+                        for (const auto& key : _dirty)
+                        {
+                            const auto iter = _cache.find(key);
+                            if (iter != _cache.end())
+                            {
+                                _ldb.store(key, iter->second);
+                                track(key);
+                            }
+                            else
+                            {
+                                _ldb.remove(key);
+                            }
+                        }
+                        _dirty.clear();
+                        evict();
+                        return;
+                    }
+
+                    auto batch = _ldb.create_batch();
+                    for (const auto& key : _dirty)
+                    {
+                        const auto iter = _cache.find(key);
+                        if (iter != _cache.end())
+                        {
+                            batch.store(key, iter->second);
+                            track(key);
+                        }
+                        else
+                        {
+                            batch.remove(key);
+                        }
+                    }
+                    batch.commit();
+                    _dirty.clear();
+                    evict();
                 } FC_CAPTURE_AND_RETHROW()
             }
 
             void toggle_leveldb(const bool enabled)
             {
                 try {
-                    FC_ASSERT(_ldb_path.valid());
-                    if (enabled == _ldb_enabled)
+                    FC_ASSERT(_ldb.is_open());
+                    // a lazy map can not hold everything in memory, leveldb stays authoritative
+                    if (enabled == _ldb_enabled || is_lazy())
                         return;
 
                     if (enabled)
                     {
-                        _ldb.open(*_ldb_path);
                         auto batch = _ldb.create_batch();
                         for (const auto& item : _cache)
                             batch.store(item.first, item.second);
@@ -86,8 +236,7 @@ namespace thinkyoung {
                     }
                     else
                     {
-                        _ldb.close();
-                        fc::remove_all(*_ldb_path);
+                        _ldb.clear();
                     }
 
                     _ldb_enabled = enabled;
@@ -97,6 +246,24 @@ namespace thinkyoung {
             void store(const K& key, const V& value)
             {
                 try {
+                    if (is_lazy())
+                    {
+                        if (count(key) == 0) ++_size;
+                        untrack(key);
+                        _cache[key] = value;
+                        if (_ldb.deferring())
+                        {
+                            // the held writes keep the value, the entry may be evicted like a clean one
+                            _dirty.erase(key);
+                            _ldb.store(key, value);
+                            track(key);
+                            evict();
+                            return;
+                        }
+                        _dirty.insert(key);
+                        if (_dirty.size() >= _cache_limit) flush();
+                        return;
+                    }
                     _cache[key] = value;
                     if (_ldb_enabled)
                         _ldb.store(key, value);
@@ -106,29 +273,56 @@ namespace thinkyoung {
             void remove(const K& key)
             {
                 try {
+                    if (is_lazy())
+                    {
+                        if (count(key) > 0) --_size;
+                        untrack(key);
+                        _cache.erase(key);
+                        if (_ldb.deferring())
+                        {
+                            _dirty.erase(key);
+                            _ldb.remove(key);
+                            return;
+                        }
+                        _dirty.insert(key);
+                        if (_dirty.size() >= _cache_limit) flush();
+                        return;
+                    }
                     _cache.erase(key);
                     if (_ldb_enabled)
                         _ldb.remove(key);
                 } FC_CAPTURE_AND_RETHROW((key))
             }
 
-            auto empty()const -> decltype(_cache.empty())
+            fc::optional<V> fetch_optional(const K& key)const
             {
-                return _cache.empty();
+                try {
+                    const auto iter = unordered_find(key);
+                    if (iter != _cache.end()) return iter->second;
+                    return fc::optional<V>();
+                } FC_CAPTURE_AND_RETHROW((key))
             }
 
-            auto size()const -> decltype(_cache.size())
+            bool empty()const
             {
-                return _cache.size();
+                return size() == 0;
+            }
+
+            size_t size()const
+            {
+                return is_lazy() ? _size : _cache.size();
             }
 
             auto count(const K& key)const -> decltype(_cache.count(key))
             {
+                fault_in(key);
                 return _cache.count(key);
             }
 
+            /** Only valid when every entry is in memory, use scan() for lazy maps */
             auto unordered_begin()const -> decltype(_cache.cbegin())
             {
+                FC_ASSERT(!is_lazy(), "Unordered iteration is not available on a lazy map!");
                 return _cache.cbegin();
             }
 
@@ -137,14 +331,35 @@ namespace thinkyoung {
                 return _cache.cend();
             }
 
+            /** For lazy maps the iterator is only valid until the next lookup */
             auto unordered_find(const K& key)const -> decltype(_cache.find(key))
             {
-                return _cache.find(key);
+                fault_in(key);
+                const auto iter = _cache.find(key);
+                if (iter != _cache.end()) touch(key);
+                return iter;
+            }
+
+            /** Visit every entry, from memory when fully loaded and from leveldb when lazy */
+            void scan(const std::function<void(const K&, const V&)>& callback)const
+            {
+                try {
+                    if (!is_lazy())
+                    {
+                        for (const auto& item : _cache)
+                            callback(item.first, item.second);
+                        return;
+                    }
+                    flush();
+                    for (auto iter = _ldb.begin(); iter.valid(); ++iter)
+                        callback(iter.key(), iter.value());
+                } FC_CAPTURE_AND_RETHROW()
             }
 
             auto ordered_first()const -> decltype(_ldb.begin())
             {
                 try {
+                    flush();
                     return _ldb.begin();
                 } FC_CAPTURE_AND_RETHROW()
             }
@@ -152,6 +367,7 @@ namespace thinkyoung {
             auto ordered_last()const -> decltype(_ldb.last())
             {
                 try {
+                    flush();
                     return _ldb.last();
                 } FC_CAPTURE_AND_RETHROW()
             }
@@ -159,6 +375,7 @@ namespace thinkyoung {
             auto ordered_lower_bound(const K& key)const -> decltype(_ldb.lower_bound(key))
             {
                 try {
+                    flush();
                     return _ldb.lower_bound(key);
                 } FC_CAPTURE_AND_RETHROW((key))
             }
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <leveldb/comparator.h>
+#include <leveldb/db.h>
+#include <leveldb/write_batch.h>
+
+#include <fc/filesystem.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace thinkyoung {
+    namespace db {
+
+        /** The writes a table holds back while its database defers them */
+        class DeferredTable
+        {
+        public:
+            virtual ~DeferredTable() {}
+
+            virtual void append_deferred_writes(leveldb::WriteBatch& batch)const = 0;
+            virtual void clear_deferred_writes() = 0;
+        };
+
+        /**
+         *  @brief one leveldb database shared by several LevelMaps
+         *
+         *  Every key starts with a byte naming its table, the rest of the key is ordered by the
+         *  comparator of that table. Tables are added before the database opens, because leveldb
+         *  compares keys of every table while it recovers and compacts.
+         *
+         *  Between defer_writes and commit_deferred_writes the tables hold their writes, and the
+         *  commit writes all of them with one WriteBatch, so they reach the disk together or not at all.
+         */
+        class LevelDatabase
+        {
+        public:
+            LevelDatabase();
+            ~LevelDatabase();
+
+            void add_table(uint8_t table, const leveldb::Comparator* comparator);
+            void attach(uint8_t table, DeferredTable* writer);
+            void detach(uint8_t table);
+
+            void open(const fc::path& dir, size_t cache_size = 0);
+            void close();
+            bool is_open()const;
+            leveldb::DB* get()const;
+
+            void defer_writes();
+            bool deferring()const;
+            void commit_deferred_writes();
+
+        private:
+            class table_compare : public leveldb::Comparator
+            {
+            public:
+                table_compare();
+
+                int Compare(const leveldb::Slice& a, const leveldb::Slice& b)const;
+                const char* Name()const { return "table_compare"; }
+                void FindShortestSeparator(std::string*, const leveldb::Slice&)const {}
+                void FindShortSuccessor(std::string*)const {}
+
+                std::array<const leveldb::Comparator*, 256>  _tables;
+            };
+
+            std::unique_ptr<leveldb::DB>                    _db;
+            std::unique_ptr<leveldb::Cache>                 _cache;
+            table_compare                                   _comparer;
+            std::array<DeferredTable*, 256>                 _writers;
+            leveldb::WriteOptions                           _write_options;
+            bool                                            _deferring = false;
+        };
+
+    }
+} // thinkyoung::db
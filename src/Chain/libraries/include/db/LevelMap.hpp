@@ -7,6 +7,7 @@
 
 
 #include <db/Exception.hpp>
+#include <db/LevelDatabase.hpp>
 #include <db/UpgradeLeveldb.hpp>
 
 #include <fc/filesystem.hpp>
@@ -14,7 +15,11 @@
 #include <fc/io/raw.hpp>
 #include <fc/reflect/reflect.hpp>
 
+#include <algorithm>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
 
 namespace thinkyoung {
     namespace db {
@@ -23,11 +28,26 @@ namespace thinkyoung {
 
         /**
          *  @brief implements a high-level API on top of Level DB that stores items using fc::raw / reflection
+         *
+         *  A map either opens a database of its own, or is attached to a table of a LevelDatabase
+         *  shared with other maps. While the shared database defers writes, store and remove are
+         *  held in memory, and every read, ordered or not, sees them merged with the stored items.
          */
         template<typename Key, typename Value>
-        class LevelMap
+        class LevelMap : public DeferredTable
         {
+            typedef std::map<Key, fc::optional<Value>> deferred_map; // empty when removed
+
         public:
+            ~LevelMap()
+            {
+                try {
+                    close();
+                } catch (const fc::exception& e) {
+                    elog("unexpected exception closing database\n ${e}", ("e", e.to_detail_string()));
+                }
+            }
+
             void open(const fc::path& dir, bool create = true, size_t cache_size = 0)
             {
                 try {
@@ -80,21 +100,113 @@ namespace thinkyoung {
                         FC_THROW_EXCEPTION(level_map_open_failure, "Failure opening database: ${db}\nStatus: ${msg}",
                             ("db", dir)("msg", ntrxstat.ToString()));
                     }
-                    _db.reset(ndb);
+                    _own_db.reset(ndb);
+                    _db = ndb;
 
                     try_upgrade_db(dir, ndb, fc::get_typename<Value>::name(), sizeof(Value));
                 } FC_CAPTURE_AND_RETHROW((dir)(create)(cache_size))
             }
 
+            /** Add the table to a database that is not open yet, so leveldb knows how to order its keys */
+            static void add_table(LevelDatabase& database, const uint8_t table)
+            {
+                static key_compare comparer;
+                database.add_table(table, &comparer);
+            }
+
+            /** Use a table of an open database, added with add_table before it opened */
+            void open(LevelDatabase& database, const uint8_t table)
+            {
+                try {
+                    FC_ASSERT(!is_open(), "Database is already open!");
+                    FC_ASSERT(database.is_open(), "Database is not open!");
+
+                    _read_options.verify_checksums = true;
+                    _iter_options.verify_checksums = true;
+                    _iter_options.fill_cache = false;
+                    _sync_options.sync = true;
+
+                    database.attach(table, this);
+                    _database = &database;
+                    _table = table;
+                    _prefix = std::string(1, char(table));
+                    _db = database.get();
+                } FC_CAPTURE_AND_RETHROW((table))
+            }
+
             bool is_open()const
             {
-                return !!_db;
+                return _db != nullptr;
             }
 
             void close()
             {
-                _db.reset();
+                if (_database != nullptr)
+                {
+                    // the shared database commits what the table holds when it closes
+                    if (_database->is_open() && _database->deferring())
+                        _database->commit_deferred_writes();
+                    _database->detach(_table);
+                    _database = nullptr;
+                }
+                clear_deferred_writes();
+                _db = nullptr;
+                _own_db.reset();
                 _cache.reset();
+                _prefix.clear();
+            }
+
+            bool deferring()const
+            {
+                return _database != nullptr && _database->deferring();
+            }
+
+            void append_deferred_writes(ldb::WriteBatch& batch)const override
+            {
+                std::lock_guard<std::mutex> lock(_deferred_mutex);
+                if (!_deferred)
+                    return;
+
+                for (const auto& item : *_deferred)
+                {
+                    const std::vector<char> kslice = pack_key(item.first);
+                    const ldb::Slice ks(kslice.data(), kslice.size());
+                    if (item.second.valid())
+                    {
+                        auto vec = fc::raw::pack(*item.second);
+                        batch.Put(ks, ldb::Slice(vec.data(), vec.size()));
+                    }
+                    else
+                    {
+                        batch.Delete(ks);
+                    }
+                }
+            }
+
+            void clear_deferred_writes() override
+            {
+                std::lock_guard<std::mutex> lock(_deferred_mutex);
+                _deferred.reset();
+            }
+
+            /** Remove every item, from the table only when the database is shared */
+            void clear()
+            {
+                try {
+                    FC_ASSERT(is_open(), "Database is not open!");
+                    FC_ASSERT(!deferring(), "Can not clear a table while its writes are deferred!");
+
+                    ldb::WriteBatch batch;
+                    std::unique_ptr<ldb::Iterator> it(_db->NewIterator(_iter_options));
+                    for (seek_first(*it); in_table(*it); it->Next())
+                        batch.Delete(it->key());
+
+                    auto status = _db->Write(_write_options, &batch);
+                    if (!status.ok())
+                    {
+                        FC_THROW_EXCEPTION(level_map_failure, "database error: ${msg}", ("msg", status.ToString()));
+                    }
+                } FC_RETHROW_EXCEPTIONS(warn, "error clearing database")
             }
 
             fc::optional<Value> fetch_optional(const Key& k)
@@ -102,9 +214,48 @@ namespace thinkyoung {
                 try {
                     FC_ASSERT(is_open(), "Database is not open!");
 
-                    auto itr = find(k);
-                    if (itr.valid()) return itr.value();
-                    return fc::optional<Value>();
+                    fc::optional<Value> deferred;
+                    if (find_deferred(k, deferred)) return deferred;
+
+                    std::vector<char> kslice = pack_key(k);
+                    ldb::Slice ks(kslice.data(), kslice.size());
+                    std::string value;
+                    auto status = _db->Get(_read_options, ks, &value);
+                    if (status.IsNotFound()) return fc::optional<Value>();
+                    if (!status.ok())
+                    {
+                        FC_THROW_EXCEPTION(level_map_failure, "database error: ${msg}", ("msg", status.ToString()));
+                    }
+                    fc::datastream<const char*> ds(value.c_str(), value.size());
+                    Value tmp;
+                    fc::raw::unpack(ds, tmp);
+                    return tmp;
+                } FC_RETHROW_EXCEPTIONS(warn, "")
+            }
+
+            /** Return the stored bytes of k as they are, without unpacking them into a Value */
+            fc::optional<std::vector<char>> fetch_raw_optional(const Key& k)
+            {
+                try {
+                    FC_ASSERT(is_open(), "Database is not open!");
+
+                    fc::optional<Value> deferred;
+                    if (find_deferred(k, deferred))
+                    {
+                        if (!deferred.valid()) return fc::optional<std::vector<char>>();
+                        return fc::raw::pack(*deferred);
+                    }
+
+                    std::vector<char> kslice = pack_key(k);
+                    ldb::Slice ks(kslice.data(), kslice.size());
+                    std::string value;
+                    auto status = _db->Get(_read_options, ks, &value);
+                    if (status.IsNotFound()) return fc::optional<std::vector<char>>();
+                    if (!status.ok())
+                    {
+                        FC_THROW_EXCEPTION(level_map_failure, "database error: ${msg}", ("msg", status.ToString()));
+                    }
+                    return std::vector<char>(value.begin(), value.end());
                 } FC_RETHROW_EXCEPTIONS(warn, "")
             }
 
@@ -113,7 +264,14 @@ namespace thinkyoung {
                 try {
                     FC_ASSERT(is_open(), "Database is not open!");
 
-                    std::vector<char> kslice = fc::raw::pack(k);
+                    fc::optional<Value> deferred;
+                    if (find_deferred(k, deferred))
+                    {
+                        if (!deferred.valid())
+                            FC_THROW_EXCEPTION(fc::key_not_found_exception, "unable to find key ${key}", ("key", k));
+                        return *deferred;
+                    }
+                    std::vector<char> kslice = pack_key(k);
                     ldb::Slice ks(kslice.data(), kslice.size());
                     std::string value;
                     auto status = _db->Get(_read_options, ks, &value);
@@ -132,40 +290,206 @@ namespace thinkyoung {
                 } FC_RETHROW_EXCEPTIONS(warn, "error fetching key ${key}", ("key", k));
             }
 
+            /**
+             *  Walks the stored items and, while writes are deferred, the held writes in key order.
+             *  A held write replaces the stored item with the same key, a held remove hides it. The
+             *  held writes are a snapshot taken when the iterator was created, like the stored items.
+             */
             class iterator
             {
             public:
                 iterator(){}
                 bool valid()const
                 {
-                    return _it && _it->Valid();
+                    return _source != no_source;
                 }
 
                 Key key()const
                 {
-                    Key tmp_key;
-                    fc::datastream<const char*> ds2(_it->key().data(), _it->key().size());
-                    fc::raw::unpack(ds2, tmp_key);
-                    return tmp_key;
+                    if (_source == deferred_source) return _dit->first;
+                    return stored_key();
                 }
 
                 Value value()const
                 {
+                    if (_source == deferred_source) return *_dit->second;
                     Value tmp_val;
                     fc::datastream<const char*> ds(_it->value().data(), _it->value().size());
                     fc::raw::unpack(ds, tmp_val);
                     return tmp_val;
                 }
 
-                iterator& operator++()    { _it->Next(); return *this; }
-                iterator& operator--()    { _it->Prev(); return *this; }
+                iterator& operator++()
+                {
+                    if (!_forward)
+                    {
+                        seek_forward(key(), false);
+                        return *this;
+                    }
+                    if (_source == deferred_source) ++_dit;
+                    else _it->Next();
+                    settle_forward();
+                    return *this;
+                }
+
+                iterator& operator--()
+                {
+                    if (_forward)
+                    {
+                        seek_backward(key(), false);
+                        return *this;
+                    }
+                    if (_source == deferred_source) step_deferred_back();
+                    else _it->Prev();
+                    settle_backward();
+                    return *this;
+                }
 
             protected:
                 friend class LevelMap;
-                iterator(ldb::Iterator* it)
-                    :_it(it){}
+                enum source_type { no_source, stored_source, deferred_source };
+
+                iterator(ldb::Iterator* it, const std::string& prefix, const std::shared_ptr<const deferred_map>& deferred)
+                    :_it(it), _prefix(prefix), _deferred(deferred)
+                {
+                    if (_deferred) _dit = _deferred->end();
+                }
+
+                bool stored_valid()const
+                {
+                    return _it->Valid() && _it->key().starts_with(_prefix);
+                }
+
+                Key stored_key()const
+                {
+                    Key tmp_key;
+                    fc::datastream<const char*> ds2(_it->key().data() + _prefix.size(), _it->key().size() - _prefix.size());
+                    fc::raw::unpack(ds2, tmp_key);
+                    return tmp_key;
+                }
+
+                bool deferred_valid()const
+                {
+                    return _deferred && _dit != _deferred->end();
+                }
+
+                void step_deferred_back()
+                {
+                    if (_dit == _deferred->begin()) _dit = _deferred->end();
+                    else --_dit;
+                }
 
-                std::shared_ptr<ldb::Iterator> _it;
+                void seek_first()
+                {
+                    _forward = true;
+                    LevelMap::seek_first(*_it, _prefix);
+                    if (_deferred) _dit = _deferred->begin();
+                    settle_forward();
+                }
+
+                void seek_last()
+                {
+                    _forward = false;
+                    LevelMap::seek_last(*_it, _prefix);
+                    if (_deferred)
+                    {
+                        _dit = _deferred->end();
+                        step_deferred_back();
+                    }
+                    settle_backward();
+                }
+
+                /** Move to the first item after k, or at k when inclusive */
+                void seek_forward(const Key& k, const bool inclusive)
+                {
+                    _forward = true;
+                    const std::vector<char> kslice = LevelMap::pack_key(_prefix, k);
+                    _it->Seek(ldb::Slice(kslice.data(), kslice.size()));
+                    if (!inclusive && stored_valid() && stored_key() == k) _it->Next();
+                    if (_deferred) _dit = inclusive ? _deferred->lower_bound(k) : _deferred->upper_bound(k);
+                    settle_forward();
+                }
+
+                /** Move to the last item before k, or at k when inclusive */
+                void seek_backward(const Key& k, const bool inclusive)
+                {
+                    _forward = false;
+                    const std::vector<char> kslice = LevelMap::pack_key(_prefix, k);
+                    _it->Seek(ldb::Slice(kslice.data(), kslice.size()));
+                    if (!_it->Valid()) _it->SeekToLast();
+                    else if (!inclusive || !stored_valid() || !(stored_key() == k)) _it->Prev();
+                    if (_deferred)
+                    {
+                        _dit = inclusive ? _deferred->upper_bound(k) : _deferred->lower_bound(k);
+                        step_deferred_back();
+                    }
+                    settle_backward();
+                }
+
+                void settle_forward()
+                {
+                    while (true)
+                    {
+                        const bool stored = stored_valid();
+                        if (!deferred_valid())
+                        {
+                            _source = stored ? stored_source : no_source;
+                            return;
+                        }
+                        if (stored)
+                        {
+                            const Key k = stored_key();
+                            if (k < _dit->first)
+                            {
+                                _source = stored_source;
+                                return;
+                            }
+                            if (k == _dit->first) _it->Next();
+                        }
+                        if (_dit->second.valid())
+                        {
+                            _source = deferred_source;
+                            return;
+                        }
+                        ++_dit;
+                    }
+                }
+
+                void settle_backward()
+                {
+                    while (true)
+                    {
+                        const bool stored = stored_valid();
+                        if (!deferred_valid())
+                        {
+                            _source = stored ? stored_source : no_source;
+                            return;
+                        }
+                        if (stored)
+                        {
+                            const Key k = stored_key();
+                            if (_dit->first < k)
+                            {
+                                _source = stored_source;
+                                return;
+                            }
+                            if (k == _dit->first) _it->Prev();
+                        }
+                        if (_dit->second.valid())
+                        {
+                            _source = deferred_source;
+                            return;
+                        }
+                        step_deferred_back();
+                    }
+                }
+
+                std::shared_ptr<ldb::Iterator>              _it;
+                std::string                                 _prefix;
+                std::shared_ptr<const deferred_map>         _deferred;
+                typename deferred_map::const_iterator       _dit;
+                bool                                        _forward = true;
+                source_type                                 _source = no_source;
             };
 
             iterator begin() const
@@ -173,8 +497,8 @@ namespace thinkyoung {
                 try {
                     FC_ASSERT(is_open(), "Database is not open!");
 
-                    iterator itr(_db->NewIterator(_iter_options));
-                    itr._it->SeekToFirst();
+                    iterator itr = new_iterator();
+                    itr.seek_first();
 
                     if (itr._it->status().IsNotFound())
                     {
@@ -196,31 +520,7 @@ namespace thinkyoung {
             iterator find(const Key& key)
             {
                 try {
-                    FC_ASSERT(is_open(), "Database is not open!");
-
-                    ldb::Slice key_slice;
-
-                    /** avoid dynamic memory allocation at this step if possible, most
-                     * keys should be relatively small in size and not require dynamic
-                     * memory allocation to seralize the key.
-                     */
-                    fc::array<char, 256 + sizeof(Key)>  stack_buffer;
-
-                    size_t pack_size = fc::raw::pack_size(key);
-                    if (pack_size <= stack_buffer.size())
-                    {
-                        fc::datastream<char*> ds(stack_buffer.data, stack_buffer.size());
-                        fc::raw::pack(ds, key);
-                        key_slice = ldb::Slice(stack_buffer.data, pack_size);
-                    }
-                    else
-                    {
-                        auto kslice = fc::raw::pack(key);
-                        key_slice = ldb::Slice(kslice.data(), kslice.size());
-                    }
-
-                    iterator itr(_db->NewIterator(_iter_options));
-                    itr._it->Seek(key_slice);
+                    iterator itr = lower_bound(key);
                     if (itr.valid() && itr.key() == key)
                     {
                         return itr;
@@ -234,11 +534,8 @@ namespace thinkyoung {
                 try {
                     FC_ASSERT(is_open(), "Database is not open!");
 
-                    std::vector<char> kslice = fc::raw::pack(key);
-                    ldb::Slice key_slice(kslice.data(), kslice.size());
-
-                    iterator itr(_db->NewIterator(_iter_options));
-                    itr._it->Seek(key_slice);
+                    iterator itr = new_iterator();
+                    itr.seek_forward(key, true);
                     return itr;
                 } FC_RETHROW_EXCEPTIONS(warn, "error finding ${key}", ("key", key))
             }
@@ -248,8 +545,8 @@ namespace thinkyoung {
                 try {
                     FC_ASSERT(is_open(), "Database is not open!");
 
-                    iterator itr(_db->NewIterator(_iter_options));
-                    itr._it->SeekToLast();
+                    iterator itr = new_iterator();
+                    itr.seek_last();
                     return itr;
                 } FC_RETHROW_EXCEPTIONS(warn, "error finding last")
             }
@@ -257,17 +554,12 @@ namespace thinkyoung {
             bool last(Key& k)
             {
                 try {
-                    FC_ASSERT(is_open(), "Database is not open!");
-
-                    std::unique_ptr<ldb::Iterator> it(_db->NewIterator(_iter_options));
-                    FC_ASSERT(it != nullptr);
-                    it->SeekToLast();
-                    if (!it->Valid())
+                    const iterator itr = last();
+                    if (!itr.valid())
                     {
                         return false;
                     }
-                    fc::datastream<const char*> ds2(it->key().data(), it->key().size());
-                    fc::raw::unpack(ds2, k);
+                    k = itr.key();
                     return true;
                 } FC_RETHROW_EXCEPTIONS(warn, "error reading last item from database");
             }
@@ -275,20 +567,13 @@ namespace thinkyoung {
             bool last(Key& k, Value& v)
             {
                 try {
-                    FC_ASSERT(is_open(), "Database is not open!");
-
-                    std::unique_ptr<ldb::Iterator> it(_db->NewIterator(_iter_options));
-                    FC_ASSERT(it != nullptr);
-                    it->SeekToLast();
-                    if (!it->Valid())
+                    const iterator itr = last();
+                    if (!itr.valid())
                     {
                         return false;
                     }
-                    fc::datastream<const char*> ds(it->value().data(), it->value().size());
-                    fc::raw::unpack(ds, v);
-
-                    fc::datastream<const char*> ds2(it->key().data(), it->key().size());
-                    fc::raw::unpack(ds2, k);
+                    v = itr.value();
+                    k = itr.key();
                     return true;
                 } FC_RETHROW_EXCEPTIONS(warn, "error reading last item from database");
             }
@@ -336,6 +621,16 @@ namespace thinkyoung {
                     try
                     {
                         FC_ASSERT(_map->is_open(), "Database is not open!");
+                        if (_map->deferring())
+                        {
+                            // the batch joins the writes the shared database holds
+                            deferred_handler handler(_map);
+                            ldb::Status status = _batch.Iterate(&handler);
+                            if (!status.ok())
+                                FC_THROW_EXCEPTION(level_map_failure, "database error while applying batch: ${msg}", ("msg", status.ToString()));
+                            _batch.Clear();
+                            return;
+                        }
 
                         ldb::Status status = _map->_db->Write(_write_options, &_batch);
                         if (!status.ok())
@@ -352,7 +647,7 @@ namespace thinkyoung {
 
                 void store(const Key& k, const Value& v)
                 {
-                    std::vector<char> kslice = fc::raw::pack(k);
+                    std::vector<char> kslice = _map->pack_key(k);
                     ldb::Slice ks(kslice.data(), kslice.size());
 
                     auto vec = fc::raw::pack(v);
@@ -363,7 +658,7 @@ namespace thinkyoung {
 
                 void remove(const Key& k)
                 {
-                    std::vector<char> kslice = fc::raw::pack(k);
+                    std::vector<char> kslice = _map->pack_key(k);
                     ldb::Slice ks(kslice.data(), kslice.size());
                     _batch.Delete(ks);
                 }
@@ -380,7 +675,12 @@ namespace thinkyoung {
                 try {
                     FC_ASSERT(is_open(), "Database is not open!");
 
-                    std::vector<char> kslice = fc::raw::pack(k);
+                    if (deferring())
+                    {
+                        defer(k, v);
+                        return;
+                    }
+                    std::vector<char> kslice = pack_key(k);
                     ldb::Slice ks(kslice.data(), kslice.size());
 
                     auto vec = fc::raw::pack(v);
@@ -399,7 +699,12 @@ namespace thinkyoung {
                 try {
                     FC_ASSERT(is_open(), "Database is not open!");
 
-                    std::vector<char> kslice = fc::raw::pack(k);
+                    if (deferring())
+                    {
+                        defer(k, fc::optional<Value>());
+                        return;
+                    }
+                    std::vector<char> kslice = pack_key(k);
                     ldb::Slice ks(kslice.data(), kslice.size());
                     auto status = _db->Delete(sync ? _sync_options : _write_options, ks);
                     if (!status.ok())
@@ -447,6 +752,114 @@ namespace thinkyoung {
             }
 
         private:
+            /** Look k up in the held writes, value is left empty when the held write removes k */
+            bool find_deferred(const Key& k, fc::optional<Value>& value)const
+            {
+                std::lock_guard<std::mutex> lock(_deferred_mutex);
+                if (!_deferred)
+                    return false;
+                const auto deferred = _deferred->find(k);
+                if (deferred == _deferred->end())
+                    return false;
+                value = deferred->second;
+                return true;
+            }
+
+            void defer(const Key& k, const fc::optional<Value>& value)
+            {
+                std::lock_guard<std::mutex> lock(_deferred_mutex);
+                // iterators keep the held writes they were created with, they are copied before changing
+                if (!_deferred)
+                    _deferred = std::make_shared<deferred_map>();
+                else if (_deferred.use_count() > 1)
+                    _deferred = std::make_shared<deferred_map>(*_deferred);
+                (*_deferred)[k] = value;
+            }
+
+            iterator new_iterator()const
+            {
+                std::shared_ptr<const deferred_map> deferred;
+                {
+                    std::lock_guard<std::mutex> lock(_deferred_mutex);
+                    deferred = _deferred;
+                }
+                return iterator(_db->NewIterator(_iter_options), _prefix, deferred);
+            }
+
+            std::vector<char> pack_key(const Key& k)const
+            {
+                return pack_key(_prefix, k);
+            }
+
+            static std::vector<char> pack_key(const std::string& prefix, const Key& k)
+            {
+                std::vector<char> kslice(prefix.size() + fc::raw::pack_size(k));
+                std::copy(prefix.begin(), prefix.end(), kslice.begin());
+                fc::datastream<char*> ds(kslice.data() + prefix.size(), kslice.size() - prefix.size());
+                fc::raw::pack(ds, k);
+                return kslice;
+            }
+
+            bool in_table(const ldb::Iterator& it)const
+            {
+                return it.Valid() && it.key().starts_with(_prefix);
+            }
+
+            void seek_first(ldb::Iterator& it)const
+            {
+                seek_first(it, _prefix);
+            }
+
+            static void seek_first(ldb::Iterator& it, const std::string& prefix)
+            {
+                if (prefix.empty()) it.SeekToFirst();
+                else it.Seek(prefix);
+            }
+
+            /** The table is followed by the one named by the next byte, its last key is just before that */
+            static void seek_last(ldb::Iterator& it, const std::string& prefix)
+            {
+                if (prefix.empty() || uint8_t(prefix[0]) == 0xff)
+                {
+                    it.SeekToLast();
+                    return;
+                }
+                it.Seek(std::string(1, char(uint8_t(prefix[0]) + 1)));
+                if (it.Valid()) it.Prev();
+                else it.SeekToLast();
+            }
+
+            /** Replays a write_batch into the held writes */
+            class deferred_handler : public ldb::WriteBatch::Handler
+            {
+            public:
+                explicit deferred_handler(LevelMap* map) : _map(map) {}
+
+                void Put(const ldb::Slice& key, const ldb::Slice& value)
+                {
+                    Value tmp_val;
+                    fc::datastream<const char*> ds(value.data(), value.size());
+                    fc::raw::unpack(ds, tmp_val);
+                    _map->defer(unpack_key(key), tmp_val);
+                }
+
+                void Delete(const ldb::Slice& key)
+                {
+                    _map->defer(unpack_key(key), fc::optional<Value>());
+                }
+
+            private:
+                Key unpack_key(const ldb::Slice& key)const
+                {
+                    Key tmp_key;
+                    fc::datastream<const char*> ds(key.data() + _map->_prefix.size(), key.size() - _map->_prefix.size());
+                    fc::raw::unpack(ds, tmp_key);
+                    return tmp_key;
+                }
+
+                LevelMap*   _map;
+            };
+
             class key_compare : public leveldb::Comparator
             {
             public:
@@ -468,14 +881,21 @@ namespace thinkyoung {
                 void FindShortSuccessor(std::string*)const{};
             };
 
-            std::unique_ptr<leveldb::DB>    _db;
+            std::unique_ptr<leveldb::DB>    _own_db;
+            leveldb::DB*                    _db = nullptr; // the own database, or the shared one
             std::unique_ptr<leveldb::Cache> _cache;
             key_compare                     _comparer;
+            LevelDatabase*                  _database = nullptr;
+            uint8_t                         _table = 0;
+            std::string                     _prefix; // the table byte in a shared database
 
             ldb::ReadOptions                _read_options;
             ldb::ReadOptions                _iter_options;
             ldb::WriteOptions               _write_options;
             ldb::WriteOptions               _sync_options;
+
+            std::shared_ptr<deferred_map>   _deferred;
+            mutable std::mutex              _deferred_mutex; // chain server threads read while a block is applied
         };
 
     }
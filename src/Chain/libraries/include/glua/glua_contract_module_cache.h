@@ -0,0 +1,86 @@
+﻿/**
+* process wide cache of contract modules decoded from the chain
+*/
+
+#ifndef glua_contract_module_cache_h
+#define glua_contract_module_cache_h
+
+#include <glua/lprefix.h>
+#include <glua/thinkyoung_lua_api.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// contract modules kept by GluaContractModuleCache
+#define GLUA_CONTRACT_MODULE_CACHE_SIZE 256
+
+namespace thinkyoung
+{
+    namespace lua
+    {
+        namespace lib
+        {
+            /************************************************************************/
+            /* Keeps the byte streams and abi of contracts built from the chain, so
+               an import or a storage check does not copy the contract code again.
+               Entries are keyed by contract id and code hash, and remember whether
+               the bytecode already passed check_contract_proto. Cached streams are
+               shared and must not be modified. Lua protos themselves are objects
+               of the lua state that undumped them, so each state still loads the
+               bytecode once.                                                      */
+            /************************************************************************/
+            class GluaContractModuleCache {
+              public:
+                static GluaContractModuleCache &instance();
+                
+                explicit GluaContractModuleCache(size_t max_size = GLUA_CONTRACT_MODULE_CACHE_SIZE);
+                
+                std::shared_ptr<GluaModuleByteStream> get(const std::string &contract_id, const std::string &code_hash);
+                void put(const std::string &contract_id, const std::string &code_hash,
+                         const std::shared_ptr<GluaModuleByteStream> &stream);
+                /************************************************************************/
+                /* whether a cached stream already passed check_contract_proto          */
+                /************************************************************************/
+                bool is_proto_checked(const GluaModuleByteStream *stream) const;
+                void set_proto_checked(const GluaModuleByteStream *stream);
+                /************************************************************************/
+                /* drop the module of a contract, used when the contract changes        */
+                /************************************************************************/
+                void invalidate(const std::string &contract_id);
+                void clear();
+                
+                uint64_t hits() const;
+                uint64_t misses() const;
+                size_t size() const;
+                
+              private:
+                struct Entry {
+                    std::string contract_id;
+                    std::string code_hash;
+                    std::shared_ptr<GluaModuleByteStream> stream;
+                    bool proto_checked = false;
+                };
+                typedef std::list<Entry>::iterator EntryIter;
+                
+                void erase(EntryIter it);
+                
+                mutable std::mutex _mutex;
+                const size_t _max_size;
+                std::list<Entry> _entries; // most recently used first
+                std::unordered_map<std::string, EntryIter> _by_contract_id;
+                std::unordered_map<const GluaModuleByteStream*, EntryIter> _by_stream;
+                uint64_t _hits = 0;
+                uint64_t _misses = 0;
+            };
+            
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,99 @@
+﻿/**
+* timing of contract execution by opcode, lua function and chain api
+*/
+
+#ifndef glua_contract_profiler_h
+#define glua_contract_profiler_h
+
+#include <glua/lprefix.h>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+struct Proto;
+
+namespace thinkyoung
+{
+    namespace lua
+    {
+        namespace lib
+        {
+            struct GluaProfileCounter {
+                uint64_t count = 0; // instructions for opcodes and functions, calls for chain apis
+                uint64_t total_ns = 0;
+            };
+            
+            struct GluaProfileReport {
+                uint64_t instructions = 0;
+                uint64_t total_ns = 0;
+                std::map<std::string, GluaProfileCounter> opcodes;
+                std::map<std::string, GluaProfileCounter> functions; // by "source:linedefined" of the Proto
+                std::map<std::string, GluaProfileCounter> apis;
+            };
+            
+            /************************************************************************/
+            /* opt-in profiler of a lua state. Each instruction is charged the wall
+               time until the next instruction starts, so the time of a call
+               (including the chain apis it reaches) lands on OP_CALL and on the
+               calling function; chain apis are timed again on their own.         */
+            /************************************************************************/
+            class GluaContractProfiler {
+              public:
+                GluaContractProfiler();
+                
+                /************************************************************************/
+                /* the profiler of L, nullptr when profiling is off                     */
+                /************************************************************************/
+                static GluaContractProfiler *of(lua_State *L);
+                
+                /************************************************************************/
+                /* close the last instruction and start timing the one about to run     */
+                /************************************************************************/
+                void on_instruction(const Proto *proto, int opcode);
+                /************************************************************************/
+                /* close the last instruction, when the state leaves the vm             */
+                /************************************************************************/
+                void stop();
+                void add_api_call(const char *api_name, uint64_t ns);
+                
+                GluaProfileReport report() const;
+                
+              private:
+                typedef std::chrono::steady_clock Clock;
+                
+                void charge_last_instruction(Clock::time_point now);
+                
+                Clock::time_point _last_time;
+                int _last_opcode = -1;
+                const Proto *_last_proto = nullptr;
+                size_t _last_function = 0;
+                std::vector<GluaProfileCounter> _opcodes;
+                std::unordered_map<const Proto*, size_t> _function_index;
+                std::vector<std::pair<std::string, GluaProfileCounter>> _functions;
+                std::map<std::string, GluaProfileCounter> _apis;
+            };
+            
+            /************************************************************************/
+            /* times a chain api called by a contract when its state is profiled    */
+            /************************************************************************/
+            class GluaProfilerApiScope {
+              public:
+                GluaProfilerApiScope(lua_State *L, const char *api_name);
+                ~GluaProfilerApiScope();
+                
+              private:
+                GluaContractProfiler *_profiler;
+                const char *_api_name;
+                std::chrono::steady_clock::time_point _start;
+            };
+            
+        }
+    }
+}
+
+#endif
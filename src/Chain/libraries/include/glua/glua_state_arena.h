@@ -0,0 +1,97 @@
+/**
+* arena behind the lua allocator of contract states, with a memory limit
+*/
+
+#ifndef glua_state_arena_h
+#define glua_state_arena_h
+
+#include <glua/lprefix.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct lua_State;
+
+// memory the lua objects of a contract state may hold at the same time
+#define GLUA_STATE_DEFAULT_MEMORY_LIMIT (64*1024*1024)
+// limit of new states, the chain sets GLUA_STATE_DEFAULT_MEMORY_LIMIT once the limit is active
+#define GLUA_STATE_UNLIMITED_MEMORY ((size_t)-1)
+// small blocks are carved from chunks of this size
+#define GLUA_STATE_ARENA_CHUNK_SIZE (256*1024)
+// blocks up to this size come from 16 byte size classes, larger ones from malloc
+#define GLUA_STATE_ARENA_MAX_SMALL_BLOCK 512
+
+namespace thinkyoung
+{
+    namespace lua
+    {
+        namespace lib
+        {
+            /************************************************************************/
+            /* lua_Alloc of one lua state. Small blocks are bump allocated from
+               chunks and reused through per size class free lists, everything is
+               released at once when the state is closed. The memory counted
+               against the limit is the size lua asks for, not the size of the
+               block, so the point where a contract runs out of memory does not
+               depend on the allocator or the platform.                           */
+            /************************************************************************/
+            class GluaStateArena {
+              public:
+                explicit GluaStateArena(size_t memory_limit = GLUA_STATE_DEFAULT_MEMORY_LIMIT);
+                ~GluaStateArena();
+                
+                /************************************************************************/
+                /* lua_Alloc, ud is the GluaStateArena                                  */
+                /************************************************************************/
+                static void *alloc(void *ud, void *ptr, size_t osize, size_t nsize);
+                /************************************************************************/
+                /* the arena of L, nullptr if L uses another allocator                  */
+                /************************************************************************/
+                static GluaStateArena *of(lua_State *L);
+                
+                void set_memory_limit(size_t memory_limit);
+                size_t memory_limit() const;
+                size_t used_bytes() const;
+                size_t peak_bytes() const;
+                /************************************************************************/
+                /* start measuring the peak again from the memory used now              */
+                /************************************************************************/
+                void reset_peak();
+                /************************************************************************/
+                /* whether the last allocation was refused by the memory limit          */
+                /************************************************************************/
+                bool over_limit() const;
+                /************************************************************************/
+                /* the state is being closed, frees are dropped until the arena is gone */
+                /************************************************************************/
+                void begin_release();
+                
+              private:
+                struct LargeBlock {
+                    LargeBlock *prev;
+                    LargeBlock *next;
+                    size_t size;
+                    size_t padding;
+                };
+                
+                void *allocate(size_t size);
+                void deallocate(void *ptr, size_t size);
+                
+                size_t _memory_limit;
+                size_t _used_bytes = 0;
+                size_t _peak_bytes = 0;
+                bool _over_limit = false;
+                bool _releasing = false;
+                std::vector<char*> _chunks;
+                char *_chunk_pos = nullptr;
+                char *_chunk_end = nullptr;
+                void *_free_blocks[GLUA_STATE_ARENA_MAX_SMALL_BLOCK / 16];
+                LargeBlock *_large_blocks = nullptr;
+            };
+            
+        }
+    }
+}
+
+#endif
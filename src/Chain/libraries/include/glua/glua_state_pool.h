@@ -0,0 +1,174 @@
+/**
+* pool of lua states initialized ahead of use, and of the memory buffers behind them
+*/
+
+#ifndef glua_state_pool_h
+#define glua_state_pool_h
+
+#include <glua/lprefix.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <glua/lobject.h>
+
+struct lua_State;
+
+// states kept ready per thread by GluaStatePool::prefill
+#define GLUA_STATE_POOL_STATES_PER_THREAD 4
+// released malloc buffers kept for the next lua_newstate
+#define GLUA_STATE_POOL_MALLOC_BUFFERS 4
+
+namespace thinkyoung
+{
+    namespace lua
+    {
+        namespace lib
+        {
+            /************************************************************************/
+            /* What a pooled state looked like when it was created: the contents,
+               sizes and metatables of every table reachable from the registry
+               (globals, package.loaded, library tables), the upvalues of the
+               functions among them and the metatables of the basic types. The
+               objects are anchored in a registry table of their own, so contract
+               code that drops them from the globals cannot get them collected.   */
+            /************************************************************************/
+            class GluaStateBaseline {
+              public:
+                /************************************************************************/
+                /* record L as it is now and attach the baseline to L                   */
+                /************************************************************************/
+                static void take(lua_State *L, bool use_contract);
+                
+                /************************************************************************/
+                /* put a used L back to the baseline. false if L can not be reused, it
+                   is still running, holds new finalizers or does not get back to the
+                   memory it had, the caller closes it then                            */
+                /************************************************************************/
+                bool restore(lua_State *L);
+                
+                bool use_contract() const;
+                
+              private:
+                struct TableRecord {
+                    Table *table;
+                    Table *metatable;
+                    unsigned int sizearray;
+                    unsigned int sizenode;
+                    std::vector<std::pair<TValue, TValue>> entries;
+                };
+                
+                struct UpvalueRecord {
+                    TValue closure;
+                    int index;
+                    TValue value;
+                };
+                
+                struct UserdataRecord {
+                    TValue udata;
+                    Table *metatable;
+                };
+                
+                void record(lua_State *L);
+                void visit(lua_State *L, const TValue *value, std::unordered_set<GCObject*> &visited, std::vector<GCObject*> &pending);
+                void anchor(lua_State *L, const TValue *value);
+                size_t count_finalizers(lua_State *L) const;
+                
+                bool _use_contract = true;
+                std::vector<TableRecord> _tables;
+                std::vector<UpvalueRecord> _upvalues;
+                std::vector<UserdataRecord> _udatas;
+                Table *_type_metatables[LUA_NUMTAGS];
+                Table *_anchors = nullptr;
+                Node *_dummy_node = nullptr;
+                int _stacksize = 0;
+                int _strt_size = 0;
+                int _gcpause = 0;
+                int _gcstepmul = 0;
+                size_t _finalizers = 0;
+                size_t _total_bytes = 0;
+            };
+            
+            /************************************************************************/
+            /* Hands out lua states that were created and initialized ahead of use.
+               A released state is put back to its GluaStateBaseline and handed out
+               again, contract code may have changed globals and library tables,
+               the reset undoes that. States belong to the thread that created
+               them, since the lua state value map is not safe to share between
+               threads. The 50 MB malloc buffers of used states are kept and
+               zeroed for reuse.                                                    */
+            /************************************************************************/
+            class GluaStatePool {
+              public:
+                static GluaStatePool &instance();
+                
+                GluaStatePool(size_t states_per_thread = GLUA_STATE_POOL_STATES_PER_THREAD,
+                              size_t malloc_buffers = GLUA_STATE_POOL_MALLOC_BUFFERS);
+                ~GluaStatePool();
+                
+                /************************************************************************/
+                /* take a ready state of the calling thread, or create one              */
+                /************************************************************************/
+                lua_State *acquire(bool use_contract = true);
+                /************************************************************************/
+                /* reset a state taken from acquire for the next acquire of the calling
+                   thread, or close it                                                  */
+                /************************************************************************/
+                void release(lua_State *L);
+                /************************************************************************/
+                /* create states for the calling thread until it has states_per_thread */
+                /************************************************************************/
+                void prefill(bool use_contract = true);
+                /************************************************************************/
+                /* close the ready states of the calling thread                         */
+                /************************************************************************/
+                void clear();
+                
+                /************************************************************************/
+                /* memory behind lua_malloc, used by lua_newstate and lua_close         */
+                /************************************************************************/
+                void *acquire_malloc_buffer();
+                void release_malloc_buffer(void *buffer, size_t used_size);
+                
+                uint64_t hits() const;
+                uint64_t misses() const;
+                uint64_t resets() const;
+                uint64_t reset_time_us() const; // total time spent putting released states back to their baseline
+                uint64_t closes() const; // released states that could not be reset or were not needed
+                uint64_t close_time_us() const;
+                uint64_t prefill_time_us() const; // total time spent creating ready states
+                size_t ready_count() const;
+                
+              private:
+                lua_State *create_state(bool use_contract);
+                
+                struct ThreadStates {
+                    std::deque<lua_State*> contract_states;
+                    std::deque<lua_State*> plain_states;
+                };
+                
+                mutable std::mutex _mutex;
+                const size_t _states_per_thread;
+                const size_t _max_malloc_buffers;
+                std::map<std::thread::id, ThreadStates> _ready;
+                std::vector<void*> _malloc_buffers;
+                uint64_t _hits = 0;
+                uint64_t _misses = 0;
+                uint64_t _resets = 0;
+                uint64_t _reset_time_us = 0;
+                uint64_t _closes = 0;
+                uint64_t _close_time_us = 0;
+                uint64_t _prefill_time_us = 0;
+            };
+            
+        }
+    }
+}
+
+#endif
@@ -107,6 +107,8 @@ LUALIB_API int(luaL_loadbufferx_with_check)(lua_State *L, const char *buff, size
 LUALIB_API int (luaL_loadstring)(lua_State *L, const char *s);
 
 LUALIB_API lua_State *(luaL_newstate)(void);
+/* state whose lua objects are allocated from a GluaStateArena limited to memory_limit bytes */
+LUALIB_API lua_State *(luaL_newstate_with_arena)(size_t memory_limit);
 
 LUALIB_API lua_Integer(luaL_len) (lua_State *L, int idx);
 
@@ -10,6 +10,8 @@
 #include <string.h>
 #include <string>
 #include <list>
+#include <unordered_map>
+#include <vector>
 
 #include "glua/lua.h"
 
@@ -20,6 +22,21 @@
 
 #define LUA_MALLOC_TOTAL_SIZE	(50*1024*1024)
 
+struct GluaStateContext;
+namespace thinkyoung { namespace lua { namespace lib { class GluaContractProfiler; class GluaStateBaseline; } } }
+
+/* with size classes, lua_malloc blocks of up to LUA_MALLOC_PAGE_SIZE bytes come from classes 32, 64, ..., 4096 */
+#define LUA_MALLOC_SIZE_CLASSES 8
+#define LUA_MALLOC_PAGE_SIZE 4096
+
+/*
+** free blocks inside malloc_buffer, all offsets are from the start of the buffer
+*/
+struct LuaMallocFreeLists {
+    ptrdiff_t small_blocks[LUA_MALLOC_SIZE_CLASSES]; // first free block of each size class, -1 if none
+    std::unordered_map<size_t, std::vector<ptrdiff_t>> large_blocks; // free blocks by page count
+};
+
 #define LUA_COMPILE_ERROR_MAX_LENGTH 4096
 
 #define LUA_API_INTERNAL_ERROR   -1
@@ -143,6 +160,7 @@ typedef struct global_State {
     unsigned int gcfinnum;  /* number of finalizers to call in each GC step */
     int gcpause;  /* size of pause between successive GCs */
     int gcstepmul;  /* GC 'granularity' */
+    int chain_api_error;  /* set by GluaChainApi::throw_exception, shared by the threads of the state */
     lua_CFunction panic;  /* to be called in unprotected errors */
     struct lua_State *mainthread;
     const lua_Number *version;  /* pointer to version number */
@@ -203,12 +221,16 @@ struct lua_State {
     unsigned short nCcalls;  /* number of nested C calls */
     lu_byte hookmask;
     lu_byte allowhook;
-    void *malloc_buffer; // malloc enough memory for the whole lua_state scope beforehand, and malloc/free in the buffer
+    void *malloc_buffer; // memory for the whole lua_state scope, taken on the first lua_malloc, and malloc/free in the buffer
     ptrdiff_t malloc_pos; // used buffer size in malloc_buffer
-    std::list<std::pair<ptrdiff_t, ptrdiff_t>> *malloced_buffers;
+    std::list<std::pair<ptrdiff_t, ptrdiff_t>> *malloced_buffers; // live blocks of the first fit lua_malloc, by offset
+    LuaMallocFreeLists *malloc_free_lists;
+    bool malloc_size_classes; // lua_malloc takes blocks from malloc_free_lists instead of the first fit gap
+    GluaStateContext *context; // values shared in the lua_State scope, created on first use
     char compile_error[LUA_COMPILE_ERROR_MAX_LENGTH];
 	char runerror[LUA_VM_EXCEPTION_STRNG_MAX_LENGTH];
 	bool bytecode_debugger_opened;
+    thinkyoung::lua::lib::GluaContractProfiler *profiler; // set while the state is profiled
     FILE *in;
     FILE *out;
     FILE *err;
@@ -216,10 +238,22 @@ struct lua_State {
 	int exit_code;
     bool debugger_pausing;
     GluaStatePreProcessorFunction *preprocessor;
+    thinkyoung::lua::lib::GluaStateBaseline *baseline; // set on pooled states, what they are reset to
 };
 
 void *lua_malloc(lua_State *L, size_t size);
 
+/*
+** switch lua_malloc of L from first fit to size classes. they run out of the buffer at
+** different points, so callers decide by block height. ignored once L used lua_malloc
+*/
+void lua_malloc_use_size_classes(lua_State *L);
+
+/*
+** hand the lua_malloc buffer of L back to the pool, the next lua_malloc starts from an empty one
+*/
+void lua_malloc_reset(lua_State *L);
+
 void *lua_calloc(lua_State *L, size_t element_count, size_t element_size);
 
 void lua_free(lua_State *L, void *address);
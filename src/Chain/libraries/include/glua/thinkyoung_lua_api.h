@@ -104,6 +104,8 @@ namespace thinkyoung {
             storage_value_string_array = 104,
 			storage_value_stream_array = 105,
 
+            storage_value_table_patch = 150,
+
             storage_value_userdata = 201,
             storage_value_not_support = 202
         };
@@ -25,6 +25,7 @@
 #include <glua/llimits.h>
 #include <glua/lobject.h>
 #include <glua/thinkyoung_lua_api.h>
+#include <glua/glua_contract_profiler.h>
 
 #define BOOL_VAL(val) ((val)>0?true:false)
 
@@ -70,6 +71,36 @@ typedef struct _GluaStateValueNode {
     GluaStateValue value;
 } GluaStateValueNode;
 
+/**
+* values read on every contract call or api call have a fixed slot in the lua_State,
+* the string keys of these values are mapped to the same slots
+*/
+enum GluaStateSlot {
+    GLUA_STATE_SLOT_EVALUATE_STATE = 0,                 // "evaluate_state"
+    GLUA_STATE_SLOT_INSTRUCTIONS_LIMIT = 1,             // INSTRUCTIONS_LIMIT_LUA_STATE_MAP_KEY
+    GLUA_STATE_SLOT_INSTRUCTIONS_EXECUTED_COUNT = 2,    // INSTRUCTIONS_EXECUTED_COUNT_LUA_STATE_MAP_KEY
+    GLUA_STATE_SLOT_STOP_IN_LVM = 3,                    // LUA_STATE_STOP_TO_RUN_IN_LVM_STATE_MAP_KEY
+    GLUA_STATE_SLOT_EXCEPTION_CODE = 4,                 // "exception_code"
+    GLUA_STATE_SLOT_EXCEPTION_MSG = 5,                  // "exception_msg"
+    GLUA_STATE_SLOT_STORAGE_CHANGELIST = 6,             // LUA_STORAGE_CHANGELIST_KEY
+    GLUA_STATE_SLOT_STORAGE_READ_TABLES = 7,            // LUA_STORAGE_READ_TABLES_KEY
+    GLUA_STATE_SLOT_OUTSIDE_OBJECT_POOLS = 8,           // GLUA_OUTSIDE_OBJECT_POOLS_KEY
+    GLUA_STATE_SLOT_STARTING_CONTRACT_ADDRESS = 9,      // STARTING_CONTRACT_ADDRESS
+    GLUA_STATE_SLOT_COUNT = 10
+};
+
+/**
+* values of one lua_State, owned by the state and released with it
+*/
+struct GluaStateContext {
+    GluaStateValueNode slots[GLUA_STATE_SLOT_COUNT];
+    std::unordered_map<std::string, GluaStateValueNode> values; // values of the other keys
+    
+    GluaStateContext() {
+        memset(slots, 0x0, sizeof(slots));
+    }
+};
+
 
 namespace thinkyoung {
     namespace lua {
@@ -144,6 +175,24 @@ namespace thinkyoung {
                 /************************************************************************/
                 int get_instructions_executed_count();
                 /************************************************************************/
+                /* set how many bytes the lua objects in the lua stack can hold         */
+                /************************************************************************/
+                void set_memory_limit(size_t limit);
+                size_t get_memory_limit();
+                /************************************************************************/
+                /* most bytes held by lua objects during the last contract api call     */
+                /************************************************************************/
+                size_t get_memory_peak();
+                /************************************************************************/
+                /* time opcodes, lua functions and chain apis run in the lua stack      */
+                /************************************************************************/
+                void enable_profiler();
+                bool profiler_enabled() const;
+                /************************************************************************/
+                /* what the profiler recorded since it was enabled                      */
+                /************************************************************************/
+                GluaProfileReport get_profile_report();
+                /************************************************************************/
                 /* check whether the thinkyoung apis over limit(maybe thinkyoung limit api called count) */
                 /************************************************************************/
                 int check_thinkyoung_contract_api_instructions_over_limit();
@@ -294,6 +343,10 @@ namespace thinkyoung {
             bool commit_storage_changes(lua_State *L);
             
             void close_lua_state(lua_State *L);
+            /**
+            * commit the storage changes of L and free the values of its scope, the lua objects stay
+            */
+            void release_lua_state_values(lua_State *L);
             
             /**
             * share some values in L
@@ -303,12 +356,29 @@ namespace thinkyoung {
             
             GluaStateValueNode get_lua_state_value_node(lua_State *L, const char *key);
             GluaStateValue get_lua_state_value(lua_State *L, const char *key);
+            
+            GluaStateValueNode get_lua_state_value_node(lua_State *L, GluaStateSlot slot);
+            GluaStateValue get_lua_state_value(lua_State *L, GluaStateSlot slot);
             void set_lua_state_instructions_limit(lua_State *L, int limit);
             
             int get_lua_state_instructions_limit(lua_State *L);
             
             int get_lua_state_instructions_executed_count(lua_State *L);
             
+            /**
+             * memory the lua objects of L may hold, only states created with an arena have a limit
+             */
+            void set_lua_state_memory_limit(lua_State *L, size_t limit);
+            
+            size_t get_lua_state_memory_limit(lua_State *L);
+            
+            /**
+             * most memory held by the lua objects of L since the current contract call started
+             */
+            size_t get_lua_state_memory_peak(lua_State *L);
+            
+            void reset_lua_state_memory_peak(lua_State *L);
+            
             void enter_lua_sandbox(lua_State *L);
             
             void exit_lua_sandbox(lua_State *L);
@@ -332,6 +402,8 @@ namespace thinkyoung {
             
             void set_lua_state_value(lua_State *L, const char *key, GluaStateValue value, enum GluaStateValueType type);
             
+            void set_lua_state_value(lua_State *L, GluaStateSlot slot, GluaStateValue value, enum GluaStateValueType type);
+            
             GluaTableMapP create_managed_lua_table_map(lua_State *L);
             
             char *malloc_managed_string(lua_State *L, size_t size, const char *init_data=nullptr);
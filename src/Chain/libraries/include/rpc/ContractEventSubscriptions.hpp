@@ -0,0 +1,48 @@
+#pragma once
+#include <blockchain/ChainDatabase.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fc {
+    namespace rpc {
+        class json_connection;
+    }
+}
+
+namespace thinkyoung {
+    namespace rpc {
+
+        /**
+        *  @class ContractEventSubscriptions
+        *  @brief the contract events each raw json connection asked to be sent as blocks are applied
+        */
+        class ContractEventSubscriptions
+        {
+        public:
+            struct Subscription
+            {
+                thinkyoung::blockchain::ContractIdType        contract_id;
+                std::string                                 event_type; // empty for all events of the contract
+            };
+
+            void subscribe(fc::rpc::json_connection* connection, const Subscription& subscription);
+            /** drops the subscription of the connection with the same contract and event name, false if it had none */
+            bool unsubscribe(fc::rpc::json_connection* connection, const Subscription& subscription);
+            /** drops every subscription of the connection, false if it had none */
+            bool unsubscribe_all(fc::rpc::json_connection* connection);
+            void clear();
+
+            bool empty()const;
+            std::vector<Subscription> get_subscriptions(fc::rpc::json_connection* connection)const;
+
+            /** sends a contract_event_notice for every event of the block a connection subscribed to */
+            void notify(const thinkyoung::blockchain::ChainDatabase& chain, const uint32_t block_num);
+
+        private:
+            std::unordered_map<fc::rpc::json_connection*, std::vector<Subscription>> _subscriptions;
+        };
+
+    }
+} // thinkyoung::rpc
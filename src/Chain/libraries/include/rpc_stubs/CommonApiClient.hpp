@@ -33,6 +33,7 @@ namespace thinkyoung {
             thinkyoung::blockchain::Asset blockchain_calculate_supply(const std::string& asset) const override;
             bool blockchain_is_synced() const override;
             uint32_t blockchain_get_block_count() const override;
+            std::vector<std::pair<uint32_t, uint32_t>> blockchain_get_block_ranges_by_time(const std::vector<std::pair<fc::time_point, fc::time_point>>& time_ranges) const override;
             thinkyoung::blockchain::BlockchainSecurityState blockchain_get_security_state() const override;
             std::vector<thinkyoung::blockchain::AccountEntry> blockchain_list_accounts(const std::string& first_account_name = fc::json::from_string("\"\"").as<std::string>(), uint32_t limit = fc::json::from_string("20").as<uint32_t>()) const override;
             std::vector<thinkyoung::blockchain::AccountEntry> blockchain_list_recently_updated_accounts() const override;
@@ -51,6 +52,7 @@ namespace thinkyoung {
             std::unordered_map<thinkyoung::blockchain::BalanceIdType, thinkyoung::blockchain::BalanceEntry> blockchain_list_balances(const std::string& first_balance_id = fc::json::from_string("\"\"").as<std::string>(), uint32_t limit = fc::json::from_string("20").as<uint32_t>()) const override;
             std::unordered_map<thinkyoung::blockchain::BalanceIdType, thinkyoung::blockchain::BalanceEntry> blockchain_list_address_balances(const std::string& addr, const fc::time_point& chanced_since = fc::json::from_string("\"1970-1-1T00:00:01\"").as<fc::time_point>()) const override;
             fc::variant_object blockchain_list_address_transactions(const std::string& addr, uint32_t filter_before = fc::json::from_string("\"0\"").as<uint32_t>()) const override;
+            std::vector<thinkyoung::blockchain::TransactionEntry> blockchain_list_address_transactions_paged(const std::string& addr, uint32_t since_block = fc::json::from_string("0").as<uint32_t>(), uint32_t limit = fc::json::from_string("100").as<uint32_t>(), bool reverse = fc::json::from_string("false").as<bool>()) const override;
             thinkyoung::wallet::AccountBalanceSummaryType blockchain_get_account_public_balance(const std::string& account_name) const override;
             std::unordered_map<thinkyoung::blockchain::BalanceIdType, thinkyoung::blockchain::BalanceEntry> blockchain_list_key_balances(const thinkyoung::blockchain::PublicKeyType& key) const override;
             fc::optional<thinkyoung::blockchain::AssetEntry> blockchain_get_asset(const std::string& asset) const override;
@@ -74,6 +76,7 @@ namespace thinkyoung {
             unordered_map<string, string> blockchain_get_forever_contracts() const override;
             std::vector<std::string> blockchain_list_pub_all_address(const std::string& pub_key) const override;
             std::vector<thinkyoung::blockchain::EventOperation> blockchain_get_events(uint32_t block_number, const thinkyoung::blockchain::TransactionIdType& trx_id) const override;
+            std::vector<thinkyoung::blockchain::ContractEventEntry> blockchain_list_contract_events(const std::string& contract, const std::string& event_type = fc::json::from_string("\"\"").as<std::string>(), uint32_t from_block = fc::json::from_string("0").as<uint32_t>(), uint32_t to_block = fc::json::from_string("0").as<uint32_t>(), uint32_t limit = fc::json::from_string("100").as<uint32_t>()) const override;
             thinkyoung::blockchain::TransactionIdType blockchain_get_transaction_id(const thinkyoung::blockchain::SignedTransaction& transaction_to_broadcast) override;
             void network_add_node(const std::string& node, const std::string& command = fc::json::from_string("\"add\"").as<std::string>()) override;
             uint32_t network_get_connection_count() const override;
@@ -221,6 +224,7 @@ namespace thinkyoung {
             std::vector<thinkyoung::blockchain::BalanceEntry> get_contract_balance(const std::string& contract) override;
             std::vector<thinkyoung::blockchain::Asset> call_contract_testing(const std::string& contract, const std::string& caller_name, const std::string& function_name, const std::string& params) override;
             std::vector<thinkyoung::blockchain::EventOperation> call_contract_local_emit(const std::string& contract, const std::string& caller_name, const std::string& function_name, const std::string& params) override;
+            thinkyoung::lua::lib::GluaProfileReport call_contract_profile(const std::string& contract, const std::string& caller_name, const std::string& function_name, const std::string& params) override;
             std::string call_contract_offline(const std::string& contract, const std::string& caller_name, const std::string& function_name, const std::string& params) override;
             thinkyoung::blockchain::ContractEntryPrintable load_contract_to_file(const std::string& contract, const fc::path& file) override;
             thinkyoung::blockchain::TransactionIdType get_result_trx_id(const thinkyoung::blockchain::TransactionIdType& request_id) override;
@@ -51,6 +51,8 @@ namespace thinkyoung {
             fc::variant blockchain_is_synced_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
             fc::variant blockchain_get_block_count_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
             fc::variant blockchain_get_block_count_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
+            fc::variant blockchain_get_block_ranges_by_time_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
+            fc::variant blockchain_get_block_ranges_by_time_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
             fc::variant blockchain_get_security_state_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
             fc::variant blockchain_get_security_state_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
             fc::variant blockchain_list_accounts_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
@@ -87,6 +89,8 @@ namespace thinkyoung {
             fc::variant blockchain_list_address_balances_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
             fc::variant blockchain_list_address_transactions_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
             fc::variant blockchain_list_address_transactions_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
+            fc::variant blockchain_list_address_transactions_paged_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
+            fc::variant blockchain_list_address_transactions_paged_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
             fc::variant blockchain_get_account_public_balance_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
             fc::variant blockchain_get_account_public_balance_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
             fc::variant blockchain_list_key_balances_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
@@ -133,6 +137,8 @@ namespace thinkyoung {
             fc::variant blockchain_list_pub_all_address_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
             fc::variant blockchain_get_events_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
             fc::variant blockchain_get_events_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
+            fc::variant blockchain_list_contract_events_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
+            fc::variant blockchain_list_contract_events_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
             fc::variant blockchain_get_transaction_id_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
             fc::variant blockchain_get_transaction_id_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
             fc::variant network_add_node_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
@@ -427,6 +433,8 @@ namespace thinkyoung {
             fc::variant call_contract_testing_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
             fc::variant call_contract_local_emit_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
             fc::variant call_contract_local_emit_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
+            fc::variant call_contract_profile_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
+            fc::variant call_contract_profile_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
             fc::variant call_contract_offline_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
             fc::variant call_contract_offline_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters);
             fc::variant load_contract_to_file_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters);
@@ -1578,6 +1578,7 @@ namespace thinkyoung {
             WalletTransactionEntry call_contract(const string caller, const ContractIdType contract, const string method, const string& arguments, const string& asset_symbol, double cost_limit, bool is_testing = false);
             std::vector<thinkyoung::blockchain::Asset> call_contract_testing(const string caller, const ContractIdType contract, const string method, const string& arguments);
             std::vector<thinkyoung::blockchain::EventOperation> call_contract_local_emit(const string caller, const ContractIdType contract, const string method, const string& arguments);
+            thinkyoung::lua::lib::GluaProfileReport call_contract_profile(const string caller, const ContractIdType contract, const string method, const string& arguments);
             std::string call_contract_offline(const string caller, const ContractIdType contract, const string method, const string& arguments);
             
             void get_enough_balances(const string& account_name, const Asset target, std::map<BalanceIdType, ShareType>& balances, unordered_set<Address>& required_signatures);
@@ -1586,6 +1587,8 @@ namespace thinkyoung {
             
             //sandbox relate function
             ChainInterfacePtr get_correct_state_ptr() const;
+            TransactionEvaluationStatePtr simulate_contract_testing(const SignedTransaction& trx,
+                    const std::function<void(TransactionEvaluationState&)>& configure = nullptr) const;
             WalletDb& get_wallet_db() const;
             /*WalletTransactionEntry sandbox_register_contract(const string& owner, const fc::path codefile, const string& asset_symbol, double init_limit);*/
             void scan_contracts();
@@ -87,7 +87,10 @@ namespace thinkyoung {
                             ilog("Sending blocks from ${start} to ${finish} to ${remote}",
                                 ("start", start_block)("finish", end_block)("remote", connection_socket.remote_endpoint()));
                             for (; start_block <= end_block; ++start_block) {
-                                fc::raw::pack(connection_socket, _chain_db->get_block(start_block));
+                                // the stored bytes are already the packed FullBlock the client unpacks
+                                const thinkyoung::blockchain::RawBlockPtr raw_block = _chain_db->get_raw_block(start_block);
+                                FC_ASSERT(raw_block, "Missing block ${n}", ("n", start_block));
+                                connection_socket.write(raw_block->data(), raw_block->size());
                                 if (start_block % 10 == 0)
                                     fc::yield();
                             }
@@ -0,0 +1,85 @@
+#define DEFAULT_LOGGER "rpc"
+
+#include <rpc/ContractEventSubscriptions.hpp>
+
+#include <fc/reflect/variant.hpp>
+#include <fc/rpc/json_connection.hpp>
+
+#include <algorithm>
+
+namespace thinkyoung {
+    namespace rpc {
+
+        void ContractEventSubscriptions::subscribe(fc::rpc::json_connection* connection, const Subscription& subscription)
+        {
+            _subscriptions[connection].push_back(subscription);
+        }
+
+        bool ContractEventSubscriptions::unsubscribe(fc::rpc::json_connection* connection, const Subscription& subscription)
+        {
+            auto iter = _subscriptions.find(connection);
+            if (iter == _subscriptions.end())
+                return false;
+
+            auto& subscriptions = iter->second;
+            const auto old_size = subscriptions.size();
+            subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(),
+                [&](const Subscription& s) { return s.contract_id == subscription.contract_id && s.event_type == subscription.event_type; }),
+                subscriptions.end());
+            const bool removed = subscriptions.size() != old_size;
+            if (subscriptions.empty())
+                _subscriptions.erase(iter);
+            return removed;
+        }
+
+        bool ContractEventSubscriptions::unsubscribe_all(fc::rpc::json_connection* connection)
+        {
+            return _subscriptions.erase(connection) > 0;
+        }
+
+        void ContractEventSubscriptions::clear()
+        {
+            _subscriptions.clear();
+        }
+
+        bool ContractEventSubscriptions::empty()const
+        {
+            return _subscriptions.empty();
+        }
+
+        std::vector<ContractEventSubscriptions::Subscription> ContractEventSubscriptions::get_subscriptions(fc::rpc::json_connection* connection)const
+        {
+            const auto iter = _subscriptions.find(connection);
+            if (iter == _subscriptions.end())
+                return std::vector<Subscription>();
+            return iter->second;
+        }
+
+        void ContractEventSubscriptions::notify(const thinkyoung::blockchain::ChainDatabase& chain, const uint32_t block_num)
+        {
+            // connections may close while a notice is written
+            const auto subscriptions = _subscriptions;
+            for (const auto& item : subscriptions)
+            {
+                for (const Subscription& subscription : item.second)
+                {
+                    try
+                    {
+                        const auto events = chain.fetch_contract_events(subscription.contract_id, subscription.event_type, block_num, block_num);
+                        for (const auto& event : events)
+                        {
+                            if (_subscriptions.find(item.first) == _subscriptions.end())
+                                break;
+                            item.first->notice("contract_event_notice", fc::variants{ fc::variant(event) });
+                        }
+                    }
+                    catch (const fc::exception& e)
+                    {
+                        wlog("error sending contract events of block ${n}: ${e}", ("n", block_num)("e", e.to_detail_string()));
+                    }
+                }
+            }
+        }
+
+    }
+} // thinkyoung::rpc
@@ -3,6 +3,7 @@
 
 #include <fc/exception/exception.hpp>
 #include <wallet/Exceptions.hpp>
+#include <rpc/ContractEventSubscriptions.hpp>
 #include <rpc/Exceptions.hpp>
 #include <rpc/RpcServer.hpp>
 #include <blockchain/Config.hpp>
@@ -32,9 +33,11 @@
 
 #include <fc/thread/mutex.hpp>
 #include <fc/thread/scoped_lock.hpp>
+#include <fc/thread/unique_lock.hpp>
 
 #include <iomanip>
 #include <limits>
+#include <set>
 #include <sstream>
 
 
@@ -69,7 +72,7 @@ namespace thinkyoung {
 
         namespace detail
         {
-            class RpcServerImpl : public thinkyoung::rpc_stubs::CommonApiRpcServer
+            class RpcServerImpl : public thinkyoung::rpc_stubs::CommonApiRpcServer, public thinkyoung::blockchain::ChainObserver
             {
             public:
                 RpcServerConfig                                 _config;
@@ -85,6 +88,7 @@ namespace thinkyoung {
                 HttpCallbackType                                _http_file_callback;
                 std::unordered_set<fc::rpc::json_connection_ptr>  _open_json_connections;
                 fc::mutex                                         _rpc_mutex; // locked to prevent executing two rpc calls at once
+                std::set<std::string>                             _simulation_methods; // only wait for the contract simulator's read lock
 
                 bool                                              _cache_enabled = true;
                 fc::time_point                                    _last_cache_clear_time;
@@ -99,15 +103,26 @@ namespace thinkyoung {
                 /** the set of connections that have successfully logged in */
                 std::unordered_set<fc::rpc::json_connection*> _authenticated_connection_set;
 
+                /** the event subscriptions of the raw json connections, removed when the connection closes */
+                ContractEventSubscriptions                        _event_subscriptions;
+                bool                                              _observing_chain = false;
+
                 RpcServerImpl(thinkyoung::client::Client* client) :
                     _client(client),
                     _on_quit_promise(new fc::promise<void>("rpc_quit")),
                     _self(nullptr),
-                    _thread(nullptr)
+                    _thread(nullptr),
+                    _simulation_methods({ "wallet_transfer_to_contract_testing", "register_contract_testing",
+                        "upgrade_contract_testing", "destroy_contract_testing", "call_contract_testing",
+                        "call_contract_local_emit", "call_contract_profile" })
                 {}
 
                 void shutdown_rpc_server();
 
+                virtual void state_changed(const thinkyoung::blockchain::PendingChainStatePtr& state) override {}
+                virtual void block_applied(const thinkyoung::blockchain::BlockSummary& summary) override;
+                void stop_observing_chain();
+
                 virtual thinkyoung::api::CommonApi* get_client() const override;
                 virtual void verify_json_connection_is_authenticated(fc::rpc::json_connection* json_connection) const override;
                 virtual void verify_wallet_is_open() const override;
@@ -1299,6 +1314,7 @@ namespace thinkyoung {
                         json_con->exec().on_complete([this, receipt, sock](fc::exception_ptr e){
                             ilog("json_con exited");
                             sock->close();
+                            _event_subscriptions.unsubscribe_all(receipt.first->get());
                             _open_json_connections.erase(receipt.first);
                             if (e)
                                 elog("Connection exited with error: ${error}", ("error", e->what()));
@@ -1342,6 +1358,7 @@ namespace thinkyoung {
                         json_con->exec().on_complete([this, receipt, sock](fc::exception_ptr e){
                             ilog("json_con exited");
                             sock->close();
+                            _event_subscriptions.unsubscribe_all(receipt.first->get());
                             _open_json_connections.erase(receipt.first);
                             if (e)
                                 elog("Connection exited with error: ${error}", ("error", e->what()));
@@ -1357,6 +1374,9 @@ namespace thinkyoung {
                     // the login method is a special case that is only used for raw json connections
                     // (not for the CLI or HTTP(s) json rpc)
                     con->add_method("login", boost::bind(&RpcServerImpl::login, this, capture_con, _1));
+                    // contract events are pushed as notices, so subscribing only works on raw json connections too
+                    con->add_method("blockchain_subscribe_contract_events", boost::bind(&RpcServerImpl::subscribe_contract_events, this, capture_con, _1));
+                    con->add_method("blockchain_unsubscribe_contract_events", boost::bind(&RpcServerImpl::unsubscribe_contract_events, this, capture_con, _1));
                     for (const MethodMapType::value_type& method : _method_map)
                     {
                         if (method.second.method)
@@ -1387,7 +1407,10 @@ namespace thinkyoung {
                 fc::variant dispatch_authenticated_method(const thinkyoung::api::MethodData& method_data,
                     const fc::variants& arguments_from_caller)
                 {
-                    fc::scoped_lock<fc::mutex> lock(_rpc_mutex);
+                    fc::unique_lock<fc::mutex> lock(_rpc_mutex);
+                    // the contract testing calls share the chain state with each other, push_block waits for them
+                    if (_simulation_methods.count(method_data.name) > 0)
+                        lock.unlock();
 
                     if (!method_data.method)
                     {
@@ -1471,6 +1494,9 @@ namespace thinkyoung {
                 }
 
                 fc::variant login(fc::rpc::json_connection* json_connection, const fc::variants& params);
+                thinkyoung::blockchain::ContractIdType resolve_contract_id(const std::string& contract) const;
+                fc::variant subscribe_contract_events(fc::rpc::json_connection* json_connection, const fc::variants& params);
+                fc::variant unsubscribe_contract_events(fc::rpc::json_connection* json_connection, const fc::variants& params);
             };
 
             thinkyoung::api::CommonApi* RpcServerImpl::get_client() const
@@ -1526,6 +1552,72 @@ namespace thinkyoung {
                 return fc::variant(true);
             }
 
+            thinkyoung::blockchain::ContractIdType RpcServerImpl::resolve_contract_id(const std::string& contract) const
+            {
+                const auto chain = _client->get_chain();
+                if (thinkyoung::blockchain::Address::is_valid(contract, CONTRACT_ADDRESS_PREFIX))
+                {
+                    const thinkyoung::blockchain::ContractIdType contract_id(contract, thinkyoung::blockchain::AddressType::contract_address);
+                    FC_ASSERT(chain->get_contract_entry(contract_id).valid(), "contract address not exist");
+                    return contract_id;
+                }
+                const thinkyoung::blockchain::oContractEntry entry = chain->get_contract_entry(contract);
+                FC_ASSERT(entry.valid(), "not valid contract name or address");
+                return entry->id;
+            }
+
+            //params: contract name or address, optional event name
+            fc::variant RpcServerImpl::subscribe_contract_events(fc::rpc::json_connection* json_connection, const fc::variants& params)
+            {
+                verify_json_connection_is_authenticated(json_connection);
+                FC_ASSERT(params.size() == 1 || params.size() == 2, "expected a contract and an optional event name");
+                const auto chain = _client->get_chain();
+                ContractEventSubscriptions::Subscription subscription;
+                subscription.contract_id = resolve_contract_id(params[0].as_string());
+                if (params.size() == 2)
+                    subscription.event_type = params[1].as_string();
+
+                _event_subscriptions.subscribe(json_connection, subscription);
+                if (!_observing_chain)
+                {
+                    chain->add_observer(this);
+                    _observing_chain = true;
+                }
+                return fc::variant(true);
+            }
+
+            //params: none to drop every subscription of the connection, or the contract and event name it subscribed with
+            fc::variant RpcServerImpl::unsubscribe_contract_events(fc::rpc::json_connection* json_connection, const fc::variants& params)
+            {
+                verify_json_connection_is_authenticated(json_connection);
+                if (params.empty())
+                    return fc::variant(_event_subscriptions.unsubscribe_all(json_connection));
+
+                ContractEventSubscriptions::Subscription subscription;
+                subscription.contract_id = resolve_contract_id(params[0].as_string());
+                if (params.size() > 1)
+                    subscription.event_type = params[1].as_string();
+                return fc::variant(_event_subscriptions.unsubscribe(json_connection, subscription));
+            }
+
+            void RpcServerImpl::block_applied(const thinkyoung::blockchain::BlockSummary& summary)
+            {
+                if (_event_subscriptions.empty())
+                    return;
+                _event_subscriptions.notify(*_client->get_chain(), summary.block_data.block_num);
+            }
+
+            void RpcServerImpl::stop_observing_chain()
+            {
+                _event_subscriptions.clear();
+                if (!_observing_chain)
+                    return;
+                const auto chain = _client->get_chain();
+                if (chain)
+                    chain->remove_observer(this);
+                _observing_chain = false;
+            }
+
             std::string RpcServerImpl::help(const std::string& command_name) const
             {
                 std::string help_string;
@@ -1800,6 +1892,7 @@ namespace thinkyoung {
             // my->_thread->async([=]() { fc::usleep(fc::milliseconds(10)); close(); });
             // Because we never waited on the above call we would crash... when rpc_server is
             // deleted before it can execute.
+            my->stop_observing_chain();
             if (my->_on_quit_promise)
                 my->_on_quit_promise->set_value();
             if (my->_tcp_serv)
@@ -209,6 +209,35 @@ namespace thinkyoung {
             FC_RETHROW_EXCEPTIONS(warn, "")
         }
 
+        std::vector<std::pair<uint32_t, uint32_t>> CommonApiClient::blockchain_get_block_ranges_by_time(const std::vector<std::pair<fc::time_point, fc::time_point>>& time_ranges) const
+        {
+            ilog("received RPC call: blockchain_get_block_ranges_by_time(${time_ranges})", ("time_ranges", time_ranges));
+            thinkyoung::api::GlobalApiLogger* glog = thinkyoung::api::GlobalApiLogger::get_instance();
+            uint64_t call_id = 0;
+            fc::variants args;
+            if( glog != NULL )
+            {
+                args.push_back( fc::variant(time_ranges) );
+                call_id = glog->log_call_started( this, "blockchain_get_block_ranges_by_time", args );
+            }
+
+            struct scope_exit
+            {
+                fc::time_point start_time;
+                scope_exit() : start_time(fc::time_point::now()) {}
+                ~scope_exit() { dlog("RPC call blockchain_get_block_ranges_by_time finished in ${time} ms", ("time", (fc::time_point::now() - start_time).count() / 1000)); }
+            } execution_time_logger;
+            try
+            {
+                std::vector<std::pair<uint32_t, uint32_t>> result =             get_impl()->blockchain_get_block_ranges_by_time(time_ranges);
+                if( call_id != 0 )
+                    glog->log_call_finished( call_id, this, "blockchain_get_block_ranges_by_time", args, fc::variant(result) );
+
+                return result;
+            }
+            FC_RETHROW_EXCEPTIONS(warn, "")
+        }
+
         thinkyoung::blockchain::BlockchainSecurityState CommonApiClient::blockchain_get_security_state() const
         {
             ilog("received RPC call: blockchain_get_security_state()", );
@@ -735,6 +764,38 @@ namespace thinkyoung {
             FC_RETHROW_EXCEPTIONS(warn, "")
         }
 
+        std::vector<thinkyoung::blockchain::TransactionEntry> CommonApiClient::blockchain_list_address_transactions_paged(const std::string& addr, uint32_t since_block /* = fc::json::from_string("0").as<uint32_t>() */, uint32_t limit /* = fc::json::from_string("100").as<uint32_t>() */, bool reverse /* = fc::json::from_string("false").as<bool>() */) const
+        {
+            ilog("received RPC call: blockchain_list_address_transactions_paged(${addr}, ${since_block}, ${limit}, ${reverse})", ("addr", addr)("since_block", since_block)("limit", limit)("reverse", reverse));
+            thinkyoung::api::GlobalApiLogger* glog = thinkyoung::api::GlobalApiLogger::get_instance();
+            uint64_t call_id = 0;
+            fc::variants args;
+            if( glog != NULL )
+            {
+                args.push_back( fc::variant(addr) );
+                args.push_back( fc::variant(since_block) );
+                args.push_back( fc::variant(limit) );
+                args.push_back( fc::variant(reverse) );
+                call_id = glog->log_call_started( this, "blockchain_list_address_transactions_paged", args );
+            }
+
+            struct scope_exit
+            {
+                fc::time_point start_time;
+                scope_exit() : start_time(fc::time_point::now()) {}
+                ~scope_exit() { dlog("RPC call blockchain_list_address_transactions_paged finished in ${time} ms", ("time", (fc::time_point::now() - start_time).count() / 1000)); }
+            } execution_time_logger;
+            try
+            {
+                std::vector<thinkyoung::blockchain::TransactionEntry> result =             get_impl()->blockchain_list_address_transactions_paged(addr, since_block, limit, reverse);
+                if( call_id != 0 )
+                    glog->log_call_finished( call_id, this, "blockchain_list_address_transactions_paged", args, fc::variant(result) );
+
+                return result;
+            }
+            FC_RETHROW_EXCEPTIONS(warn, "")
+        }
+
         thinkyoung::wallet::AccountBalanceSummaryType CommonApiClient::blockchain_get_account_public_balance(const std::string& account_name) const
         {
             ilog("received RPC call: blockchain_get_account_public_balance(${account_name})", ("account_name", account_name));
@@ -1412,6 +1473,39 @@ namespace thinkyoung {
             FC_RETHROW_EXCEPTIONS(warn, "")
         }
 
+        std::vector<thinkyoung::blockchain::ContractEventEntry> CommonApiClient::blockchain_list_contract_events(const std::string& contract, const std::string& event_type /* = fc::json::from_string("\"\"").as<std::string>() */, uint32_t from_block /* = fc::json::from_string("0").as<uint32_t>() */, uint32_t to_block /* = fc::json::from_string("0").as<uint32_t>() */, uint32_t limit /* = fc::json::from_string("100").as<uint32_t>() */) const
+        {
+            ilog("received RPC call: blockchain_list_contract_events(${contract}, ${event_type}, ${from_block}, ${to_block}, ${limit})", ("contract", contract)("event_type", event_type)("from_block", from_block)("to_block", to_block)("limit", limit));
+            thinkyoung::api::GlobalApiLogger* glog = thinkyoung::api::GlobalApiLogger::get_instance();
+            uint64_t call_id = 0;
+            fc::variants args;
+            if( glog != NULL )
+            {
+                args.push_back( fc::variant(contract) );
+                args.push_back( fc::variant(event_type) );
+                args.push_back( fc::variant(from_block) );
+                args.push_back( fc::variant(to_block) );
+                args.push_back( fc::variant(limit) );
+                call_id = glog->log_call_started( this, "blockchain_list_contract_events", args );
+            }
+
+            struct scope_exit
+            {
+                fc::time_point start_time;
+                scope_exit() : start_time(fc::time_point::now()) {}
+                ~scope_exit() { dlog("RPC call blockchain_list_contract_events finished in ${time} ms", ("time", (fc::time_point::now() - start_time).count() / 1000)); }
+            } execution_time_logger;
+            try
+            {
+                std::vector<thinkyoung::blockchain::ContractEventEntry> result =             get_impl()->blockchain_list_contract_events(contract, event_type, from_block, to_block, limit);
+                if( call_id != 0 )
+                    glog->log_call_finished( call_id, this, "blockchain_list_contract_events", args, fc::variant(result) );
+
+                return result;
+            }
+            FC_RETHROW_EXCEPTIONS(warn, "")
+        }
+
         thinkyoung::blockchain::TransactionIdType CommonApiClient::blockchain_get_transaction_id(const thinkyoung::blockchain::SignedTransaction& transaction_to_broadcast)
         {
             ilog("received RPC call: blockchain_get_transaction_id(${transaction_to_broadcast})", ("transaction_to_broadcast", transaction_to_broadcast));
@@ -5849,6 +5943,38 @@ namespace thinkyoung {
             FC_RETHROW_EXCEPTIONS(warn, "")
         }
 
+        thinkyoung::lua::lib::GluaProfileReport CommonApiClient::call_contract_profile(const std::string& contract, const std::string& caller_name, const std::string& function_name, const std::string& params)
+        {
+            ilog("received RPC call: call_contract_profile(${contract}, ${caller_name}, ${function_name}, ${params})", ("contract", contract)("caller_name", caller_name)("function_name", function_name)("params", params));
+            thinkyoung::api::GlobalApiLogger* glog = thinkyoung::api::GlobalApiLogger::get_instance();
+            uint64_t call_id = 0;
+            fc::variants args;
+            if( glog != NULL )
+            {
+                args.push_back( fc::variant(contract) );
+                args.push_back( fc::variant(caller_name) );
+                args.push_back( fc::variant(function_name) );
+                args.push_back( fc::variant(params) );
+                call_id = glog->log_call_started( this, "call_contract_profile", args );
+            }
+
+            struct scope_exit
+            {
+                fc::time_point start_time;
+                scope_exit() : start_time(fc::time_point::now()) {}
+                ~scope_exit() { dlog("RPC call call_contract_profile finished in ${time} ms", ("time", (fc::time_point::now() - start_time).count() / 1000)); }
+            } execution_time_logger;
+            try
+            {
+                thinkyoung::lua::lib::GluaProfileReport result =             get_impl()->call_contract_profile(contract, caller_name, function_name, params);
+                if( call_id != 0 )
+                    glog->log_call_finished( call_id, this, "call_contract_profile", args, fc::variant(result) );
+
+                return result;
+            }
+            FC_RETHROW_EXCEPTIONS(warn, "")
+        }
+
         std::string CommonApiClient::call_contract_offline(const std::string& contract, const std::string& caller_name, const std::string& function_name, const std::string& params)
         {
             ilog("received RPC call: call_contract_offline(${contract}, ${caller_name}, ${function_name}, ${params})", ("contract", contract)("caller_name", caller_name)("function_name", function_name)("params", params));
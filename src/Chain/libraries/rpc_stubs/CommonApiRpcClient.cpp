@@ -47,6 +47,10 @@ namespace thinkyoung {
             fc::variant result = get_json_connection()->async_call("blockchain_get_block_count", std::vector<fc::variant> {}).wait();
             return result.as<uint32_t>();
         }
+        std::vector<std::pair<uint32_t, uint32_t>> CommonApiRpcClient::blockchain_get_block_ranges_by_time(const std::vector<std::pair<fc::time_point, fc::time_point>>& time_ranges) const {
+            fc::variant result = get_json_connection()->async_call("blockchain_get_block_ranges_by_time", std::vector<fc::variant> {fc::variant(time_ranges)}).wait();
+            return result.as<std::vector<std::pair<uint32_t, uint32_t>>>();
+        }
         thinkyoung::blockchain::BlockchainSecurityState CommonApiRpcClient::blockchain_get_security_state() const {
             fc::variant result = get_json_connection()->async_call("blockchain_get_security_state", std::vector<fc::variant> {}).wait();
             return result.as<thinkyoung::blockchain::BlockchainSecurityState>();
@@ -119,6 +123,10 @@ namespace thinkyoung {
             fc::variant result = get_json_connection()->async_call("blockchain_list_address_transactions", std::vector<fc::variant> {fc::variant(addr), fc::variant(filter_before)}).wait();
             return result.as<fc::variant_object>();
         }
+        std::vector<thinkyoung::blockchain::TransactionEntry> CommonApiRpcClient::blockchain_list_address_transactions_paged(const std::string& addr, uint32_t since_block /* = fc::json::from_string("0").as<uint32_t>() */, uint32_t limit /* = fc::json::from_string("100").as<uint32_t>() */, bool reverse /* = fc::json::from_string("false").as<bool>() */) const {
+            fc::variant result = get_json_connection()->async_call("blockchain_list_address_transactions_paged", std::vector<fc::variant> {fc::variant(addr), fc::variant(since_block), fc::variant(limit), fc::variant(reverse)}).wait();
+            return result.as<std::vector<thinkyoung::blockchain::TransactionEntry>>();
+        }
         thinkyoung::wallet::AccountBalanceSummaryType CommonApiRpcClient::blockchain_get_account_public_balance(const std::string& account_name) const {
             fc::variant result = get_json_connection()->async_call("blockchain_get_account_public_balance", std::vector<fc::variant> {fc::variant(account_name)}).wait();
             return result.as<thinkyoung::wallet::AccountBalanceSummaryType>();
@@ -207,6 +215,10 @@ namespace thinkyoung {
             fc::variant result = get_json_connection()->async_call("blockchain_get_events", std::vector<fc::variant> {fc::variant(block_number), fc::variant(trx_id)}).wait();
             return result.as<std::vector<thinkyoung::blockchain::EventOperation>>();
         }
+        std::vector<thinkyoung::blockchain::ContractEventEntry> CommonApiRpcClient::blockchain_list_contract_events(const std::string& contract, const std::string& event_type /* = fc::json::from_string("\"\"").as<std::string>() */, uint32_t from_block /* = fc::json::from_string("0").as<uint32_t>() */, uint32_t to_block /* = fc::json::from_string("0").as<uint32_t>() */, uint32_t limit /* = fc::json::from_string("100").as<uint32_t>() */) const {
+            fc::variant result = get_json_connection()->async_call("blockchain_list_contract_events", std::vector<fc::variant> {fc::variant(contract), fc::variant(event_type), fc::variant(from_block), fc::variant(to_block), fc::variant(limit)}).wait();
+            return result.as<std::vector<thinkyoung::blockchain::ContractEventEntry>>();
+        }
         thinkyoung::blockchain::TransactionIdType CommonApiRpcClient::blockchain_get_transaction_id(const thinkyoung::blockchain::SignedTransaction& transaction_to_broadcast) {
             fc::variant result = get_json_connection()->async_call("blockchain_get_transaction_id", std::vector<fc::variant> {fc::variant(transaction_to_broadcast)}).wait();
             return result.as<thinkyoung::blockchain::TransactionIdType>();
@@ -753,6 +765,10 @@ namespace thinkyoung {
             fc::variant result = get_json_connection()->async_call("call_contract_local_emit", std::vector<fc::variant> {fc::variant(contract), fc::variant(caller_name), fc::variant(function_name), fc::variant(params)}).wait();
             return result.as<std::vector<thinkyoung::blockchain::EventOperation>>();
         }
+        thinkyoung::lua::lib::GluaProfileReport CommonApiRpcClient::call_contract_profile(const std::string& contract, const std::string& caller_name, const std::string& function_name, const std::string& params) {
+            fc::variant result = get_json_connection()->async_call("call_contract_profile", std::vector<fc::variant> {fc::variant(contract), fc::variant(caller_name), fc::variant(function_name), fc::variant(params)}).wait();
+            return result.as<thinkyoung::lua::lib::GluaProfileReport>();
+        }
         std::string CommonApiRpcClient::call_contract_offline(const std::string& contract, const std::string& caller_name, const std::string& function_name, const std::string& params) {
             fc::variant result = get_json_connection()->async_call("call_contract_offline", std::vector<fc::variant> {fc::variant(contract), fc::variant(caller_name), fc::variant(function_name), fc::variant(params)}).wait();
             return result.as<std::string>();
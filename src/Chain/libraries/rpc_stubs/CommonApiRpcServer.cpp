@@ -204,6 +204,30 @@ namespace thinkyoung {
             return fc::variant(result);
         }
 
+        fc::variant CommonApiRpcServer::blockchain_get_block_ranges_by_time_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters)
+        {
+            // this method has no prerequisites
+
+            if (parameters.size() <= 0)
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 1 (time_ranges)");
+            std::vector<std::pair<fc::time_point, fc::time_point>> time_ranges = parameters[0].as<std::vector<std::pair<fc::time_point, fc::time_point>>>();
+
+            std::vector<std::pair<uint32_t, uint32_t>> result = get_client()->blockchain_get_block_ranges_by_time(time_ranges);
+            return fc::variant(result);
+        }
+
+        fc::variant CommonApiRpcServer::blockchain_get_block_ranges_by_time_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters)
+        {
+            // this method has no prerequisites
+
+            if (!parameters.contains("time_ranges"))
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 'time_ranges'");
+            std::vector<std::pair<fc::time_point, fc::time_point>> time_ranges = parameters["time_ranges"].as<std::vector<std::pair<fc::time_point, fc::time_point>>>();
+
+            std::vector<std::pair<uint32_t, uint32_t>> result = get_client()->blockchain_get_block_ranges_by_time(time_ranges);
+            return fc::variant(result);
+        }
+
         fc::variant CommonApiRpcServer::blockchain_get_security_state_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters)
         {
             // this method has no prerequisites
@@ -660,6 +684,48 @@ namespace thinkyoung {
             return fc::variant(result);
         }
 
+        fc::variant CommonApiRpcServer::blockchain_list_address_transactions_paged_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters)
+        {
+            // this method has no prerequisites
+
+            if (parameters.size() <= 0)
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 1 (addr)");
+            std::string addr = parameters[0].as<std::string>();
+            uint32_t since_block = (parameters.size() <= 1) ?
+            (fc::json::from_string("0").as<uint32_t>()) :
+            parameters[1].as<uint32_t>();
+            uint32_t limit = (parameters.size() <= 2) ?
+            (fc::json::from_string("100").as<uint32_t>()) :
+            parameters[2].as<uint32_t>();
+            bool reverse = (parameters.size() <= 3) ?
+            (fc::json::from_string("false").as<bool>()) :
+            parameters[3].as<bool>();
+
+            std::vector<thinkyoung::blockchain::TransactionEntry> result = get_client()->blockchain_list_address_transactions_paged(addr, since_block, limit, reverse);
+            return fc::variant(result);
+        }
+
+        fc::variant CommonApiRpcServer::blockchain_list_address_transactions_paged_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters)
+        {
+            // this method has no prerequisites
+
+            if (!parameters.contains("addr"))
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 'addr'");
+            std::string addr = parameters["addr"].as<std::string>();
+            uint32_t since_block = parameters.contains("since_block") ?
+                parameters["since_block"].as<uint32_t>() :
+                (fc::json::from_string("0").as<uint32_t>());
+            uint32_t limit = parameters.contains("limit") ?
+                parameters["limit"].as<uint32_t>() :
+                (fc::json::from_string("100").as<uint32_t>());
+            bool reverse = parameters.contains("reverse") ?
+                parameters["reverse"].as<bool>() :
+                (fc::json::from_string("false").as<bool>());
+
+            std::vector<thinkyoung::blockchain::TransactionEntry> result = get_client()->blockchain_list_address_transactions_paged(addr, since_block, limit, reverse);
+            return fc::variant(result);
+        }
+
         fc::variant CommonApiRpcServer::blockchain_get_account_public_balance_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters)
         {
             // check all of this method's prerequisites
@@ -1254,6 +1320,54 @@ namespace thinkyoung {
             return fc::variant(result);
         }
 
+        fc::variant CommonApiRpcServer::blockchain_list_contract_events_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters)
+        {
+            // this method has no prerequisites
+
+            if (parameters.size() <= 0)
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 1 (contract)");
+            std::string contract = parameters[0].as<std::string>();
+            std::string event_type = (parameters.size() <= 1) ?
+            (fc::json::from_string("\"\"").as<std::string>()) :
+            parameters[1].as<std::string>();
+            uint32_t from_block = (parameters.size() <= 2) ?
+            (fc::json::from_string("0").as<uint32_t>()) :
+            parameters[2].as<uint32_t>();
+            uint32_t to_block = (parameters.size() <= 3) ?
+            (fc::json::from_string("0").as<uint32_t>()) :
+            parameters[3].as<uint32_t>();
+            uint32_t limit = (parameters.size() <= 4) ?
+            (fc::json::from_string("100").as<uint32_t>()) :
+            parameters[4].as<uint32_t>();
+
+            std::vector<thinkyoung::blockchain::ContractEventEntry> result = get_client()->blockchain_list_contract_events(contract, event_type, from_block, to_block, limit);
+            return fc::variant(result);
+        }
+
+        fc::variant CommonApiRpcServer::blockchain_list_contract_events_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters)
+        {
+            // this method has no prerequisites
+
+            if (!parameters.contains("contract"))
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 'contract'");
+            std::string contract = parameters["contract"].as<std::string>();
+            std::string event_type = parameters.contains("event_type") ?
+                parameters["event_type"].as<std::string>() :
+                (fc::json::from_string("\"\"").as<std::string>());
+            uint32_t from_block = parameters.contains("from_block") ?
+                parameters["from_block"].as<uint32_t>() :
+                (fc::json::from_string("0").as<uint32_t>());
+            uint32_t to_block = parameters.contains("to_block") ?
+                parameters["to_block"].as<uint32_t>() :
+                (fc::json::from_string("0").as<uint32_t>());
+            uint32_t limit = parameters.contains("limit") ?
+                parameters["limit"].as<uint32_t>() :
+                (fc::json::from_string("100").as<uint32_t>());
+
+            std::vector<thinkyoung::blockchain::ContractEventEntry> result = get_client()->blockchain_list_contract_events(contract, event_type, from_block, to_block, limit);
+            return fc::variant(result);
+        }
+
         fc::variant CommonApiRpcServer::blockchain_get_transaction_id_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters)
         {
             // check all of this method's prerequisites
@@ -6170,6 +6284,56 @@ namespace thinkyoung {
             return fc::variant(result);
         }
 
+        fc::variant CommonApiRpcServer::call_contract_profile_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters)
+        {
+            // check all of this method's prerequisites
+            verify_json_connection_is_authenticated(json_connection);
+            verify_wallet_is_open();
+            verify_wallet_is_unlocked();
+            // done checking prerequisites
+
+            if (parameters.size() <= 0)
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 1 (contract)");
+            std::string contract = parameters[0].as<std::string>();
+            if (parameters.size() <= 1)
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 2 (caller_name)");
+            std::string caller_name = parameters[1].as<std::string>();
+            if (parameters.size() <= 2)
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 3 (function_name)");
+            std::string function_name = parameters[2].as<std::string>();
+            if (parameters.size() <= 3)
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 4 (params)");
+            std::string params = parameters[3].as<std::string>();
+
+            thinkyoung::lua::lib::GluaProfileReport result = get_client()->call_contract_profile(contract, caller_name, function_name, params);
+            return fc::variant(result);
+        }
+
+        fc::variant CommonApiRpcServer::call_contract_profile_named(fc::rpc::json_connection* json_connection, const fc::variant_object& parameters)
+        {
+            // check all of this method's prerequisites
+            verify_json_connection_is_authenticated(json_connection);
+            verify_wallet_is_open();
+            verify_wallet_is_unlocked();
+            // done checking prerequisites
+
+            if (!parameters.contains("contract"))
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 'contract'");
+            std::string contract = parameters["contract"].as<std::string>();
+            if (!parameters.contains("caller_name"))
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 'caller_name'");
+            std::string caller_name = parameters["caller_name"].as<std::string>();
+            if (!parameters.contains("function_name"))
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 'function_name'");
+            std::string function_name = parameters["function_name"].as<std::string>();
+            if (!parameters.contains("params"))
+                FC_THROW_EXCEPTION(fc::invalid_arg_exception, "missing required parameter 'params'");
+            std::string params = parameters["params"].as<std::string>();
+
+            thinkyoung::lua::lib::GluaProfileReport result = get_client()->call_contract_profile(contract, caller_name, function_name, params);
+            return fc::variant(result);
+        }
+
         fc::variant CommonApiRpcServer::call_contract_offline_positional(fc::rpc::json_connection* json_connection, const fc::variants& parameters)
         {
             // check all of this method's prerequisites
@@ -7696,6 +7860,14 @@ namespace thinkyoung {
             json_connection->add_named_param_method("blockchain_get_blockcount", bound_named_method);
             json_connection->add_named_param_method("getblockcount", bound_named_method);
 
+           // register method blockchain_get_block_ranges_by_time
+            bound_positional_method = boost::bind(&CommonApiRpcServer::blockchain_get_block_ranges_by_time_positional,
+                this, capture_con, _1);
+            json_connection->add_method("blockchain_get_block_ranges_by_time", bound_positional_method);
+            bound_named_method = boost::bind(&CommonApiRpcServer::blockchain_get_block_ranges_by_time_named, 
+                this, capture_con, _1);
+            json_connection->add_named_param_method("blockchain_get_block_ranges_by_time", bound_named_method);
+
            // register method blockchain_get_security_state
             bound_positional_method = boost::bind(&CommonApiRpcServer::blockchain_get_security_state_positional,
                 this, capture_con, _1);
@@ -7870,6 +8042,14 @@ namespace thinkyoung {
             json_connection->add_named_param_method("blockchain_list_address_transactions", bound_named_method);
             json_connection->add_named_param_method("list_address_transactions", bound_named_method);
 
+           // register method blockchain_list_address_transactions_paged
+            bound_positional_method = boost::bind(&CommonApiRpcServer::blockchain_list_address_transactions_paged_positional,
+                this, capture_con, _1);
+            json_connection->add_method("blockchain_list_address_transactions_paged", bound_positional_method);
+            bound_named_method = boost::bind(&CommonApiRpcServer::blockchain_list_address_transactions_paged_named, 
+                this, capture_con, _1);
+            json_connection->add_named_param_method("blockchain_list_address_transactions_paged", bound_named_method);
+
            // register method blockchain_get_account_public_balance
             bound_positional_method = boost::bind(&CommonApiRpcServer::blockchain_get_account_public_balance_positional,
                 this, capture_con, _1);
@@ -8076,6 +8256,14 @@ namespace thinkyoung {
                 this, capture_con, _1);
             json_connection->add_named_param_method("blockchain_get_events", bound_named_method);
 
+           // register method blockchain_list_contract_events
+            bound_positional_method = boost::bind(&CommonApiRpcServer::blockchain_list_contract_events_positional,
+                this, capture_con, _1);
+            json_connection->add_method("blockchain_list_contract_events", bound_positional_method);
+            bound_named_method = boost::bind(&CommonApiRpcServer::blockchain_list_contract_events_named, 
+                this, capture_con, _1);
+            json_connection->add_named_param_method("blockchain_list_contract_events", bound_named_method);
+
            // register method blockchain_get_transaction_id
             bound_positional_method = boost::bind(&CommonApiRpcServer::blockchain_get_transaction_id_positional,
                 this, capture_con, _1);
@@ -9412,6 +9600,14 @@ namespace thinkyoung {
                 this, capture_con, _1);
             json_connection->add_named_param_method("call_contract_local_emit", bound_named_method);
 
+           // register method call_contract_profile
+            bound_positional_method = boost::bind(&CommonApiRpcServer::call_contract_profile_positional,
+                this, capture_con, _1);
+            json_connection->add_method("call_contract_profile", bound_positional_method);
+            bound_named_method = boost::bind(&CommonApiRpcServer::call_contract_profile_named, 
+                this, capture_con, _1);
+            json_connection->add_named_param_method("call_contract_profile", bound_named_method);
+
            // register method call_contract_offline
             bound_positional_method = boost::bind(&CommonApiRpcServer::call_contract_offline_positional,
                 this, capture_con, _1);
@@ -9813,6 +10009,20 @@ namespace thinkyoung {
                 store_method_metadata(blockchain_get_block_count_method_metadata);
             }
 
+            {
+                // register method blockchain_get_block_ranges_by_time
+                thinkyoung::api::MethodData blockchain_get_block_ranges_by_time_method_metadata{ "blockchain_get_block_ranges_by_time", nullptr,
+                    /* description */ "Converts time ranges into the first and last block produced within each of them, 0 and 0 when a range holds no block",
+                    /* returns */ "block_range_array",
+                    /* params: */{
+                        {"time_ranges", "time_range_array", thinkyoung::api::required_positional, fc::ovariant()}
+                          },
+                    /* prerequisites */ (thinkyoung::api::MethodPrerequisites) 0,
+                    /* detailed description */ "Converts time ranges into the first and last block produced within each of them, 0 and 0 when a range holds no block\n\nParameters:\n  time_ranges (time_range_array, required): pairs of first and last time, both included\n\nReturns:\n  block_range_array\n",
+                    /* aliases */ {}, false};
+                store_method_metadata(blockchain_get_block_ranges_by_time_method_metadata);
+            }
+
             {
                 // register method blockchain_get_security_state
                 thinkyoung::api::MethodData blockchain_get_security_state_method_metadata{ "blockchain_get_security_state", nullptr,
@@ -10065,6 +10275,23 @@ namespace thinkyoung {
                 store_method_metadata(blockchain_list_address_transactions_method_metadata);
             }
 
+            {
+                // register method blockchain_list_address_transactions_paged
+                thinkyoung::api::MethodData blockchain_list_address_transactions_paged_method_metadata{ "blockchain_list_address_transactions_paged", nullptr,
+                    /* description */ "Lists one page of the transactions involving an address, pages end on whole blocks",
+                    /* returns */ "transaction_entry_array",
+                    /* params: */{
+                        {"addr", "string", thinkyoung::api::required_positional, fc::ovariant()},
+                        {"since_block", "uint32_t", thinkyoung::api::optional_positional, fc::variant(fc::json::from_string("0"))},
+                        {"limit", "uint32_t", thinkyoung::api::optional_positional, fc::variant(fc::json::from_string("100"))},
+                        {"reverse", "bool", thinkyoung::api::optional_positional, fc::variant(fc::json::from_string("false"))}
+                          },
+                    /* prerequisites */ (thinkyoung::api::MethodPrerequisites) 0,
+                    /* detailed description */ "Lists one page of the transactions involving an address, pages end on whole blocks\n\nParameters:\n  addr (string, required): address to scan for\n  since_block (uint32_t, optional, defaults to 0): first block to list, or the newest when reverse; 0 for no bound\n  limit (uint32_t, optional, defaults to 100): transactions to list before stopping at the end of a block\n  reverse (bool, optional, defaults to false): list the newest transactions first\n\nReturns:\n  transaction_entry_array\n",
+                    /* aliases */ {}, false};
+                store_method_metadata(blockchain_list_address_transactions_paged_method_metadata);
+            }
+
             {
                 // register method blockchain_get_account_public_balance
                 thinkyoung::api::MethodData blockchain_get_account_public_balance_method_metadata{ "blockchain_get_account_public_balance", nullptr,
@@ -10388,6 +10615,24 @@ namespace thinkyoung {
                 store_method_metadata(blockchain_get_events_method_metadata);
             }
 
+            {
+                // register method blockchain_list_contract_events
+                thinkyoung::api::MethodData blockchain_list_contract_events_method_metadata{ "blockchain_list_contract_events", nullptr,
+                    /* description */ "Lists the events a contract emitted in a block range from the event index, results end on whole blocks",
+                    /* returns */ "contract_event_entry_array",
+                    /* params: */{
+                        {"contract", "string", thinkyoung::api::required_positional, fc::ovariant()},
+                        {"event_type", "string", thinkyoung::api::optional_positional, fc::variant(fc::json::from_string("\"\""))},
+                        {"from_block", "uint32_t", thinkyoung::api::optional_positional, fc::variant(fc::json::from_string("0"))},
+                        {"to_block", "uint32_t", thinkyoung::api::optional_positional, fc::variant(fc::json::from_string("0"))},
+                        {"limit", "uint32_t", thinkyoung::api::optional_positional, fc::variant(fc::json::from_string("100"))}
+                          },
+                    /* prerequisites */ (thinkyoung::api::MethodPrerequisites) 0,
+                    /* detailed description */ "Lists the events a contract emitted in a block range from the event index, results end on whole blocks\n\nParameters:\n  contract (string, required): contract name or address\n  event_type (string, optional, defaults to \"\"): event name to list, empty for all events of the contract\n  from_block (uint32_t, optional, defaults to 0): first block to list\n  to_block (uint32_t, optional, defaults to 0): last block to list, 0 for the head block\n  limit (uint32_t, optional, defaults to 100): events to list before stopping at the end of a block\n\nReturns:\n  contract_event_entry_array\n",
+                    /* aliases */ {}, false};
+                store_method_metadata(blockchain_list_contract_events_method_metadata);
+            }
+
             {
                 // register method blockchain_get_transaction_id
                 thinkyoung::api::MethodData blockchain_get_transaction_id_method_metadata{ "blockchain_get_transaction_id", nullptr,
@@ -12520,6 +12765,23 @@ namespace thinkyoung {
                 store_method_metadata(call_contract_local_emit_method_metadata);
             }
 
+            {
+                // register method call_contract_profile
+                thinkyoung::api::MethodData call_contract_profile_method_metadata{ "call_contract_profile", nullptr,
+                    /* description */ "call contract function on local endpoint without spreading it, and report the time spent per opcode, lua function and chain api",
+                    /* returns */ "contract_profile_report",
+                    /* params: */{
+                        {"contract", "string", thinkyoung::api::required_positional, fc::ovariant()},
+                        {"caller_name", "string", thinkyoung::api::required_positional, fc::ovariant()},
+                        {"function_name", "string", thinkyoung::api::required_positional, fc::ovariant()},
+                        {"params", "string", thinkyoung::api::required_positional, fc::ovariant()}
+                          },
+                    /* prerequisites */ (thinkyoung::api::MethodPrerequisites) 4,
+                    /* detailed description */ "call contract function on local endpoint without spreading it, and report the time spent per opcode, lua function and chain api\n\nParameters:\n  contract (string, required): contract name or contract address need to be called\n  caller_name (string, required): caller name\n  function_name (string, required): function in contract\n  params (string, required): parameters which would be passed to function\n\nReturns:\n  contract_profile_report\n",
+                    /* aliases */ {}, false};
+                store_method_metadata(call_contract_profile_method_metadata);
+            }
+
             {
                 // register method call_contract_offline
                 thinkyoung::api::MethodData call_contract_offline_method_metadata{ "call_contract_offline", nullptr,
@@ -13119,6 +13381,8 @@ namespace thinkyoung {
                 return blockchain_is_synced_positional(nullptr, parameters);
             if (method_name == "blockchain_get_block_count")
                 return blockchain_get_block_count_positional(nullptr, parameters);
+            if (method_name == "blockchain_get_block_ranges_by_time")
+                return blockchain_get_block_ranges_by_time_positional(nullptr, parameters);
             if (method_name == "blockchain_get_security_state")
                 return blockchain_get_security_state_positional(nullptr, parameters);
             if (method_name == "blockchain_list_accounts")
@@ -13155,6 +13419,8 @@ namespace thinkyoung {
                 return blockchain_list_address_balances_positional(nullptr, parameters);
             if (method_name == "blockchain_list_address_transactions")
                 return blockchain_list_address_transactions_positional(nullptr, parameters);
+            if (method_name == "blockchain_list_address_transactions_paged")
+                return blockchain_list_address_transactions_paged_positional(nullptr, parameters);
             if (method_name == "blockchain_get_account_public_balance")
                 return blockchain_get_account_public_balance_positional(nullptr, parameters);
             if (method_name == "blockchain_list_key_balances")
@@ -13201,6 +13467,8 @@ namespace thinkyoung {
                 return blockchain_list_pub_all_address_positional(nullptr, parameters);
             if (method_name == "blockchain_get_events")
                 return blockchain_get_events_positional(nullptr, parameters);
+            if (method_name == "blockchain_list_contract_events")
+                return blockchain_list_contract_events_positional(nullptr, parameters);
             if (method_name == "blockchain_get_transaction_id")
                 return blockchain_get_transaction_id_positional(nullptr, parameters);
             if (method_name == "network_add_node")
@@ -13495,6 +13763,8 @@ namespace thinkyoung {
                 return call_contract_testing_positional(nullptr, parameters);
             if (method_name == "call_contract_local_emit")
                 return call_contract_local_emit_positional(nullptr, parameters);
+            if (method_name == "call_contract_profile")
+                return call_contract_profile_positional(nullptr, parameters);
             if (method_name == "call_contract_offline")
                 return call_contract_offline_positional(nullptr, parameters);
             if (method_name == "load_contract_to_file")
@@ -22,6 +22,7 @@
 #include "boost/filesystem/path.hpp"
 #include "boost/filesystem/operations.hpp"
 #include <blockchain/ContractOperations.hpp>
+#include <blockchain/ContractSimulator.hpp>
 #include <utilities/CommonApi.hpp>
 namespace thinkyoung {
     namespace wallet {
@@ -2815,6 +2816,15 @@ namespace thinkyoung {
             return my->_blockchain;
         }
         
+        TransactionEvaluationStatePtr Wallet::simulate_contract_testing(const SignedTransaction& trx,
+                const std::function<void(TransactionEvaluationState&)>& configure) const {
+            // the sandbox state changes with every sandbox call, evaluate on it in place
+            if (my->_blockchain->get_is_in_sandbox())
+                return ContractSimulator::evaluate(my->_blockchain->get_sandbox_pending_state(), trx, configure);
+                
+            return my->_blockchain->simulate_transaction(trx, configure);
+        }
+        
         WalletTransactionEntry Wallet::register_contract(const string& owner, const fc::path codefile, const string& asset_symbol, double init_limit, bool is_testing) {
             ChainInterfacePtr data_ptr = get_correct_state_ptr();
             string codefile_str = codefile.string();
@@ -2896,12 +2906,7 @@ namespace thinkyoung {
                                                 );
             SignedTransaction     trx;
             trx = trans_entry.trx;
-            ChainInterfacePtr state_ptr = get_correct_state_ptr();
-            PendingChainStatePtr          pend_state = std::make_shared<PendingChainState>(state_ptr);
-            TransactionEvaluationStatePtr trx_eval_state = std::make_shared<TransactionEvaluationState>(pend_state.get());
-            trx_eval_state->skipexec = false;
-            trx_eval_state->evaluate_contract_testing = true;
-            trx_eval_state->evaluate(trx);
+            TransactionEvaluationStatePtr trx_eval_state = simulate_contract_testing(trx);
             std::vector<thinkyoung::blockchain::Asset> asset_vec;
             asset_vec.emplace_back(fee);
             asset_vec.emplace_back(margin);
@@ -2978,12 +2983,7 @@ namespace thinkyoung {
                                              true);
             SignedTransaction     trx;
             trx = trans_entry.trx;
-            ChainInterfacePtr state_ptr = get_correct_state_ptr();
-            PendingChainStatePtr          pend_state = std::make_shared<PendingChainState>(state_ptr);
-            TransactionEvaluationStatePtr trx_eval_state = std::make_shared<TransactionEvaluationState>(pend_state.get());
-            trx_eval_state->skipexec = false;
-            trx_eval_state->evaluate_contract_testing = true;
-            trx_eval_state->evaluate(trx);
+            TransactionEvaluationStatePtr trx_eval_state = simulate_contract_testing(trx);
             std::vector<thinkyoung::blockchain::Asset> asset_vec;
             asset_vec.emplace_back(fee);
             asset_vec.emplace_back(trx_eval_state->exec_cost);
@@ -3004,12 +3004,7 @@ namespace thinkyoung {
                                              true);
             SignedTransaction trx;
             trx = trans_entry.trx;
-            ChainInterfacePtr state_ptr = get_correct_state_ptr();
-            PendingChainStatePtr          pend_state = std::make_shared<PendingChainState>(state_ptr);
-            TransactionEvaluationStatePtr trx_eval_state = std::make_shared<TransactionEvaluationState>(pend_state.get());
-            trx_eval_state->skipexec = false;
-            trx_eval_state->evaluate_contract_testing = true;
-            trx_eval_state->evaluate(trx);
+            TransactionEvaluationStatePtr trx_eval_state = simulate_contract_testing(trx);
             vector<EventOperation> ops;
             
             for (const auto& op : trx_eval_state->p_result_trx.operations) {
@@ -3021,6 +3016,26 @@ namespace thinkyoung {
             return ops;
         }
         
+        thinkyoung::lua::lib::GluaProfileReport Wallet::call_contract_profile(const string caller, const ContractIdType contract, const string method, const string& arguments) {
+            FC_ASSERT(is_open(), "Wallet not open!");
+            FC_ASSERT(is_unlocked(), "Wallet not unlock!");
+            FC_ASSERT(my->is_receive_account(caller), "Invalid account name");
+            Asset asset_for_exec = my->_blockchain->get_amount(CONTRACT_TESTING_LIMIT_MAX);
+            auto trans_entry = call_contract(caller,
+                                             contract,
+                                             method,
+                                             arguments,
+                                             ALP_BLOCKCHAIN_SYMBOL,
+                                             (double)asset_for_exec.amount / ALP_BLOCKCHAIN_PRECISION,
+                                             true);
+            SignedTransaction trx;
+            trx = trans_entry.trx;
+            TransactionEvaluationStatePtr trx_eval_state = simulate_contract_testing(trx, [](TransactionEvaluationState& eval_state) {
+                eval_state.profile_contract_execution = true;
+            });
+            return trx_eval_state->exec_profile;
+        }
+        
         std::string Wallet::call_contract_offline(const string caller, const ContractIdType contract, const string method, const string& arguments) {
             FC_ASSERT(is_open(), "Wallet not open!");
             FC_ASSERT(is_unlocked(), "Wallet not unlock!");
@@ -3052,13 +3067,13 @@ namespace thinkyoung {
             lua::lib::GluaStateScope scope;
             lua::lib::add_global_string_variable(scope.L(), "caller", (((string)(caller_public_key)).c_str()));
             lua::lib::add_global_string_variable(scope.L(), "caller_address", ((string)(Address(caller_address))).c_str());
-            lua::lib::set_lua_state_value(scope.L(), "evaluate_state", statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
+            lua::lib::set_lua_state_value(scope.L(), GLUA_STATE_SLOT_EVALUATE_STATE, statevalue, GluaStateValueType::LUA_STATE_VALUE_POINTER);
             lua::api::global_glua_chain_api->clear_exceptions(scope.L());
             std::string result;
             scope.set_instructions_limit(CONTRACT_OFFLINE_LIMIT_MAX);
             scope.execute_contract_api_by_address(contract.AddressToString(AddressType::contract_address).c_str(), method.c_str(), arguments.c_str(), &result);
-            int exception_code = lua::lib::get_lua_state_value(scope.L(), "exception_code").int_value;
-            char* exception_msg = (char*)lua::lib::get_lua_state_value(scope.L(), "exception_msg").string_value;
+            int exception_code = lua::lib::get_lua_state_value(scope.L(), GLUA_STATE_SLOT_EXCEPTION_CODE).int_value;
+            char* exception_msg = (char*)lua::lib::get_lua_state_value(scope.L(), GLUA_STATE_SLOT_EXCEPTION_MSG).string_value;
             
             if (exception_code > 0) {
                 thinkyoung::blockchain::contract_error con_err(32000, "exception", exception_msg);
@@ -3639,12 +3654,7 @@ namespace thinkyoung {
                                    true,
                                    true);
                 trx = trans_entry.trx;
-                ChainInterfacePtr state_ptr = get_correct_state_ptr();
-                PendingChainStatePtr          pend_state = std::make_shared<PendingChainState>(state_ptr);
-                TransactionEvaluationStatePtr trx_eval_state = std::make_shared<TransactionEvaluationState>(pend_state.get());
-                trx_eval_state->skipexec = false;
-                trx_eval_state->evaluate_contract_testing = true;
-                trx_eval_state->evaluate(trx);
+                TransactionEvaluationStatePtr trx_eval_state = simulate_contract_testing(trx);
                 std::vector<thinkyoung::blockchain::Asset> asset_vec;
                 asset_vec.emplace_back(required_fees);
                 asset_vec.emplace_back(asset_to_transfer);
@@ -3713,12 +3723,7 @@ namespace thinkyoung {
                                                     true
                                                    );
                 SignedTransaction     trx = trans_entry.trx;
-                ChainInterfacePtr state_ptr = get_correct_state_ptr();
-                PendingChainStatePtr          pend_state = std::make_shared<PendingChainState>(state_ptr);
-                TransactionEvaluationStatePtr trx_eval_state = std::make_shared<TransactionEvaluationState>(pend_state.get());
-                trx_eval_state->skipexec = false;
-                trx_eval_state->evaluate_contract_testing = true;
-                trx_eval_state->evaluate(trx);
+                TransactionEvaluationStatePtr trx_eval_state = simulate_contract_testing(trx);
                 std::vector<thinkyoung::blockchain::Asset> asset_vec;
                 asset_vec.emplace_back(fee);
                 asset_vec.emplace_back(trx_eval_state->exec_cost);
@@ -3851,12 +3856,7 @@ namespace thinkyoung {
                                                     true
                                                    );
                 SignedTransaction     trx = trans_entry.trx;
-                ChainInterfacePtr state_ptr = get_correct_state_ptr();
-                PendingChainStatePtr          pend_state = std::make_shared<PendingChainState>(state_ptr);
-                TransactionEvaluationStatePtr trx_eval_state = std::make_shared<TransactionEvaluationState>(pend_state.get());
-                trx_eval_state->skipexec = false;
-                trx_eval_state->evaluate_contract_testing = true;
-                trx_eval_state->evaluate(trx);
+                TransactionEvaluationStatePtr trx_eval_state = simulate_contract_testing(trx);
                 std::vector<thinkyoung::blockchain::Asset> asset_vec;
                 asset_vec.emplace_back(fee);
                 asset_vec.emplace_back(trx_eval_state->exec_cost);
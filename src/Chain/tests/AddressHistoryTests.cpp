@@ -0,0 +1,109 @@
+#include "ChainFixture.hpp"
+
+#include <algorithm>
+#include <limits>
+
+using namespace thinkyoung::blockchain;
+using namespace thinkyoung::blockchain::test;
+
+namespace {
+
+    // account 0 sends in blocks 1, 2 (twice) and 4, block 3 only moves funds between accounts 1 and 2
+    struct AddressHistoryFixture : ChainFixture
+    {
+        AddressHistoryFixture() {
+            push_transfer(0, account_address(1), ALP_BLOCKCHAIN_PRECISION);
+            produce_block();
+            push_transfer(0, account_address(2), ALP_BLOCKCHAIN_PRECISION);
+            push_transfer(0, account_address(1), 2 * ALP_BLOCKCHAIN_PRECISION);
+            produce_block();
+            push_transfer(1, account_address(2), ALP_BLOCKCHAIN_PRECISION);
+            produce_block();
+            push_transfer(0, account_address(2), 3 * ALP_BLOCKCHAIN_PRECISION);
+            produce_block();
+        }
+
+        std::vector<uint32_t> history_blocks(const uint32_t account, const uint32_t since_block,
+                                             const uint32_t limit = 0, const bool reverse = false) {
+            std::vector<uint32_t> blocks;
+
+            for (const TransactionEntry& entry : db->fetch_address_transactions(account_address(account), since_block, limit, reverse))
+                blocks.push_back(entry.chain_location.block_num);
+
+            return blocks;
+        }
+    };
+
+}
+
+TEST_FIXTURE(AddressHistoryFixture, TEST_ADDRESS_HISTORY_FORWARD_PAGES)
+{
+    printf("TEST_ADDRESS_HISTORY_FORWARD_PAGES\n");
+    GCHECK_EQUAL(4u, db->get_head_block_num());
+    GCHECK(history_blocks(0, 0) == std::vector<uint32_t>({ 1, 2, 2, 4 }));
+    // a page ends on a whole block, so a limit inside block 2 still returns both of its transactions
+    GCHECK(history_blocks(0, 0, 1) == std::vector<uint32_t>({ 1 }));
+    GCHECK(history_blocks(0, 0, 2) == std::vector<uint32_t>({ 1, 2, 2 }));
+    GCHECK(history_blocks(0, 2, 1) == std::vector<uint32_t>({ 2, 2 }));
+    GCHECK(history_blocks(0, 3, 1) == std::vector<uint32_t>({ 4 }));
+    GCHECK(history_blocks(0, 4) == std::vector<uint32_t>({ 4 }));
+    GCHECK(history_blocks(0, 5).empty());
+    GCHECK(history_blocks(0, std::numeric_limits<uint32_t>::max()).empty());
+    GCHECK(history_blocks(3, 0).empty());
+
+    // resuming from the block after the last one returned walks the whole history exactly once
+    std::vector<uint32_t> paged;
+    uint32_t since_block = 0;
+
+    for (;;) {
+        const std::vector<uint32_t> page = history_blocks(0, since_block, 1);
+
+        if (page.empty())
+            break;
+
+        paged.insert(paged.end(), page.begin(), page.end());
+        since_block = page.back() + 1;
+    }
+
+    GCHECK(paged == history_blocks(0, 0));
+}
+
+TEST_FIXTURE(AddressHistoryFixture, TEST_ADDRESS_HISTORY_REVERSE_PAGES)
+{
+    printf("TEST_ADDRESS_HISTORY_REVERSE_PAGES\n");
+    GCHECK(history_blocks(0, 0, 0, true) == std::vector<uint32_t>({ 4, 2, 2, 1 }));
+    // starting past the head, at the largest block number, must not wrap to block 0
+    GCHECK(history_blocks(0, std::numeric_limits<uint32_t>::max(), 0, true) == std::vector<uint32_t>({ 4, 2, 2, 1 }));
+    GCHECK(history_blocks(0, 4, 1, true) == std::vector<uint32_t>({ 4 }));
+    GCHECK(history_blocks(0, 3, 1, true) == std::vector<uint32_t>({ 2, 2 }));
+    GCHECK(history_blocks(0, 2, 0, true) == std::vector<uint32_t>({ 2, 2, 1 }));
+    GCHECK(history_blocks(0, 1, 0, true) == std::vector<uint32_t>({ 1 }));
+    GCHECK(history_blocks(3, 0, 0, true).empty());
+
+    std::vector<uint32_t> paged;
+    uint32_t since_block = std::numeric_limits<uint32_t>::max();
+
+    for (;;) {
+        const std::vector<uint32_t> page = history_blocks(0, since_block, 1, true);
+
+        if (page.empty())
+            break;
+
+        paged.insert(paged.end(), page.begin(), page.end());
+
+        if (page.back() == 1)
+            break;
+
+        since_block = page.back() - 1;
+    }
+
+    GCHECK(paged == history_blocks(0, 0, 0, true));
+
+    // whichever address sorts last in the index, the reverse walk mirrors the forward one
+    for (uint32_t account = 0; account < 3; ++account) {
+        std::vector<uint32_t> forward = history_blocks(account, 0);
+        std::reverse(forward.begin(), forward.end());
+        GCHECK(!forward.empty());
+        GCHECK(history_blocks(account, 0, 0, true) == forward);
+    }
+}
@@ -0,0 +1,142 @@
+#include "ChainFixture.hpp"
+
+#include <blockchain/BlockTimestampIndex.hpp>
+
+#include <limits>
+#include <utility>
+
+using namespace thinkyoung::blockchain;
+using namespace thinkyoung::blockchain::test;
+
+namespace {
+
+    typedef std::pair<fc::time_point_sec, fc::time_point_sec> TimeRange;
+    typedef std::pair<uint32_t, uint32_t> BlockRange;
+
+    // blocks 1 and 2 in the first two slots, two missed slots, then blocks 3 and 4
+    struct BlockTimestampFixture : ChainFixture
+    {
+        BlockTimestampFixture() {
+            produce_block();
+            produce_block();
+            produce_block(2);
+            produce_block();
+        }
+
+        fc::time_point_sec at(const uint32_t seconds)const {
+            return genesis_time + seconds;
+        }
+    };
+
+}
+
+GTEST(TEST_BLOCK_TIMESTAMP_INDEX_EDGES)
+{
+    printf("TEST_BLOCK_TIMESTAMP_INDEX_EDGES\n");
+    fc::temp_directory dir;
+    const fc::path file = dir.path() / "block_timestamps";
+    const uint32_t start = 1500000000;
+    BlockTimestampIndex index;
+    index.open(file);
+    GCHECK_EQUAL(0u, index.size());
+    GCHECK_EQUAL(0u, index.find_block_num(fc::time_point_sec(start)));
+    GCHECK_EQUAL(1u, index.find_first_block_num(fc::time_point_sec(start)));
+
+    // past the first growth of the file, so the index is mapped again while it is written
+    const uint32_t block_count = (1 << 15) + 10;
+
+    for (uint32_t block_num = 1; block_num <= block_count; ++block_num)
+        index.store(block_num, fc::time_point_sec(start + 10 * block_num));
+
+    GCHECK_EQUAL(block_count, index.size());
+    GCHECK_EQUAL(1u, index.find_block_num(fc::time_point_sec(start)));
+    GCHECK_EQUAL(1u, index.find_block_num(fc::time_point_sec(start + 10)));
+    GCHECK_EQUAL(1u, index.find_block_num(fc::time_point_sec(start + 19)));
+    GCHECK_EQUAL(1u, index.find_first_block_num(fc::time_point_sec(start)));
+    GCHECK_EQUAL(2u, index.find_first_block_num(fc::time_point_sec(start + 11)));
+    GCHECK_EQUAL(uint32_t(1 << 15), index.find_block_num(fc::time_point_sec(start + 10 * (1 << 15) + 9)));
+    GCHECK_EQUAL(uint32_t(1 << 15) + 1, index.find_first_block_num(fc::time_point_sec(start + 10 * (1 << 15) + 1)));
+    GCHECK_EQUAL(block_count, index.find_block_num(fc::time_point_sec(std::numeric_limits<uint32_t>::max())));
+    GCHECK_EQUAL(block_count + 1, index.find_first_block_num(fc::time_point_sec(start + 10 * block_count + 1)));
+
+    // popped blocks are forgotten, and blocks pushed again overwrite them
+    index.resize(2);
+    GCHECK_EQUAL(2u, index.find_block_num(fc::time_point_sec(start + 100)));
+    GCHECK_EQUAL(3u, index.find_first_block_num(fc::time_point_sec(start + 21)));
+    index.store(3, fc::time_point_sec(start + 50));
+    GCHECK_EQUAL(2u, index.find_block_num(fc::time_point_sec(start + 49)));
+    GCHECK_EQUAL(3u, index.find_block_num(fc::time_point_sec(start + 100)));
+
+    // the timestamps stay in the file, the chain sets the size again when it opens
+    index.close();
+    index.open(file);
+    GCHECK_EQUAL(0u, index.size());
+    GCHECK(index.at(3) == fc::time_point_sec(start + 50));
+    GCHECK(index.at(block_count) == fc::time_point_sec(start + 10 * block_count));
+    GCHECK(index.at(0) == fc::time_point_sec());
+}
+
+TEST_FIXTURE(BlockTimestampFixture, TEST_FIND_BLOCK_NUM_EDGES)
+{
+    printf("TEST_FIND_BLOCK_NUM_EDGES\n");
+    GCHECK_EQUAL(4u, db->get_head_block_num());
+    GCHECK(db->get_block_header(3).timestamp == at(50));
+    // before the first block the first block is returned
+    GCHECK_EQUAL(1u, db->find_block_num(at(0)));
+    GCHECK_EQUAL(1u, db->find_block_num(at(10)));
+    GCHECK_EQUAL(1u, db->find_block_num(at(19)));
+    GCHECK_EQUAL(2u, db->find_block_num(at(20)));
+    GCHECK_EQUAL(2u, db->find_block_num(at(49)));
+    GCHECK_EQUAL(3u, db->find_block_num(at(50)));
+    GCHECK_EQUAL(4u, db->find_block_num(at(60)));
+    GCHECK_EQUAL(4u, db->find_block_num(fc::time_point_sec(std::numeric_limits<uint32_t>::max())));
+}
+
+TEST_FIXTURE(BlockTimestampFixture, TEST_FIND_BLOCK_RANGES_EDGES)
+{
+    printf("TEST_FIND_BLOCK_RANGES_EDGES\n");
+    const std::vector<TimeRange> time_ranges = {
+        TimeRange(at(0), at(5)),        // before the first block
+        TimeRange(at(0), at(10)),       // ends on the first block
+        TimeRange(at(10), at(20)),
+        TimeRange(at(11), at(19)),      // between two blocks
+        TimeRange(at(21), at(49)),      // the missed slots
+        TimeRange(at(20), at(50)),      // both ends on the blocks around the missed slots
+        TimeRange(at(25), at(1000)),    // ends after the head block
+        TimeRange(at(60), at(60)),      // one block, one second
+        TimeRange(at(61), at(1000)),    // after the head block
+        TimeRange(at(50), at(20)),      // inverted
+        TimeRange(fc::time_point_sec(), fc::time_point_sec(std::numeric_limits<uint32_t>::max()))
+    };
+    const std::vector<BlockRange> expected = {
+        BlockRange(0, 0),
+        BlockRange(1, 1),
+        BlockRange(1, 2),
+        BlockRange(0, 0),
+        BlockRange(0, 0),
+        BlockRange(2, 3),
+        BlockRange(3, 4),
+        BlockRange(4, 4),
+        BlockRange(0, 0),
+        BlockRange(0, 0),
+        BlockRange(1, 4)
+    };
+    const std::vector<BlockRange> block_ranges = db->find_block_ranges(time_ranges);
+    GCHECK_EQUAL(expected.size(), block_ranges.size());
+    GCHECK(block_ranges == expected);
+
+    for (size_t i = 0; i < time_ranges.size() && i < block_ranges.size(); ++i) {
+        if (block_ranges[i].first == 0)
+            continue;
+
+        // every block of a range is inside it, and its neighbours are not
+        GCHECK(db->get_block_header(block_ranges[i].first).timestamp >= time_ranges[i].first);
+        GCHECK(db->get_block_header(block_ranges[i].second).timestamp <= time_ranges[i].second);
+
+        if (block_ranges[i].first > 1)
+            GCHECK(db->get_block_header(block_ranges[i].first - 1).timestamp < time_ranges[i].first);
+
+        if (block_ranges[i].second < db->get_head_block_num())
+            GCHECK(db->get_block_header(block_ranges[i].second + 1).timestamp > time_ranges[i].second);
+    }
+}
@@ -0,0 +1,132 @@
+#include "ChainFixture.hpp"
+
+#include <blockchain/api_extern.hpp>
+#include <blockchain/GenesisState.hpp>
+#include <blockchain/Time.hpp>
+
+#include <fc/crypto/ripemd160.hpp>
+#include <fc/io/json.hpp>
+#include <fc/io/raw.hpp>
+
+#include <algorithm>
+#include <string>
+
+namespace thinkyoung {
+    namespace blockchain {
+        namespace test {
+
+            const ShareType ChainFixture::initial_balance;
+
+            ChainFixture::ChainFixture(const uint32_t funded_account_count, const bool statistics_enabled)
+                : genesis_time(1500000000) {
+                // the chain reads the relay fee from the client after each block
+                client = std::make_shared<thinkyoung::client::Client>("chain_tests");
+                thinkyoung::client::g_client = client.get();
+                start_simulated_time(fc::time_point(genesis_time));
+
+                GenesisState genesis;
+                genesis.timestamp = genesis_time;
+
+                for (uint32_t i = 0; i < ALP_BLOCKCHAIN_NUM_DELEGATES; ++i) {
+                    const PrivateKeyType key = PrivateKeyType::regenerate(fc::sha256::hash("delegate" + std::to_string(i)));
+                    GenesisDelegate delegate;
+                    delegate.name = "init" + std::to_string(i);
+                    delegate.owner = key.get_public_key();
+                    genesis.delegates.push_back(delegate);
+                    delegate_keys[delegate.owner] = key;
+                }
+
+                for (uint32_t i = 0; i < funded_account_count; ++i) {
+                    account_keys.push_back(PrivateKeyType::regenerate(fc::sha256::hash("account" + std::to_string(i))));
+                    GenesisBalance balance;
+                    balance.raw_address = string(account_address(i));
+                    balance.balance = initial_balance;
+                    genesis.initial_balances.push_back(balance);
+                }
+
+                const fc::path genesis_file = data_dir.path() / "genesis.json";
+                fc::json::save_to_file(genesis, genesis_file);
+                db = std::make_shared<ChainDatabase>();
+                db->open(data_dir.path() / "chain", genesis_file, statistics_enabled);
+            }
+
+            ChainFixture::~ChainFixture() {
+                try {
+                    db->close();
+
+                } catch (const fc::exception& e) {
+                    elog("unexpected exception closing the test chain\n ${e}", ("e", e.to_detail_string()));
+                }
+
+                thinkyoung::client::g_client = nullptr;
+            }
+
+            FullBlock ChainFixture::generate_block(const uint32_t missed_slots) {
+                const fc::time_point_sec timestamp = std::max(db->get_head_block_timestamp(), genesis_time)
+                                                     + (missed_slots + 1) * ALP_BLOCKCHAIN_BLOCK_INTERVAL_SEC;
+                start_simulated_time(fc::time_point(timestamp));
+                FullBlock block_data = db->generate_block(timestamp);
+                const AccountEntry signee = db->get_slot_signee(timestamp, db->get_active_delegates());
+                const PrivateKeyType& key = delegate_keys.at(signee.signing_key());
+
+                // reveal the secret committed to by the delegate's last block, as Wallet::sign_block does
+                if (signee.delegate_info->next_secret_hash.valid())
+                    block_data.previous_secret = delegate_secret(key, signee.delegate_info->last_block_num_produced);
+
+                block_data.next_secret_hash = fc::ripemd160::hash(delegate_secret(key, block_data.block_num));
+                block_data.sign(key);
+                return block_data;
+            }
+
+            void ChainFixture::push_block(const FullBlock& block_data) {
+                db->push_block(block_data);
+            }
+
+            FullBlock ChainFixture::produce_block(const uint32_t missed_slots) {
+                const FullBlock block_data = generate_block(missed_slots);
+                push_block(block_data);
+                return block_data;
+            }
+
+            void ChainFixture::produce_blocks(const uint32_t count) {
+                for (uint32_t i = 0; i < count; ++i)
+                    produce_block();
+            }
+
+            SignedTransaction ChainFixture::transfer(const uint32_t from, const Address& to, const ShareType amount)const {
+                SignedTransaction trx;
+                trx.expiration = now() + ALP_DEFAULT_TRANSACTION_EXPIRATION_SEC;
+                trx.withdraw(account_balance_id(from), amount + DelegateConfig().transaction_min_fee);
+                trx.deposit(to, Asset(amount, 0));
+                trx.sign(account_keys.at(from), db->get_chain_id());
+                return trx;
+            }
+
+            SignedTransaction ChainFixture::push_transfer(const uint32_t from, const Address& to, const ShareType amount) {
+                const SignedTransaction trx = transfer(from, to, amount);
+                db->store_pending_transaction(trx, true);
+                return trx;
+            }
+
+            Address ChainFixture::account_address(const uint32_t index)const {
+                return Address(account_keys.at(index).get_public_key());
+            }
+
+            BalanceIdType ChainFixture::account_balance_id(const uint32_t index)const {
+                return BalanceEntry(account_address(index), Asset(0, 0), 0).id();
+            }
+
+            detail::ChainDatabaseImpl& ChainFixture::impl()const {
+                return *db->my;
+            }
+
+            SecretHashType ChainFixture::delegate_secret(const PrivateKeyType& key, const uint32_t block_num)const {
+                fc::sha256::encoder enc;
+                fc::raw::pack(enc, key.get_secret());
+                fc::raw::pack(enc, block_num);
+                return fc::ripemd160::hash(enc.result());
+            }
+
+        }
+    }
+} // thinkyoung::blockchain::test
@@ -0,0 +1,64 @@
+#pragma once
+#include <blockchain/ChainDatabase.hpp>
+#include <client/Client.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <UnitTest++/UnitTest++.h>
+
+#define GTEST TEST
+#define GCHECK CHECK
+#define GCHECK_EQUAL CHECK_EQUAL
+
+namespace thinkyoung {
+    namespace blockchain {
+        namespace test {
+
+            /**
+             *  A chain opened in a temporary directory from a generated genesis state, with simulated
+             *  time. Blocks are signed with the deterministic keys of the genesis delegates, and a few
+             *  funded accounts can transfer between each other.
+             */
+            struct ChainFixture
+            {
+                ChainFixture(const uint32_t funded_account_count = 8, const bool statistics_enabled = true);
+                ~ChainFixture();
+
+                /** the next block with the pending transactions after missed_slots empty slots, signed but not pushed */
+                FullBlock                 generate_block(const uint32_t missed_slots = 0);
+                void                      push_block(const FullBlock& block_data);
+                /** generate_block and push_block */
+                FullBlock                 produce_block(const uint32_t missed_slots = 0);
+                /** pushes empty blocks until the head block is count blocks further */
+                void                      produce_blocks(const uint32_t count);
+
+                /** a signed transfer of amount plus the minimum fee from the balance of a funded account */
+                SignedTransaction         transfer(const uint32_t from, const Address& to, const ShareType amount)const;
+                /** transfer and store_pending_transaction */
+                SignedTransaction         push_transfer(const uint32_t from, const Address& to, const ShareType amount);
+
+                Address                   account_address(const uint32_t index)const;
+                BalanceIdType             account_balance_id(const uint32_t index)const;
+
+                detail::ChainDatabaseImpl& impl()const;
+
+                static const ShareType    initial_balance = 1000 * ALP_BLOCKCHAIN_PRECISION;
+
+                fc::temp_directory                               data_dir;
+                fc::time_point_sec                               genesis_time;
+                std::shared_ptr<thinkyoung::client::Client>      client;
+                ChainDatabasePtr                                 db;
+                std::map<PublicKeyType, PrivateKeyType>          delegate_keys;
+                std::vector<PrivateKeyType>                      account_keys;
+
+            private:
+                SecretHashType            delegate_secret(const PrivateKeyType& key, const uint32_t block_num)const;
+            };
+
+        }
+    }
+} // thinkyoung::blockchain::test
@@ -0,0 +1,206 @@
+#include "ChainFixture.hpp"
+
+#include <blockchain/ChainDatabaseImpl.hpp>
+#include <db/LevelDatabase.hpp>
+#include <db/LevelMap.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace thinkyoung::blockchain;
+using namespace thinkyoung::blockchain::test;
+using thinkyoung::db::LevelDatabase;
+using thinkyoung::db::LevelMap;
+
+namespace {
+
+    typedef LevelMap<uint32_t, std::string> TestTable;
+
+    // as many tables as the chain state has
+    const uint32_t table_count = 29;
+
+    std::string value_of(const uint32_t block_num, const uint32_t key) {
+        return std::string(64, char('a' + (block_num + key) % 26));
+    }
+
+}
+
+GTEST(TEST_CHAIN_STATE_DEFERRED_READS)
+{
+    printf("TEST_CHAIN_STATE_DEFERRED_READS\n");
+    fc::temp_directory dir;
+    LevelDatabase database;
+    TestTable::add_table(database, 1);
+    TestTable::add_table(database, 2);
+    database.open(dir.path() / "chain_state");
+    TestTable first;
+    TestTable second;
+    first.open(database, 1);
+    second.open(database, 2);
+
+    for (uint32_t key = 1; key <= 5; ++key) {
+        first.store(key * 10, "stored");
+        second.store(key, "second");
+    }
+
+    database.defer_writes();
+    first.store(20, "replaced");
+    first.store(25, "added");
+    first.remove(30);
+    first.store(60, "added");
+    second.remove(5);
+    auto snapshot = first.begin();
+
+    // every read sees the held writes, none of them reached leveldb yet
+    GCHECK(first.fetch(20) == "replaced");
+    GCHECK(!first.fetch_optional(30).valid());
+    GCHECK(first.fetch(25) == "added");
+    GCHECK(first.find(30).valid() == false);
+    GCHECK_EQUAL(25u, first.lower_bound(21).key());
+    GCHECK_EQUAL(40u, first.lower_bound(26).key());
+    GCHECK_EQUAL(60u, first.last().key());
+    GCHECK_EQUAL(4u, second.last().key());
+    std::vector<uint32_t> keys;
+
+    for (auto iter = first.begin(); iter.valid(); ++iter)
+        keys.push_back(iter.key());
+
+    GCHECK(keys == std::vector<uint32_t>({ 10, 20, 25, 40, 50, 60 }));
+    keys.clear();
+
+    for (auto iter = first.last(); iter.valid(); --iter)
+        keys.push_back(iter.key());
+
+    GCHECK(keys == std::vector<uint32_t>({ 60, 50, 40, 25, 20, 10 }));
+    auto iter = first.lower_bound(25);
+    --iter;
+    GCHECK_EQUAL(20u, iter.key());
+    ++iter;
+    GCHECK_EQUAL(25u, iter.key());
+
+    // an iterator keeps the held writes it was created with
+    first.store(15, "later");
+    GCHECK_EQUAL(10u, snapshot.key());
+    ++snapshot;
+    GCHECK_EQUAL(20u, snapshot.key());
+    GCHECK(first.fetch(15) == "later");
+
+    database.commit_deferred_writes();
+    GCHECK(!database.deferring());
+    GCHECK_EQUAL(7u, first.size());
+    GCHECK_EQUAL(4u, second.size());
+
+    // the tables come back from one database with the committed writes
+    first.close();
+    second.close();
+    database.close();
+    TestTable::add_table(database, 1);
+    TestTable::add_table(database, 2);
+    database.open(dir.path() / "chain_state");
+    first.open(database, 1);
+    second.open(database, 2);
+    GCHECK(first.fetch(20) == "replaced");
+    GCHECK(!first.fetch_optional(30).valid());
+    GCHECK_EQUAL(60u, first.last().key());
+    GCHECK_EQUAL(10u, first.begin().key());
+    GCHECK_EQUAL(1u, second.begin().key());
+    GCHECK_EQUAL(4u, second.last().key());
+}
+
+GTEST(TEST_CHAIN_STATE_COMMIT_LATENCY)
+{
+    printf("TEST_CHAIN_STATE_COMMIT_LATENCY\n");
+    fc::temp_directory dir;
+    const uint32_t block_count = 200;
+    const uint32_t writes_per_block = 500;
+    // before: a database for every table, written one item at a time
+    std::vector<std::unique_ptr<TestTable>> separate;
+
+    for (uint32_t table = 0; table < table_count; ++table) {
+        separate.emplace_back(new TestTable());
+        separate.back()->open(dir.path() / ("separate_" + std::to_string(table)));
+    }
+
+    // after: the tables of one database, written with one batch per block
+    LevelDatabase database;
+    std::vector<std::unique_ptr<TestTable>> shared;
+
+    for (uint32_t table = 0; table < table_count; ++table)
+        TestTable::add_table(database, uint8_t(table + 1));
+
+    database.open(dir.path() / "chain_state");
+
+    for (uint32_t table = 0; table < table_count; ++table) {
+        shared.emplace_back(new TestTable());
+        shared.back()->open(database, uint8_t(table + 1));
+    }
+
+    fc::microseconds separate_time;
+    fc::microseconds shared_time;
+
+    for (uint32_t block_num = 1; block_num <= block_count; ++block_num) {
+        fc::time_point start = fc::time_point::now();
+
+        for (uint32_t i = 0; i < writes_per_block; ++i)
+            separate[i % table_count]->store(block_num * writes_per_block + i, value_of(block_num, i));
+
+        separate_time += fc::time_point::now() - start;
+        start = fc::time_point::now();
+        database.defer_writes();
+
+        for (uint32_t i = 0; i < writes_per_block; ++i)
+            shared[i % table_count]->store(block_num * writes_per_block + i, value_of(block_num, i));
+
+        database.commit_deferred_writes();
+        shared_time += fc::time_point::now() - start;
+    }
+
+    printf("  %u blocks of %u writes over %u tables, per block: %lld us in separate databases, %lld us in one batch\n",
+           block_count, writes_per_block, table_count,
+           (long long)(separate_time.count() / block_count), (long long)(shared_time.count() / block_count));
+
+    for (uint32_t table = 0; table < table_count; ++table) {
+        GCHECK_EQUAL(separate[table]->size(), shared[table]->size());
+        GCHECK(separate[table]->last().key() == shared[table]->last().key());
+        GCHECK(separate[table]->last().value() == shared[table]->last().value());
+    }
+}
+
+TEST_FIXTURE(ChainFixture, TEST_BLOCK_NUM_INDEX_FOLLOWS_CHAIN_STATE)
+{
+    printf("TEST_BLOCK_NUM_INDEX_FOLLOWS_CHAIN_STATE\n");
+    produce_blocks(3);
+    const BlockIdType head_block_id = db->get_head_block_id();
+    uint32_t last_block_num = 0;
+    BlockIdType last_block_id;
+
+    // the block was written to the chain state, but not to the index
+    impl()._block_num_to_id_db.remove(3);
+    impl().sync_block_num_to_id();
+    GCHECK(impl()._block_num_to_id_db.last(last_block_num, last_block_id));
+    GCHECK_EQUAL(3u, last_block_num);
+    GCHECK(last_block_id == head_block_id);
+
+    // the block was popped from the chain state, but not from the index
+    impl()._block_num_to_id_db.store(4, BlockIdType());
+    impl().sync_block_num_to_id();
+    GCHECK(impl()._block_num_to_id_db.last(last_block_num, last_block_id));
+    GCHECK_EQUAL(3u, last_block_num);
+
+    // popping a block leaves both in line
+    impl().pop_block();
+    GCHECK(impl()._block_num_to_id_db.last(last_block_num, last_block_id));
+    GCHECK_EQUAL(2u, last_block_num);
+    GCHECK(db->get_property_entry(PropertyIdType::head_block_id)->value.as<BlockIdType>() == db->get_head_block_id());
+
+    // the chain opens again without a replay, at the head block it was closed at
+    db->close();
+    db = std::make_shared<ChainDatabase>();
+    db->open(data_dir.path() / "chain", data_dir.path() / "genesis.json", true);
+    GCHECK_EQUAL(2u, db->get_head_block_num());
+    // a slot later than the popped block, which the fork database still knows
+    produce_block(1);
+    GCHECK_EQUAL(3u, db->get_head_block_num());
+    GCHECK(db->get_block_id(3) == db->get_head_block_id());
+}
@@ -0,0 +1,13 @@
+#include <blockchain/Time.hpp>
+
+#include <fc/log/logger_config.hpp>
+
+#include <UnitTest++/UnitTest++.h>
+
+int main(int argc, char* argv[])
+{
+    int status = UnitTest::RunAllTests();
+    thinkyoung::blockchain::shutdown_ntp_time();
+    fc::configure_logging(fc::logging_config::default_config());
+    return status;
+}
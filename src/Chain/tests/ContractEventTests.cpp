@@ -0,0 +1,180 @@
+#include "ChainFixture.hpp"
+
+#include <blockchain/ChainDatabaseImpl.hpp>
+#include <rpc/ContractEventSubscriptions.hpp>
+
+#include <fc/io/buffered_iostream.hpp>
+#include <fc/io/sstream.hpp>
+#include <fc/rpc/json_connection.hpp>
+
+#include <string>
+
+using namespace thinkyoung::blockchain;
+using namespace thinkyoung::blockchain::test;
+using thinkyoung::rpc::ContractEventSubscriptions;
+
+namespace {
+
+    ContractIdType contract_id(const std::string& name) {
+        return ContractIdType(PrivateKeyType::regenerate(fc::sha256::hash(name)).get_public_key());
+    }
+
+    SignedTransaction event_transaction(const std::vector<EventOperation>& events) {
+        SignedTransaction trx;
+
+        for (const EventOperation& event : events)
+            trx.operations.emplace_back(event);
+
+        return trx;
+    }
+
+    /**
+     *  Events of contract a: transfer and approve in block 1, two transfers in block 2 and an approve
+     *  in block 4. Contract b has a transfer in block 3. Only result transactions of contract calls may
+     *  carry events, so the blocks are written to the event index directly rather than pushed.
+     */
+    struct ContractEventFixture : ChainFixture
+    {
+        ContractEventFixture()
+            : contract_a(contract_id("contract a")), contract_b(contract_id("contract b")) {
+            produce_blocks(4);
+            blocks.resize(5);
+            add_events(1, { EventOperation(contract_a, "transfer", "1"), EventOperation(contract_a, "approve", "2") });
+            add_events(2, { EventOperation(contract_a, "transfer", "3") });
+            add_events(2, { EventOperation(contract_a, "transfer", "4") });
+            add_events(3, { EventOperation(contract_b, "transfer", "5") });
+            add_events(4, { EventOperation(contract_a, "approve", "6") });
+
+            for (uint32_t block_num = 1; block_num < blocks.size(); ++block_num)
+                impl().index_contract_events(blocks[block_num], true);
+        }
+
+        void add_events(const uint32_t block_num, const std::vector<EventOperation>& events) {
+            blocks[block_num].block_num = block_num;
+            blocks[block_num].user_transactions.push_back(event_transaction(events));
+        }
+
+        std::string event_params(const ContractIdType& contract, const std::string& event_type,
+                                 const uint32_t from_block = 0, const uint32_t to_block = 0, const uint32_t limit = 0) {
+            std::string params;
+
+            for (const ContractEventEntry& entry : db->fetch_contract_events(contract, event_type, from_block, to_block, limit))
+                params += entry.event_param;
+
+            return params;
+        }
+
+        ContractIdType           contract_a;
+        ContractIdType           contract_b;
+        std::vector<FullBlock>   blocks;
+    };
+
+    // a json connection that never reads, the notices it is sent are kept in out
+    struct NoticeConnection
+    {
+        NoticeConnection()
+            : out(std::make_shared<fc::stringstream>()),
+              connection(std::make_shared<fc::buffered_istream>(std::make_shared<fc::stringstream>()),
+                         std::make_shared<fc::buffered_ostream>(out)) {}
+
+        size_t notice_count() {
+            const std::string text = out->str();
+            size_t count = 0;
+
+            for (size_t pos = text.find("contract_event_notice"); pos != std::string::npos; pos = text.find("contract_event_notice", pos + 1))
+                ++count;
+
+            return count;
+        }
+
+        std::shared_ptr<fc::stringstream>   out;
+        fc::rpc::json_connection            connection;
+    };
+
+    ContractEventSubscriptions::Subscription subscription(const ContractIdType& contract, const std::string& event_type = std::string()) {
+        ContractEventSubscriptions::Subscription result;
+        result.contract_id = contract;
+        result.event_type = event_type;
+        return result;
+    }
+
+}
+
+TEST_FIXTURE(ContractEventFixture, TEST_CONTRACT_EVENT_RANGE_QUERY)
+{
+    printf("TEST_CONTRACT_EVENT_RANGE_QUERY\n");
+    GCHECK_EQUAL("134", event_params(contract_a, "transfer"));
+    GCHECK_EQUAL("26", event_params(contract_a, "approve"));
+    // all event names of a contract come out merged in chain order
+    GCHECK_EQUAL("12346", event_params(contract_a, ""));
+    GCHECK_EQUAL("5", event_params(contract_b, ""));
+    GCHECK_EQUAL("", event_params(contract_id("contract c"), ""));
+    GCHECK_EQUAL("", event_params(contract_a, "mint"));
+
+    GCHECK_EQUAL("34", event_params(contract_a, "transfer", 2, 2));
+    GCHECK_EQUAL("346", event_params(contract_a, "", 2));
+    GCHECK_EQUAL("12", event_params(contract_a, "", 0, 1));
+    GCHECK_EQUAL("", event_params(contract_a, "", 3, 3));
+    GCHECK_EQUAL("", event_params(contract_a, "", 5));
+    GCHECK_EQUAL("", event_params(contract_a, "", 4, 2));
+
+    // a limit inside a block still returns the rest of that block
+    GCHECK_EQUAL("1", event_params(contract_a, "transfer", 0, 0, 1));
+    GCHECK_EQUAL("134", event_params(contract_a, "transfer", 0, 0, 2));
+    GCHECK_EQUAL("12", event_params(contract_a, "", 0, 0, 1));
+    GCHECK_EQUAL("1234", event_params(contract_a, "", 0, 0, 3));
+    GCHECK_EQUAL("6", event_params(contract_a, "", 3, 0, 1));
+
+    const std::vector<ContractEventEntry> entries = db->fetch_contract_events(contract_a, "transfer", 2, 2);
+    GCHECK_EQUAL(2u, entries.size());
+    GCHECK_EQUAL(0u, entries[0].trx_num);
+    GCHECK_EQUAL(1u, entries[1].trx_num);
+    GCHECK(entries[1].trx_id == blocks[2].user_transactions[1].id());
+
+    // popping block 4 takes its events out of the index again
+    impl().index_contract_events(blocks[4], false);
+    GCHECK_EQUAL("2", event_params(contract_a, "approve"));
+    GCHECK_EQUAL("1234", event_params(contract_a, ""));
+}
+
+TEST_FIXTURE(ContractEventFixture, TEST_CONTRACT_EVENT_UNSUBSCRIBE)
+{
+    printf("TEST_CONTRACT_EVENT_UNSUBSCRIBE\n");
+    NoticeConnection all_of_a;
+    NoticeConnection approvals;
+    ContractEventSubscriptions subscriptions;
+    GCHECK(subscriptions.empty());
+    subscriptions.subscribe(&all_of_a.connection, subscription(contract_a));
+    subscriptions.subscribe(&approvals.connection, subscription(contract_a, "approve"));
+    subscriptions.subscribe(&approvals.connection, subscription(contract_b));
+
+    subscriptions.notify(*db, 1);
+    GCHECK_EQUAL(2u, all_of_a.notice_count());
+    GCHECK_EQUAL(1u, approvals.notice_count());
+    subscriptions.notify(*db, 3);
+    GCHECK_EQUAL(2u, all_of_a.notice_count());
+    GCHECK_EQUAL(2u, approvals.notice_count());
+
+    // only the subscription with the same contract and event name is dropped
+    GCHECK(!subscriptions.unsubscribe(&approvals.connection, subscription(contract_a, "transfer")));
+    GCHECK(!subscriptions.unsubscribe(&approvals.connection, subscription(contract_a)));
+    GCHECK(subscriptions.unsubscribe(&approvals.connection, subscription(contract_a, "approve")));
+    GCHECK(!subscriptions.unsubscribe(&approvals.connection, subscription(contract_a, "approve")));
+    GCHECK_EQUAL(1u, subscriptions.get_subscriptions(&approvals.connection).size());
+    subscriptions.notify(*db, 4);
+    GCHECK_EQUAL(3u, all_of_a.notice_count());
+    GCHECK_EQUAL(2u, approvals.notice_count());
+    subscriptions.notify(*db, 3);
+    GCHECK_EQUAL(3u, approvals.notice_count());
+
+    // dropping the last subscription of a connection forgets the connection
+    GCHECK(subscriptions.unsubscribe(&approvals.connection, subscription(contract_b)));
+    GCHECK(subscriptions.get_subscriptions(&approvals.connection).empty());
+    GCHECK(subscriptions.unsubscribe_all(&all_of_a.connection));
+    GCHECK(!subscriptions.unsubscribe_all(&all_of_a.connection));
+    GCHECK(subscriptions.empty());
+    subscriptions.notify(*db, 1);
+    subscriptions.notify(*db, 3);
+    GCHECK_EQUAL(3u, all_of_a.notice_count());
+    GCHECK_EQUAL(3u, approvals.notice_count());
+}
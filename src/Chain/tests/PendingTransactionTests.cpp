@@ -0,0 +1,87 @@
+#include "ChainFixture.hpp"
+
+#include <blockchain/ChainDatabaseImpl.hpp>
+#include <blockchain/Time.hpp>
+
+#include <string>
+
+using namespace thinkyoung::blockchain;
+using namespace thinkyoung::blockchain::test;
+
+namespace {
+
+    Address payee_address(const uint32_t index) {
+        return Address(PrivateKeyType::regenerate(fc::sha256::hash("pending" + std::to_string(index))).get_public_key());
+    }
+
+}
+
+TEST_FIXTURE(ChainFixture, TEST_REVALIDATE_KEEPS_UNTOUCHED_TRANSACTIONS)
+{
+    printf("TEST_REVALIDATE_KEEPS_UNTOUCHED_TRANSACTIONS\n");
+    const ShareType fee = DelegateConfig().transaction_min_fee;
+    produce_block();
+
+    // the block spends from account 0 and is generated before the transactions below are pending
+    push_transfer(0, payee_address(0), ALP_BLOCKCHAIN_PRECISION);
+    const FullBlock block_data = generate_block();
+    GCHECK_EQUAL(1u, block_data.user_transactions.size());
+    const SignedTransaction untouched = push_transfer(1, payee_address(1), ALP_BLOCKCHAIN_PRECISION);
+    const SignedTransaction touched = push_transfer(0, payee_address(2), ALP_BLOCKCHAIN_PRECISION);
+    const PendingTrxDependencies& before = impl()._pending_trx_dependencies.at(untouched.id());
+    // the time is read, the head block is not
+    GCHECK(before.read_keys->now);
+    GCHECK(!before.read_keys->head_block);
+    const TransactionEvaluationStatePtr untouched_state = before.eval_state;
+    const TransactionEvaluationStatePtr touched_state = impl()._pending_trx_dependencies.at(touched.id()).eval_state;
+    const fc::time_point_sec evaluated_at = before.now;
+
+    push_block(block_data);
+    GCHECK(db->get_head_block_timestamp() > evaluated_at);
+
+    if (impl()._revalidate_pending.valid())
+        impl()._revalidate_pending.wait();
+    else
+        impl().revalidate_pending();
+
+    // the block moved the head and paid its delegate, but left account 1 alone
+    GCHECK(!impl()._pending_trx_dependencies.count(block_data.user_transactions.front().id()));
+    const PendingTrxDependencies& after = impl()._pending_trx_dependencies.at(untouched.id());
+    GCHECK(after.eval_state == untouched_state);
+    GCHECK(after.now == evaluated_at);
+    // the block wrote the balance of account 0
+    GCHECK(impl()._pending_trx_dependencies.at(touched.id()).eval_state != touched_state);
+
+    // the reused changes added only their own fee to what the block left
+    const oAssetEntry head_base = db->get_asset_entry(AssetIdType(0));
+    const oAssetEntry pending_base = impl()._pending_trx_state->get_asset_entry(AssetIdType(0));
+    GCHECK(head_base.valid() && pending_base.valid());
+    GCHECK_EQUAL(head_base->collected_fees + 2 * fee, pending_base->collected_fees);
+    GCHECK_EQUAL(head_base->current_share_supply, pending_base->current_share_supply);
+    GCHECK_EQUAL(2u, db->get_pending_transactions().size());
+}
+
+TEST_FIXTURE(ChainFixture, TEST_REVALIDATE_DROPS_EXPIRED_TRANSACTIONS)
+{
+    printf("TEST_REVALIDATE_DROPS_EXPIRED_TRANSACTIONS\n");
+    produce_block();
+
+    // a block past the expiration, generated while the transaction is not pending yet
+    const FullBlock block_data = generate_block(ALP_DEFAULT_TRANSACTION_EXPIRATION_SEC / ALP_BLOCKCHAIN_BLOCK_INTERVAL_SEC);
+    start_simulated_time(fc::time_point(db->get_head_block_timestamp()));
+    const SignedTransaction trx = push_transfer(1, payee_address(3), ALP_BLOCKCHAIN_PRECISION);
+    const fc::time_point_sec expiration = trx.expiration;
+    GCHECK(impl()._pending_trx_dependencies.count(trx.id()));
+
+    // the block leaves the balance alone, the transaction is dropped for the time alone
+    push_block(block_data);
+    GCHECK(db->get_head_block_timestamp() >= expiration);
+
+    if (impl()._revalidate_pending.valid())
+        impl()._revalidate_pending.wait();
+    else
+        impl().revalidate_pending();
+
+    GCHECK(!impl()._pending_trx_dependencies.count(trx.id()));
+    GCHECK(db->get_pending_transactions().empty());
+}
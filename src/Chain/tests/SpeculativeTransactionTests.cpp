@@ -0,0 +1,82 @@
+#include "ChainFixture.hpp"
+
+#include <blockchain/ChainDatabaseImpl.hpp>
+
+#include <string>
+
+using namespace thinkyoung::blockchain;
+using namespace thinkyoung::blockchain::test;
+
+namespace {
+
+    Address payee_address(const uint32_t index) {
+        return Address(PrivateKeyType::regenerate(fc::sha256::hash("payee" + std::to_string(index))).get_public_key());
+    }
+
+    ShareType balance_of(const ChainDatabasePtr& db, const BalanceIdType& id) {
+        const oBalanceEntry entry = db->get_balance_entry(id);
+        return entry.valid() ? entry->balance : 0;
+    }
+
+}
+
+TEST_FIXTURE(ChainFixture, TEST_SPECULATIVE_BLOCKS_MATCH_SERIAL)
+{
+    printf("TEST_SPECULATIVE_BLOCKS_MATCH_SERIAL\n");
+    const ShareType fee = DelegateConfig().transaction_min_fee;
+    const uint32_t rounds = 3;
+
+    for (uint32_t round = 0; round < rounds; ++round) {
+        // disjoint transfers, each to an address the chain has not seen
+        for (uint32_t i = 0; i < 5; ++i)
+            push_transfer(i, payee_address(round * 5 + i), (round + 1) * ALP_BLOCKCHAIN_PRECISION);
+
+        // account 6 spends from the balance account 5 pays into in the same block,
+        // and account 0 withdraws from its balance a second time
+        push_transfer(5, account_address(6), 10 * ALP_BLOCKCHAIN_PRECISION);
+        push_transfer(6, account_address(7), ALP_BLOCKCHAIN_PRECISION);
+        push_transfer(0, account_address(7), ALP_BLOCKCHAIN_PRECISION);
+
+        const FullBlock block_data = generate_block();
+        GCHECK_EQUAL(8u, block_data.user_transactions.size());
+        GCHECK(impl().can_speculate_transactions(block_data.user_transactions));
+
+        // both evaluations run on their own layer over the head state, in the same order as push_block
+        const PendingChainStatePtr pending_state = std::make_shared<PendingChainState>(db);
+        const fc::sha256 serial_digest = impl().applied_transactions_digest(block_data, pending_state, nullptr, false);
+        const fc::sha256 speculative_digest = impl().applied_transactions_digest(block_data, pending_state, nullptr, true);
+        GCHECK(serial_digest == speculative_digest);
+        GCHECK(serial_digest == impl().applied_transactions_digest(block_data, pending_state, nullptr, false));
+
+        push_block(block_data);
+        GCHECK_EQUAL(round + 1, db->get_head_block_num());
+    }
+
+    // the block that was pushed wrote what both evaluations agreed on
+    GCHECK_EQUAL(initial_balance + rounds * (9 * ALP_BLOCKCHAIN_PRECISION - fee), balance_of(db, account_balance_id(6)));
+    GCHECK_EQUAL(initial_balance + rounds * 2 * ALP_BLOCKCHAIN_PRECISION, balance_of(db, account_balance_id(7)));
+    GCHECK_EQUAL(initial_balance - (1 + 2 + 3) * ALP_BLOCKCHAIN_PRECISION - rounds * (ALP_BLOCKCHAIN_PRECISION + 2 * fee),
+                 balance_of(db, account_balance_id(0)));
+    GCHECK_EQUAL(3 * ALP_BLOCKCHAIN_PRECISION, balance_of(db, BalanceEntry(payee_address(10), Asset(0, 0), 0).id()));
+}
+
+TEST_FIXTURE(ChainFixture, TEST_SPECULATIVE_BLOCK_WITH_ONE_BALANCE)
+{
+    printf("TEST_SPECULATIVE_BLOCK_WITH_ONE_BALANCE\n");
+
+    // every transaction conflicts with the one before it, so all but the first are evaluated again
+    for (uint32_t i = 0; i < 6; ++i)
+        push_transfer(0, payee_address(i), (i + 1) * ALP_BLOCKCHAIN_PRECISION);
+
+    const FullBlock block_data = generate_block();
+    GCHECK_EQUAL(6u, block_data.user_transactions.size());
+    GCHECK(impl().can_speculate_transactions(block_data.user_transactions));
+    const PendingChainStatePtr pending_state = std::make_shared<PendingChainState>(db);
+    GCHECK(impl().applied_transactions_digest(block_data, pending_state, nullptr, false)
+           == impl().applied_transactions_digest(block_data, pending_state, nullptr, true));
+    // the same check push_block runs while replaying in debug builds
+    impl().check_speculative_transactions(block_data, pending_state, nullptr);
+    push_block(block_data);
+    GCHECK_EQUAL(initial_balance - 21 * ALP_BLOCKCHAIN_PRECISION - 6 * DelegateConfig().transaction_min_fee,
+                 balance_of(db, account_balance_id(0)));
+}